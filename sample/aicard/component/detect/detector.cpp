@@ -98,7 +98,7 @@ AX_VOID CDetector::RunDetect(AX_VOID *pArg) {
     AX_U32 nSkipCount = 0;
     while (m_DetectThread.IsRunning()) {
         for (nCurrGrp = nNextGrp; nCurrGrp < TOTAL_GRP_COUNT; ++nCurrGrp) {
-            if (m_arrFrameQ[nCurrGrp].Pop(axFrame, 0)) {
+            if (m_arrFrameQ[nCurrGrp].pop(axFrame, 0)) {
                 nSkipCount = 0;
                 break;
             }
@@ -172,14 +172,21 @@ AX_BOOL CDetector::Init(AX_S32 nDevID, const DETECTOR_ATTR_T &stAttr) {
         m_stAttr.nSkipRate = 1;
     }
 
-    m_arrFrameQ = new (nothrow) CAXLockQ<CAXFrame>[stAttr.nGrpCount];
+    /* the frame queues are bounded lock-free rings: a depth <= 0 (unbounded for CAXLockQ) falls back to a bounded depth per grp */
+    AX_S32 nBufQDepth = m_stAttr.nDepth / static_cast<AX_S32>(stAttr.nGrpCount);
+    if (nBufQDepth <= 0) {
+        LOG_M_W(DETECTOR, "%s: fifo depth %d of %d grp is unbounded or < 1 per grp, use depth %d per grp", __func__, m_stAttr.nDepth,
+                stAttr.nGrpCount, DETECTOR_DEFAULT_GRP_DEPTH);
+        nBufQDepth = DETECTOR_DEFAULT_GRP_DEPTH;
+    }
+
+    m_arrFrameQ = new (nothrow) axcl::mpmc_queue<CAXFrame>[stAttr.nGrpCount];
     if (!m_arrFrameQ) {
         LOG_M_E(DETECTOR, "%s: alloc queue fail", __func__);
         return AX_FALSE;
     } else {
-        AX_S32 nBufQDepth = m_stAttr.nDepth / stAttr.nGrpCount;
         for (AX_U32 i = 0; i < stAttr.nGrpCount; ++i) {
-            m_arrFrameQ[i].SetCapacity(nBufQDepth);
+            m_arrFrameQ[i].set_capacity(nBufQDepth);
         }
     }
 
@@ -381,7 +388,7 @@ AX_BOOL CDetector::Stop(AX_VOID) {
 
     if (m_arrFrameQ) {
         for (AX_U32 i = 0; i < m_stAttr.nGrpCount; ++i) {
-            m_arrFrameQ[i].Wakeup();
+            m_arrFrameQ[i].wakeup();
         }
     }
 
@@ -431,7 +438,7 @@ AX_BOOL CDetector::SendFrame(const CAXFrame &axFrame) {
 
     axFrame.IncRef();
 
-    if (!m_arrFrameQ[axFrame.nGrp].Push(axFrame)) {
+    if (!m_arrFrameQ[axFrame.nGrp].push(axFrame)) {
         LOG_M_W(DETECTOR, "%s: push frame %lld to q full", __func__, axFrame.stFrame.stVFrame.stVFrame.u64SeqNum);
         axFrame.DecRef();
     }
@@ -444,11 +451,11 @@ AX_BOOL CDetector::SkipFrame(const CAXFrame &axFrame) {
 }
 
 AX_VOID CDetector::ClearQueue(AX_S32 nGrp) {
-    AX_U32 nCount = m_arrFrameQ[nGrp].GetCount();
+    AX_U32 nCount = m_arrFrameQ[nGrp].size();
     if (nCount > 0) {
         CAXFrame axFrame;
         for (AX_U32 i = 0; i < nCount; ++i) {
-            if (m_arrFrameQ[nGrp].Pop(axFrame, 0)) {
+            if (m_arrFrameQ[nGrp].pop(axFrame, 0)) {
                 axFrame.DecRef();
             }
         }
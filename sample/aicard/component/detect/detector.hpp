@@ -13,13 +13,15 @@
 #include <vector>
 
 #include "AXFrame.hpp"
-#include "AXLockQ.hpp"
+#include "mpmc_queue.hpp"
 #include "AXResource.hpp"
 #include "AXThread.hpp"
 
 #include "axcl_skel.h"
 
 #define DETECTOR_MAX_CHN_NUM 3
+/* frame queue depth of each grp if fifo depth <= 0 (unbounded), same as the default vdec chn depth */
+#define DETECTOR_DEFAULT_GRP_DEPTH 8
 
 typedef struct DETECTOR_CHN_ATTR_S {
     AX_U32 nPPL;
@@ -93,7 +95,7 @@ protected:
 protected:
     AX_S32 m_nDevID{0};
 
-    CAXLockQ<CAXFrame>* m_arrFrameQ{nullptr};
+    axcl::mpmc_queue<CAXFrame>* m_arrFrameQ{nullptr};
     DETECTOR_ATTR_T m_stAttr;
     CAXThread m_DetectThread;
 
@@ -0,0 +1,322 @@
+/**************************************************************************************************
+ *
+ * Copyright (c) 2019-2024 Axera Semiconductor Co., Ltd. All Rights Reserved.
+ *
+ * This source file is the property of Axera Semiconductor Co., Ltd. and
+ * may not be copied or distributed in any isomorphic form without the prior
+ * written consent of Axera Semiconductor Co., Ltd.
+ *
+ **************************************************************************************************/
+
+#include "axclite_downloader.hpp"
+#include <string.h>
+#include "axclite_helper.hpp"
+#include "log/logger.hpp"
+
+#define TAG "axclite-download"
+
+namespace axclite {
+
+namespace {
+
+struct plane_layout {
+    AX_U32 num = 0;
+    AX_U32 bpp = 1;
+    AX_U32 row_bytes[AX_MAX_COLOR_COMPONENT] = {0};
+    AX_U32 rows[AX_MAX_COLOR_COMPONENT] = {0};
+};
+
+bool get_plane_layout(AX_IMG_FORMAT_E pix_fmt, AX_U32 width, AX_U32 height, plane_layout &layout) {
+    switch (pix_fmt) {
+        case AX_FORMAT_YUV400:
+            layout.num = 1;
+            layout.row_bytes[0] = width;
+            layout.rows[0] = height;
+            break;
+        case AX_FORMAT_YUV420_SEMIPLANAR:
+        case AX_FORMAT_YUV420_SEMIPLANAR_VU:
+            layout.num = 2;
+            layout.row_bytes[0] = width;
+            layout.rows[0] = height;
+            layout.row_bytes[1] = width;
+            layout.rows[1] = height / 2;
+            break;
+        case AX_FORMAT_RGB888:
+        case AX_FORMAT_BGR888:
+            layout.num = 1;
+            layout.bpp = 3;
+            layout.row_bytes[0] = width * 3;
+            layout.rows[0] = height;
+            break;
+        default:
+            return false;
+    }
+
+    return true;
+}
+
+}  // namespace
+
+axclError downloader::init(const axclite_download_attr &attr) {
+    if (m_pool) {
+        LOG_MM_W(TAG, "downloader is already initialized");
+        return AXCL_SUCC;
+    }
+
+    m_attr = attr;
+    if (0 == m_attr.fifo_depth) {
+        m_attr.fifo_depth = 2;
+    }
+
+    m_pool = std::make_unique<host_pool>(m_attr.pool_depth);
+    if (!m_pool) {
+        LOG_MM_E(TAG, "create host pool fail");
+        return AXCL_ERR_LITE_DOWNLOAD_NO_MEMORY;
+    }
+
+    m_q_frames.set_capacity(m_attr.fifo_depth);
+    m_q_hosts.set_capacity(m_attr.fifo_depth);
+
+    LOG_MM_I(TAG, "pool depth {}, async {}, fifo depth {}", m_attr.pool_depth, m_attr.async ? "true" : "false", m_attr.fifo_depth);
+    return AXCL_SUCC;
+}
+
+axclError downloader::deinit() {
+    if (!m_pool) {
+        LOG_MM_E(TAG, "downloader is not initialized");
+        return AXCL_ERR_LITE_DOWNLOAD_NOT_INIT;
+    }
+
+    if (m_started) {
+        if (axclError ret = stop(); AXCL_SUCC != ret) {
+            return ret;
+        }
+    }
+
+    m_pool = nullptr;
+    return AXCL_SUCC;
+}
+
+axclError downloader::start(int32_t device) {
+    if (!m_pool) {
+        LOG_MM_E(TAG, "downloader is not initialized");
+        return AXCL_ERR_LITE_DOWNLOAD_NOT_INIT;
+    }
+
+    if (!m_attr.async) {
+        /* nothing to do in sync mode */
+        return AXCL_SUCC;
+    }
+
+    if (m_started) {
+        LOG_MM_W(TAG, "download thread is already started");
+        return AXCL_SUCC;
+    }
+
+    m_thread.start("axclite-download", &downloader::download_thread, this, device);
+    m_started = true;
+
+    return AXCL_SUCC;
+}
+
+axclError downloader::stop() {
+    if (!m_started) {
+        return AXCL_SUCC;
+    }
+
+    m_thread.stop();
+    m_q_frames.wakeup();
+    m_thread.join();
+    m_started = false;
+
+    axclite_host_frame host;
+    while (m_q_hosts.pop(host, 0)) {
+        (void)release_frame(host);
+    }
+
+    return AXCL_SUCC;
+}
+
+axclError downloader::copy_plane(AX_U8 *dst, AX_U64 phy, AX_U32 stride, AX_U32 row_bytes, AX_U32 rows) {
+    if (stride == row_bytes) {
+        if (axclError ret = axclrtMemcpy(dst, reinterpret_cast<void *>(phy), row_bytes * rows, AXCL_MEMCPY_DEVICE_TO_HOST);
+            AXCL_SUCC != ret) {
+            LOG_MM_E(TAG, "axclrtMemcpy(phy {:#x}, size {}) fail, ret = {:#x}", phy, row_bytes * rows, static_cast<uint32_t>(ret));
+            return ret;
+        }
+
+        return AXCL_SUCC;
+    }
+
+    /**
+     * a PCIe transfer per row costs far more than the padding bytes, so transfer the span from the first pixel
+     * to the last visible pixel once into a pinned staging buffer and drop the padding on host.
+     */
+    const AX_U32 span = stride * (rows - 1) + row_bytes;
+    const host_pool::key key = {span, 1, AX_FORMAT_INVALID};
+
+    AX_U8 *staging = nullptr;
+    if (axclError ret = m_pool->alloc(key, span, staging); AXCL_SUCC != ret) {
+        return ret;
+    }
+
+    if (axclError ret = axclrtMemcpy(staging, reinterpret_cast<void *>(phy), span, AXCL_MEMCPY_DEVICE_TO_HOST); AXCL_SUCC != ret) {
+        LOG_MM_E(TAG, "axclrtMemcpy(phy {:#x}, size {}) fail, ret = {:#x}", phy, span, static_cast<uint32_t>(ret));
+        m_pool->free(key, staging);
+        return ret;
+    }
+
+    const AX_U8 *src = staging;
+    for (AX_U32 i = 0; i < rows; ++i) {
+        ::memcpy(dst, src, row_bytes);
+        dst += row_bytes;
+        src += stride;
+    }
+
+    m_pool->free(key, staging);
+    return AXCL_SUCC;
+}
+
+axclError downloader::download(const AX_VIDEO_FRAME_T &frame, axclite_host_frame &host) {
+    if (!m_pool) {
+        LOG_MM_E(TAG, "downloader is not initialized");
+        return AXCL_ERR_LITE_DOWNLOAD_NOT_INIT;
+    }
+
+    plane_layout layout;
+    if (!get_plane_layout(frame.enImgFormat, frame.u32Width, frame.u32Height, layout)) {
+        LOG_MM_E(TAG, "unsupported image format {}", static_cast<int32_t>(frame.enImgFormat));
+        return AXCL_ERR_LITE_DOWNLOAD_UNSUPPORT;
+    }
+
+    host = {};
+    host.width = frame.u32Width;
+    host.height = frame.u32Height;
+    host.pix_fmt = frame.enImgFormat;
+    host.plane_num = layout.num;
+    host.seq_num = frame.u64SeqNum;
+    host.pts = frame.u64PTS;
+    for (AX_U32 i = 0; i < layout.num; ++i) {
+        host.plane_size[i] = layout.row_bytes[i] * layout.rows[i];
+        host.size += host.plane_size[i];
+    }
+
+    if (axclError ret = m_pool->alloc({host.width, host.height, host.pix_fmt}, host.size, host.data); AXCL_SUCC != ret) {
+        return ret;
+    }
+
+    AX_U8 *dst = host.data;
+    AX_U64 phy = 0;
+    AX_U32 stride = 0;
+    for (AX_U32 i = 0; i < layout.num; ++i) {
+        /* some modules only fill the address and stride of the 1st plane */
+        phy = (0 == frame.u64PhyAddr[i] && i > 0) ? (phy + stride * layout.rows[i - 1]) : frame.u64PhyAddr[i];
+        stride = (0 == frame.u32PicStride[i] ? frame.u32PicStride[0] : frame.u32PicStride[i]) * layout.bpp;
+        if (0 == phy || stride < layout.row_bytes[i]) {
+            LOG_MM_E(TAG, "invalid plane {} of frame {}, phy {:#x}, stride {}, width {}", i, frame.u64SeqNum, phy, stride, frame.u32Width);
+            release_frame(host);
+            return AXCL_ERR_LITE_DOWNLOAD_ILLEGAL_PARAM;
+        }
+
+        if (axclError ret = copy_plane(dst, phy, stride, layout.row_bytes[i], layout.rows[i]); AXCL_SUCC != ret) {
+            release_frame(host);
+            return ret;
+        }
+
+        host.plane[i] = dst;
+        dst += host.plane_size[i];
+    }
+
+    return AXCL_SUCC;
+}
+
+axclError downloader::send_frame(const AX_VIDEO_FRAME_T &frame) {
+    if (!m_started) {
+        LOG_MM_E(TAG, "download thread is not started");
+        return AXCL_ERR_LITE_DOWNLOAD_NOT_STARTED;
+    }
+
+    axclite_frame axframe;
+    axframe.frame = {.stVFrame = frame, .enModId = AX_ID_BUTT, .bEndOfStream = AX_FALSE};
+    if (axclError ret = axframe.increase_ref_cnt(); AXCL_SUCC != ret) {
+        LOG_MM_E(TAG, "increase frame {} VB ref count fail, ret = {:#x}", frame.u64SeqNum, static_cast<uint32_t>(ret));
+        return ret;
+    }
+
+    if (!m_q_frames.push(axframe)) {
+        axframe.decrease_ref_cnt();
+        return AXCL_ERR_LITE_DOWNLOAD_BUF_FULL;
+    }
+
+    return AXCL_SUCC;
+}
+
+int32_t downloader::recv_frame(const axclite_frame &frame) {
+    /* VB ref count is already increased by dispatcher */
+    axclite_frame axframe = frame;
+    if (AXCL_LITE_VDEC != frame.module && AXCL_LITE_IVPS != frame.module) {
+        LOG_MM_E(TAG, "frame is not from VDEC or IVPS module {}", frame.module);
+        return 1;
+    }
+
+    if (!m_started || !m_q_frames.push(axframe)) {
+        LOG_MM_W(TAG, "drop frame {} of grp {} chn {}", frame.frame.stVFrame.u64SeqNum, frame.grp, frame.chn);
+        axframe.decrease_ref_cnt();
+        return 1;
+    }
+
+    return 0;
+}
+
+axclError downloader::get_frame(axclite_host_frame &host, AX_S32 timeout) {
+    if (!m_started) {
+        LOG_MM_E(TAG, "download thread is not started");
+        return AXCL_ERR_LITE_DOWNLOAD_NOT_STARTED;
+    }
+
+    return m_q_hosts.pop(host, timeout) ? AXCL_SUCC : AXCL_ERR_LITE_DOWNLOAD_TIMEOUT;
+}
+
+axclError downloader::release_frame(const axclite_host_frame &host) {
+    if (!m_pool) {
+        LOG_MM_E(TAG, "downloader is not initialized");
+        return AXCL_ERR_LITE_DOWNLOAD_NOT_INIT;
+    }
+
+    m_pool->free({host.width, host.height, host.pix_fmt}, host.data);
+    return AXCL_SUCC;
+}
+
+void downloader::download_thread(int32_t device) {
+    LOG_MM_D(TAG, "+++");
+
+    context_guard context_holder(device);
+
+    constexpr AX_S32 TIMEOUT = 100;
+    axclite_frame frame;
+    axclite_host_frame host;
+    while (m_thread.running()) {
+        if (!m_q_frames.pop(frame, TIMEOUT)) {
+            continue;
+        }
+
+        axclError ret = download(frame.frame.stVFrame, host);
+        frame.decrease_ref_cnt();
+        if (AXCL_SUCC != ret) {
+            continue;
+        }
+
+        if (!m_q_hosts.push(host)) {
+            LOG_MM_W(TAG, "host fifo is full, drop frame {}", host.seq_num);
+            (void)release_frame(host);
+        }
+    }
+
+    while (m_q_frames.pop(frame, 0)) {
+        frame.decrease_ref_cnt();
+    }
+
+    LOG_MM_D(TAG, "---");
+}
+
+}  // namespace axclite
@@ -0,0 +1,65 @@
+/**************************************************************************************************
+ *
+ * Copyright (c) 2019-2024 Axera Semiconductor Co., Ltd. All Rights Reserved.
+ *
+ * This source file is the property of Axera Semiconductor Co., Ltd. and
+ * may not be copied or distributed in any isomorphic form without the prior
+ * written consent of Axera Semiconductor Co., Ltd.
+ *
+ **************************************************************************************************/
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include "axclite.h"
+#include "axclite_host_pool.hpp"
+#include "axclite_sink.hpp"
+#include "lock_queue.hpp"
+#include "threadx.hpp"
+
+namespace axclite {
+
+/**
+ * @brief download device frames into pooled host buffers.
+ *        only the visible area is kept, the returned planes are tightly packed (stride == width).
+ *
+ * sync:  download() -> ... -> release_frame()
+ * async: send_frame() or recv_frame() (registered as sinker) -> get_frame() -> ... -> release_frame()
+ *        the background thread downloads the next frame while the previous one is consumed.
+ */
+class downloader final : public sinker {
+public:
+    downloader() = default;
+
+    axclError init(const axclite_download_attr &attr);
+    axclError deinit();
+
+    axclError start(int32_t device);
+    axclError stop();
+
+    axclError download(const AX_VIDEO_FRAME_T &frame, axclite_host_frame &host);
+    axclError send_frame(const AX_VIDEO_FRAME_T &frame);
+    axclError get_frame(axclite_host_frame &host, AX_S32 timeout = -1);
+    axclError release_frame(const axclite_host_frame &host);
+
+    int32_t recv_frame(const axclite_frame &frame);
+
+    const axclite_download_attr &get_attr() const {
+        return m_attr;
+    }
+
+protected:
+    void download_thread(int32_t device);
+    axclError copy_plane(AX_U8 *dst, AX_U64 phy, AX_U32 stride, AX_U32 row_bytes, AX_U32 rows);
+
+private:
+    axclite_download_attr m_attr = {};
+    std::unique_ptr<host_pool> m_pool;
+    axcl::lock_queue<axclite_frame> m_q_frames;
+    axcl::lock_queue<axclite_host_frame> m_q_hosts;
+    axcl::threadx m_thread;
+    std::atomic<bool> m_started = {false};
+};
+
+}  // namespace axclite
@@ -0,0 +1,77 @@
+/**************************************************************************************************
+ *
+ * Copyright (c) 2019-2024 Axera Semiconductor Co., Ltd. All Rights Reserved.
+ *
+ * This source file is the property of Axera Semiconductor Co., Ltd. and
+ * may not be copied or distributed in any isomorphic form without the prior
+ * written consent of Axera Semiconductor Co., Ltd.
+ *
+ **************************************************************************************************/
+
+#include "axclite_host_pool.hpp"
+#include "log/logger.hpp"
+
+#define TAG "axclite-host-pool"
+
+namespace axclite {
+
+axclError host_pool::alloc(const key &k, AX_U32 size, AX_U8 *&buf) {
+    {
+        std::lock_guard<std::mutex> lck(m_mtx);
+        if (auto it = m_map.find(k); it != m_map.end() && !it->second.empty()) {
+            buf = it->second.front();
+            it->second.pop_front();
+            return AXCL_SUCC;
+        }
+    }
+
+    void *mem = nullptr;
+    if (axclError ret = axclrtMallocHost(&mem, size); AXCL_SUCC != ret) {
+        LOG_MM_E(TAG, "axclrtMallocHost(size {}) fail, ret = {:#x}", size, static_cast<uint32_t>(ret));
+        return ret;
+    }
+
+    LOG_MM_D(TAG, "alloc host buffer {} size {} for {}x{} fmt {}", mem, size, k.width, k.height, static_cast<int32_t>(k.pix_fmt));
+
+    std::lock_guard<std::mutex> lck(m_mtx);
+    ++m_alloc_cnt;
+    buf = reinterpret_cast<AX_U8 *>(mem);
+    return AXCL_SUCC;
+}
+
+void host_pool::free(const key &k, AX_U8 *buf) {
+    if (!buf) {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lck(m_mtx);
+        auto &lst = m_map[k];
+        if (0 == m_depth || lst.size() < m_depth) {
+            lst.push_back(buf);
+            return;
+        }
+
+        --m_alloc_cnt;
+    }
+
+    axclrtFreeHost(buf);
+}
+
+void host_pool::clear() {
+    std::lock_guard<std::mutex> lck(m_mtx);
+    for (auto &&[k, lst] : m_map) {
+        for (auto &&m : lst) {
+            axclrtFreeHost(m);
+            --m_alloc_cnt;
+        }
+    }
+
+    m_map.clear();
+
+    if (m_alloc_cnt > 0) {
+        LOG_MM_W(TAG, "{} host buffers are not returned to pool", m_alloc_cnt);
+    }
+}
+
+}  // namespace axclite
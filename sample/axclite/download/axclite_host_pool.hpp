@@ -0,0 +1,71 @@
+/**************************************************************************************************
+ *
+ * Copyright (c) 2019-2024 Axera Semiconductor Co., Ltd. All Rights Reserved.
+ *
+ * This source file is the property of Axera Semiconductor Co., Ltd. and
+ * may not be copied or distributed in any isomorphic form without the prior
+ * written consent of Axera Semiconductor Co., Ltd.
+ *
+ **************************************************************************************************/
+
+#pragma once
+
+#include <list>
+#include <mutex>
+#include <unordered_map>
+#include "axclite.h"
+
+namespace axclite {
+
+/**
+ * @brief pool of pinned host buffers allocated by axclrtMallocHost, keyed by resolution and format.
+ *        buffers are recycled instead of freed, so steady state download does not hit the allocator.
+ */
+class host_pool {
+public:
+    struct key {
+        AX_U32 width;
+        AX_U32 height;
+        AX_IMG_FORMAT_E pix_fmt;
+    };
+
+    explicit host_pool(AX_U32 depth = 0) : m_depth(depth) {
+    }
+
+    ~host_pool() {
+        clear();
+    }
+
+    axclError alloc(const key &k, AX_U32 size, AX_U8 *&buf);
+    void free(const key &k, AX_U8 *buf);
+    void clear();
+
+    AX_U32 get_alloc_count() const {
+        return m_alloc_cnt;
+    }
+
+private:
+    host_pool(const host_pool &) = delete;
+    host_pool &operator=(const host_pool &) = delete;
+
+    struct hash_fn {
+        std::size_t operator()(const key &k) const {
+            return (static_cast<std::size_t>(k.width) << 32) ^ (static_cast<std::size_t>(k.height) << 12) ^
+                   static_cast<std::size_t>(k.pix_fmt);
+        }
+    };
+
+    struct hash_equal {
+        bool operator()(const key &k1, const key &k2) const {
+            return (k1.width == k2.width && k1.height == k2.height && k1.pix_fmt == k2.pix_fmt);
+        }
+    };
+
+private:
+    AX_U32 m_depth;
+    AX_U32 m_alloc_cnt = 0;
+    std::mutex m_mtx;
+    std::unordered_map<key, std::list<AX_U8 *>, hash_fn, hash_equal> m_map;
+};
+
+}  // namespace axclite
@@ -12,7 +12,9 @@
 #define __AXCLITE_H__
 
 #include "axcl.h"
+#include "axclite_download_type.h"
 #include "axclite_ivps_type.h"
+#include "axclite_jpeg_type.h"
 #include "axclite_msys_type.h"
 #include "axclite_vdec_type.h"
 #include "axclite_venc_type.h"
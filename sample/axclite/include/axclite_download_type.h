@@ -0,0 +1,53 @@
+/**************************************************************************************************
+ *
+ * Copyright (c) 2019-2024 Axera Semiconductor Co., Ltd. All Rights Reserved.
+ *
+ * This source file is the property of Axera Semiconductor Co., Ltd. and
+ * may not be copied or distributed in any isomorphic form without the prior
+ * written consent of Axera Semiconductor Co., Ltd.
+ *
+ **************************************************************************************************/
+
+#ifndef __AXCLITE_DOWNLOAD_TYPE_H__
+#define __AXCLITE_DOWNLOAD_TYPE_H__
+
+#include "axclite.h"
+
+#define AXCL_DEF_LITE_DOWNLOAD_ERR(e)           AXCL_DEF_LITE_ERR(AX_ID_DMA, (e))
+#define AXCL_ERR_LITE_DOWNLOAD_NULL_POINTER     AXCL_DEF_LITE_DOWNLOAD_ERR(AXCL_ERR_NULL_POINTER)
+#define AXCL_ERR_LITE_DOWNLOAD_ILLEGAL_PARAM    AXCL_DEF_LITE_DOWNLOAD_ERR(AXCL_ERR_ILLEGAL_PARAM)
+#define AXCL_ERR_LITE_DOWNLOAD_UNSUPPORT        AXCL_DEF_LITE_DOWNLOAD_ERR(AXCL_ERR_UNSUPPORT)
+#define AXCL_ERR_LITE_DOWNLOAD_TIMEOUT          AXCL_DEF_LITE_DOWNLOAD_ERR(AXCL_ERR_TIMEOUT)
+#define AXCL_ERR_LITE_DOWNLOAD_NO_MEMORY        AXCL_DEF_LITE_DOWNLOAD_ERR(AXCL_ERR_NO_MEMORY)
+#define AXCL_ERR_LITE_DOWNLOAD_NOT_INIT         AXCL_DEF_LITE_DOWNLOAD_ERR(0x81)
+#define AXCL_ERR_LITE_DOWNLOAD_NOT_STARTED      AXCL_DEF_LITE_DOWNLOAD_ERR(0x82)
+#define AXCL_ERR_LITE_DOWNLOAD_BUF_FULL         AXCL_DEF_LITE_DOWNLOAD_ERR(0x83)
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+    AX_U32 pool_depth; /* max. idle host buffers kept per resolution and format, 0: no limit */
+    AX_BOOL async;     /* download in background thread, frames are fetched by get_frame() */
+    AX_U32 fifo_depth; /* pending and downloaded frames in async mode, 2: double buffered */
+} axclite_download_attr;
+
+typedef struct {
+    AX_U32 width;
+    AX_U32 height;
+    AX_IMG_FORMAT_E pix_fmt;
+    AX_U32 plane_num;
+    AX_U8 *plane[AX_MAX_COLOR_COMPONENT]; /* visible area only, stride == width * bpp */
+    AX_U32 plane_size[AX_MAX_COLOR_COMPONENT];
+    AX_U8 *data; /* contiguous host buffer allocated by axclrtMallocHost */
+    AX_U32 size;
+    AX_U64 seq_num;
+    AX_U64 pts;
+} axclite_host_frame;
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __AXCLITE_DOWNLOAD_TYPE_H__ */
@@ -18,14 +18,20 @@
 #define CHECK_IVPS_GRP(ivGrp) ((ivGrp) >= 0 && (ivGrp) < AX_IVPS_MAX_GRP_NUM)
 #define CHECK_IVPS_CHN(ivChn) ((ivChn) >= 0 && (ivChn) < AX_IVPS_MAX_OUTCHN_NUM)
 
+/* max. crop number of one CropResizeV2 submission */
+#define AXCL_IVPS_MAX_BATCH_CROP_NUM (32)
+
 #define AXCL_DEF_LITE_IVPS_ERR(e)           AXCL_DEF_LITE_ERR(AX_ID_IVPS, (e))
 #define AXCL_ERR_LITE_IVPS_NULL_POINTER     AXCL_DEF_LITE_IVPS_ERR(AXCL_ERR_NULL_POINTER)
 #define AXCL_ERR_LITE_IVPS_ILLEGAL_PARAM    AXCL_DEF_LITE_IVPS_ERR(AXCL_ERR_ILLEGAL_PARAM)
 #define AXCL_ERR_LITE_IVPS_NO_MEMORY        AXCL_DEF_LITE_IVPS_ERR(AXCL_ERR_NO_MEMORY)
+#define AXCL_ERR_LITE_IVPS_UNSUPPORT        AXCL_DEF_LITE_IVPS_ERR(AXCL_ERR_UNSUPPORT)
 #define AXCL_ERR_LITE_IVPS_INVALID_GRP      AXCL_DEF_LITE_IVPS_ERR(0x81)
 #define AXCL_ERR_LITE_IVPS_INVALID_CHN      AXCL_DEF_LITE_IVPS_ERR(0x82)
 #define AXCL_ERR_LITE_IVPS_START_DISPATCH   AXCL_DEF_LITE_IVPS_ERR(0x83)
 #define AXCL_ERR_LITE_IVPS_STOP_DISPATCH    AXCL_DEF_LITE_IVPS_ERR(0x84)
+#define AXCL_ERR_LITE_IVPS_NOT_STARTED      AXCL_DEF_LITE_IVPS_ERR(0x85)
+#define AXCL_ERR_LITE_IVPS_BUF_FULL         AXCL_DEF_LITE_IVPS_ERR(0x86)
 
 #ifdef __cplusplus
 extern "C" {
@@ -59,6 +65,19 @@ typedef struct {
     axclite_ivps_chn_attr chn[AX_IVPS_MAX_OUTCHN_NUM];
 } axclite_ivps_attr;
 
+typedef struct {
+    AX_IVPS_RECT_T box; /* crop area of source frame */
+    AX_U32 width;       /* resized width */
+    AX_U32 height;      /* resized height */
+} axclite_ivps_roi;
+
+typedef struct {
+    AX_IVPS_ENGINE_E engine; /* TDP, VPP or VGP */
+    AX_IVPS_ASPECT_RATIO_T aspect_ratio;
+    AX_U32 pool_depth; /* idle output buffers kept for reuse, 0: no limit */
+    AX_U32 fifo_depth; /* pending batches in async mode */
+} axclite_ivps_batch_attr;
+
 #ifdef __cplusplus
 }
 #endif
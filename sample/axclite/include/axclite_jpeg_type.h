@@ -0,0 +1,73 @@
+/**************************************************************************************************
+ *
+ * Copyright (c) 2019-2024 Axera Semiconductor Co., Ltd. All Rights Reserved.
+ *
+ * This source file is the property of Axera Semiconductor Co., Ltd. and
+ * may not be copied or distributed in any isomorphic form without the prior
+ * written consent of Axera Semiconductor Co., Ltd.
+ *
+ **************************************************************************************************/
+
+#ifndef __AXCLITE_JPEG_TYPE_H__
+#define __AXCLITE_JPEG_TYPE_H__
+
+#include "axclite.h"
+
+#define AXCL_DEF_LITE_JDEC_ERR(e)           AXCL_DEF_LITE_ERR(AX_ID_JDEC, (e))
+#define AXCL_ERR_LITE_JDEC_NULL_POINTER     AXCL_DEF_LITE_JDEC_ERR(AXCL_ERR_NULL_POINTER)
+#define AXCL_ERR_LITE_JDEC_ILLEGAL_PARAM    AXCL_DEF_LITE_JDEC_ERR(AXCL_ERR_ILLEGAL_PARAM)
+#define AXCL_ERR_LITE_JDEC_TIMEOUT          AXCL_DEF_LITE_JDEC_ERR(AXCL_ERR_TIMEOUT)
+#define AXCL_ERR_LITE_JDEC_NO_MEMORY        AXCL_DEF_LITE_JDEC_ERR(AXCL_ERR_NO_MEMORY)
+#define AXCL_ERR_LITE_JDEC_NOT_STARTED      AXCL_DEF_LITE_JDEC_ERR(0x81)
+
+#define AXCL_DEF_LITE_JENC_ERR(e)           AXCL_DEF_LITE_ERR(AX_ID_JENC, (e))
+#define AXCL_ERR_LITE_JENC_NULL_POINTER     AXCL_DEF_LITE_JENC_ERR(AXCL_ERR_NULL_POINTER)
+#define AXCL_ERR_LITE_JENC_ILLEGAL_PARAM    AXCL_DEF_LITE_JENC_ERR(AXCL_ERR_ILLEGAL_PARAM)
+#define AXCL_ERR_LITE_JENC_TIMEOUT          AXCL_DEF_LITE_JENC_ERR(AXCL_ERR_TIMEOUT)
+#define AXCL_ERR_LITE_JENC_NO_MEMORY        AXCL_DEF_LITE_JENC_ERR(AXCL_ERR_NO_MEMORY)
+#define AXCL_ERR_LITE_JENC_NOT_STARTED      AXCL_DEF_LITE_JENC_ERR(0x81)
+
+#define AXCL_LITE_JPEG_MAX_CHN_NUM (16)
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+    AX_U32 chn_num;    /* VDEC groups decoding in parallel, [1, AXCL_LITE_JPEG_MAX_CHN_NUM] */
+    AX_U32 width;      /* max. picture width */
+    AX_U32 height;     /* max. picture height */
+    AX_BOOL crop;      /* ROI: output the area of box instead of the whole picture */
+    AX_IVPS_RECT_T box;
+    AX_U32 out_width;  /* 0: no scale, else scale the picture to out_width x out_height, exclusive with crop */
+    AX_U32 out_height;
+    AX_U32 blk_cnt;    /* pooled output frames per group */
+    AX_U32 fifo_depth; /* decoded frames queued for get_frame() */
+} axclite_jdec_attr;
+
+typedef struct {
+    AX_U32 chn_num;  /* VENC channels encoding in parallel, [1, AXCL_LITE_JPEG_MAX_CHN_NUM] */
+    AX_U32 width;    /* max. picture width */
+    AX_U32 height;   /* max. picture height */
+    AX_U32 qfactor;  /* [1, 99] */
+    AX_U32 roi_num;  /* [0, MAX_VENC_ROI_NUM] */
+    AX_U32 roi_qfactor;
+    AX_RECT_T roi[MAX_VENC_ROI_NUM];
+    AX_U32 in_fifo_depth;
+    AX_U32 out_fifo_depth;
+    AX_U32 fifo_depth; /* encoded streams queued for get_stream() */
+} axclite_jenc_attr;
+
+typedef struct {
+    AX_U8 *data; /* pooled host buffer */
+    AX_U32 len;
+    AX_U64 pts;
+    AX_U64 seq_num;
+    AX_U64 userdata;
+} axclite_jpeg_stream;
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __AXCLITE_JPEG_TYPE_H__ */
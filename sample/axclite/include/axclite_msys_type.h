@@ -17,7 +17,9 @@
 #define AXCL_ERR_LITE_MSYS_NULL_POINTER     AXCL_DEF_LITE_MSYS_ERR(AXCL_ERR_NULL_POINTER)
 #define AXCL_ERR_LITE_MSYS_ILLEGAL_PARAM    AXCL_DEF_LITE_MSYS_ERR(AXCL_ERR_ILLEGAL_PARAM)
 #define AXCL_ERR_LITE_MSYS_NO_MEMORY        AXCL_DEF_LITE_MSYS_ERR(AXCL_ERR_NO_MEMORY)
+#define AXCL_ERR_LITE_MSYS_BUSY             AXCL_DEF_LITE_MSYS_ERR(AXCL_ERR_BUSY)
 #define AXCL_ERR_LITE_MSYS_NO_LINKED        AXCL_DEF_LITE_MSYS_ERR(0x81)
+#define AXCL_ERR_LITE_MSYS_INVALID_GRAPH    AXCL_DEF_LITE_MSYS_ERR(0x82)
 
 #ifdef __cplusplus
 extern "C" {
@@ -0,0 +1,401 @@
+/**************************************************************************************************
+ *
+ * Copyright (c) 2019-2024 Axera Semiconductor Co., Ltd. All Rights Reserved.
+ *
+ * This source file is the property of Axera Semiconductor Co., Ltd. and
+ * may not be copied or distributed in any isomorphic form without the prior
+ * written consent of Axera Semiconductor Co., Ltd.
+ *
+ **************************************************************************************************/
+
+#include "axclite_ivps_batch.hpp"
+#include <string.h>
+#include <algorithm>
+#include <tuple>
+#include "axclite_helper.hpp"
+#include "log/logger.hpp"
+
+#define TAG "axclite-ivps-batch"
+
+namespace axclite {
+
+namespace {
+
+/* output buffers are rounded up so that batches with a similar ROI count share buffers */
+constexpr AX_U32 BATCH_BUFFER_ALIGN = 0x40000;
+constexpr AX_U32 FRAME_ADDR_ALIGN = 256;
+constexpr AX_U32 FRAME_STRIDE_ALIGN = 16;
+
+bool get_frame_size(AX_IMG_FORMAT_E pix_fmt, AX_U32 stride, AX_U32 height, AX_U32 &y_size, AX_U32 &uv_size) {
+    switch (pix_fmt) {
+        case AX_FORMAT_YUV400:
+            y_size = stride * height;
+            uv_size = 0;
+            break;
+        case AX_FORMAT_YUV420_SEMIPLANAR:
+        case AX_FORMAT_YUV420_SEMIPLANAR_VU:
+            y_size = stride * height;
+            uv_size = stride * height / 2;
+            break;
+        case AX_FORMAT_RGB888:
+        case AX_FORMAT_BGR888:
+            y_size = stride * height * 3;
+            uv_size = 0;
+            break;
+        default:
+            return false;
+    }
+
+    return true;
+}
+
+}  // namespace
+
+bool ivps_batch::check_attr(const axclite_ivps_batch_attr &attr) {
+    switch (attr.engine) {
+        case AX_IVPS_ENGINE_TDP:
+        case AX_IVPS_ENGINE_VPP:
+        case AX_IVPS_ENGINE_VGP:
+            break;
+        default:
+            LOG_MM_E(TAG, "unsupported engine {}", static_cast<int32_t>(attr.engine));
+            return false;
+    }
+
+    return true;
+}
+
+axclError ivps_batch::init(const axclite_ivps_batch_attr &attr) {
+    if (m_inited) {
+        LOG_MM_W(TAG, "ivps batch is already initialized");
+        return AXCL_SUCC;
+    }
+
+    if (!check_attr(attr)) {
+        return AXCL_ERR_LITE_IVPS_ILLEGAL_PARAM;
+    }
+
+    m_attr = attr;
+    if (0 == m_attr.fifo_depth) {
+        m_attr.fifo_depth = 4;
+    }
+
+    m_q_tasks.set_capacity(m_attr.fifo_depth);
+    m_v2_support = true;
+    m_inited = true;
+
+    LOG_MM_I(TAG, "engine {}, pool depth {}, fifo depth {}", static_cast<int32_t>(m_attr.engine), m_attr.pool_depth, m_attr.fifo_depth);
+    return AXCL_SUCC;
+}
+
+axclError ivps_batch::deinit() {
+    if (!m_inited) {
+        return AXCL_SUCC;
+    }
+
+    if (m_started) {
+        if (axclError ret = stop(); AXCL_SUCC != ret) {
+            return ret;
+        }
+    }
+
+    clear_buffers();
+    m_inited = false;
+    return AXCL_SUCC;
+}
+
+axclError ivps_batch::start(int32_t device, ivps_batch_callback callback) {
+    if (!m_inited) {
+        LOG_MM_E(TAG, "ivps batch is not initialized");
+        return AXCL_ERR_LITE_IVPS_NOT_STARTED;
+    }
+
+    if (m_started) {
+        LOG_MM_W(TAG, "ivps batch thread is already started");
+        return AXCL_SUCC;
+    }
+
+    if (!callback) {
+        LOG_MM_E(TAG, "nil callback");
+        return AXCL_ERR_LITE_IVPS_NULL_POINTER;
+    }
+
+    m_callback = std::move(callback);
+    m_thread.start("ivps-batch", &ivps_batch::batch_thread, this, device);
+    m_started = true;
+
+    return AXCL_SUCC;
+}
+
+axclError ivps_batch::stop() {
+    if (!m_started) {
+        return AXCL_SUCC;
+    }
+
+    m_thread.stop();
+    m_q_tasks.wakeup();
+    m_thread.join();
+    m_started = false;
+
+    return AXCL_SUCC;
+}
+
+axclError ivps_batch::alloc_buffer(AX_U32 size, AX_U64 &phy, AX_VOID *&vir) {
+    {
+        std::lock_guard<std::mutex> lck(m_mtx_buffers);
+        if (auto it = m_buffers.find(size); it != m_buffers.end() && !it->second.empty()) {
+            std::tie(phy, vir) = it->second.front();
+            it->second.pop_front();
+            return AXCL_SUCC;
+        }
+    }
+
+    if (axclError ret = AXCL_SYS_MemAlloc(&phy, &vir, size, FRAME_ADDR_ALIGN, reinterpret_cast<const AX_S8 *>("axclite_ivps_batch"));
+        AXCL_SUCC != ret) {
+        LOG_MM_E(TAG, "AXCL_SYS_MemAlloc(size {}) fail, ret = {:#x}", size, static_cast<uint32_t>(ret));
+        return ret;
+    }
+
+    LOG_MM_D(TAG, "alloc batch buffer phy {:#x} size {}", phy, size);
+    return AXCL_SUCC;
+}
+
+void ivps_batch::free_buffer(AX_U32 size, AX_U64 phy, AX_VOID *vir) {
+    {
+        std::lock_guard<std::mutex> lck(m_mtx_buffers);
+        auto &lst = m_buffers[size];
+        if (0 == m_attr.pool_depth || lst.size() < m_attr.pool_depth) {
+            lst.emplace_back(phy, vir);
+            return;
+        }
+    }
+
+    AXCL_SYS_MemFree(phy, vir);
+}
+
+void ivps_batch::clear_buffers() {
+    std::lock_guard<std::mutex> lck(m_mtx_buffers);
+    for (auto &&[size, lst] : m_buffers) {
+        for (auto &&[phy, vir] : lst) {
+            AXCL_SYS_MemFree(phy, vir);
+        }
+    }
+
+    m_buffers.clear();
+}
+
+axclError ivps_batch::submit_batch(const AX_VIDEO_FRAME_T &src, const AX_IVPS_RECT_T boxes[], AX_U32 num, AX_VIDEO_FRAME_T *dst[]) {
+    switch (m_attr.engine) {
+        case AX_IVPS_ENGINE_TDP:
+            return AXCL_IVPS_CropResizeV2Tdp(&src, boxes, num, dst, &m_attr.aspect_ratio);
+        case AX_IVPS_ENGINE_VPP:
+            return AXCL_IVPS_CropResizeV2Vpp(&src, boxes, num, dst, &m_attr.aspect_ratio);
+        case AX_IVPS_ENGINE_VGP:
+            return AXCL_IVPS_CropResizeV2Vgp(&src, boxes, num, dst, &m_attr.aspect_ratio);
+        default:
+            return AXCL_ERR_LITE_IVPS_UNSUPPORT;
+    }
+}
+
+axclError ivps_batch::submit_one(const AX_VIDEO_FRAME_T &src, const AX_IVPS_RECT_T &box, AX_VIDEO_FRAME_T &dst) {
+    AX_VIDEO_FRAME_T crop = src;
+    crop.s16CropX = box.nX;
+    crop.s16CropY = box.nY;
+    crop.s16CropWidth = static_cast<AX_S16>(box.nW);
+    crop.s16CropHeight = static_cast<AX_S16>(box.nH);
+
+    switch (m_attr.engine) {
+        case AX_IVPS_ENGINE_TDP:
+            return AXCL_IVPS_CropResizeTdp(&crop, &dst, &m_attr.aspect_ratio);
+        case AX_IVPS_ENGINE_VPP:
+            return AXCL_IVPS_CropResizeVpp(&crop, &dst, &m_attr.aspect_ratio);
+        case AX_IVPS_ENGINE_VGP:
+            return AXCL_IVPS_CropResizeVgp(&crop, &dst, &m_attr.aspect_ratio);
+        default:
+            return AXCL_ERR_LITE_IVPS_UNSUPPORT;
+    }
+}
+
+axclError ivps_batch::crop_resize(const AX_VIDEO_FRAME_T &src, const axclite_ivps_roi rois[], AX_U32 num, ivps_batch_result &result) {
+    if (!m_inited) {
+        LOG_MM_E(TAG, "ivps batch is not initialized");
+        return AXCL_ERR_LITE_IVPS_NOT_STARTED;
+    }
+
+    if (!rois || 0 == num) {
+        LOG_MM_E(TAG, "no roi");
+        return AXCL_ERR_LITE_IVPS_ILLEGAL_PARAM;
+    }
+
+    /* step01: layout all outputs in one buffer */
+    std::vector<AX_IVPS_RECT_T> boxes(num);
+    result.frames.resize(num);
+    AX_U32 offset = 0;
+    for (AX_U32 i = 0; i < num; ++i) {
+        const axclite_ivps_roi &roi = rois[i];
+        if (0 == roi.width || 0 == roi.height || 0 == roi.box.nW || 0 == roi.box.nH || roi.box.nX < 0 || roi.box.nY < 0 ||
+            static_cast<AX_U32>(roi.box.nX + roi.box.nW) > src.u32Width || static_cast<AX_U32>(roi.box.nY + roi.box.nH) > src.u32Height) {
+            LOG_MM_E(TAG, "invalid roi {}: [{}, {}, {}, {}] -> {}x{}, frame {}x{}", i, roi.box.nX, roi.box.nY, roi.box.nW, roi.box.nH,
+                     roi.width, roi.height, src.u32Width, src.u32Height);
+            return AXCL_ERR_LITE_IVPS_ILLEGAL_PARAM;
+        }
+
+        AX_VIDEO_FRAME_T &dst = result.frames[i];
+        memset(&dst, 0, sizeof(dst));
+        dst.u32Width = roi.width;
+        dst.u32Height = roi.height;
+        dst.enImgFormat = src.enImgFormat;
+        dst.u32PicStride[0] = AXCL_ALIGN_UP(roi.width, FRAME_STRIDE_ALIGN);
+
+        AX_U32 y_size;
+        AX_U32 uv_size;
+        if (!get_frame_size(dst.enImgFormat, dst.u32PicStride[0], dst.u32Height, y_size, uv_size)) {
+            LOG_MM_E(TAG, "unsupported image format {}", static_cast<int32_t>(dst.enImgFormat));
+            return AXCL_ERR_LITE_IVPS_UNSUPPORT;
+        }
+
+        dst.u64PhyAddr[0] = offset;
+        if (uv_size > 0) {
+            dst.u32PicStride[1] = dst.u32PicStride[0];
+            dst.u64PhyAddr[1] = offset + y_size;
+        }
+
+        for (AX_U32 j = 0; j < AX_MAX_COLOR_COMPONENT; ++j) {
+            dst.u32BlkId[j] = AX_INVALID_BLOCKID;
+        }
+
+        dst.u32FrameSize = y_size + uv_size;
+        dst.u64SeqNum = src.u64SeqNum;
+        dst.u64PTS = src.u64PTS;
+        boxes[i] = roi.box;
+
+        offset = AXCL_ALIGN_UP(offset + dst.u32FrameSize, FRAME_ADDR_ALIGN);
+    }
+
+    /* step02: one pooled device buffer for the whole batch */
+    result.size = AXCL_ALIGN_UP(offset, BATCH_BUFFER_ALIGN);
+    if (axclError ret = alloc_buffer(result.size, result.phy, result.vir); AXCL_SUCC != ret) {
+        result.size = 0;
+        return ret;
+    }
+
+    for (auto &&m : result.frames) {
+        m.u64PhyAddr[0] += result.phy;
+        if (0 != m.u32PicStride[1]) {
+            m.u64PhyAddr[1] += result.phy;
+        }
+    }
+
+    /* step03: submit, at most AXCL_IVPS_MAX_BATCH_CROP_NUM ROIs per call */
+    AX_VIDEO_FRAME_T *dst[AXCL_IVPS_MAX_BATCH_CROP_NUM];
+    for (AX_U32 i = 0; i < num; i += AXCL_IVPS_MAX_BATCH_CROP_NUM) {
+        const AX_U32 cnt = std::min<AX_U32>(num - i, AXCL_IVPS_MAX_BATCH_CROP_NUM);
+
+        axclError ret = AX_ERR_IVPS_NOT_SUPPORT;
+        if (m_v2_support) {
+            for (AX_U32 j = 0; j < cnt; ++j) {
+                dst[j] = &result.frames[i + j];
+            }
+
+            ret = submit_batch(src, &boxes[i], cnt, dst);
+            if (AX_ERR_IVPS_NOT_SUPPORT == ret) {
+                LOG_MM_W(TAG, "CropResizeV2 is not supported by engine {}, submit roi one by one", static_cast<int32_t>(m_attr.engine));
+                m_v2_support = false;
+            }
+        }
+
+        if (AX_ERR_IVPS_NOT_SUPPORT == ret) {
+            for (AX_U32 j = 0; j < cnt; ++j) {
+                if (ret = submit_one(src, boxes[i + j], result.frames[i + j]); AXCL_SUCC != ret) {
+                    break;
+                }
+            }
+        }
+
+        if (AXCL_SUCC != ret) {
+            LOG_MM_E(TAG, "crop resize roi [{}, {}) of frame {} fail, ret = {:#x}", i, i + cnt, src.u64SeqNum, static_cast<uint32_t>(ret));
+            release(result);
+            return ret;
+        }
+    }
+
+    /* some engines update the size to the resized area, restore to the requested size */
+    for (AX_U32 i = 0; i < num; ++i) {
+        result.frames[i].u32Width = rois[i].width;
+        result.frames[i].u32Height = rois[i].height;
+    }
+
+    return AXCL_SUCC;
+}
+
+axclError ivps_batch::release(ivps_batch_result &result) {
+    if (0 != result.phy) {
+        free_buffer(result.size, result.phy, result.vir);
+    }
+
+    result.phy = 0;
+    result.vir = nullptr;
+    result.size = 0;
+    result.frames.clear();
+    return AXCL_SUCC;
+}
+
+axclError ivps_batch::send_batch(const AX_VIDEO_FRAME_T &src, const axclite_ivps_roi rois[], AX_U32 num, AX_U64 userdata) {
+    if (!m_started) {
+        LOG_MM_E(TAG, "ivps batch thread is not started");
+        return AXCL_ERR_LITE_IVPS_NOT_STARTED;
+    }
+
+    if (!rois || 0 == num) {
+        LOG_MM_E(TAG, "no roi");
+        return AXCL_ERR_LITE_IVPS_ILLEGAL_PARAM;
+    }
+
+    batch_task task;
+    task.src.module = AXCL_LITE_IVPS;
+    task.src.frame = {.stVFrame = src, .enModId = AX_ID_IVPS, .bEndOfStream = AX_FALSE};
+    task.rois.assign(rois, rois + num);
+    task.userdata = userdata;
+
+    /* hold the source frame until the batch is done */
+    if (axclError ret = task.src.increase_ref_cnt(); AXCL_SUCC != ret) {
+        LOG_MM_E(TAG, "increase frame {} VB ref count fail, ret = {:#x}", src.u64SeqNum, static_cast<uint32_t>(ret));
+        return ret;
+    }
+
+    if (!m_q_tasks.push(task)) {
+        task.src.decrease_ref_cnt();
+        return AXCL_ERR_LITE_IVPS_BUF_FULL;
+    }
+
+    return AXCL_SUCC;
+}
+
+void ivps_batch::batch_thread(int32_t device) {
+    LOG_MM_D(TAG, "+++");
+
+    context_guard context_holder(device);
+
+    constexpr AX_S32 TIMEOUT = 100;
+    batch_task task;
+    while (m_thread.running()) {
+        if (!m_q_tasks.pop(task, TIMEOUT)) {
+            continue;
+        }
+
+        ivps_batch_result result;
+        result.userdata = task.userdata;
+        result.ret = crop_resize(task.src.frame.stVFrame, task.rois.data(), static_cast<AX_U32>(task.rois.size()), result);
+        task.src.decrease_ref_cnt();
+
+        m_callback(result);
+    }
+
+    while (m_q_tasks.pop(task, 0)) {
+        task.src.decrease_ref_cnt();
+    }
+
+    LOG_MM_D(TAG, "---");
+}
+
+}  // namespace axclite
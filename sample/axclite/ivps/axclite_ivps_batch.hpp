@@ -0,0 +1,92 @@
+/**************************************************************************************************
+ *
+ * Copyright (c) 2019-2024 Axera Semiconductor Co., Ltd. All Rights Reserved.
+ *
+ * This source file is the property of Axera Semiconductor Co., Ltd. and
+ * may not be copied or distributed in any isomorphic form without the prior
+ * written consent of Axera Semiconductor Co., Ltd.
+ *
+ **************************************************************************************************/
+
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+#include "axclite.h"
+#include "axclite_frame.hpp"
+#include "lock_queue.hpp"
+#include "threadx.hpp"
+
+namespace axclite {
+
+struct ivps_batch_result {
+    axclError ret = AXCL_SUCC;
+    AX_U64 userdata = 0;
+    /* all outputs are packed into one device buffer */
+    AX_U64 phy = 0;
+    AX_VOID *vir = nullptr;
+    AX_U32 size = 0;
+    /* frames[i] is the output of rois[i] */
+    std::vector<AX_VIDEO_FRAME_T> frames;
+};
+
+using ivps_batch_callback = std::function<void(ivps_batch_result &result)>;
+
+/**
+ * @brief crop and resize a list of ROIs of one frame.
+ *        ROIs are submitted by CropResizeV2 in groups of AXCL_IVPS_MAX_BATCH_CROP_NUM, if the engine rejects
+ *        the batched entry, ROIs are submitted one by one. either way there is only one completion per batch.
+ *
+ * sync:  crop_resize() -> ... -> release()
+ * async: start(device, callback) -> send_batch() -> callback -> ... -> release()
+ */
+class ivps_batch {
+public:
+    ivps_batch() = default;
+
+    axclError init(const axclite_ivps_batch_attr &attr);
+    axclError deinit();
+
+    axclError start(int32_t device, ivps_batch_callback callback);
+    axclError stop();
+
+    axclError crop_resize(const AX_VIDEO_FRAME_T &src, const axclite_ivps_roi rois[], AX_U32 num, ivps_batch_result &result);
+    axclError send_batch(const AX_VIDEO_FRAME_T &src, const axclite_ivps_roi rois[], AX_U32 num, AX_U64 userdata = 0);
+    axclError release(ivps_batch_result &result);
+
+    const axclite_ivps_batch_attr &get_attr() const {
+        return m_attr;
+    }
+
+protected:
+    struct batch_task {
+        axclite_frame src;
+        std::vector<axclite_ivps_roi> rois;
+        AX_U64 userdata;
+    };
+
+    bool check_attr(const axclite_ivps_batch_attr &attr);
+    axclError alloc_buffer(AX_U32 size, AX_U64 &phy, AX_VOID *&vir);
+    void free_buffer(AX_U32 size, AX_U64 phy, AX_VOID *vir);
+    void clear_buffers();
+    axclError submit_batch(const AX_VIDEO_FRAME_T &src, const AX_IVPS_RECT_T boxes[], AX_U32 num, AX_VIDEO_FRAME_T *dst[]);
+    axclError submit_one(const AX_VIDEO_FRAME_T &src, const AX_IVPS_RECT_T &box, AX_VIDEO_FRAME_T &dst);
+    void batch_thread(int32_t device);
+
+private:
+    axclite_ivps_batch_attr m_attr = {};
+    std::atomic<bool> m_inited = {false};
+    std::atomic<bool> m_v2_support = {true};
+    std::mutex m_mtx_buffers;
+    std::unordered_map<AX_U32, std::list<std::pair<AX_U64, AX_VOID *>>> m_buffers;
+    ivps_batch_callback m_callback;
+    axcl::lock_queue<batch_task> m_q_tasks;
+    axcl::threadx m_thread;
+    std::atomic<bool> m_started = {false};
+};
+
+}  // namespace axclite
@@ -19,7 +19,11 @@
 
 namespace axclite {
 
-ivps_dispatch::ivps_dispatch(IVPS_GRP grp, IVPS_CHN chn) : m_grp(grp), m_chn(chn) {
+ivps_dispatch::ivps_dispatch(IVPS_GRP grp, IVPS_CHN chn)
+    : m_grp(grp),
+      m_chn(chn),
+      m_frames(axcl::metrics_registry::get_instance()->counter("axcl_ivps_frames_total", "frames processed and dispatched",
+                                                               {{"grp", std::to_string(grp)}, {"chn", std::to_string(chn)}})) {
 }
 
 void ivps_dispatch::dispatch_thread(int32_t device) {
@@ -46,9 +50,10 @@ void ivps_dispatch::dispatch_thread(int32_t device) {
             continue;
         }
 
-        LOG_MM_I(TAG, "received ivGrp {} ivChn {} frame {} pts {} phy {:#x} {}x{} stride {} blkId {:#x}", m_grp, m_chn, frame.u64SeqNum,
-                 frame.u64PTS, frame.u64PhyAddr[0], frame.u32Width, frame.u32Height, frame.u32PicStride[0], frame.u32BlkId[0]);
+        LOG_MM_DEFER_I(TAG, "received ivGrp {} ivChn {} frame {} pts {} phy {:#x} {}x{} stride {} blkId {:#x}", m_grp, m_chn, frame.u64SeqNum,
+                       frame.u64PTS, frame.u64PhyAddr[0], frame.u32Width, frame.u32Height, frame.u32PicStride[0], frame.u32BlkId[0]);
 
+        m_frames.inc();
         (void)dispatch_frame(frame);
 
         if (ret = AXCL_IVPS_ReleaseChnFrame(m_grp, m_chn, &frame); AXCL_SUCC != ret) {
@@ -15,6 +15,7 @@
 #include <list>
 #include <mutex>
 #include "axclite_ivps_type.h"
+#include "metrics.hpp"
 #include "threadx.hpp"
 
 namespace axclite {
@@ -49,6 +50,7 @@ protected:
     axcl::threadx m_thread;
     std::atomic<bool> m_paused = {false};
     std::atomic<bool> m_started = {false};
+    axcl::metric_counter& m_frames;
 };
 
 }  // namespace axclite
\ No newline at end of file
@@ -0,0 +1,255 @@
+/**************************************************************************************************
+ *
+ * Copyright (c) 2019-2024 Axera Semiconductor Co., Ltd. All Rights Reserved.
+ *
+ * This source file is the property of Axera Semiconductor Co., Ltd. and
+ * may not be copied or distributed in any isomorphic form without the prior
+ * written consent of Axera Semiconductor Co., Ltd.
+ *
+ **************************************************************************************************/
+
+#include "axclite_jdec.hpp"
+#include <algorithm>
+#include "axclite_helper.hpp"
+#include "log/logger.hpp"
+
+#define TAG "axclite-jdec"
+
+namespace axclite {
+
+bool jdec::check_attr(const axclite_jdec_attr &attr) {
+    if (0 == attr.chn_num || attr.chn_num > AXCL_LITE_JPEG_MAX_CHN_NUM) {
+        LOG_MM_E(TAG, "invalid channel number {}", attr.chn_num);
+        return false;
+    }
+
+    if (0 == attr.width || 0 == attr.height) {
+        LOG_MM_E(TAG, "invalid picture width {} or height {}", attr.width, attr.height);
+        return false;
+    }
+
+    if (attr.crop) {
+        if (attr.out_width > 0 || attr.out_height > 0) {
+            LOG_MM_E(TAG, "crop and scale can not be enabled at the same time");
+            return false;
+        }
+
+        if (attr.box.nX < 0 || attr.box.nY < 0 || 0 == attr.box.nW || 0 == attr.box.nH ||
+            static_cast<AX_U32>(attr.box.nX + attr.box.nW) > attr.width || static_cast<AX_U32>(attr.box.nY + attr.box.nH) > attr.height) {
+            LOG_MM_E(TAG, "invalid crop box [{}, {}, {}, {}] of {}x{}", attr.box.nX, attr.box.nY, attr.box.nW, attr.box.nH, attr.width,
+                     attr.height);
+            return false;
+        }
+    }
+
+    if (0 == attr.blk_cnt || 0 == attr.fifo_depth) {
+        LOG_MM_E(TAG, "blk count {} and fifo depth {} should > 0", attr.blk_cnt, attr.fifo_depth);
+        return false;
+    }
+
+    return true;
+}
+
+axclError jdec::init(const axclite_jdec_attr &attr) {
+    if (!check_attr(attr)) {
+        return AXCL_ERR_LITE_JDEC_ILLEGAL_PARAM;
+    }
+
+    /**
+     * VDEC channel 0 outputs the original or cropped picture, channel 1 the scaled one.
+     */
+    axclite_vdec_attr vdec_attr = {};
+    vdec_attr.grp.payload = PT_JPEG;
+    vdec_attr.grp.width = attr.width;
+    vdec_attr.grp.height = attr.height;
+    vdec_attr.grp.output_order = AX_VDEC_OUTPUT_ORDER_DEC;
+    vdec_attr.grp.display_mode = AX_VDEC_DISPLAY_MODE_PLAYBACK;
+
+    m_chn = (attr.out_width > 0 && attr.out_height > 0) ? 1 : 0;
+    axclite_vdec_chn_attr &chn_attr = vdec_attr.chn[m_chn];
+    chn_attr.enable = AX_TRUE;
+    chn_attr.link = AX_FALSE;
+    if (attr.crop) {
+        chn_attr.x = attr.box.nX;
+        chn_attr.y = attr.box.nY;
+        chn_attr.width = attr.box.nW;
+        chn_attr.height = attr.box.nH;
+    } else if (1 == m_chn) {
+        chn_attr.width = attr.out_width;
+        chn_attr.height = attr.out_height;
+    } else {
+        chn_attr.width = attr.width;
+        chn_attr.height = attr.height;
+    }
+    chn_attr.blk_cnt = attr.blk_cnt;
+    chn_attr.fifo_depth = attr.blk_cnt;
+
+    for (AX_U32 i = 0; i < attr.chn_num; ++i) {
+        auto m = std::make_unique<vdec>();
+        if (!m) {
+            LOG_MM_E(TAG, "create vdec instance fail");
+            deinit();
+            return AXCL_ERR_LITE_JDEC_NO_MEMORY;
+        }
+
+        if (axclError ret = m->init(vdec_attr); AXCL_SUCC != ret) {
+            deinit();
+            return ret;
+        }
+
+        m_vdecs.push_back(std::move(m));
+    }
+
+    m_q_frames.set_capacity(attr.fifo_depth);
+    m_attr = attr;
+
+    LOG_MM_I(TAG, "{} groups, {}x{}, output vdChn {} {}x{}", attr.chn_num, attr.width, attr.height, m_chn, chn_attr.width,
+             chn_attr.height);
+    return AXCL_SUCC;
+}
+
+axclError jdec::deinit() {
+    if (m_started) {
+        LOG_MM_E(TAG, "jdec is still running");
+        return AXCL_ERR_LITE_JDEC_ILLEGAL_PARAM;
+    }
+
+    for (auto &&m : m_vdecs) {
+        if (axclError ret = m->deinit(); AXCL_SUCC != ret) {
+            return ret;
+        }
+    }
+
+    m_vdecs.clear();
+    return AXCL_SUCC;
+}
+
+axclError jdec::start(int32_t device) {
+    if (m_started) {
+        LOG_MM_W(TAG, "jdec is already started");
+        return AXCL_SUCC;
+    }
+
+    for (AX_U32 i = 0; i < m_vdecs.size(); ++i) {
+        if (axclError ret = m_vdecs[i]->start(); AXCL_SUCC != ret) {
+            for (AX_U32 j = 0; j < i; ++j) {
+                m_vdecs[j]->stop();
+            }
+
+            return ret;
+        }
+    }
+
+    /* fetch_thread looks up its own threadx in m_threads, so the vector must not change once any of them runs */
+    for (AX_U32 i = 0; i < m_vdecs.size(); ++i) {
+        m_threads.push_back(std::make_unique<axcl::threadx>());
+    }
+
+    for (AX_U32 i = 0; i < m_vdecs.size(); ++i) {
+        char name[16];
+        sprintf(name, "jdec-fetch%d", m_vdecs[i]->get_grp_id());
+        m_threads[i]->start(name, &jdec::fetch_thread, this, device, i);
+    }
+
+    m_started = true;
+    return AXCL_SUCC;
+}
+
+axclError jdec::stop() {
+    if (!m_started) {
+        LOG_MM_W(TAG, "jdec is not started yet");
+        return AXCL_SUCC;
+    }
+
+    for (auto &&m : m_threads) {
+        m->stop();
+    }
+
+    for (auto &&m : m_threads) {
+        m->join();
+    }
+
+    m_threads.clear();
+
+    for (auto &&m : m_vdecs) {
+        if (axclError ret = m->stop(); AXCL_SUCC != ret) {
+            return ret;
+        }
+    }
+
+    axclite_frame frame;
+    while (m_q_frames.pop(frame, 0)) {
+        frame.decrease_ref_cnt();
+    }
+
+    m_started = false;
+    return AXCL_SUCC;
+}
+
+axclError jdec::send_stream(const AX_U8 *jpeg, AX_U32 len, AX_U64 userdata, AX_S32 timeout) {
+    if (!m_started) {
+        return AXCL_ERR_LITE_JDEC_NOT_STARTED;
+    }
+
+    if (!jpeg || 0 == len) {
+        LOG_MM_E(TAG, "nil jpeg picture");
+        return AXCL_ERR_LITE_JDEC_NULL_POINTER;
+    }
+
+    /* each JPEG is a complete picture, so any group will do; round robin keeps all of them busy */
+    const AX_U32 index = m_next.fetch_add(1) % m_vdecs.size();
+    return m_vdecs[index]->send_stream(jpeg, len, 0, userdata, timeout);
+}
+
+axclError jdec::get_frame(axclite_frame &frame, AX_S32 timeout) {
+    if (!m_started) {
+        return AXCL_ERR_LITE_JDEC_NOT_STARTED;
+    }
+
+    return m_q_frames.pop(frame, timeout) ? AXCL_SUCC : AXCL_ERR_LITE_JDEC_TIMEOUT;
+}
+
+axclError jdec::release_frame(axclite_frame &frame) {
+    return frame.decrease_ref_cnt();
+}
+
+void jdec::fetch_thread(int32_t device, AX_U32 index) {
+    const AX_VDEC_GRP grp = m_vdecs[index]->get_grp_id();
+    LOG_MM_D(TAG, "vdGrp {} +++", grp);
+
+    context_guard context_holder(device);
+
+    axclError ret;
+    constexpr AX_S32 TIMEOUT = 100;
+    AX_VIDEO_FRAME_INFO_T info;
+    const axcl::threadx &thread = *m_threads[index];
+    while (thread.running()) {
+        if (ret = AXCL_VDEC_GetChnFrame(grp, m_chn, &info, TIMEOUT); AXCL_SUCC != ret) {
+            if (AX_ERR_VDEC_STRM_ERROR == ret) {
+                LOG_MM_W(TAG, "vdGrp {}: jpeg is undecodeable", grp);
+            } else if (AX_ERR_VDEC_TIMED_OUT != ret && AX_ERR_VDEC_BUF_EMPTY != ret && AX_ERR_VDEC_FLOW_END != ret) {
+                LOG_MM_E(TAG, "AXCL_VDEC_GetChnFrame(vdGrp {}, vdChn {}) fail, ret = {:#x}", grp, m_chn, static_cast<uint32_t>(ret));
+            }
+
+            continue;
+        }
+
+        axclite_frame frame(AXCL_LITE_JDEC, grp, m_chn, info);
+        bool queued = false;
+        if (AXCL_SUCC == frame.increase_ref_cnt()) {
+            queued = m_q_frames.push(frame);
+            if (!queued) {
+                LOG_MM_W(TAG, "frame fifo is full, drop vdGrp {} frame {}", grp, info.stVFrame.u64SeqNum);
+                frame.decrease_ref_cnt();
+            }
+        }
+
+        if (ret = AXCL_VDEC_ReleaseChnFrame(grp, m_chn, &info); AXCL_SUCC != ret) {
+            LOG_MM_E(TAG, "AXCL_VDEC_ReleaseChnFrame(vdGrp {}, vdChn {}) fail, ret = {:#x}", grp, m_chn, static_cast<uint32_t>(ret));
+        }
+    }
+
+    LOG_MM_D(TAG, "vdGrp {} ---", grp);
+}
+
+}  // namespace axclite
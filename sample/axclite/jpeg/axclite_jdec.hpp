@@ -0,0 +1,63 @@
+/**************************************************************************************************
+ *
+ * Copyright (c) 2019-2024 Axera Semiconductor Co., Ltd. All Rights Reserved.
+ *
+ * This source file is the property of Axera Semiconductor Co., Ltd. and
+ * may not be copied or distributed in any isomorphic form without the prior
+ * written consent of Axera Semiconductor Co., Ltd.
+ *
+ **************************************************************************************************/
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <vector>
+#include "axclite.h"
+#include "axclite_frame.hpp"
+#include "axclite_vdec.hpp"
+#include "lock_queue.hpp"
+#include "threadx.hpp"
+
+namespace axclite {
+
+/**
+ * @brief hardware JPEG decoder on persistent VDEC groups.
+ *        send_stream() spreads pictures over the groups, decoded frames of all groups are collected into one
+ *        queue which holds a VB reference of each frame until release_frame().
+ *
+ * init() -> start() -> send_stream() ... get_frame() -> release_frame() ... -> stop() -> deinit()
+ */
+class jdec {
+public:
+    jdec() = default;
+
+    axclError init(const axclite_jdec_attr &attr);
+    axclError deinit();
+
+    axclError start(int32_t device);
+    axclError stop();
+
+    axclError send_stream(const AX_U8 *jpeg, AX_U32 len, AX_U64 userdata = 0, AX_S32 timeout = -1);
+    axclError get_frame(axclite_frame &frame, AX_S32 timeout = -1);
+    axclError release_frame(axclite_frame &frame);
+
+    const axclite_jdec_attr &get_attr() const {
+        return m_attr;
+    }
+
+protected:
+    bool check_attr(const axclite_jdec_attr &attr);
+    void fetch_thread(int32_t device, AX_U32 index);
+
+private:
+    axclite_jdec_attr m_attr = {};
+    AX_VDEC_CHN m_chn = 0;
+    std::vector<std::unique_ptr<vdec>> m_vdecs;
+    std::vector<std::unique_ptr<axcl::threadx>> m_threads;
+    axcl::lock_queue<axclite_frame> m_q_frames;
+    std::atomic<AX_U32> m_next = {0};
+    std::atomic<bool> m_started = {false};
+};
+
+}  // namespace axclite
@@ -0,0 +1,331 @@
+/**************************************************************************************************
+ *
+ * Copyright (c) 2019-2024 Axera Semiconductor Co., Ltd. All Rights Reserved.
+ *
+ * This source file is the property of Axera Semiconductor Co., Ltd. and
+ * may not be copied or distributed in any isomorphic form without the prior
+ * written consent of Axera Semiconductor Co., Ltd.
+ *
+ **************************************************************************************************/
+
+#include "axclite_jenc.hpp"
+#include <string.h>
+#include "log/logger.hpp"
+
+#define TAG "axclite-jenc"
+
+namespace axclite {
+
+bool jenc::check_attr(const axclite_jenc_attr &attr) {
+    if (0 == attr.chn_num || attr.chn_num > AXCL_LITE_JPEG_MAX_CHN_NUM) {
+        LOG_MM_E(TAG, "invalid channel number {}", attr.chn_num);
+        return false;
+    }
+
+    if (0 == attr.width || 0 == attr.height) {
+        LOG_MM_E(TAG, "invalid picture width {} or height {}", attr.width, attr.height);
+        return false;
+    }
+
+    if (0 == attr.qfactor || attr.qfactor > 99) {
+        LOG_MM_E(TAG, "invalid qfactor {}, range [1, 99]", attr.qfactor);
+        return false;
+    }
+
+    if (attr.roi_num > MAX_VENC_ROI_NUM || (attr.roi_num > 0 && (0 == attr.roi_qfactor || attr.roi_qfactor > 99))) {
+        LOG_MM_E(TAG, "invalid roi number {} or roi qfactor {}", attr.roi_num, attr.roi_qfactor);
+        return false;
+    }
+
+    if (0 == attr.fifo_depth) {
+        LOG_MM_E(TAG, "fifo depth should > 0");
+        return false;
+    }
+
+    return true;
+}
+
+axclError jenc::init(const axclite_jenc_attr &attr) {
+    if (!check_attr(attr)) {
+        return AXCL_ERR_LITE_JENC_ILLEGAL_PARAM;
+    }
+
+    axclite_venc_attr venc_attr = {};
+    venc_attr.chn.payload = PT_JPEG;
+    venc_attr.chn.width = attr.width;
+    venc_attr.chn.height = attr.height;
+    venc_attr.chn.link = AX_FALSE;
+    venc_attr.chn.in_fifo_depth = attr.in_fifo_depth;
+    venc_attr.chn.out_fifo_depth = attr.out_fifo_depth;
+
+    for (AX_U32 i = 0; i < attr.chn_num; ++i) {
+        auto m = std::make_unique<venc>();
+        if (!m) {
+            LOG_MM_E(TAG, "create venc instance fail");
+            deinit();
+            return AXCL_ERR_LITE_JENC_NO_MEMORY;
+        }
+
+        if (axclError ret = m->init(venc_attr); AXCL_SUCC != ret) {
+            deinit();
+            return ret;
+        }
+
+        m_vencs.push_back(std::move(m));
+    }
+
+    if (axclError ret = update_jpeg_param(attr); AXCL_SUCC != ret) {
+        deinit();
+        return ret;
+    }
+
+    /**
+     * one buffer per queued stream, sized as the VENC output buffer so that every picture fits.
+     */
+    m_buf_size = attr.width * attr.height * 3 / 2;
+    m_buffers.reserve(attr.fifo_depth);
+    m_free_buffers.reserve(attr.fifo_depth);
+    for (AX_U32 i = 0; i < attr.fifo_depth; ++i) {
+        m_buffers.emplace_back(new (std::nothrow) AX_U8[m_buf_size]);
+        if (!m_buffers.back()) {
+            LOG_MM_E(TAG, "alloc {} bytes stream buffer fail", m_buf_size);
+            deinit();
+            return AXCL_ERR_LITE_JENC_NO_MEMORY;
+        }
+
+        m_free_buffers.push_back(m_buffers.back().get());
+    }
+
+    m_q_streams.set_capacity(attr.fifo_depth);
+    m_attr = attr;
+
+    LOG_MM_I(TAG, "{} channels, {}x{}, qfactor {}, {} roi", attr.chn_num, attr.width, attr.height, attr.qfactor, attr.roi_num);
+    return AXCL_SUCC;
+}
+
+axclError jenc::deinit() {
+    if (m_started) {
+        LOG_MM_E(TAG, "jenc is still running");
+        return AXCL_ERR_LITE_JENC_ILLEGAL_PARAM;
+    }
+
+    for (auto &&m : m_vencs) {
+        if (axclError ret = m->deinit(); AXCL_SUCC != ret) {
+            return ret;
+        }
+    }
+
+    m_vencs.clear();
+
+    std::lock_guard<std::mutex> lck(m_mtx_buffers);
+    m_free_buffers.clear();
+    m_buffers.clear();
+    return AXCL_SUCC;
+}
+
+axclError jenc::start(int32_t device) {
+    if (m_started) {
+        LOG_MM_W(TAG, "jenc is already started");
+        return AXCL_SUCC;
+    }
+
+    for (AX_U32 i = 0; i < m_vencs.size(); ++i) {
+        m_vencs[i]->register_sink(&m_sinker);
+        if (axclError ret = m_vencs[i]->start(device); AXCL_SUCC != ret) {
+            m_vencs[i]->unregister_sink(&m_sinker);
+            for (AX_U32 j = 0; j < i; ++j) {
+                m_vencs[j]->stop();
+                m_vencs[j]->unregister_sink(&m_sinker);
+            }
+
+            return ret;
+        }
+    }
+
+    m_started = true;
+    return AXCL_SUCC;
+}
+
+axclError jenc::stop() {
+    if (!m_started) {
+        LOG_MM_W(TAG, "jenc is not started yet");
+        return AXCL_SUCC;
+    }
+
+    for (auto &&m : m_vencs) {
+        if (axclError ret = m->stop(); AXCL_SUCC != ret) {
+            return ret;
+        }
+
+        m->unregister_sink(&m_sinker);
+    }
+
+    axclite_jpeg_stream stream;
+    while (m_q_streams.pop(stream, 0)) {
+        free_buffer(stream.data);
+    }
+
+    m_started = false;
+    return AXCL_SUCC;
+}
+
+axclError jenc::send_frame(const AX_VIDEO_FRAME_T &frame, AX_U64 userdata, AX_S32 timeout) {
+    if (!m_started) {
+        return AXCL_ERR_LITE_JENC_NOT_STARTED;
+    }
+
+    AX_VIDEO_FRAME_INFO_T info = {};
+    info.stVFrame = frame;
+    info.stVFrame.u64UserData = userdata;
+
+    const AX_U32 index = m_next.fetch_add(1) % m_vencs.size();
+    const VENC_CHN chn = m_vencs[index]->get_chn_id();
+    if (axclError ret = AXCL_VENC_SendFrame(chn, &info, timeout); AXCL_SUCC != ret) {
+        if (AX_ERR_VENC_QUEUE_FULL == ret) {
+            return AXCL_ERR_LITE_JENC_TIMEOUT;
+        }
+
+        LOG_MM_E(TAG, "AXCL_VENC_SendFrame(veChn {}) fail, ret = {:#x}", chn, static_cast<uint32_t>(ret));
+        return ret;
+    }
+
+    return AXCL_SUCC;
+}
+
+axclError jenc::get_stream(axclite_jpeg_stream &stream, AX_S32 timeout) {
+    if (!m_started) {
+        return AXCL_ERR_LITE_JENC_NOT_STARTED;
+    }
+
+    return m_q_streams.pop(stream, timeout) ? AXCL_SUCC : AXCL_ERR_LITE_JENC_TIMEOUT;
+}
+
+axclError jenc::release_stream(axclite_jpeg_stream &stream) {
+    if (!stream.data) {
+        return AXCL_ERR_LITE_JENC_NULL_POINTER;
+    }
+
+    free_buffer(stream.data);
+    stream.data = nullptr;
+    stream.len = 0;
+    return AXCL_SUCC;
+}
+
+axclError jenc::set_quality(AX_U32 qfactor) {
+    std::lock_guard<std::mutex> lck(m_mtx_param);
+    axclite_jenc_attr attr = m_attr;
+    attr.qfactor = qfactor;
+    if (!check_attr(attr)) {
+        return AXCL_ERR_LITE_JENC_ILLEGAL_PARAM;
+    }
+
+    if (axclError ret = update_jpeg_param(attr); AXCL_SUCC != ret) {
+        return ret;
+    }
+
+    m_attr = attr;
+    return AXCL_SUCC;
+}
+
+axclError jenc::set_roi(AX_U32 roi_num, const AX_RECT_T *roi, AX_U32 roi_qfactor) {
+    if (roi_num > 0 && !roi) {
+        return AXCL_ERR_LITE_JENC_NULL_POINTER;
+    }
+
+    std::lock_guard<std::mutex> lck(m_mtx_param);
+    axclite_jenc_attr attr = m_attr;
+    attr.roi_num = roi_num;
+    attr.roi_qfactor = roi_qfactor;
+    for (AX_U32 i = 0; i < MAX_VENC_ROI_NUM; ++i) {
+        attr.roi[i] = (i < roi_num) ? roi[i] : AX_RECT_T{};
+    }
+
+    if (!check_attr(attr)) {
+        return AXCL_ERR_LITE_JENC_ILLEGAL_PARAM;
+    }
+
+    if (axclError ret = update_jpeg_param(attr); AXCL_SUCC != ret) {
+        return ret;
+    }
+
+    m_attr = attr;
+    return AXCL_SUCC;
+}
+
+axclError jenc::update_jpeg_param(const axclite_jenc_attr &attr) {
+    for (auto &&m : m_vencs) {
+        const VENC_CHN chn = m->get_chn_id();
+
+        AX_VENC_JPEG_PARAM_T param;
+        if (axclError ret = AXCL_VENC_GetJpegParam(chn, &param); AXCL_SUCC != ret) {
+            LOG_MM_E(TAG, "AXCL_VENC_GetJpegParam(veChn {}) fail, ret = {:#x}", chn, static_cast<uint32_t>(ret));
+            return ret;
+        }
+
+        param.u32Qfactor = attr.qfactor;
+        param.bEnableRoi = (attr.roi_num > 0) ? AX_TRUE : AX_FALSE;
+        if (param.bEnableRoi) {
+            param.u32RoiQfactor = attr.roi_qfactor;
+        }
+
+        for (AX_U32 i = 0; i < MAX_VENC_ROI_NUM; ++i) {
+            param.bEnable[i] = (i < attr.roi_num) ? AX_TRUE : AX_FALSE;
+            param.stRoiArea[i] = attr.roi[i];
+        }
+
+        if (axclError ret = AXCL_VENC_SetJpegParam(chn, &param); AXCL_SUCC != ret) {
+            LOG_MM_E(TAG, "AXCL_VENC_SetJpegParam(veChn {}, qfactor {}) fail, ret = {:#x}", chn, attr.qfactor, static_cast<uint32_t>(ret));
+            return ret;
+        }
+    }
+
+    return AXCL_SUCC;
+}
+
+AX_U8 *jenc::alloc_buffer() {
+    std::lock_guard<std::mutex> lck(m_mtx_buffers);
+    if (m_free_buffers.empty()) {
+        return nullptr;
+    }
+
+    AX_U8 *buf = m_free_buffers.back();
+    m_free_buffers.pop_back();
+    return buf;
+}
+
+void jenc::free_buffer(AX_U8 *buf) {
+    std::lock_guard<std::mutex> lck(m_mtx_buffers);
+    m_free_buffers.push_back(buf);
+}
+
+int32_t jenc::on_stream(const axclite_frame &frame) {
+    /* called by the dispatch thread of each channel, the stream is already copied to host */
+    const AX_VENC_PACK_T &pack = frame.stream.stPack;
+    if (pack.u32Len > m_buf_size) {
+        LOG_MM_E(TAG, "veChn {}: jpeg size {} exceeds {}", frame.chn, pack.u32Len, m_buf_size);
+        return AXCL_ERR_LITE_JENC_NO_MEMORY;
+    }
+
+    AX_U8 *buf = alloc_buffer();
+    if (!buf) {
+        LOG_MM_W(TAG, "stream fifo is full, drop veChn {} jpeg {}", frame.chn, pack.u64SeqNum);
+        return AXCL_ERR_LITE_JENC_NO_MEMORY;
+    }
+
+    memcpy(buf, pack.pu8Addr, pack.u32Len);
+
+    axclite_jpeg_stream stream;
+    stream.data = buf;
+    stream.len = pack.u32Len;
+    stream.pts = pack.u64PTS;
+    stream.seq_num = pack.u64SeqNum;
+    stream.userdata = pack.u64UserData;
+    if (!m_q_streams.push(stream)) {
+        free_buffer(buf);
+        return AXCL_ERR_LITE_JENC_NO_MEMORY;
+    }
+
+    return AXCL_SUCC;
+}
+
+}  // namespace axclite
@@ -0,0 +1,90 @@
+/**************************************************************************************************
+ *
+ * Copyright (c) 2019-2024 Axera Semiconductor Co., Ltd. All Rights Reserved.
+ *
+ * This source file is the property of Axera Semiconductor Co., Ltd. and
+ * may not be copied or distributed in any isomorphic form without the prior
+ * written consent of Axera Semiconductor Co., Ltd.
+ *
+ **************************************************************************************************/
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "axclite.h"
+#include "axclite_sink.hpp"
+#include "axclite_venc.hpp"
+#include "lock_queue.hpp"
+
+namespace axclite {
+
+/**
+ * @brief hardware JPEG encoder on persistent VENC channels.
+ *        send_frame() spreads pictures over the channels, encoded pictures of all channels are copied into
+ *        pooled host buffers and collected into one queue, the buffer is recycled by release_stream().
+ *
+ * init() -> start() -> send_frame() ... get_stream() -> release_stream() ... -> stop() -> deinit()
+ */
+class jenc {
+public:
+    jenc() = default;
+
+    axclError init(const axclite_jenc_attr &attr);
+    axclError deinit();
+
+    axclError start(int32_t device);
+    axclError stop();
+
+    axclError send_frame(const AX_VIDEO_FRAME_T &frame, AX_U64 userdata = 0, AX_S32 timeout = -1);
+    axclError get_stream(axclite_jpeg_stream &stream, AX_S32 timeout = -1);
+    axclError release_stream(axclite_jpeg_stream &stream);
+
+    /* runtime quality of all channels */
+    axclError set_quality(AX_U32 qfactor);
+    axclError set_roi(AX_U32 roi_num, const AX_RECT_T *roi, AX_U32 roi_qfactor);
+
+    const axclite_jenc_attr &get_attr() const {
+        return m_attr;
+    }
+
+protected:
+    bool check_attr(const axclite_jenc_attr &attr);
+    axclError update_jpeg_param(const axclite_jenc_attr &attr);
+
+    AX_U8 *alloc_buffer();
+    void free_buffer(AX_U8 *buf);
+    int32_t on_stream(const axclite_frame &frame);
+
+    class stream_sinker : public sinker {
+    public:
+        explicit stream_sinker(jenc *owner) : m_owner(owner) {
+        }
+
+        int32_t recv_frame(const axclite_frame &frame) {
+            return m_owner->on_stream(frame);
+        }
+
+    private:
+        jenc *m_owner;
+    };
+
+private:
+    axclite_jenc_attr m_attr = {};
+    std::vector<std::unique_ptr<venc>> m_vencs;
+    stream_sinker m_sinker{this};
+
+    AX_U32 m_buf_size = 0;
+    std::vector<std::unique_ptr<AX_U8[]>> m_buffers;
+    std::vector<AX_U8 *> m_free_buffers;
+    std::mutex m_mtx_buffers;
+
+    axcl::lock_queue<axclite_jpeg_stream> m_q_streams;
+    std::mutex m_mtx_param;
+    std::atomic<AX_U32> m_next = {0};
+    std::atomic<bool> m_started = {false};
+};
+
+}  // namespace axclite
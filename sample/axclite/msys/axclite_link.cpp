@@ -9,14 +9,166 @@
  **************************************************************************************************/
 
 #include "axclite_link.hpp"
+#include <algorithm>
+#include <chrono>
+#include <queue>
 #include "log/logger.hpp"
+#include "thread_pool.hpp"
 
 #define TAG "axclite-link"
 
+#define MAX_UNLINK_THREAD_NUM (8)
+
 namespace axclite {
 
+static bool check_port(const AX_MOD_INFO_T& m, bool src) {
+    if (m.s32GrpId < 0 || m.s32ChnId < 0) {
+        return false;
+    }
+
+    switch (m.enModId) {
+        case AX_ID_VDEC:
+            return src && m.s32GrpId < AX_VDEC_MAX_GRP_NUM && m.s32ChnId < AX_DEC_MAX_CHN_NUM;
+        case AX_ID_IVPS:
+            return m.s32GrpId < AX_IVPS_MAX_GRP_NUM && (src ? (m.s32ChnId < AX_IVPS_MAX_OUTCHN_NUM) : (0 == m.s32ChnId));
+        case AX_ID_VENC:
+            return !src && 0 == m.s32GrpId && m.s32ChnId < MAX_VENC_CHN_NUM;
+        default:
+            return false;
+    }
+}
+
+/* input and output channels of the same IVPS group are one node, VENC channels are independent nodes */
+static uint64_t node_of(const AX_MOD_INFO_T& m) {
+    const int32_t id = (AX_ID_VENC == m.enModId) ? m.s32ChnId : m.s32GrpId;
+    return (static_cast<uint64_t>(m.enModId) << 32) | static_cast<uint32_t>(id);
+}
+
+static uint64_t port_of(const AX_MOD_INFO_T& m) {
+    return (static_cast<uint64_t>(m.enModId) << 48) | (static_cast<uint64_t>(m.s32GrpId) << 24) | static_cast<uint64_t>(m.s32ChnId);
+}
+
+static uint64_t elapsed_us(const std::chrono::steady_clock::time_point& begin) {
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - begin).count();
+}
+
+void link_graph::add(const link_port& src, const link_port& dst) {
+    if (m_linked) {
+        LOG_MM_W(TAG, "graph {} is linked, unlink it before adding", m_id);
+        return;
+    }
+
+    m_edges.push_back({src, dst, false});
+}
+
+void link_graph::clear() {
+    if (m_linked) {
+        LOG_MM_W(TAG, "graph {} is linked, unlink it before clearing", m_id);
+        return;
+    }
+
+    m_edges.clear();
+}
+
+axclError link_graph::validate() const {
+    std::vector<edge> edges;
+    return sort(edges);
+}
+
+axclError link_graph::sort(std::vector<edge>& edges) const {
+    if (m_edges.empty()) {
+        LOG_MM_E(TAG, "graph {} is empty", m_id);
+        return AXCL_ERR_LITE_MSYS_INVALID_GRAPH;
+    }
+
+    std::unordered_map<uint64_t, uint32_t> in_degree;
+    std::unordered_map<uint64_t, std::vector<size_t>> out_edges;
+    std::unordered_set<uint64_t> dsts;
+    for (size_t i = 0; i < m_edges.size(); ++i) {
+        const link_port& src = m_edges[i].src;
+        const link_port& dst = m_edges[i].dst;
+
+        if (!check_port(src.mod, true) || !check_port(dst.mod, false)) {
+            LOG_MM_E(TAG, "graph {}: [{}, {}, {}] -> [{}, {}, {}] is not supported", m_id, static_cast<int32_t>(src.mod.enModId),
+                     src.mod.s32GrpId, src.mod.s32ChnId, static_cast<int32_t>(dst.mod.enModId), dst.mod.s32GrpId, dst.mod.s32ChnId);
+            return AXCL_ERR_LITE_MSYS_INVALID_GRAPH;
+        }
+
+        if (!dsts.insert(port_of(dst.mod)).second) {
+            LOG_MM_E(TAG, "graph {}: [{}, {}, {}] is linked to more than one src", m_id, static_cast<int32_t>(dst.mod.enModId),
+                     dst.mod.s32GrpId, dst.mod.s32ChnId);
+            return AXCL_ERR_LITE_MSYS_INVALID_GRAPH;
+        }
+
+        /* VENC neither scales nor converts, IVPS does both */
+        if (AX_ID_VENC == dst.mod.enModId) {
+            if (src.width > 0 && dst.width > 0 && (src.width != dst.width || src.height != dst.height)) {
+                LOG_MM_E(TAG, "graph {}: [{}, {}, {}] {}x{} mismatch VENC chn {} {}x{}", m_id, static_cast<int32_t>(src.mod.enModId),
+                         src.mod.s32GrpId, src.mod.s32ChnId, src.width, src.height, dst.mod.s32ChnId, dst.width, dst.height);
+                return AXCL_ERR_LITE_MSYS_INVALID_GRAPH;
+            }
+
+            if (AX_FORMAT_INVALID != src.pix_fmt && AX_FORMAT_INVALID != dst.pix_fmt && src.pix_fmt != dst.pix_fmt) {
+                LOG_MM_E(TAG, "graph {}: [{}, {}, {}] format {} mismatch VENC chn {} format {}", m_id,
+                         static_cast<int32_t>(src.mod.enModId), src.mod.s32GrpId, src.mod.s32ChnId, static_cast<int32_t>(src.pix_fmt),
+                         dst.mod.s32ChnId, static_cast<int32_t>(dst.pix_fmt));
+                return AXCL_ERR_LITE_MSYS_INVALID_GRAPH;
+            }
+        }
+
+        if (src.blk_cnt > 0 && src.blk_cnt <= dst.fifo_depth) {
+            LOG_MM_W(TAG, "graph {}: {} blocks of [{}, {}, {}] can be all held by fifo (depth {}) of [{}, {}, {}]", m_id, src.blk_cnt,
+                     static_cast<int32_t>(src.mod.enModId), src.mod.s32GrpId, src.mod.s32ChnId, dst.fifo_depth,
+                     static_cast<int32_t>(dst.mod.enModId), dst.mod.s32GrpId, dst.mod.s32ChnId);
+        }
+
+        in_degree.emplace(node_of(src.mod), 0);
+        ++in_degree[node_of(dst.mod)];
+        out_edges[node_of(src.mod)].push_back(i);
+    }
+
+    /* topological order from sources to sinks */
+    std::queue<uint64_t> nodes;
+    for (auto&& m : in_degree) {
+        if (0 == m.second) {
+            nodes.push(m.first);
+        }
+    }
+
+    std::vector<size_t> order;
+    order.reserve(m_edges.size());
+    while (!nodes.empty()) {
+        const uint64_t node = nodes.front();
+        nodes.pop();
+
+        for (size_t i : out_edges[node]) {
+            order.push_back(i);
+            if (0 == --in_degree[node_of(m_edges[i].dst.mod)]) {
+                nodes.push(node_of(m_edges[i].dst.mod));
+            }
+        }
+    }
+
+    if (order.size() != m_edges.size()) {
+        LOG_MM_E(TAG, "graph {} has loop", m_id);
+        return AXCL_ERR_LITE_MSYS_INVALID_GRAPH;
+    }
+
+    /* link downstream first, so that no frame is sent to an unlinked module */
+    edges.clear();
+    edges.reserve(order.size());
+    for (auto it = order.rbegin(); it != order.rend(); ++it) {
+        edges.push_back(m_edges[*it]);
+    }
+
+    return AXCL_SUCC;
+}
+
 axclError linker::link(const AX_MOD_INFO_T& src, const AX_MOD_INFO_T& dst) {
-    std::lock_guard<std::mutex> lock(m_mtx);
+    std::unique_lock<std::mutex> lock(m_mtx);
+
+    /* a graph being linked owns dst, wait until it is linked or rolled back */
+    m_cv.wait(lock, [this, &dst]() { return m_pending.find(dst) == m_pending.end(); });
 
     auto it = m_map.find(src);
     if (it != m_map.end() && it->second.find(dst) != it->second.end()) {
@@ -32,6 +184,7 @@ axclError linker::link(const AX_MOD_INFO_T& src, const AX_MOD_INFO_T& dst) {
     }
 
     m_map[src].insert(dst);
+    m_dst[dst] = src;
     LOG_MM_I(TAG, "[{}, {}, {}] -> [{}, {}, {}] is linked", static_cast<int32_t>(src.enModId), src.s32GrpId, src.s32ChnId,
              static_cast<int32_t>(dst.enModId), dst.s32GrpId, dst.s32ChnId);
 
@@ -59,6 +212,7 @@ axclError linker::unlink(const AX_MOD_INFO_T& src) {
         } else {
             LOG_MM_I(TAG, "[{}, {}, {}] -> [{}, {}, {}] is unlinked", static_cast<int32_t>(src.enModId), src.s32GrpId, src.s32ChnId,
                      static_cast<int32_t>(dst.enModId), dst.s32GrpId, dst.s32ChnId);
+            m_dst.erase(dst);
             dst_it = dst_set.erase(dst_it);
         }
     }
@@ -94,6 +248,7 @@ axclError linker::unlink(const AX_MOD_INFO_T& src, const AX_MOD_INFO_T& dst) {
         return ret;
     }
 
+    m_dst.erase(dst);
     dst_set.erase(dst_it);
     if (dst_set.empty()) {
         m_map.erase(it);
@@ -123,6 +278,7 @@ axclError linker::unlink() {
             } else {
                 LOG_MM_I(TAG, "[{}, {}, {}] -> [{}, {}, {}] is unlinked", static_cast<int32_t>(src.enModId), src.s32GrpId, src.s32ChnId,
                          static_cast<int32_t>(dst.enModId), dst.s32GrpId, dst.s32ChnId);
+                m_dst.erase(dst);
                 dst_it = dst_set.erase(dst_it);
             }
         }
@@ -137,4 +293,180 @@ axclError linker::unlink() {
     return err;
 }
 
+axclError linker::link(link_graph& graph) {
+    if (graph.m_linked) {
+        LOG_MM_W(TAG, "graph {} is already linked", graph.m_id);
+        return AXCL_SUCC;
+    }
+
+    std::vector<link_graph::edge> edges;
+    if (axclError ret = graph.sort(edges); AXCL_SUCC != ret) {
+        return ret;
+    }
+
+    const auto begin = std::chrono::steady_clock::now();
+
+    /* reserve all dst as pending in lock, then link out of lock */
+    {
+        std::lock_guard<std::mutex> lock(m_mtx);
+        for (auto&& e : edges) {
+            if (auto it = m_dst.find(e.dst.mod); it != m_dst.end()) {
+                LOG_MM_E(TAG, "graph {}: [{}, {}, {}] is already linked from [{}, {}, {}]", graph.m_id,
+                         static_cast<int32_t>(e.dst.mod.enModId), e.dst.mod.s32GrpId, e.dst.mod.s32ChnId,
+                         static_cast<int32_t>(it->second.enModId), it->second.s32GrpId, it->second.s32ChnId);
+                return AXCL_ERR_LITE_MSYS_BUSY;
+            }
+
+            if (m_pending.find(e.dst.mod) != m_pending.end()) {
+                LOG_MM_E(TAG, "graph {}: [{}, {}, {}] is being linked by another graph", graph.m_id, static_cast<int32_t>(e.dst.mod.enModId),
+                         e.dst.mod.s32GrpId, e.dst.mod.s32ChnId);
+                return AXCL_ERR_LITE_MSYS_BUSY;
+            }
+        }
+
+        for (auto&& e : edges) {
+            m_pending.insert(e.dst.mod);
+        }
+    }
+
+    for (size_t i = 0; i < edges.size(); ++i) {
+        const AX_MOD_INFO_T& src = edges[i].src.mod;
+        const AX_MOD_INFO_T& dst = edges[i].dst.mod;
+        if (axclError ret = AXCL_SYS_Link(&src, &dst); AXCL_SUCC != ret) {
+            LOG_MM_E(TAG, "graph {}: AXCL_SYS_Link: [{}, {}, {}] -> [{}, {}, {}] fail, ret = {:#x}", graph.m_id,
+                     static_cast<int32_t>(src.enModId), src.s32GrpId, src.s32ChnId, static_cast<int32_t>(dst.enModId), dst.s32GrpId,
+                     dst.s32ChnId, static_cast<uint32_t>(ret));
+
+            while (i-- > 0) {
+                (void)AXCL_SYS_UnLink(&edges[i].src.mod, &edges[i].dst.mod);
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(m_mtx);
+                for (auto&& e : edges) {
+                    m_pending.erase(e.dst.mod);
+                }
+            }
+
+            m_cv.notify_all();
+            return ret;
+        }
+
+        edges[i].linked = true;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mtx);
+        for (auto&& e : edges) {
+            m_pending.erase(e.dst.mod);
+            m_map[e.src.mod].insert(e.dst.mod);
+            m_dst[e.dst.mod] = e.src.mod;
+        }
+    }
+
+    m_cv.notify_all();
+
+    graph.m_edges = std::move(edges);
+    graph.m_linked = true;
+    graph.m_setup_us = elapsed_us(begin);
+
+    LOG_MM_I(TAG, "graph {}: {} links are linked in {} us", graph.m_id, graph.m_edges.size(), graph.m_setup_us);
+    return AXCL_SUCC;
+}
+
+axclError linker::unlink(link_graph& graph) {
+    if (!graph.m_linked) {
+        LOG_MM_W(TAG, "graph {} is not linked", graph.m_id);
+        return AXCL_SUCC;
+    }
+
+    const auto begin = std::chrono::steady_clock::now();
+
+    axclError err = AXCL_SUCC;
+    bool linked = false;
+    for (auto it = graph.m_edges.rbegin(); it != graph.m_edges.rend(); ++it) {
+        if (!it->linked) {
+            continue;
+        }
+
+        const AX_MOD_INFO_T& src = it->src.mod;
+        const AX_MOD_INFO_T& dst = it->dst.mod;
+        if (axclError ret = AXCL_SYS_UnLink(&src, &dst); AXCL_SUCC != ret) {
+            LOG_MM_E(TAG, "graph {}: AXCL_SYS_UnLink: [{}, {}, {}] -> [{}, {}, {}] fail, ret = {:#x}", graph.m_id,
+                     static_cast<int32_t>(src.enModId), src.s32GrpId, src.s32ChnId, static_cast<int32_t>(dst.enModId), dst.s32GrpId,
+                     dst.s32ChnId, static_cast<uint32_t>(ret));
+            err = ret;
+            linked = true;
+            continue;
+        }
+
+        it->linked = false;
+
+        std::lock_guard<std::mutex> lock(m_mtx);
+        erase(src, dst);
+    }
+
+    graph.m_linked = linked;
+    graph.m_teardown_us = elapsed_us(begin);
+
+    LOG_MM_I(TAG, "graph {}: {} links are unlinked in {} us", graph.m_id, graph.m_edges.size(), graph.m_teardown_us);
+    return err;
+}
+
+axclError linker::unlink(const std::vector<link_graph*>& graphs) {
+    if (std::any_of(graphs.begin(), graphs.end(), [](const link_graph* g) { return !g; })) {
+        LOG_MM_E(TAG, "nil graph");
+        return AXCL_ERR_LITE_MSYS_NULL_POINTER;
+    }
+
+    if (graphs.size() <= 1) {
+        return graphs.empty() ? AXCL_SUCC : unlink(*graphs[0]);
+    }
+
+    axclrtContext context;
+    if (axclError ret = axclrtGetCurrentContext(&context); AXCL_SUCC != ret) {
+        LOG_MM_E(TAG, "axclrtGetCurrentContext() fail, ret = {:#x}", static_cast<uint32_t>(ret));
+        return ret;
+    }
+
+    const auto begin = std::chrono::steady_clock::now();
+
+    std::vector<std::future<axclError>> futures;
+    futures.reserve(graphs.size());
+    {
+        axcl::thread_pool threads(std::min<size_t>(graphs.size(), MAX_UNLINK_THREAD_NUM), "unlink");
+        for (link_graph* graph : graphs) {
+            futures.push_back(threads.enqueue([this, graph, context]() -> axclError {
+                if (axclError ret = axclrtSetCurrentContext(context); AXCL_SUCC != ret) {
+                    LOG_MM_E(TAG, "axclrtSetCurrentContext() fail, ret = {:#x}", static_cast<uint32_t>(ret));
+                    return ret;
+                }
+
+                return unlink(*graph);
+            }));
+        }
+    }
+
+    axclError err = AXCL_SUCC;
+    for (auto&& f : futures) {
+        if (axclError ret = f.get(); AXCL_SUCC != ret) {
+            err = ret;
+        }
+    }
+
+    LOG_MM_I(TAG, "{} graphs are unlinked in {} us", graphs.size(), elapsed_us(begin));
+    return err;
+}
+
+void linker::erase(const AX_MOD_INFO_T& src, const AX_MOD_INFO_T& dst) {
+    if (auto it = m_map.find(src); it != m_map.end()) {
+        it->second.erase(dst);
+        if (it->second.empty()) {
+            m_map.erase(it);
+        }
+    }
+
+    m_dst.erase(dst);
+}
+
 }  // namespace axclite
\ No newline at end of file
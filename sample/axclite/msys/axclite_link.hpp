@@ -10,13 +10,83 @@
 
 #pragma once
 
+#include <condition_variable>
 #include <mutex>
 #include <unordered_map>
 #include <unordered_set>
+#include <vector>
 #include "axclite.h"
 
 namespace axclite {
 
+/**
+ * @brief one end of a link. 0 or AX_FORMAT_INVALID means unknown and is not checked.
+ *        src port: output frame size and format, blk_cnt of the output pool.
+ *        dst port: input frame size and format, fifo_depth of the input fifo.
+ */
+struct link_port {
+    AX_MOD_INFO_T mod;
+    AX_U32 width = 0;
+    AX_U32 height = 0;
+    AX_IMG_FORMAT_E pix_fmt = AX_FORMAT_INVALID;
+    AX_U32 blk_cnt = 0;
+    AX_U32 fifo_depth = 0;
+};
+
+/**
+ * @brief links of one pipeline, e.g. VDEC -> IVPS -> VENC.
+ *        linker links the whole graph in one batch (downstream first) and unlinks it in the reverse order.
+ */
+class link_graph {
+    friend class linker;
+
+    struct edge {
+        link_port src;
+        link_port dst;
+        bool linked;
+    };
+
+public:
+    explicit link_graph(int32_t id = -1) : m_id(id) {
+    }
+
+    void add(const link_port& src, const link_port& dst);
+    void clear();
+
+    /**
+     * @brief check module ids, channel ranges, resolution and format of each link,
+     *        a dst to be linked to only one src and no loop.
+     */
+    axclError validate() const;
+
+    int32_t id() const {
+        return m_id;
+    }
+
+    bool linked() const {
+        return m_linked;
+    }
+
+    /* cost in microseconds of the last linker::link and linker::unlink */
+    uint64_t setup_us() const {
+        return m_setup_us;
+    }
+
+    uint64_t teardown_us() const {
+        return m_teardown_us;
+    }
+
+private:
+    axclError sort(std::vector<edge>& edges) const;
+
+private:
+    int32_t m_id;
+    std::vector<edge> m_edges;
+    bool m_linked = false;
+    uint64_t m_setup_us = 0;
+    uint64_t m_teardown_us = 0;
+};
+
 class linker {
     struct hash_fn {
         std::size_t operator()(const AX_MOD_INFO_T& m) const {
@@ -38,9 +108,31 @@ public:
     axclError unlink(const AX_MOD_INFO_T& src, const AX_MOD_INFO_T& dst);
     axclError unlink();
 
+    /**
+     * @brief validate and link all edges of graph, linked edges are rolled back if any one fails.
+     *        AXCL_SYS_Link is called out of lock, so different graphs can be linked concurrently;
+     *        the dst are pending until all links are done, link(src, dst) of a pending dst waits for them.
+     */
+    axclError link(link_graph& graph);
+    axclError unlink(link_graph& graph);
+
+    /**
+     * @brief unlink graphs concurrently, each graph is unlinked in its reverse link order.
+     *        the context of the caller thread is used.
+     */
+    axclError unlink(const std::vector<link_graph*>& graphs);
+
+private:
+    void erase(const AX_MOD_INFO_T& src, const AX_MOD_INFO_T& dst);
+
 private:
     std::mutex m_mtx;
     std::unordered_map<AX_MOD_INFO_T, std::unordered_set<AX_MOD_INFO_T, hash_fn, hash_equal>, hash_fn, hash_equal> m_map;
+    /* dst -> src, a dst can be linked to only one src */
+    std::unordered_map<AX_MOD_INFO_T, AX_MOD_INFO_T, hash_fn, hash_equal> m_dst;
+    /* dst reserved by link(graph) whose AXCL_SYS_Link is in progress, not in m_map or m_dst yet */
+    std::unordered_set<AX_MOD_INFO_T, hash_fn, hash_equal> m_pending;
+    std::condition_variable m_cv;
 };
 
 }  // namespace axclite
\ No newline at end of file
@@ -87,4 +87,16 @@ axclError msys::unlink(const AX_MOD_INFO_T& src, const AX_MOD_INFO_T& dst) {
     return m_link.unlink(src, dst);
 }
 
+axclError msys::link(link_graph& graph) {
+    return m_link.link(graph);
+}
+
+axclError msys::unlink(link_graph& graph) {
+    return m_link.unlink(graph);
+}
+
+axclError msys::unlink(const std::vector<link_graph*>& graphs) {
+    return m_link.unlink(graphs);
+}
+
 }  // namespace axclite
\ No newline at end of file
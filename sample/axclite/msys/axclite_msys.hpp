@@ -28,6 +28,10 @@ public:
     axclError link(const AX_MOD_INFO_T& src, const AX_MOD_INFO_T& dst);
     axclError unlink(const AX_MOD_INFO_T& src, const AX_MOD_INFO_T& dst);
 
+    axclError link(link_graph& graph);
+    axclError unlink(link_graph& graph);
+    axclError unlink(const std::vector<link_graph*>& graphs);
+
 private:
     msys() = default;
 
@@ -201,6 +201,14 @@ axclError vdec::stop() {
     m_started = false;
     m_last_send_code = 0;
 
+    axcl::latency_histogram send_latency;
+    m_send_latency.interval(send_latency);
+    if (send_latency.count() > 0) {
+        LOG_MM_I(TAG, "vdGrp {} sent {} streams, latency us: p50 {:.1f}, p99 {:.1f}, p99.9 {:.1f}, max {:.1f}", m_grp, send_latency.count(),
+                 send_latency.percentile(50) / 1000.0, send_latency.percentile(99) / 1000.0, send_latency.percentile(99.9) / 1000.0,
+                 send_latency.max() / 1000.0);
+    }
+
     if (ret = reset_grp(MAX_VDEC_RESET_GRP_RETRY_COUNT); AXCL_SUCC != ret) {
         return ret;
     }
@@ -243,7 +251,10 @@ axclError vdec::send_stream(const AX_U8 *nalu, AX_U32 len, AX_U64 pts, AX_U64 us
     }
 
     LOG_MM_D(TAG, "AXCL_VDEC_SendStream(vdGrp {}, len {}, pts {}, timeout {}) +++", m_grp, len, pts, timeout);
-    m_last_send_code = AXCL_VDEC_SendStream(m_grp, &stream, timeout);
+    {
+        axcl::scoped_elapser timer(m_send_latency);
+        m_last_send_code = AXCL_VDEC_SendStream(m_grp, &stream, timeout);
+    }
     LOG_MM_D(TAG, "AXCL_VDEC_SendStream(vdGrp {}, len {}, pts {}, timeout {}) ---", m_grp, len, pts, timeout);
     if (0 != m_last_send_code) {
         if ((AX_ERR_VDEC_BUF_FULL == m_last_send_code) || (AX_ERR_VDEC_QUEUE_FULL == m_last_send_code)) {
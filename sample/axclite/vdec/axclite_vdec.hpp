@@ -15,6 +15,7 @@
 #include <mutex>
 #include "axclite.h"
 #include "axclite_sink.hpp"
+#include "elapser.hpp"
 
 namespace axclite {
 
@@ -49,6 +50,7 @@ private:
     axclite_vdec_attr m_attr;
     AX_VDEC_GRP m_grp = INVALID_VDGRP_ID;
     AX_S32 m_last_send_code = 0;
+    axcl::latency_recorder m_send_latency; /* AXCL_VDEC_SendStream, reported on stop() */
     std::atomic<bool> m_started = {false};
     std::mutex m_mtx_sink;
     std::list<sinker *> m_lst_sinks[AX_DEC_MAX_CHN_NUM];
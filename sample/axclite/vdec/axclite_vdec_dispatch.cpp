@@ -101,11 +101,14 @@ void vdec_dispatch::dispatch_thread(int32_t device) {
                     continue;
                 }
 
-                LOG_MM_I(TAG, "decoded vdGrp {} vdChn {} frame {} pts {} phy {:#x} {}x{} stride {} blkId {:#x}", grp, chn,
-                         frame.stVFrame.u64SeqNum, frame.stVFrame.u64PTS, frame.stVFrame.u64PhyAddr[0], frame.stVFrame.u32Width,
-                         frame.stVFrame.u32Height, frame.stVFrame.u32PicStride[0], frame.stVFrame.u32BlkId[0]);
+                LOG_MM_DEFER_I(TAG, "decoded vdGrp {} vdChn {} frame {} pts {} phy {:#x} {}x{} stride {} blkId {:#x}", grp, chn,
+                               frame.stVFrame.u64SeqNum, frame.stVFrame.u64PTS, frame.stVFrame.u64PhyAddr[0], frame.stVFrame.u32Width,
+                               frame.stVFrame.u32Height, frame.stVFrame.u32PicStride[0], frame.stVFrame.u32BlkId[0]);
 
+                frame_counter(grp, chn).inc();
+                const auto begin = std::chrono::steady_clock::now();
                 (void)dispatch_frame(grp, chn, frame);
+                m_dispatch_seconds.observe(std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count());
 
                 if (ret = AXCL_VDEC_ReleaseChnFrame(grp, chn, &frame); AXCL_SUCC != ret) {
                     LOG_MM_E(TAG, "AXCL_VDEC_ReleaseChnFrame(vdGrp {}, vdChn {}, blk {:#x}) fail, ret = {:#x}", grp, chn,
@@ -276,4 +279,14 @@ bool vdec_dispatch::dispatch_frame(AX_VDEC_GRP grp, AX_VDEC_CHN chn, const AX_VI
     return true;
 }
 
+axcl::metric_counter& vdec_dispatch::frame_counter(AX_VDEC_GRP grp, AX_VDEC_CHN chn) {
+    axcl::metric_counter*& counter = m_frame_counters[std::make_pair(grp, chn)];
+    if (!counter) {
+        counter = &axcl::metrics_registry::get_instance()->counter("axcl_vdec_frames_total", "frames decoded and dispatched",
+                                                                   {{"grp", std::to_string(grp)}, {"chn", std::to_string(chn)}});
+    }
+
+    return *counter;
+}
+
 }  // namespace axclite
\ No newline at end of file
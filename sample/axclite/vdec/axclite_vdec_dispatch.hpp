@@ -16,6 +16,7 @@
 #include <mutex>
 #include <unordered_map>
 #include "axclite.h"
+#include "metrics.hpp"
 #include "singleton.hpp"
 #include "threadx.hpp"
 
@@ -57,12 +58,19 @@ protected:
     bool dispatch_frame(AX_VDEC_GRP grp, AX_VDEC_CHN chn, const AX_VIDEO_FRAME_INFO_T& frame);
     void remove_sinks(AX_VDEC_GRP grp, AX_VDEC_CHN chn);
 
+    axcl::metric_counter& frame_counter(AX_VDEC_GRP grp, AX_VDEC_CHN chn);
+
 protected:
     axcl::threadx m_thread;
     std::atomic<bool> m_started = {false};
     std::condition_variable m_cv;
     std::mutex m_mtx;
     std::unordered_multimap<std::pair<AX_VDEC_GRP, AX_VDEC_CHN>, sinker*, pair_hash, pair_equal> m_map_sinks;
+
+    /* only touched by the dispatch thread */
+    std::unordered_map<std::pair<AX_VDEC_GRP, AX_VDEC_CHN>, axcl::metric_counter*, pair_hash, pair_equal> m_frame_counters;
+    axcl::metric_histogram& m_dispatch_seconds = axcl::metrics_registry::get_instance()->histogram(
+        "axcl_vdec_dispatch_seconds", "time of handing a decoded frame to its sinks", axcl::metric_histogram::latency_buckets());
 };
 
 }  // namespace axclite
\ No newline at end of file
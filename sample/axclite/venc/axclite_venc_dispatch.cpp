@@ -13,13 +13,20 @@
 #include <vector>
 #include "axclite_helper.hpp"
 #include "axclite_sink.hpp"
+#include "elapser.hpp"
 #include "log/logger.hpp"
 
 #define TAG "axclite-venc-dispatch"
 
 namespace axclite {
 
-venc_dispatch::venc_dispatch(VENC_CHN chn, AX_U32 max_stream_size) : m_chn(chn), m_max_stream_size(max_stream_size) {
+venc_dispatch::venc_dispatch(VENC_CHN chn, AX_U32 max_stream_size)
+    : m_chn(chn),
+      m_max_stream_size(max_stream_size),
+      m_streams(axcl::metrics_registry::get_instance()->counter("axcl_venc_streams_total", "streams encoded and dispatched",
+                                                                {{"chn", std::to_string(chn)}})),
+      m_stream_bytes(axcl::metrics_registry::get_instance()->counter("axcl_venc_stream_bytes_total", "bytes of streams encoded and dispatched",
+                                                                     {{"chn", std::to_string(chn)}})) {
 }
 
 void venc_dispatch::dispatch_thread(int32_t device) {
@@ -33,6 +40,9 @@ void venc_dispatch::dispatch_thread(int32_t device) {
     nalu.reserve(m_max_stream_size);
     bool dispatch = false;
 
+    /* drain: from a stream got to released, which is the copy to host */
+    axcl::latency_histogram drain_latency;
+
     while (m_thread.running()) {
         ret = AXCL_VENC_GetStream(m_chn, &packed, -1);
         if (AXCL_SUCC != ret) {
@@ -49,6 +59,7 @@ void venc_dispatch::dispatch_thread(int32_t device) {
             continue;
         }
 
+        axcl::elapser drain;
         if (packed.stPack.u32Len > m_max_stream_size) {
             LOG_MM_W(TAG, "stream size {} is small, reallo size {}", m_max_stream_size, packed.stPack.u32Len);
             nalu.resize(packed.stPack.u32Len);
@@ -70,11 +81,21 @@ void venc_dispatch::dispatch_thread(int32_t device) {
             continue;
         }
 
+        drain_latency.record(drain.cost(axcl::elapser::UNIT::nanoseconds));
+
         if (dispatch) {
+            m_streams.inc();
+            m_stream_bytes.inc(stream.stPack.u32Len);
             (void)dispatch_stream(stream);
         }
     }
 
+    if (drain_latency.count() > 0) {
+        LOG_MM_I(TAG, "veChn {} drained {} streams, latency us: p50 {}, p99 {}, p99.9 {}, max {}", m_chn, drain_latency.count(),
+                 drain_latency.percentile(50) / 1000, drain_latency.percentile(99) / 1000, drain_latency.percentile(99.9) / 1000,
+                 drain_latency.max() / 1000);
+    }
+
     LOG_MM_D(TAG, "veChn {} ---", m_chn);
 }
 
@@ -14,6 +14,7 @@
 #include <list>
 #include <mutex>
 #include "axclite_venc_type.h"
+#include "metrics.hpp"
 #include "threadx.hpp"
 
 namespace axclite {
@@ -42,5 +43,7 @@ protected:
     std::mutex m_mtx_sinks;
     axcl::threadx m_thread;
     std::atomic<bool> m_started = {false};
+    axcl::metric_counter& m_streams;
+    axcl::metric_counter& m_stream_bytes;
 };
 }  // namespace axclite
\ No newline at end of file
@@ -0,0 +1,269 @@
+/**************************************************************************************************
+ *
+ * Copyright (c) 2019-2024 Axera Semiconductor Co., Ltd. All Rights Reserved.
+ *
+ * This source file is the property of Axera Semiconductor Co., Ltd. and
+ * may not be copied or distributed in any isomorphic form without the prior
+ * written consent of Axera Semiconductor Co., Ltd.
+ *
+ **************************************************************************************************/
+
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "axcl.h"
+#include "axclite_downloader.hpp"
+#include "cmdline.h"
+#include "logger.h"
+
+static int32_t setup(const std::string &json, int32_t &device_id);
+static void cleanup(int32_t device_id);
+
+struct bench_result {
+    double total_ms = 0;
+    std::vector<double> costs;
+};
+
+static void report(const char *name, const bench_result &result, uint32_t visible_size) {
+    std::vector<double> costs = result.costs;
+    if (costs.empty()) {
+        return;
+    }
+
+    std::sort(costs.begin(), costs.end());
+    const double avg = result.total_ms / costs.size();
+    const double mbps = (static_cast<double>(visible_size) * costs.size()) / (result.total_ms * 1000.0);
+    SAMPLE_LOG_I("%-8s: %4ld frames, %8.2f MB/s, latency avg %.3f ms, min %.3f ms, p50 %.3f ms, p99 %.3f ms, max %.3f ms", name, costs.size(),
+                 mbps, avg, costs.front(), costs[costs.size() / 2], costs[costs.size() * 99 / 100], costs.back());
+}
+
+/**
+ * the pattern used by the samples today: alloc host memory per frame, copy the whole strided frame and remove
+ * the padding on CPU.
+ */
+static int32_t bench_adhoc(const AX_VIDEO_FRAME_T &frame, uint32_t count, bench_result &result) {
+    const uint32_t frame_size = frame.u32PicStride[0] * frame.u32Height * 3 / 2;
+    std::vector<uint8_t> nv12(frame.u32Width * frame.u32Height * 3 / 2);
+
+    auto begin = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < count; ++i) {
+        auto t0 = std::chrono::steady_clock::now();
+
+        void *host = nullptr;
+        if (axclError ret = axclrtMallocHost(&host, frame_size); AXCL_SUCC != ret) {
+            SAMPLE_LOG_E("axclrtMallocHost(size %d) fail, ret = 0x%x", frame_size, ret);
+            return ret;
+        }
+
+        if (axclError ret = axclrtMemcpy(host, reinterpret_cast<void *>(frame.u64PhyAddr[0]), frame_size, AXCL_MEMCPY_DEVICE_TO_HOST);
+            AXCL_SUCC != ret) {
+            SAMPLE_LOG_E("axclrtMemcpy(size %d) fail, ret = 0x%x", frame_size, ret);
+            axclrtFreeHost(host);
+            return ret;
+        }
+
+        const uint8_t *src = reinterpret_cast<const uint8_t *>(host);
+        uint8_t *dst = nv12.data();
+        for (uint32_t h = 0; h < frame.u32Height * 3 / 2; ++h) {
+            memcpy(dst, src, frame.u32Width);
+            dst += frame.u32Width;
+            src += frame.u32PicStride[0];
+        }
+
+        axclrtFreeHost(host);
+
+        result.costs.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count());
+    }
+
+    result.total_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+    return 0;
+}
+
+static int32_t bench_sync(const AX_VIDEO_FRAME_T &frame, uint32_t count, bench_result &result) {
+    axclite::downloader downloader;
+    axclite_download_attr attr = {};
+    attr.async = AX_FALSE;
+    if (axclError ret = downloader.init(attr); AXCL_SUCC != ret) {
+        return ret;
+    }
+
+    auto begin = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < count; ++i) {
+        auto t0 = std::chrono::steady_clock::now();
+
+        axclite_host_frame host;
+        if (axclError ret = downloader.download(frame, host); AXCL_SUCC != ret) {
+            downloader.deinit();
+            return ret;
+        }
+
+        downloader.release_frame(host);
+
+        result.costs.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count());
+    }
+
+    result.total_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+    downloader.deinit();
+    return 0;
+}
+
+/**
+ * double buffered: the background thread downloads frame N+1 while frame N is consumed.
+ * latency is measured from send_frame() to get_frame().
+ */
+static int32_t bench_async(int32_t device, const AX_VIDEO_FRAME_T &frame, uint32_t count, bench_result &result) {
+    axclite::downloader downloader;
+    axclite_download_attr attr = {};
+    attr.async = AX_TRUE;
+    attr.fifo_depth = 2;
+    if (axclError ret = downloader.init(attr); AXCL_SUCC != ret) {
+        return ret;
+    }
+
+    if (axclError ret = downloader.start(device); AXCL_SUCC != ret) {
+        downloader.deinit();
+        return ret;
+    }
+
+    std::vector<std::chrono::steady_clock::time_point> sends(count);
+    AX_VIDEO_FRAME_T input = frame;
+    uint32_t sent = 0;
+    uint32_t received = 0;
+
+    auto begin = std::chrono::steady_clock::now();
+    while (received < count) {
+        while (sent < count) {
+            input.u64SeqNum = sent;
+            sends[sent] = std::chrono::steady_clock::now();
+            if (AXCL_SUCC != downloader.send_frame(input)) {
+                break;
+            }
+
+            ++sent;
+        }
+
+        axclite_host_frame host;
+        if (AXCL_SUCC != downloader.get_frame(host, 1000)) {
+            SAMPLE_LOG_E("get downloaded frame timeout, sent %d received %d", sent, received);
+            break;
+        }
+
+        result.costs.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - sends[host.seq_num]).count());
+        downloader.release_frame(host);
+        ++received;
+    }
+
+    result.total_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+
+    downloader.stop();
+    downloader.deinit();
+    return 0;
+}
+
+int main(int argc, char *argv[]) {
+    SAMPLE_LOG_I("============== %s sample started %s %s ==============\n", AXCL_BUILD_VERSION, __DATE__, __TIME__);
+
+    cmdline::parser a;
+    a.add<int32_t>("device", 'd', "device id", false, 0);
+    a.add<std::string>("json", '\0', "axcl.json path", false, "./axcl.json");
+    a.add<uint32_t>("width", 'w', "frame width", false, 1920);
+    a.add<uint32_t>("height", 'h', "frame height", false, 1080);
+    a.add<uint32_t>("stride", 's', "frame stride, 0: align width to 256", false, 0);
+    a.add<uint32_t>("count", 'n', "download count", false, 200);
+    a.parse_check(argc, argv);
+    int32_t device_id = a.get<int32_t>("device");
+    const std::string json = a.get<std::string>("json");
+    const uint32_t width = a.get<uint32_t>("width");
+    const uint32_t height = a.get<uint32_t>("height");
+    const uint32_t count = a.get<uint32_t>("count");
+    uint32_t stride = a.get<uint32_t>("stride");
+    if (0 == stride) {
+        stride = AXCL_ALIGN_UP(width, 256);
+    }
+
+    if (stride < width || 0 == count) {
+        SAMPLE_LOG_E("invalid stride %d or count %d", stride, count);
+        return 1;
+    }
+
+    if (AXCL_SUCC != setup(json, device_id)) {
+        return 1;
+    }
+
+    const uint32_t frame_size = stride * height * 3 / 2;
+    const uint32_t visible_size = width * height * 3 / 2;
+    void *dev_mem = nullptr;
+    if (axclError ret = axclrtMalloc(&dev_mem, frame_size, AXCL_MEM_MALLOC_NORMAL_ONLY); AXCL_SUCC != ret) {
+        SAMPLE_LOG_E("alloc device memory size %d fail, ret = 0x%x", frame_size, ret);
+        cleanup(device_id);
+        return 1;
+    }
+
+    AX_VIDEO_FRAME_T frame;
+    memset(&frame, 0, sizeof(frame));
+    frame.u32Width = width;
+    frame.u32Height = height;
+    frame.enImgFormat = AX_FORMAT_YUV420_SEMIPLANAR;
+    frame.u32PicStride[0] = stride;
+    frame.u32PicStride[1] = stride;
+    frame.u64PhyAddr[0] = reinterpret_cast<AX_U64>(dev_mem);
+    frame.u64PhyAddr[1] = frame.u64PhyAddr[0] + stride * height;
+    frame.u32FrameSize = frame_size;
+    for (uint32_t i = 0; i < AX_MAX_COLOR_COMPONENT; ++i) {
+        frame.u32BlkId[i] = AX_INVALID_BLOCKID;
+    }
+
+    SAMPLE_LOG_I("NV12 %dx%d stride %d, frame size %d, visible size %d, count %d", width, height, stride, frame_size, visible_size, count);
+
+    bench_result adhoc, sync, async;
+    if (0 == bench_adhoc(frame, count, adhoc) && 0 == bench_sync(frame, count, sync) && 0 == bench_async(device_id, frame, count, async)) {
+        report("adhoc", adhoc, visible_size);
+        report("sync", sync, visible_size);
+        report("async", async, visible_size);
+    }
+
+    axclrtFree(dev_mem);
+    cleanup(device_id);
+
+    SAMPLE_LOG_I("============== %s sample exited %s %s ==============\n", AXCL_BUILD_VERSION, __DATE__, __TIME__);
+    return 0;
+}
+
+static int32_t setup(const std::string &json, int32_t &device_id) {
+    axclError ret;
+    SAMPLE_LOG_I("json: %s", json.c_str());
+    if (ret = axclInit(json.c_str()); AXCL_SUCC != ret) {
+        SAMPLE_LOG_E("axclInit(%s) fail, ret = 0x%x", json.c_str(), ret);
+        return ret;
+    }
+
+    if (device_id <= 0) {
+        axclrtDeviceList lst;
+        if (axclError ret = axclrtGetDeviceList(&lst); AXCL_SUCC != ret || 0 == lst.num) {
+            SAMPLE_LOG_E("no device is connected");
+            axclFinalize();
+            return ret;
+        }
+
+        device_id = lst.devices[0];
+        SAMPLE_LOG_I("device id: %d", device_id);
+    }
+
+    if (ret = axclrtSetDevice(device_id); AXCL_SUCC != ret) {
+        SAMPLE_LOG_E("axclrtSetDevice(%d) fail, ret = 0x%x", device_id, ret);
+        axclFinalize();
+        return ret;
+    }
+
+    return ret;
+}
+
+static void cleanup(int32_t device_id) {
+    axclrtResetDevice(device_id);
+    axclFinalize();
+    SAMPLE_LOG_I("deactive device %d and cleanup axcl", device_id);
+}
@@ -13,6 +13,8 @@
 #include <cmdline.h>
 #include <utilities/file.hpp>
 
+#include <sstream>
+
 #include "common/types.hpp"
 
 #if defined(ENV_CHIP_SERIES_MC50) || defined(ENV_AXCL_RUNTIME_API_ENABLE) || defined(ENV_AXCL_NATIVE_API_ENABLE)
@@ -42,6 +44,18 @@ constexpr char LIST_FILE_STR[] = "list";
 constexpr char CONFIG_PATH_STR[] = "config";
 constexpr char DEVICE_INDEX_STR[] = "device";
 constexpr char VERIFY_MODE_STR[] = "verify";
+constexpr char ASYNC_DEPTH_STR[] = "async";
+constexpr char THREADS_STR[] = "threads";
+constexpr char CONTEXTS_STR[] = "contexts";
+constexpr char AFFINITY_GROUPS_STR[] = "affinity-groups";
+constexpr char DURATION_STR[] = "duration";
+constexpr char REPORT_STR[] = "report";
+constexpr char DEVICES_STR[] = "devices";
+constexpr char DISPATCH_STR[] = "dispatch";
+constexpr char BATCHER_STR[] = "batcher";
+constexpr char SHARE_STR[] = "share";
+constexpr char BATCH_DELAY_STR[] = "batch-delay";
+constexpr char TRACE_STR[] = "trace";
 constexpr char CONFIG_FILE_DEFAULT[] = "/usr/local/axcl/axcl.json";
 
 #if defined(CONFIG_MC50)
@@ -94,6 +108,27 @@ struct config {
         cmd.add<int>("api", 'x', R"(api, 0="axcl runtime", 1="axcl native")", false, 0, cmdline::range(0, 1));
 #endif
 
+        cmd.add<int>(ASYNC_DEPTH_STR, 0, "in-flight IO sets of pipelined running (upload + run + download), compared with 1", false, 0, cmdline::range(0, 16));
+
+        cmd.add<int>(THREADS_STR, 0, "threads of throughput running against the loaded model, 0 disables throughput running", false, 0, cmdline::range(0, 32));
+        cmd.add<int>(CONTEXTS_STR, 0, "contexts (in-flight IO sets) of each throughput running thread", false, 1, cmdline::range(1, 16));
+#if defined(CONFIG_MC50) || defined(CONFIG_MC20E)
+        cmd.add<std::string>(AFFINITY_GROUPS_STR, 0, R"(npu affinity of throughput running threads, assigned round-robin, e.g. "1,2,4")", false);
+#endif
+        cmd.add<int>(DURATION_STR, 0, "seconds of throughput or dynamic batching running, 0 runs repeat times in total", false, 0, cmdline::range(0, INT32_MAX / 1000));
+
+#if defined(CONFIG_AXCL_API)
+        cmd.add<std::string>(DEVICES_STR, 0, R"(run on a group of devices, "all" or device indexes like "0,1", in-flight IO sets of each device follow --async (2 if not set))", false);
+        cmd.add<int>(DISPATCH_STR, 0, "how requests are dispatched to the group of devices, 0=round-robin, 1=least-queued", false, 1, cmdline::range(0, 1));
+        cmd.add<int>(SHARE_STR, 0, "more runners loading the model, which share the loaded model with axcl runtime api, reports load time and cmm saved", false, 0, cmdline::range(0, 64));
+#endif
+
+        cmd.add<int>(BATCHER_STR, 0, "producer threads of single requests packed by a dynamic batcher into batches of up to --batch items, 0 disables", false, 0, cmdline::range(0, 256));
+        cmd.add<int>(BATCH_DELAY_STR, 0, "microseconds a request waits at most for its batch to fill when dynamic batching", false, 2000, cmdline::range(0, INT32_MAX));
+
+        cmd.add<std::string>(REPORT_STR, 0, "write the latency percentiles of each stage (input, execute, output) to a JSON file, or CSV if named *.csv", false);
+        cmd.add<std::string>(TRACE_STR, 0, "write the latency of each stage of every running to a CSV file", false);
+
         cmd.add(VERIFY_MODE_STR, 0, "verify outputs after running model");
 
         cmd.parse_check(argc, argv);
@@ -145,6 +180,35 @@ struct config {
 #endif
 
         this->has_verify_mode_flag = cmd.exist(VERIFY_MODE_STR);
+
+        this->has_async_depth = cmd.exist(ASYNC_DEPTH_STR);
+        this->async_depth = cmd.get<int>(ASYNC_DEPTH_STR);
+
+        this->threads = cmd.get<int>(THREADS_STR);
+        this->has_contexts = cmd.exist(CONTEXTS_STR);
+        this->contexts = cmd.get<int>(CONTEXTS_STR);
+#if defined(CONFIG_MC50) || defined(CONFIG_MC20E)
+        this->has_affinity_groups = cmd.exist(AFFINITY_GROUPS_STR);
+        this->affinity_groups_string = cmd.get<std::string>(AFFINITY_GROUPS_STR);
+#endif
+        this->has_duration = cmd.exist(DURATION_STR);
+        this->duration = cmd.get<int>(DURATION_STR);
+
+#if defined(CONFIG_AXCL_API)
+        this->has_devices = cmd.exist(DEVICES_STR);
+        this->devices_string = cmd.get<std::string>(DEVICES_STR);
+        this->dispatch = cmd.get<int>(DISPATCH_STR);
+        this->share = cmd.get<int>(SHARE_STR);
+#endif
+
+        this->batcher = cmd.get<int>(BATCHER_STR);
+        this->has_batch_delay = cmd.exist(BATCH_DELAY_STR);
+        this->batch_delay = cmd.get<int>(BATCH_DELAY_STR);
+
+        this->has_report_file = cmd.exist(REPORT_STR);
+        this->report_file = cmd.get<std::string>(REPORT_STR);
+        this->has_trace_file = cmd.exist(TRACE_STR);
+        this->trace_file = cmd.get<std::string>(TRACE_STR);
     }
 
     [[nodiscard]] bool check() {
@@ -219,6 +283,75 @@ struct config {
             fflush(stderr);
         }
 
+        if (this->feed_mode && this->has_async_depth) {
+            fprintf(stderr, "[WARNING] Option { --%s } will be ignored when feeding data.\n", ASYNC_DEPTH_STR);
+            fflush(stderr);
+        }
+
+#if defined(CONFIG_MC50) || defined(CONFIG_MC20E)
+        if (this->has_affinity_groups) {
+            std::stringstream ss(this->affinity_groups_string);
+            for (std::string item; std::getline(ss, item, ',');) {
+                const auto group = std::strtol(item.c_str(), nullptr, 0);
+                if (group < 1 || group > AFFINITY_MAX) {
+                    fprintf(stderr, "[ERROR] Affinity group { %s } of option { --%s } is out of range { 1 ~ %d }.\n",
+                            item.c_str(), AFFINITY_GROUPS_STR, AFFINITY_MAX);
+                    return false;
+                }
+                this->affinity_groups.push_back(static_cast<uint32_t>(group));
+            }
+        }
+#endif
+
+        if (this->has_devices && "all" != this->devices_string) {
+            std::stringstream ss(this->devices_string);
+            for (std::string item; std::getline(ss, item, ',');) {
+                char* end = nullptr;
+                const auto index = std::strtol(item.c_str(), &end, 10);
+                if (item.empty() || '\0' != *end || index < 0 || index >= 32) {
+                    fprintf(stderr, "[ERROR] Device { %s } of option { --%s } is not \"all\" or a device index.\n", item.c_str(), DEVICES_STR);
+                    return false;
+                }
+                this->devices.push_back(static_cast<uint32_t>(index));
+            }
+            if (this->devices.empty()) {
+                fprintf(stderr, "[ERROR] Option { --%s } has no device.\n", DEVICES_STR);
+                return false;
+            }
+        }
+
+        if (this->has_devices && (this->feed_mode || 0 < this->threads || this->has_device_index)) {
+            fprintf(stderr, "[WARNING] Options { --%s, --%s, --%s } will be ignored when running on a group of devices.\n",
+                    INPUT_FOLDER_STR, THREADS_STR, DEVICE_INDEX_STR);
+            fflush(stderr);
+        }
+
+        if (0 == this->threads && (this->has_contexts || this->has_affinity_groups || (this->has_duration && 0 == this->batcher))) {
+            fprintf(stderr, "[WARNING] Options { --%s, --%s, --%s } will be ignored without option { --%s }.\n",
+                    CONTEXTS_STR, AFFINITY_GROUPS_STR, DURATION_STR, THREADS_STR);
+            fflush(stderr);
+        }
+
+        if (0 == this->batcher && this->has_batch_delay) {
+            fprintf(stderr, "[WARNING] Option { --%s } will be ignored without option { --%s }.\n", BATCH_DELAY_STR, BATCHER_STR);
+            fflush(stderr);
+        }
+
+        if (0 < this->share && 0 != this->api) {
+            fprintf(stderr, "[WARNING] Option { --%s } will be ignored without axcl runtime api.\n", SHARE_STR);
+            fflush(stderr);
+        }
+
+        if (this->feed_mode && 0 < this->batcher) {
+            fprintf(stderr, "[WARNING] Option { --%s } will be ignored when feeding data.\n", BATCHER_STR);
+            fflush(stderr);
+        }
+
+        if (this->feed_mode && 0 < this->threads) {
+            fprintf(stderr, "[WARNING] Option { --%s } will be ignored when feeding data.\n", THREADS_STR);
+            fflush(stderr);
+        }
+
         if (!this->feed_mode) {
             if (this->has_verify_mode_flag) {
                 fprintf(
@@ -288,6 +421,33 @@ struct config {
 
     bool has_verify_mode_flag = false;
 
+    bool has_async_depth = false;
+    uint32_t async_depth = 0;
+
+    uint32_t threads = 0;
+    bool has_contexts = false;
+    uint32_t contexts = 1;
+    bool has_affinity_groups = false;
+    std::string affinity_groups_string;
+    std::vector<uint32_t> affinity_groups;
+    bool has_duration = false;
+    uint32_t duration = 0;
+
+    bool has_devices = false;
+    std::string devices_string;
+    std::vector<uint32_t> devices;
+    uint32_t dispatch = 1;
+    uint32_t share = 0;
+
+    uint32_t batcher = 0;
+    bool has_batch_delay = false;
+    uint32_t batch_delay = 2000;
+
+    bool has_report_file = false;
+    std::string report_file;
+    bool has_trace_file = false;
+    std::string trace_file;
+
     bool has_config_file = false;
     std::string config_file;
     bool has_device_index = false;
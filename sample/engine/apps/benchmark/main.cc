@@ -10,6 +10,7 @@
 
 #include "main.hpp"
 #include "config.hpp"
+#include "report.hpp"
 
 #include "version.hpp"
 #include "utilities/timer.hpp"
@@ -26,6 +27,52 @@
 
 #include <memory>
 
+#if defined(CONFIG_AXCL_API)
+static int run_device_group(const common::config& cfg) {
+    middleware::device_group group([&cfg]() -> std::unique_ptr<middleware::runner> {
+        if (1 == cfg.api) {
+            return std::make_unique<middleware::native_runner>();
+        }
+        return std::make_unique<middleware::runtime_runner>();
+    });
+
+    if (!group.init(cfg.config_file, cfg.devices, cfg.vnpu_mode)) {
+        fprintf(stderr, "[ERROR] Init device group failed.\n");
+        return -1;
+    }
+
+    if (!group.load(cfg.model_path)) {
+        fprintf(stderr, "[ERROR] Loading model {%s} on device group failed.\n", cfg.model_path.c_str());
+        return -1;
+    }
+
+    const uint32_t depth = cfg.has_async_depth ? std::max(cfg.async_depth, 1u) : 2;
+    if (!group.prepare(cfg.group, cfg.batch, depth, cfg.parallel_mode)) {
+        fprintf(stderr, "[ERROR] Prepare for model {%s} on device group failed.\n", cfg.model_path.c_str());
+        return -1;
+    }
+
+    auto& first = group.get_runner(0);
+    fprintf(stdout, "   Run AxModel:\n");
+    fprintf(stdout, "         model: %s\n", cfg.model_path.c_str());
+    fprintf(stdout, "          type: %s\n", common::get_model_type_string(first.get_model_type()).c_str());
+    fprintf(stdout, "       devices: %d\n", group.get_device_count());
+    fprintf(stdout, "   async depth: %d\n", depth);
+    if (0 != cfg.duration) {
+        fprintf(stdout, "      duration: %ds\n", cfg.duration);
+    } else {
+        fprintf(stdout, "        repeat: %d\n", cfg.repeat_count);
+    }
+    fprintf(stdout, "         batch: %d\n", first.get_batch_size());
+    fprintf(stdout, "    axclrt ver: %s\n", first.get_library_version().c_str());
+    fprintf(stdout, "   pulsar2 ver: %s\n", first.get_model_version().c_str());
+    fprintf(stdout, "      tool ver: %s\n", VERSION_STRING);
+    fflush(stdout);
+
+    return display_device_group(group, static_cast<middleware::device_group::policy>(cfg.dispatch), cfg.duration * 1000, cfg.repeat_count);
+}
+#endif
+
 int main(const int argc, char* argv[])
 {
     common::config cfg(argc, argv);
@@ -33,6 +80,12 @@ int main(const int argc, char* argv[])
         return -1;
     }
 
+#if defined(CONFIG_AXCL_API)
+    if (cfg.has_devices) {
+        return run_device_group(cfg);
+    }
+#endif
+
     std::unique_ptr<middleware::runner> runner;
 
 #if defined(CONFIG_AXCL_API)
@@ -76,7 +129,50 @@ int main(const int argc, char* argv[])
     std::vector<float> elapsed_times;
     float cost_min = 0.f, cost_max = 0.f, cost_average = 0.f;
 
-    auto run = [&runner, &cfg, &elapsed_times]() {
+    common::report report;
+    report.model = cfg.model_path;
+    report.library_version = runner->get_library_version();
+    report.model_version = runner->get_model_version();
+    report.tool_version = VERSION_STRING;
+    report.batch = runner->get_batch_size();
+    report.tracing = cfg.has_trace_file;
+
+    // without feeding, the input and output stages also copy between host and the model tensors;
+    // when feeding, the tensors hold the stimulus, so these stages only flush and invalidate
+    std::vector<std::vector<uint8_t>> host_inputs, host_outputs;
+    if (!cfg.feed_mode) {
+        host_inputs.resize(runner->get_input_count());
+        host_outputs.resize(runner->get_output_count());
+        for (uint32_t i = 0; i < host_inputs.size(); i++) {
+            host_inputs[i].resize(runner->get_input_size(i) * runner->get_batch_size());
+        }
+        for (uint32_t i = 0; i < host_outputs.size(); i++) {
+            host_outputs[i].resize(runner->get_output_size(i) * runner->get_batch_size());
+        }
+    }
+
+    auto input = [&runner, &host_inputs]() {
+        for (uint32_t i = 0; i < host_inputs.size(); i++) {
+            if (!runner->upload(0, i, host_inputs[i].data(), host_inputs[i].size())) {
+                return false;
+            }
+        }
+        return runner->flush_input();
+    };
+
+    auto output = [&runner, &host_outputs]() {
+        if (!runner->invalidate_output()) {
+            return false;
+        }
+        for (uint32_t i = 0; i < host_outputs.size(); i++) {
+            if (!runner->download(0, i, host_outputs[i].data(), host_outputs[i].size())) {
+                return false;
+            }
+        }
+        return true;
+    };
+
+    auto run = [&runner, &cfg, &elapsed_times, &report, &input, &output]() {
         for (uint32_t i = 0; i < cfg.warmup_count; i++) {
             if (!runner->run(cfg.parallel_mode)) {
                 fprintf(stderr, "[ERROR] Warmup model {%s} failed.\n", cfg.model_path.c_str());
@@ -87,7 +183,17 @@ int main(const int argc, char* argv[])
             }
         }
         for (uint32_t i = 0; i < cfg.repeat_count; i++) {
+            std::array<uint64_t, common::STAGE_COUNT> costs{};
+
             utilities::timer timer;
+            if (!input()) {
+                fprintf(stderr, "[ERROR] Prepare input of model {%s} failed.\n", cfg.model_path.c_str());
+                return -1;
+            }
+            timer.stop();
+            costs[common::STAGE_INPUT] = static_cast<uint64_t>(timer.elapsed<utilities::timer::nanoseconds>());
+
+            timer.start();
             const auto flag = runner->run(cfg.parallel_mode);
             timer.stop();
             if (!flag) {
@@ -95,6 +201,17 @@ int main(const int argc, char* argv[])
                 return -1;
             }
             elapsed_times.push_back(timer.elapsed<utilities::timer::milliseconds>());
+            costs[common::STAGE_EXECUTE] = static_cast<uint64_t>(timer.elapsed<utilities::timer::nanoseconds>());
+
+            timer.start();
+            if (!output()) {
+                fprintf(stderr, "[ERROR] Get output of model {%s} failed.\n", cfg.model_path.c_str());
+                return -1;
+            }
+            timer.stop();
+            costs[common::STAGE_OUTPUT] = static_cast<uint64_t>(timer.elapsed<utilities::timer::nanoseconds>());
+
+            report.record(costs);
             if (cfg.has_sleep_times) {
                 runner->sleep_for(cfg.sleep_times);
             }
@@ -102,6 +219,16 @@ int main(const int argc, char* argv[])
         return 0;
     };
 
+    auto write = [&cfg, &report]() {
+        if (cfg.has_report_file && !common::write_report(cfg.report_file, report)) {
+            return -1;
+        }
+        if (cfg.has_trace_file && !common::write_trace(cfg.trace_file, report)) {
+            return -1;
+        }
+        return 0;
+    };
+
     if (!cfg.feed_mode) {
         fprintf(stdout, "   Run AxModel:\n");
         fprintf(stdout, "         model: %s\n", cfg.model_path.c_str());
@@ -112,6 +239,15 @@ int main(const int argc, char* argv[])
         if (cfg.has_sleep_times) {
             fprintf(stdout, "         sleep: %dms\n", cfg.sleep_times);
         }
+        if (1 < cfg.async_depth) {
+            fprintf(stdout, "   async depth: %d\n", cfg.async_depth);
+        }
+        if (0 < cfg.threads) {
+            fprintf(stdout, "    throughput: %d threads x %d contexts\n", cfg.threads, cfg.contexts);
+        }
+        if (0 < cfg.batcher) {
+            fprintf(stdout, "       batcher: %d producers, max delay %dus\n", cfg.batcher, cfg.batch_delay);
+        }
         if (0 == cfg.batch) {
             fprintf(stdout, "         batch: { auto: %d }\n", runner->get_batch_size());
         }
@@ -133,6 +269,39 @@ int main(const int argc, char* argv[])
             return ret;
         }
         display_costs(elapsed_times, cost_min, cost_max, cost_average);
+        common::display_stages(report);
+        if (const auto ret = write(); 0 != ret) {
+            return ret;
+        }
+
+        if (1 < cfg.async_depth) {
+            if (const auto ret = display_pipelined(*runner, cfg.async_depth, cfg.repeat_count, cfg.parallel_mode); 0 != ret) {
+                return ret;
+            }
+        }
+
+        if (0 < cfg.threads) {
+            if (const auto ret = display_throughput(*runner, cfg.threads, cfg.contexts, cfg.affinity_groups, cfg.duration * 1000,
+                                                    cfg.repeat_count, cfg.parallel_mode); 0 != ret) {
+                return ret;
+            }
+        }
+
+#if defined(CONFIG_AXCL_API)
+        if (0 < cfg.share && 0 == cfg.api) {
+            if (const auto ret = display_model_cache(cfg.config_file, cfg.device_index, cfg.vnpu_mode, cfg.model_path, cfg.share); 0 != ret) {
+                return ret;
+            }
+        }
+#endif
+
+        if (0 < cfg.batcher) {
+            const uint32_t depth = cfg.has_async_depth ? std::max(cfg.async_depth, 1u) : 2;
+            if (const auto ret = display_batcher(*runner, cfg.batcher, cfg.batch_delay, depth, cfg.duration * 1000,
+                                                 cfg.repeat_count, cfg.parallel_mode); 0 != ret) {
+                return ret;
+            }
+        }
     }
     else {
         bool verified = false, saved = false;
@@ -165,6 +334,10 @@ int main(const int argc, char* argv[])
 
         if (!elapsed_times.empty()) {
             display_costs(elapsed_times, cost_min, cost_max, cost_average);
+            common::display_stages(report);
+        }
+        if (const auto ret = write(); 0 != ret) {
+            return ret;
         }
 
         if (cfg.has_verify_mode_flag && !verified) {
@@ -12,7 +12,21 @@
 
 #include <cstdio>
 #include <algorithm>
+#include <atomic>
 #include <numeric>
+#include <thread>
+
+#include "middleware/runner.hpp"
+#include "middleware/batcher.hpp"
+#if defined(ENV_AXCL_RUNTIME_API_ENABLE) || defined(ENV_AXCL_NATIVE_API_ENABLE)
+#include "middleware/axcl_device_group.hpp"
+#endif
+#if defined(ENV_AXCL_RUNTIME_API_ENABLE)
+#include "middleware/axcl_runtime_runner.hpp"
+#include "middleware/axcl_model_cache.hpp"
+#endif
+#include "utilities/histogram.hpp"
+#include "utilities/timer.hpp"
 
 inline void display_costs(std::vector<float>& elapsed_times, float& cost_min, float& cost_max, float& cost_average) {
     if (100 <= elapsed_times.size()) {
@@ -43,3 +57,443 @@ inline void display_costs(std::vector<float>& elapsed_times, float& cost_min, fl
         fprintf(stdout, "  ------------------------------------------------------\n\n");
     }
 }
+
+// upload inputs, run and download outputs 'count' times with 'depth' IO sets in flight, returns inferences per second
+inline float run_pipelined(middleware::runner& runner, const uint32_t& depth, const uint32_t& count, const bool& parallel) {
+    if (!runner.prepare_async(depth)) {
+        return -1.f;
+    }
+
+    const auto batch = static_cast<uintmax_t>(runner.get_batch_size());
+    std::vector<std::vector<uint8_t>> inputs(runner.get_input_count());
+    std::vector<std::vector<uint8_t>> outputs(runner.get_output_count());
+    for (uint32_t i = 0; i < inputs.size(); i++) {
+        inputs[i].resize(runner.get_input_size(i) * batch);
+    }
+    for (uint32_t i = 0; i < outputs.size(); i++) {
+        outputs[i].resize(runner.get_output_size(i) * batch);
+    }
+
+    utilities::timer timer;
+    for (uint32_t i = 0; i < count + depth; i++) {
+        const uint32_t slot = i % depth;
+
+        // collect the running submitted 'depth' times before
+        if (i >= depth) {
+            if (!runner.wait(slot)) {
+                return -1.f;
+            }
+            for (uint32_t j = 0; j < outputs.size(); j++) {
+                if (!runner.download(slot, j, outputs[j].data(), outputs[j].size())) {
+                    return -1.f;
+                }
+            }
+        }
+
+        if (i < count) {
+            for (uint32_t j = 0; j < inputs.size(); j++) {
+                if (!runner.upload(slot, j, inputs[j].data(), inputs[j].size())) {
+                    return -1.f;
+                }
+            }
+            if (!runner.submit(slot, parallel)) {
+                return -1.f;
+            }
+        }
+    }
+    timer.stop();
+
+    return static_cast<float>(count) * 1000.f / timer.elapsed<utilities::timer::milliseconds>();
+}
+
+inline int display_pipelined(middleware::runner& runner, const uint32_t& depth, const uint32_t& count, const bool& parallel) {
+    const float serial = run_pipelined(runner, 1, count, parallel);
+    if (serial <= 0.f) {
+        fprintf(stderr, "[ERROR] Pipelined running with depth {1} failed.\n");
+        return -1;
+    }
+
+    const float pipelined = run_pipelined(runner, depth, count, parallel);
+    if (pipelined <= 0.f) {
+        fprintf(stderr, "[ERROR] Pipelined running with depth {%d} failed.\n", depth);
+        return -1;
+    }
+
+    fprintf(stdout, "  pipelined (upload + run + download) %d times:\n", count);
+    fprintf(stdout, "  ------------------------------------------------------\n");
+    fprintf(stdout, "  depth = %2d   %9.2f inferences/s\n", 1, serial);
+    fprintf(stdout, "  depth = %2d   %9.2f inferences/s   gain = %5.2fx\n", depth, pipelined, pipelined / serial);
+    fprintf(stdout, "  ------------------------------------------------------\n\n");
+    fflush(stdout);
+
+    return 0;
+}
+
+struct throughput_result {
+    float seconds = 0.f;
+    std::vector<uint64_t> counts;       // finished inferences of each thread
+    std::vector<intmax_t> utilization;  // NPU utilization sampled during running, in percent
+};
+
+// run 'threads' threads, each keeps its own 'contexts' slots in flight; the slots of thread t take the NPU affinity
+// groups[t % groups.size()]; stops after 'duration' ms, or after 'count' inferences in total if 'duration' is 0
+inline bool run_throughput(middleware::runner& runner, const uint32_t& threads, const uint32_t& contexts, const std::vector<uint32_t>& groups,
+                           const uint32_t& duration, const uint32_t& count, const bool& parallel, throughput_result& result) {
+    std::vector<uint32_t> affinities;
+    if (!groups.empty()) {
+        for (uint32_t t = 0; t < threads; t++) {
+            affinities.insert(affinities.end(), contexts, groups[t % groups.size()]);
+        }
+    }
+
+    if (!runner.prepare_affinity(threads * contexts, affinities)) {
+        return false;
+    }
+
+    const auto batch = static_cast<uintmax_t>(runner.get_batch_size());
+    std::vector<uintmax_t> input_sizes(runner.get_input_count()), output_sizes(runner.get_output_count());
+    for (uint32_t i = 0; i < input_sizes.size(); i++) {
+        input_sizes[i] = runner.get_input_size(i) * batch;
+    }
+    for (uint32_t i = 0; i < output_sizes.size(); i++) {
+        output_sizes[i] = runner.get_output_size(i) * batch;
+    }
+
+    std::atomic<bool> stop{false}, failed{false};
+    std::atomic<uint32_t> tickets{0}, finished{0};
+    result.counts.assign(threads, 0);
+    result.utilization.clear();
+
+    auto work = [&](const uint32_t& t) {
+        std::vector<std::vector<uint8_t>> inputs(input_sizes.size()), outputs(output_sizes.size());
+        for (uint32_t i = 0; i < inputs.size(); i++) {
+            inputs[i].resize(input_sizes[i]);
+        }
+        for (uint32_t i = 0; i < outputs.size(); i++) {
+            outputs[i].resize(output_sizes[i]);
+        }
+
+        // in count mode every submitting takes a ticket, so the total of all threads is exactly 'count'
+        auto next = [&]() {
+            return !stop.load(std::memory_order_relaxed) && (0 != duration || tickets.fetch_add(1) < count);
+        };
+        auto submit = [&](const uint32_t& slot) {
+            for (uint32_t j = 0; j < inputs.size(); j++) {
+                if (!runner.upload(slot, j, inputs[j].data(), inputs[j].size())) {
+                    return false;
+                }
+            }
+            return runner.submit(slot, parallel);
+        };
+        auto collect = [&](const uint32_t& slot) {
+            if (!runner.wait(slot)) {
+                return false;
+            }
+            for (uint32_t j = 0; j < outputs.size(); j++) {
+                if (!runner.download(slot, j, outputs[j].data(), outputs[j].size())) {
+                    return false;
+                }
+            }
+            return true;
+        };
+
+        auto flag = runner.attach_thread();
+        std::vector<bool> pending(contexts, false);
+        for (uint32_t c = 0; flag && c < contexts && next(); c++) {
+            flag = submit(t * contexts + c);
+            pending[c] = flag;
+        }
+
+        // collect the slots round-robin, submit again on the slot just collected
+        for (uint32_t c = 0; flag && std::find(pending.begin(), pending.end(), true) != pending.end(); c = (c + 1) % contexts) {
+            if (!pending[c]) {
+                continue;
+            }
+            pending[c] = false;
+            if (flag = collect(t * contexts + c); !flag) {
+                break;
+            }
+            result.counts[t]++;
+            if (next()) {
+                flag = submit(t * contexts + c);
+                pending[c] = flag;
+            }
+        }
+
+        if (!flag) {
+            failed = true;
+            stop = true;
+            for (uint32_t c = 0; c < contexts; c++) {
+                std::ignore = runner.wait(t * contexts + c);
+            }
+        }
+        finished++;
+    };
+
+    std::ignore = runner.get_npu_utilization();
+
+    utilities::timer timer;
+    std::vector<std::thread> workers;
+    for (uint32_t t = 0; t < threads; t++) {
+        workers.emplace_back(work, t);
+    }
+
+    while (finished.load() < threads) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(200));
+        if (const auto utilization = runner.get_npu_utilization(); 0 <= utilization) {
+            result.utilization.push_back(utilization);
+        }
+
+        timer.stop();
+        if (0 != duration && timer.elapsed<utilities::timer::milliseconds>() >= static_cast<float>(duration)) {
+            stop = true;
+        }
+    }
+
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    timer.stop();
+    result.seconds = timer.elapsed<utilities::timer::milliseconds>() / 1000.f;
+
+    return !failed.load();
+}
+
+inline int display_throughput(middleware::runner& runner, const uint32_t& threads, const uint32_t& contexts, const std::vector<uint32_t>& groups,
+                              const uint32_t& duration, const uint32_t& count, const bool& parallel) {
+    throughput_result result;
+    if (!run_throughput(runner, threads, contexts, groups, duration, count, parallel, result)) {
+        fprintf(stderr, "[ERROR] Throughput running with {%d threads x %d contexts} failed.\n", threads, contexts);
+        return -1;
+    }
+
+    const auto batch = static_cast<float>(runner.get_batch_size());
+    const auto total = std::accumulate(result.counts.begin(), result.counts.end(), uint64_t{0});
+
+    fprintf(stdout, "  throughput (upload + run + download) %d threads x %d contexts, %.2fs:\n", threads, contexts, result.seconds);
+    fprintf(stdout, "  ------------------------------------------------------\n");
+    for (uint32_t t = 0; t < threads; t++) {
+        fprintf(stdout, "  thread %2d   affinity = 0x%X   %9.2f fps\n", t, groups.empty() ? 0 : groups[t % groups.size()],
+                static_cast<float>(result.counts[t]) * batch / result.seconds);
+    }
+    fprintf(stdout, "  ------------------------------------------------------\n");
+    fprintf(stdout, "  total       %9lu inferences   %9.2f fps\n", total, static_cast<float>(total) * batch / result.seconds);
+    if (!result.utilization.empty()) {
+        auto [fst, snd] = std::minmax_element(result.utilization.begin(), result.utilization.end());
+        const auto average = static_cast<float>(std::accumulate(result.utilization.begin(), result.utilization.end(), intmax_t{0}))
+            / static_cast<float>(result.utilization.size());
+        fprintf(stdout, "  npu usage   min = %3ld%%   max = %3ld%%   avg = %5.1f%%\n", *fst, *snd, average);
+    }
+    fprintf(stdout, "  ------------------------------------------------------\n\n");
+    fflush(stdout);
+
+    return 0;
+}
+
+// 'producers' threads each issue single requests to a dynamic batcher of up to get_batch_size() items, and wait the result;
+// stops after 'duration' ms, or after 'count' requests in total if 'duration' is 0
+inline int display_batcher(middleware::runner& runner, const uint32_t& producers, const uint32_t& delay, const uint32_t& depth,
+                           const uint32_t& duration, const uint32_t& count, const bool& parallel) {
+    middleware::batcher batcher(runner);
+    middleware::batcher::config config;
+    config.max_delay_us = delay;
+    config.depth = depth;
+    config.parallel = parallel;
+    if (!batcher.start(config)) {
+        fprintf(stderr, "[ERROR] Start dynamic batcher failed.\n");
+        return -1;
+    }
+
+    std::vector<std::vector<uint8_t>> inputs(runner.get_input_count());
+    std::vector<const void*> pointers(inputs.size());
+    for (uint32_t i = 0; i < inputs.size(); i++) {
+        inputs[i].resize(runner.get_input_size(i));
+        pointers[i] = inputs[i].data();
+    }
+
+    std::atomic<uint64_t> tickets{0};
+    std::atomic<bool> stop{false}, failed{false};
+    std::vector<utilities::histogram> latencies(producers);
+
+    utilities::timer timer;
+    std::vector<std::thread> workers;
+    for (uint32_t t = 0; t < producers; t++) {
+        workers.emplace_back([&, t]() {
+            while (!stop.load(std::memory_order_relaxed) && (0 != duration || tickets.fetch_add(1) < count)) {
+                utilities::timer request;
+                auto future = batcher.infer(pointers);
+                if (!future.valid() || !future.get().ok) {
+                    failed = true;
+                    stop = true;
+                    return;
+                }
+                request.stop();
+                latencies[t].record(static_cast<uint64_t>(request.elapsed<utilities::timer::microseconds>()));
+            }
+        });
+    }
+    if (0 != duration) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(duration));
+        stop = true;
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    timer.stop();
+
+    if (!batcher.stop() || failed.load()) {
+        fprintf(stderr, "[ERROR] Dynamic batching with {%d producers} failed.\n", producers);
+        return -1;
+    }
+
+    utilities::histogram latency;
+    for (const auto& h : latencies) {
+        latency.merge(h);
+    }
+
+    const float seconds = timer.elapsed<utilities::timer::milliseconds>() / 1000.f;
+    const auto batches = batcher.get_batch_count();
+    const auto requests = batcher.get_request_count();
+
+    fprintf(stdout, "  dynamic batching %d producers, max batch = %d, max delay = %dus, %.2fs:\n", producers, runner.get_batch_size(), delay, seconds);
+    fprintf(stdout, "  ------------------------------------------------------\n");
+    fprintf(stdout, "  requests    %9lu   %9.2f requests/s\n", requests, static_cast<float>(requests) / seconds);
+    fprintf(stdout, "  batches     %9lu   avg batch = %5.2f\n", batches, 0 == batches ? 0.f : static_cast<float>(requests) / static_cast<float>(batches));
+    fprintf(stdout, "  latency     p50 = %.3fms   p99 = %.3fms   max = %.3fms\n", static_cast<float>(latency.percentile(50.)) / 1000.f,
+            static_cast<float>(latency.percentile(99.)) / 1000.f, static_cast<float>(latency.max()) / 1000.f);
+    fprintf(stdout, "  ------------------------------------------------------\n\n");
+    fflush(stdout);
+
+    return 0;
+}
+
+#if defined(ENV_AXCL_RUNTIME_API_ENABLE) || defined(ENV_AXCL_NATIVE_API_ENABLE)
+// dispatch 'count' requests, or requests for 'duration' ms if it is not 0, to the group of devices
+inline int display_device_group(middleware::device_group& group, const middleware::device_group::policy& how,
+                                const uint32_t& duration, const uint32_t& count) {
+    auto& first = group.get_runner(0);
+    const auto batch = static_cast<uintmax_t>(first.get_batch_size());
+    std::vector<std::vector<uint8_t>> inputs(first.get_input_count());
+    std::vector<const void*> pointers(inputs.size());
+    for (uint32_t i = 0; i < inputs.size(); i++) {
+        inputs[i].resize(first.get_input_size(i) * batch);
+        pointers[i] = inputs[i].data();
+    }
+
+    // NPU utilization of each device, sampled while running
+    std::atomic<bool> stop{false};
+    std::vector<std::vector<intmax_t>> utilization(group.get_device_count());
+    std::thread sampler([&]() {
+        std::ignore = first.attach_thread();
+        for (uint32_t d = 0; d < group.get_device_count(); d++) {
+            std::ignore = group.get_runner(d).get_npu_utilization();
+        }
+        while (!stop.load()) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(200));
+            for (uint32_t d = 0; d < group.get_device_count(); d++) {
+                if (const auto value = group.get_runner(d).get_npu_utilization(); 0 <= value) {
+                    utilization[d].push_back(value);
+                }
+            }
+        }
+    });
+
+    auto flag = true;
+    utilities::timer timer;
+    for (uint32_t i = 0; flag; i++) {
+        if (0 == duration && i >= count) {
+            break;
+        }
+        if (0 != duration && 0 == (i & 0xF)) {
+            timer.stop();
+            if (timer.elapsed<utilities::timer::milliseconds>() >= static_cast<float>(duration)) {
+                break;
+            }
+        }
+        flag = group.dispatch(pointers, {}, how, nullptr);
+    }
+    group.drain();
+    timer.stop();
+
+    stop = true;
+    sampler.join();
+
+    if (!flag) {
+        fprintf(stderr, "[ERROR] Dispatch to the group of devices failed.\n");
+        return -1;
+    }
+
+    const float seconds = timer.elapsed<utilities::timer::milliseconds>() / 1000.f;
+    uint64_t total = 0, failed = 0;
+
+    fprintf(stdout, "  %d devices (upload + run + download), %s, %.2fs:\n", group.get_device_count(),
+            middleware::device_group::policy::least_queued == how ? "least-queued" : "round-robin", seconds);
+    fprintf(stdout, "  ------------------------------------------------------\n");
+    for (uint32_t d = 0; d < group.get_device_count(); d++) {
+        const auto done = group.get_done_count(d);
+        total += done;
+        failed += group.get_failed_count(d);
+
+        fprintf(stdout, "  device %2d   %9lu inferences   %9.2f fps", group.get_device_index(d), done,
+                static_cast<float>(done * batch) / seconds);
+        if (!utilization[d].empty()) {
+            const auto average = static_cast<float>(std::accumulate(utilization[d].begin(), utilization[d].end(), intmax_t{0}))
+                / static_cast<float>(utilization[d].size());
+            fprintf(stdout, "   npu %5.1f%%", average);
+        }
+        fprintf(stdout, "\n");
+    }
+    fprintf(stdout, "  ------------------------------------------------------\n");
+    fprintf(stdout, "  total       %9lu inferences   %9.2f fps\n", total, static_cast<float>(total * batch) / seconds);
+    fprintf(stdout, "  ------------------------------------------------------\n\n");
+    fflush(stdout);
+
+    if (0 != failed) {
+        fprintf(stderr, "[ERROR] %lu requests failed.\n", failed);
+        return -1;
+    }
+
+    return 0;
+}
+#endif
+
+#if defined(ENV_AXCL_RUNTIME_API_ENABLE)
+// 'count' more runners load the model on the device, sharing the loading of the model cache
+inline int display_model_cache(const std::string& config_file, const uint32_t& device, const uint32_t& kind,
+                               const std::string& model_path, const uint32_t& count) {
+    std::vector<std::unique_ptr<middleware::runtime_runner>> runners;
+    std::vector<float> costs;
+
+    auto flag = true;
+    for (uint32_t i = 0; flag && i < count; i++) {
+        auto& r = runners.emplace_back(std::make_unique<middleware::runtime_runner>());
+        utilities::timer timer;
+        flag = r->init(config_file, device, kind) && r->load(model_path);
+        timer.stop();
+        costs.push_back(timer.elapsed<utilities::timer::milliseconds>());
+    }
+
+    const auto statistics = middleware::model_cache::get_statistics();
+    for (auto it = runners.rbegin(); it != runners.rend(); ++it) {
+        std::ignore = (*it)->final();
+    }
+
+    if (!flag) {
+        fprintf(stderr, "[ERROR] Loading model {%s} by shared runner {%zu} failed.\n", model_path.c_str(), runners.size());
+        return -1;
+    }
+
+    fprintf(stdout, "  model shared by %d more runners:\n", count);
+    fprintf(stdout, "  ------------------------------------------------------\n");
+    for (uint32_t i = 0; i < costs.size(); i++) {
+        fprintf(stdout, "  runner %2d   load = %8.3f ms\n", i + 1, costs[i]);
+    }
+    fprintf(stdout, "  ------------------------------------------------------\n");
+    fprintf(stdout, "  loads = %lu   hits = %lu   load time = %.3f ms\n", statistics.loads, statistics.hits, statistics.load_ms);
+    fprintf(stdout, "  cmm saved   %lu Bytes\n", statistics.cmm_saved);
+    fprintf(stdout, "  ------------------------------------------------------\n\n");
+    fflush(stdout);
+
+    return 0;
+}
+#endif
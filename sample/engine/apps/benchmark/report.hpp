@@ -0,0 +1,170 @@
+/**************************************************************************************************
+ *
+ * Copyright (c) 2019-2024 Axera Semiconductor Co., Ltd. All Rights Reserved.
+ *
+ * This source file is the property of Axera Semiconductor Co., Ltd. and
+ * may not be copied or distributed in any isomorphic form without the prior
+ * written consent of Axera Semiconductor Co., Ltd.
+ *
+ **************************************************************************************************/
+
+#pragma once
+
+#include <array>
+#include <cstdio>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "utilities/histogram.hpp"
+
+namespace common {
+
+// stages of one running: input (flush + copy in), execute, output (invalidate + copy out)
+enum stage : uint32_t {
+    STAGE_INPUT = 0,
+    STAGE_EXECUTE,
+    STAGE_OUTPUT,
+    STAGE_COUNT
+};
+
+constexpr const char* STAGE_NAMES[STAGE_COUNT] = {"input", "execute", "output"};
+constexpr double STAGE_PERCENTS[] = {50., 90., 99., 99.9};
+constexpr const char* STAGE_PERCENT_NAMES[] = {"p50", "p90", "p99", "p99.9"};
+
+struct report {
+    std::string model;
+    std::string library_version;
+    std::string model_version;
+    std::string tool_version;
+    int32_t batch = 0;
+
+    // nanoseconds of each stage
+    std::array<utilities::histogram, STAGE_COUNT> stages;
+
+    // nanoseconds of each stage of every running, kept only when tracing
+    bool tracing = false;
+    std::vector<std::array<uint64_t, STAGE_COUNT>> trace;
+
+    void record(const std::array<uint64_t, STAGE_COUNT>& costs) {
+        for (uint32_t i = 0; i < STAGE_COUNT; i++) {
+            this->stages[i].record(costs[i]);
+        }
+        if (this->tracing) {
+            this->trace.push_back(costs);
+        }
+    }
+};
+
+inline double to_ms(const uint64_t& ns) {
+    return static_cast<double>(ns) / 1000000.;
+}
+
+inline void display_stages(const report& rpt) {
+    if (0 == rpt.stages[STAGE_EXECUTE].count()) {
+        return;
+    }
+
+    fprintf(stdout, "  stage (ms)        min        p50        p90        p99      p99.9        max\n");
+    fprintf(stdout, "  ---------------------------------------------------------------------------\n");
+    for (uint32_t i = 0; i < STAGE_COUNT; i++) {
+        const auto& h = rpt.stages[i];
+        fprintf(stdout, "  %-10s %10.3f %10.3f %10.3f %10.3f %10.3f %10.3f\n", STAGE_NAMES[i], to_ms(h.min()),
+                to_ms(h.percentile(50.)), to_ms(h.percentile(90.)), to_ms(h.percentile(99.)), to_ms(h.percentile(99.9)), to_ms(h.max()));
+    }
+    fprintf(stdout, "  ---------------------------------------------------------------------------\n\n");
+    fflush(stdout);
+}
+
+inline bool write_json(FILE* fp, const report& rpt) {
+    fprintf(fp, "{\n");
+    fprintf(fp, "  \"model\": \"%s\",\n", rpt.model.c_str());
+    fprintf(fp, "  \"library_version\": \"%s\",\n", rpt.library_version.c_str());
+    fprintf(fp, "  \"model_version\": \"%s\",\n", rpt.model_version.c_str());
+    fprintf(fp, "  \"tool_version\": \"%s\",\n", rpt.tool_version.c_str());
+    fprintf(fp, "  \"batch\": %d,\n", rpt.batch);
+    fprintf(fp, "  \"unit\": \"ms\",\n");
+    fprintf(fp, "  \"stages\": {\n");
+    for (uint32_t i = 0; i < STAGE_COUNT; i++) {
+        const auto& h = rpt.stages[i];
+        fprintf(fp, "    \"%s\": {\"count\": %lu, \"min\": %.6f, \"mean\": %.6f", STAGE_NAMES[i], h.count(), to_ms(h.min()), h.mean() / 1000000.);
+        for (uint32_t j = 0; j < std::size(STAGE_PERCENTS); j++) {
+            fprintf(fp, ", \"%s\": %.6f", STAGE_PERCENT_NAMES[j], to_ms(h.percentile(STAGE_PERCENTS[j])));
+        }
+        fprintf(fp, ", \"max\": %.6f}%s\n", to_ms(h.max()), (i + 1 < STAGE_COUNT) ? "," : "");
+    }
+    fprintf(fp, "  }\n");
+    fprintf(fp, "}\n");
+    return 0 == ferror(fp);
+}
+
+inline bool write_csv(FILE* fp, const report& rpt) {
+    fprintf(fp, "stage,count,min,mean");
+    for (const auto& name : STAGE_PERCENT_NAMES) {
+        fprintf(fp, ",%s", name);
+    }
+    fprintf(fp, ",max\n");
+
+    for (uint32_t i = 0; i < STAGE_COUNT; i++) {
+        const auto& h = rpt.stages[i];
+        fprintf(fp, "%s,%lu,%.6f,%.6f", STAGE_NAMES[i], h.count(), to_ms(h.min()), h.mean() / 1000000.);
+        for (const auto& percent : STAGE_PERCENTS) {
+            fprintf(fp, ",%.6f", to_ms(h.percentile(percent)));
+        }
+        fprintf(fp, ",%.6f\n", to_ms(h.max()));
+    }
+    return 0 == ferror(fp);
+}
+
+// the format follows the extension of the path, ".csv" writes CSV, others write JSON
+inline bool write_report(const std::string& path, const report& rpt) {
+    FILE* fp = fopen(path.c_str(), "w");
+    if (nullptr == fp) {
+        fprintf(stderr, "[ERROR] Open report file {%s} failed.\n", path.c_str());
+        return false;
+    }
+
+    const bool csv = path.size() >= 4 && 0 == path.compare(path.size() - 4, 4, ".csv");
+    const auto flag = csv ? write_csv(fp, rpt) : write_json(fp, rpt);
+    fclose(fp);
+
+    if (!flag) {
+        fprintf(stderr, "[ERROR] Write report file {%s} failed.\n", path.c_str());
+    }
+    return flag;
+}
+
+// one line per running in CSV, so traces of different firmware or model versions can be diffed directly
+inline bool write_trace(const std::string& path, const report& rpt) {
+    FILE* fp = fopen(path.c_str(), "w");
+    if (nullptr == fp) {
+        fprintf(stderr, "[ERROR] Open trace file {%s} failed.\n", path.c_str());
+        return false;
+    }
+
+    fprintf(fp, "# model: %s, library: %s, pulsar2: %s, batch: %d\n", rpt.model.c_str(), rpt.library_version.c_str(),
+            rpt.model_version.c_str(), rpt.batch);
+    fprintf(fp, "iteration");
+    for (const auto& name : STAGE_NAMES) {
+        fprintf(fp, ",%s_ms", name);
+    }
+    fprintf(fp, "\n");
+
+    for (size_t i = 0; i < rpt.trace.size(); i++) {
+        fprintf(fp, "%zu", i);
+        for (const auto& cost : rpt.trace[i]) {
+            fprintf(fp, ",%.6f", to_ms(cost));
+        }
+        fprintf(fp, "\n");
+    }
+
+    const auto flag = 0 == ferror(fp);
+    fclose(fp);
+
+    if (!flag) {
+        fprintf(stderr, "[ERROR] Write trace file {%s} failed.\n", path.c_str());
+    }
+    return flag;
+}
+
+}
@@ -0,0 +1,277 @@
+/**************************************************************************************************
+ *
+ * Copyright (c) 2019-2024 Axera Semiconductor Co., Ltd. All Rights Reserved.
+ *
+ * This source file is the property of Axera Semiconductor Co., Ltd. and
+ * may not be copied or distributed in any isomorphic form without the prior
+ * written consent of Axera Semiconductor Co., Ltd.
+ *
+ **************************************************************************************************/
+
+#include "common/args.hpp"
+#include "common/letterbox.hpp"
+
+#include "utilities/timer.hpp"
+
+#include <cmdline.h>
+
+#if defined(ENV_HAS_OPENCV)
+#include "common/sampler.hpp"
+#include <opencv2/opencv.hpp>
+#endif
+
+#include <array>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <limits>
+#include <string>
+#include <vector>
+
+constexpr int   DEFAULT_IMG_H = 640;
+constexpr int   DEFAULT_IMG_W = 640;
+
+constexpr int   DEFAULT_LOOP_COUNT = 100;
+
+constexpr std::array<float, 3> NORM_MEAN = {0.f, 0.f, 0.f};
+constexpr std::array<float, 3> NORM_SCALE = {1.f / 255.f, 1.f / 255.f, 1.f / 255.f};
+
+struct image {
+    int width = 0;
+    int height = 0;
+    std::vector<uint8_t> data;
+};
+
+// deterministic BGR content, gradients with noise, so all weights and rounding paths are hit
+static image make_image(const int width, const int height) {
+    image img{width, height, std::vector<uint8_t>(static_cast<size_t>(width) * height * 3)};
+    uint32_t seed = 0x2545F491;
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            for (int c = 0; c < 3; c++) {
+                seed = seed * 1664525u + 1013904223u;
+                const auto value = (x * (c + 1) + y * (3 - c)) / 4 + static_cast<int>(seed >> 28);
+                img.data[(static_cast<size_t>(y) * width + x) * 3 + c] = static_cast<uint8_t>(value & 0xFF);
+            }
+        }
+    }
+    return img;
+}
+
+#if defined(ENV_HAS_OPENCV)
+// the current path: sampler of crop_type::letterbox by OpenCV, then the layout pass
+static void reference_letterbox(const image& src, const int dst_w, const int dst_h, const bool swap_rb, std::vector<uint8_t>& bgr) {
+    cv::Mat src_mat(src.height, src.width, CV_8UC3, const_cast<uint8_t*>(src.data.data()));
+    cv::Mat dst_mat(dst_h, dst_w, CV_8UC3);
+    preprocess::sampler sampler(preprocess::crop_type::letterbox, preprocess::resize_type::linear, swap_rb);
+    sampler(src_mat, dst_mat);
+    bgr.assign(dst_mat.data, dst_mat.data + static_cast<size_t>(dst_w) * dst_h * 3);
+}
+#else
+// without OpenCV, a plain multi-pass implementation of the same arithmetic: resize of the roi, padding and B/R swap
+static void reference_letterbox(const image& src, const int dst_w, const int dst_h, const bool swap_rb, std::vector<uint8_t>& bgr) {
+    const auto width_ratio = static_cast<float>(dst_w) / static_cast<float>(src.width);
+    const auto height_ratio = static_cast<float>(dst_h) / static_cast<float>(src.height);
+    int roi_x = 0, roi_y = 0, roi_w = dst_w, roi_h = dst_h;
+    if (width_ratio < height_ratio) {
+        roi_h = static_cast<int>(std::roundf(static_cast<float>(src.height) * width_ratio));
+        roi_y = (dst_h - roi_h) / 2;
+    } else {
+        roi_w = static_cast<int>(std::roundf(static_cast<float>(src.width) * height_ratio));
+        roi_x = (dst_w - roi_w) / 2;
+    }
+    const double scale_x = 1. / (static_cast<double>(roi_w) / src.width);
+    const double scale_y = 1. / (static_cast<double>(roi_h) / src.height);
+    const auto at = [&src](const int x, const int y, const int c) {
+        return static_cast<int>(src.data[(static_cast<size_t>(y) * src.width + x) * 3 + c]);
+    };
+
+    // pass 1, resize
+    std::vector<uint8_t> roi(static_cast<size_t>(roi_w) * roi_h * 3);
+    const int width = roi_w * 3;
+    int simd_width = width / 16 * 16;
+    simd_width += width - simd_width > 8 ? 8 : 0;
+    for (int dy = 0; dy < roi_h; dy++) {
+        for (int dx = 0; dx < roi_w; dx++) {
+            for (int c = 0; c < 3; c++) {
+                uint8_t value = 0;
+                if (roi_w == src.width && roi_h == src.height) {
+                    value = static_cast<uint8_t>(at(dx, dy, c));
+                } else if (roi_w * 2 == src.width && roi_h * 2 == src.height) {
+                    value = static_cast<uint8_t>((at(2 * dx, 2 * dy, c) + at(2 * dx + 1, 2 * dy, c) + at(2 * dx, 2 * dy + 1, c) + at(2 * dx + 1, 2 * dy + 1, c) + 2) >> 2);
+                } else {
+                    auto fx = static_cast<float>((dx + 0.5) * scale_x - 0.5);
+                    int sx = static_cast<int>(std::floor(fx));
+                    fx -= static_cast<float>(sx);
+                    if (sx < 0) { fx = 0.f, sx = 0; }
+                    if (sx >= src.width - 1) { fx = 0.f, sx = src.width - 1; }
+                    const auto a0 = static_cast<int>(std::lrint((1.f - fx) * 2048)), a1 = static_cast<int>(std::lrint(fx * 2048));
+
+                    auto fy = static_cast<float>((dy + 0.5) * scale_y - 0.5);
+                    const int sy = static_cast<int>(std::floor(fy));
+                    fy -= static_cast<float>(sy);
+                    const auto b0 = static_cast<int>(std::lrint((1.f - fy) * 2048)), b1 = static_cast<int>(std::lrint(fy * 2048));
+
+                    const int x1 = std::min(sx + 1, src.width - 1);
+                    const int y0 = std::clamp(sy, 0, src.height - 1), y1 = std::clamp(sy + 1, 0, src.height - 1);
+                    const int h0 = at(sx, y0, c) * a0 + at(x1, y0, c) * a1;
+                    const int h1 = at(sx, y1, c) * a0 + at(x1, y1, c) * a1;
+
+                    if (dx * 3 + c < simd_width) {
+                        const auto sum = static_cast<int16_t>((((h0 >> 4) * b0) >> 16) + (((h1 >> 4) * b1) >> 16));
+                        value = static_cast<uint8_t>(std::clamp((sum + 2) >> 2, 0, 255));
+                    } else {
+                        value = static_cast<uint8_t>(std::clamp((h0 * b0 + h1 * b1 + (1 << 21)) >> 22, 0, 255));
+                    }
+                }
+                roi[(static_cast<size_t>(dy) * roi_w + dx) * 3 + c] = value;
+            }
+        }
+    }
+
+    // pass 2, padding and placing
+    bgr.assign(static_cast<size_t>(dst_w) * dst_h * 3, 0);
+    for (int y = 0; y < roi_h; y++) {
+        std::memcpy(bgr.data() + (static_cast<size_t>(roi_y + y) * dst_w + roi_x) * 3, roi.data() + static_cast<size_t>(y) * roi_w * 3, roi_w * 3);
+    }
+
+    // pass 3, B/R swap of the roi
+    if (swap_rb) {
+        for (int y = roi_y; y < roi_y + roi_h; y++) {
+            for (int x = roi_x; x < roi_x + roi_w; x++) {
+                std::swap(bgr[(static_cast<size_t>(y) * dst_w + x) * 3], bgr[(static_cast<size_t>(y) * dst_w + x) * 3 + 2]);
+            }
+        }
+    }
+}
+#endif
+
+// the passes after the letterbox: layout to NCHW, then normalization
+static void reference_nchw(const std::vector<uint8_t>& hwc, const int dst_w, const int dst_h, std::vector<uint8_t>& chw) {
+    const size_t plane = static_cast<size_t>(dst_w) * dst_h;
+    chw.resize(plane * 3);
+    for (size_t i = 0; i < plane; i++) {
+        for (int c = 0; c < 3; c++) {
+            chw[plane * c + i] = hwc[i * 3 + c];
+        }
+    }
+}
+
+static void reference_normalize(const std::vector<uint8_t>& in, std::vector<float>& out) {
+    const size_t plane = in.size() / 3;
+    out.resize(in.size());
+    for (size_t i = 0; i < in.size(); i++) {
+        const auto c = i / plane;
+        out[i] = (static_cast<float>(in[i]) - NORM_MEAN[c]) * NORM_SCALE[c];
+    }
+}
+
+static float measure(const int repeat, const std::function<void()>& task) {
+    task();
+    utilities::timer timer;
+    for (int i = 0; i < repeat; i++) {
+        task();
+    }
+    timer.stop();
+    return timer.elapsed<utilities::timer::milliseconds>() / static_cast<float>(repeat);
+}
+
+template<typename T>
+static const char* same(const std::vector<T>& a, const std::vector<T>& b) {
+    return a.size() == b.size() && 0 == std::memcmp(a.data(), b.data(), a.size() * sizeof(T)) ? "yes" : "NO";
+}
+
+static bool bench(const int src_w, const int src_h, const int dst_w, const int dst_h, const int repeat) {
+    const auto src = make_image(src_w, src_h);
+    const size_t size = static_cast<size_t>(dst_w) * dst_h * 3;
+    const size_t step = static_cast<size_t>(src_w) * 3;
+
+    preprocess::fused_letterbox rgb(src_w, src_h, dst_w, dst_h, true, preprocess::layout::nhwc);
+    preprocess::fused_letterbox planar(src_w, src_h, dst_w, dst_h, true, preprocess::layout::nchw);
+    const auto [roi_x, roi_y, roi_w, roi_h] = rgb.get_roi();
+    fprintf(stdout, "letterbox %dx%d -> %dx%d, roi{%d, %d, %d, %d}:\n", src_w, src_h, dst_w, dst_h, roi_x, roi_y, roi_w, roi_h);
+
+    std::vector<uint8_t> ref_hwc, ref_chw, simd_u8(size), scalar_u8(size);
+    std::vector<float> ref_f32, simd_f32(size), scalar_f32(size);
+    bool exact = true;
+
+    // 1. uint8 NHWC RGB
+    const auto ref_ms = measure(repeat, [&]() { reference_letterbox(src, dst_w, dst_h, true, ref_hwc); });
+    rgb.enable_simd(false);
+    const auto scalar_ms = measure(repeat, [&]() { rgb(src.data.data(), step, scalar_u8.data()); });
+    rgb.enable_simd(true);
+    const auto simd_ms = measure(repeat, [&]() { rgb(src.data.data(), step, simd_u8.data()); });
+    fprintf(stdout, "    u8  nhwc rgb           : multi-pass %7.3f ms, fused scalar %7.3f ms, fused simd %7.3f ms, x%.2f, bit-exact{scalar: %s, simd: %s}\n",
+            ref_ms, scalar_ms, simd_ms, ref_ms / simd_ms, same(ref_hwc, scalar_u8), same(ref_hwc, simd_u8));
+    exact &= ref_hwc == scalar_u8 && ref_hwc == simd_u8;
+
+    // 2. uint8 NCHW RGB
+    const auto ref_chw_ms = measure(repeat, [&]() {
+        reference_letterbox(src, dst_w, dst_h, true, ref_hwc);
+        reference_nchw(ref_hwc, dst_w, dst_h, ref_chw);
+    });
+    planar.enable_simd(false);
+    const auto scalar_chw_ms = measure(repeat, [&]() { planar(src.data.data(), step, scalar_u8.data()); });
+    planar.enable_simd(true);
+    const auto simd_chw_ms = measure(repeat, [&]() { planar(src.data.data(), step, simd_u8.data()); });
+    fprintf(stdout, "    u8  nchw rgb           : multi-pass %7.3f ms, fused scalar %7.3f ms, fused simd %7.3f ms, x%.2f, bit-exact{scalar: %s, simd: %s}\n",
+            ref_chw_ms, scalar_chw_ms, simd_chw_ms, ref_chw_ms / simd_chw_ms, same(ref_chw, scalar_u8), same(ref_chw, simd_u8));
+    exact &= ref_chw == scalar_u8 && ref_chw == simd_u8;
+
+    // 3. float NCHW RGB, normalized
+    const auto ref_f32_ms = measure(repeat, [&]() {
+        reference_letterbox(src, dst_w, dst_h, true, ref_hwc);
+        reference_nchw(ref_hwc, dst_w, dst_h, ref_chw);
+        reference_normalize(ref_chw, ref_f32);
+    });
+    planar.enable_simd(false);
+    const auto scalar_f32_ms = measure(repeat, [&]() { planar(src.data.data(), step, scalar_f32.data(), NORM_MEAN, NORM_SCALE); });
+    planar.enable_simd(true);
+    const auto simd_f32_ms = measure(repeat, [&]() { planar(src.data.data(), step, simd_f32.data(), NORM_MEAN, NORM_SCALE); });
+    fprintf(stdout, "    f32 nchw rgb normalized: multi-pass %7.3f ms, fused scalar %7.3f ms, fused simd %7.3f ms, x%.2f, bit-exact{scalar: %s, simd: %s}\n",
+            ref_f32_ms, scalar_f32_ms, simd_f32_ms, ref_f32_ms / simd_f32_ms, same(ref_f32, scalar_f32), same(ref_f32, simd_f32));
+    exact &= ref_f32 == scalar_f32 && ref_f32 == simd_f32;
+
+    return exact;
+}
+
+int main(int argc, char* argv[]) {
+    cmdline::parser cmd;
+
+    cmd.add<std::string>("size", 'g', "input_h,input_w", false, std::to_string(DEFAULT_IMG_H) + "," + std::to_string(DEFAULT_IMG_W));
+    cmd.add<int>("repeat", 'r', "repeat count", false, DEFAULT_LOOP_COUNT, cmdline::range(1, std::numeric_limits<int>::max()));
+    cmd.parse_check(argc, argv);
+
+    std::array<int, 2> input_size = {DEFAULT_IMG_H, DEFAULT_IMG_W}; {
+        auto input_size_string = cmd.get<std::string>("size");
+        if (auto input_size_flag = common::parse_args(input_size_string, input_size); !input_size_flag) {
+            fprintf(stderr, "Input size(%s) is not allowed, please check it.\n", input_size_string.c_str());
+            return -1;
+        }
+    }
+    const auto repeat = cmd.get<int>("repeat");
+
+#if defined(__AVX2__)
+    fprintf(stdout, "simd: avx2, ");
+#elif defined(__aarch64__)
+    fprintf(stdout, "simd: neon, ");
+#else
+    fprintf(stdout, "simd: none, ");
+#endif
+#if defined(ENV_HAS_OPENCV)
+    fprintf(stdout, "reference: sampler by OpenCV %s.\n", CV_VERSION);
+#else
+    fprintf(stdout, "reference: multi-pass scalar.\n");
+#endif
+
+    bool exact = true;
+    for (const auto& [width, height] : std::array<std::array<int, 2>, 2>{{{640, 640}, {1920, 1080}}}) {
+        exact &= bench(width, height, input_size[1], input_size[0], repeat);
+    }
+
+    if (!exact) {
+        fprintf(stderr, "Fused letterbox is not bit-exact against the reference.\n");
+        return -1;
+    }
+    return 0;
+}
@@ -0,0 +1,421 @@
+/**************************************************************************************************
+ *
+ * Copyright (c) 2019-2024 Axera Semiconductor Co., Ltd. All Rights Reserved.
+ *
+ * This source file is the property of Axera Semiconductor Co., Ltd. and
+ * may not be copied or distributed in any isomorphic form without the prior
+ * written consent of Axera Semiconductor Co., Ltd.
+ *
+ **************************************************************************************************/
+
+#include "common/args.hpp"
+#include "common/detection.hpp"
+#include "common/quantization.hpp"
+#include "common/topk.hpp"
+
+#include "utilities/timer.hpp"
+
+#include <cmdline.h>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <stack>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
+constexpr int   DEFAULT_IMG_H = 640;
+constexpr int   DEFAULT_IMG_W = 640;
+
+constexpr int   DEFAULT_CLASS_NUM = 80;
+constexpr int   DEFAULT_OBJECT_COUNT = 100;
+constexpr int   DEFAULT_LOOP_COUNT = 20;
+
+constexpr int strides[] = {8, 16, 32};
+const std::vector<std::vector<detection::box>> anchors{
+    {{10, 13}, {16, 30}, {33, 23}},
+    {{30, 61}, {62, 45}, {59, 119}},
+    {{116, 90}, {156, 198}, {373, 326}},
+};
+
+// the decoding, sorting and nms of detection::anchor_based before they were vectorized and bucketed
+namespace legacy {
+
+class anchor_based : public detection::anchor_based {
+public:
+    using detection::anchor_based::anchor_based;
+
+    void proposal(const float* feat, const int stride, const std::vector<detection::box>& anchors, const int class_num,
+                  const float prob_threshold, const int input_h, const int input_w) {
+        const float prob_logic_threshold = -1.0f * std::log((1.0f / prob_threshold) - 1.0f);
+        auto feature_ptr = feat;
+        for (int h = 0; h < input_h / stride; h++) {
+            for (int w = 0; w < input_w / stride; w++) {
+                for (size_t a = 0; a < anchors.size(); a++) {
+                    if (feature_ptr[4] < prob_logic_threshold) {
+                        feature_ptr += (class_num + 5);
+                        continue;
+                    }
+
+                    int class_index = 0;
+                    float class_score = -FLT_MAX;
+                    for (int s = 0; s < class_num; s++) {
+                        if (const float score = feature_ptr[s + 5]; score > class_score) {
+                            class_index = s;
+                            class_score = score;
+                        }
+                    }
+
+                    if (const float final_score = detection::sigmoid(feature_ptr[4]) * detection::sigmoid(class_score); final_score >= prob_threshold) {
+                        const float dx = detection::sigmoid(feature_ptr[0]);
+                        const float dy = detection::sigmoid(feature_ptr[1]);
+                        const float dw = detection::sigmoid(feature_ptr[2]);
+                        const float dh = detection::sigmoid(feature_ptr[3]);
+                        const float pred_cx = (dx * 2.f - 0.5f + static_cast<float>(w)) * static_cast<float>(stride);
+                        const float pred_cy = (dy * 2.f - 0.5f + static_cast<float>(h)) * static_cast<float>(stride);
+                        const float pred_w = dw * dw * 4.f * anchors[a].w;
+                        const float pred_h = dh * dh * 4.f * anchors[a].h;
+                        const float x0 = pred_cx - pred_w * 0.5f;
+                        const float y0 = pred_cy - pred_h * 0.5f;
+                        const float x1 = pred_cx + pred_w * 0.5f;
+                        const float y1 = pred_cy + pred_h * 0.5f;
+                        this->proposals_.push_back({{x0, y0, x1 - x0, y1 - y0}, final_score, class_index});
+                    }
+
+                    feature_ptr += (class_num + 5);
+                }
+            }
+        }
+    }
+
+    std::vector<detection::object> pick(const float iou_threshold) {
+        sort(this->proposals_);
+
+        std::vector<detection::object> result;
+        std::vector suppressed(this->proposals_.size(), false);
+        for (size_t i = 0; i < this->proposals_.size(); ++i) {
+            if (suppressed[i]) continue;
+
+            result.push_back(this->proposals_[i]);
+            for (size_t j = i + 1; j < this->proposals_.size(); ++j) {
+                if (iou(this->proposals_[i].rect, this->proposals_[j].rect) > iou_threshold) {
+                    suppressed[j] = true;
+                }
+            }
+        }
+        return result;
+    }
+
+    void reset() {
+        this->proposals_.clear();
+    }
+
+    [[nodiscard]] size_t get_proposal_count() const {
+        return this->proposals_.size();
+    }
+
+private:
+    static void sort(std::vector<detection::object>& objects) {
+        if (objects.empty()) { return; }
+
+        std::stack<std::pair<int, int>> stack;
+        stack.emplace(0, objects.size() - 1);
+
+        while (!stack.empty()) {
+            int left = stack.top().first;
+            int right = stack.top().second;
+            stack.pop();
+
+            int i = left;
+            int j = right;
+            const float p = objects[(left + right) / 2].prob;
+
+            while (i <= j) {
+                while (objects[i].prob > p) { i++; }
+                while (objects[j].prob < p) { j--; }
+
+                if (i <= j) {
+                    std::swap(objects[i], objects[j]);
+                    i++;
+                    j--;
+                }
+            }
+
+            if (left < j) { stack.emplace(left, j); }
+            if (i < right) { stack.emplace(i, right); }
+        }
+    }
+
+    std::vector<detection::object> proposals_;
+};
+
+}
+
+// dense synthetic heads of yolov5: every anchor near one of 'object_count' objects proposes a noisy box of it, as
+// a crowded scene does, and the other anchors carry background noise which a low threshold lets in
+static std::vector<std::vector<float>> make_outputs(const int input_h, const int input_w, const int class_num, const int object_count) {
+    uint32_t seed = 0x9E3779B9;
+    const auto uniform = [&seed](const float low, const float high) {
+        seed = seed * 1664525u + 1013904223u;
+        return low + (high - low) * static_cast<float>(seed >> 8) / static_cast<float>(1u << 24);
+    };
+    const auto logit = [](const float p) {
+        const float q = std::min(std::max(p, 0.01f), 0.99f);
+        return std::log(q / (1.f - q));
+    };
+
+    struct truth {
+        float cx, cy, w, h;
+        int label;
+    };
+    std::vector<truth> truths(object_count);
+    for (auto& t : truths) {
+        t = {uniform(0.f, static_cast<float>(input_w)), uniform(0.f, static_cast<float>(input_h)),
+             uniform(12.f, 300.f), uniform(12.f, 300.f), static_cast<int>(uniform(0.f, static_cast<float>(class_num) - 0.5f))};
+    }
+
+    std::vector<std::vector<float>> outputs;
+    for (size_t k = 0; k < std::size(strides); k++) {
+        const int stride = strides[k];
+        const int feat_h = input_h / stride, feat_w = input_w / stride;
+        std::vector<float> output(static_cast<size_t>(feat_h) * feat_w * 3 * (class_num + 5));
+
+        float* p = output.data();
+        for (int h = 0; h < feat_h; h++) {
+            for (int w = 0; w < feat_w; w++) {
+                for (size_t a = 0; a < anchors[k].size(); a++, p += class_num + 5) {
+                    for (int c = 0; c < 4; c++) {
+                        p[c] = uniform(-2.f, 2.f);
+                    }
+                    p[4] = uniform(-9.f, -1.f);
+                    for (int c = 0; c < class_num; c++) {
+                        p[5 + c] = uniform(-9.f, 0.f);
+                    }
+
+                    for (const auto& t : truths) {
+                        const float ox = t.cx / static_cast<float>(stride) - static_cast<float>(w);
+                        const float oy = t.cy / static_cast<float>(stride) - static_cast<float>(h);
+                        const float sw = std::sqrt(t.w / (4.f * anchors[k][a].w)), sh = std::sqrt(t.h / (4.f * anchors[k][a].h));
+                        if (ox <= -0.4f || ox >= 1.4f || oy <= -0.4f || oy >= 1.4f || sw >= 0.95f || sh >= 0.95f || sw <= 0.1f || sh <= 0.1f) {
+                            continue;
+                        }
+                        p[0] = logit((ox + 0.5f) / 2.f) + uniform(-0.2f, 0.2f);
+                        p[1] = logit((oy + 0.5f) / 2.f) + uniform(-0.2f, 0.2f);
+                        p[2] = logit(sw) + uniform(-0.2f, 0.2f);
+                        p[3] = logit(sh) + uniform(-0.2f, 0.2f);
+                        p[4] = uniform(-1.f, 4.f);
+                        p[5 + t.label] = uniform(0.f, 4.f);
+                        break;
+                    }
+                }
+            }
+        }
+        outputs.push_back(std::move(output));
+    }
+    return outputs;
+}
+
+// the same objects, up to the order of objects of the same probability, which the previous quicksort left unspecified
+static bool same(std::vector<detection::object> a, std::vector<detection::object> b) {
+    if (a.size() != b.size()) {
+        return false;
+    }
+    const auto order = [](const detection::object& l, const detection::object& r) {
+        return std::make_tuple(-l.prob, l.label, l.rect.x, l.rect.y, l.rect.w, l.rect.h)
+             < std::make_tuple(-r.prob, r.label, r.rect.x, r.rect.y, r.rect.w, r.rect.h);
+    };
+    std::sort(a.begin(), a.end(), order);
+    std::sort(b.begin(), b.end(), order);
+    for (size_t i = 0; i < a.size(); i++) {
+        if (a[i].label != b[i].label || 0 != std::memcmp(&a[i].prob, &b[i].prob, sizeof(float))
+            || 0 != std::memcmp(&a[i].rect, &b[i].rect, sizeof(detection::rect))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// per tensor quantization of 'output' over its range, as the toolchain gives int8 (symmetric) or uint8 (asymmetric) heads
+template<typename T>
+static std::vector<T> quantize(const std::vector<float>& output, quantization::param& param) {
+    const auto [low, high] = std::minmax_element(output.begin(), output.end());
+    if constexpr (std::is_signed_v<T>) {
+        param = {std::max(std::fabs(*low), std::fabs(*high)) / 127.f, 0};
+    } else {
+        param.scale = (*high - *low) / 255.f;
+        param.zero_point = static_cast<int32_t>(std::lround(-*low / param.scale));
+    }
+
+    std::vector<T> codes(output.size());
+    for (size_t i = 0; i < output.size(); i++) {
+        const auto code = std::lround(output[i] / param.scale) + param.zero_point;
+        codes[i] = static_cast<T>(std::min<long>(std::max<long>(code, std::numeric_limits<T>::lowest()), std::numeric_limits<T>::max()));
+    }
+    return codes;
+}
+
+// decoding of the quantized heads against dequantizing them first, which has to give the very same objects
+template<typename T>
+static bool compare_quantized(const char* name, const std::vector<std::vector<float>>& outputs, const std::array<int, 2>& input_size,
+                              const int class_num, const float iou_threshold, const int repeat) {
+    std::vector<std::vector<T>> codes;
+    std::vector<quantization::param> params(outputs.size());
+    for (size_t k = 0; k < outputs.size(); k++) {
+        codes.push_back(quantize<T>(outputs[k], params[k]));
+    }
+
+    bool exact = true;
+    for (const auto prob_threshold : {0.45f, 0.25f}) {
+        detection::anchor_based dequantized(class_num, input_size[0], input_size[1], prob_threshold, iou_threshold);
+        detection::anchor_based quantized(class_num, input_size[0], input_size[1], prob_threshold, iou_threshold);
+
+        std::vector<std::vector<float>> buffers(outputs.size());
+        std::vector<detection::object> expected, result;
+        float dequantized_ms = 0.f, quantized_ms = 0.f;
+        for (int i = 0; i < repeat; i++) {
+            utilities::timer dequantized_timer;
+            dequantized.reset();
+            for (size_t k = 0; k < codes.size(); k++) {
+                buffers[k].resize(codes[k].size());
+                for (size_t j = 0; j < codes[k].size(); j++) {
+                    buffers[k][j] = quantization::dequantize(codes[k][j], params[k]);
+                }
+                dequantized.proposal(buffers[k].data(), strides[k], anchors[k]);
+            }
+            expected = dequantized.pick(input_size[0], input_size[1]);
+            dequantized_timer.stop();
+            dequantized_ms += dequantized_timer.elapsed<utilities::timer::milliseconds>() / static_cast<float>(repeat);
+
+            utilities::timer quantized_timer;
+            quantized.reset();
+            for (size_t k = 0; k < codes.size(); k++) {
+                quantized.proposal(codes[k].data(), strides[k], anchors[k], params[k]);
+            }
+            result = quantized.pick(input_size[0], input_size[1]);
+            quantized_timer.stop();
+            quantized_ms += quantized_timer.elapsed<utilities::timer::milliseconds>() / static_cast<float>(repeat);
+        }
+
+        const bool equal = same(expected, result);
+        fprintf(stdout, "    %s prob %.2f: %4zu objects, dequantized %8.3f ms, quantized %8.3f ms, x%.2f, same objects: %s\n",
+                name, prob_threshold, result.size(), dequantized_ms, quantized_ms, dequantized_ms / quantized_ms, equal ? "yes" : "NO");
+        exact &= equal;
+    }
+
+    // top k of the class scores of the first head, as a classification model gives them
+    const auto size = std::min(codes[0].size(), static_cast<size_t>(1000));
+    std::vector<float> scores(size);
+    for (size_t j = 0; j < size; j++) {
+        scores[j] = quantization::dequantize(codes[0][j], params[0]);
+    }
+    for (const bool reverse : {false, true}) {
+        const auto expected = classification::topK(scores.data(), size, 5, reverse);
+        const auto result = classification::topK(codes[0].data(), size, 5, params[0], reverse);
+        bool equal = expected.size() == result.size();
+        for (size_t j = 0; equal && j < result.size(); j++) {
+            equal = expected[j].first == result[j].first && scores[result[j].second] == result[j].first;
+        }
+        fprintf(stdout, "    %s top 5 of %zu scores%s, same scores: %s\n", name, size, reverse ? " reversed" : "", equal ? "yes" : "NO");
+        exact &= equal;
+    }
+
+    return exact;
+}
+
+int main(int argc, char* argv[]) {
+    cmdline::parser cmd;
+
+    cmd.add<std::string>("size", 'g', "input_h,input_w", false, std::to_string(DEFAULT_IMG_H) + "," + std::to_string(DEFAULT_IMG_W));
+    cmd.add<int>("classes", 'n', "class count", false, DEFAULT_CLASS_NUM, cmdline::range(1, 1000));
+    cmd.add<int>("objects", 'o', "object count of the synthetic scene", false, DEFAULT_OBJECT_COUNT, cmdline::range(0, 10000));
+    cmd.add<float>("iou", 0, "iou threshold", false, 0.45f);
+    cmd.add<int>("repeat", 'r', "repeat count", false, DEFAULT_LOOP_COUNT, cmdline::range(1, std::numeric_limits<int>::max()));
+    cmd.parse_check(argc, argv);
+
+    std::array<int, 2> input_size = {DEFAULT_IMG_H, DEFAULT_IMG_W}; {
+        auto input_size_string = cmd.get<std::string>("size");
+        if (auto input_size_flag = common::parse_args(input_size_string, input_size); !input_size_flag) {
+            fprintf(stderr, "Input size(%s) is not allowed, please check it.\n", input_size_string.c_str());
+            return -1;
+        }
+    }
+    const auto class_num = cmd.get<int>("classes");
+    const auto object_count = cmd.get<int>("objects");
+    const auto iou_threshold = cmd.get<float>("iou");
+    const auto repeat = cmd.get<int>("repeat");
+
+#if defined(__AVX__)
+    fprintf(stdout, "simd: avx, ");
+#elif defined(__aarch64__)
+    fprintf(stdout, "simd: neon, ");
+#else
+    fprintf(stdout, "simd: none, ");
+#endif
+    fprintf(stdout, "yolov5 heads of %dx%d, %d classes, %d objects, iou threshold %.2f:\n",
+            input_size[0], input_size[1], class_num, object_count, iou_threshold);
+
+    const auto outputs = make_outputs(input_size[0], input_size[1], class_num, object_count);
+
+    bool exact = true;
+    for (const auto prob_threshold : {0.45f, 0.25f, 0.1f, 0.05f}) {
+        // the letterbox of the source is the input itself, so pick does not move the boxes
+        legacy::anchor_based reference(class_num, input_size[0], input_size[1], prob_threshold, iou_threshold);
+        detection::anchor_based fast(class_num, input_size[0], input_size[1], prob_threshold, iou_threshold);
+
+        // the two run in turns, so neither one gets the cache warmed by the other
+        std::vector<detection::object> expected, result;
+        float reference_ms = 0.f, fast_ms = 0.f;
+        for (int i = 0; i < repeat; i++) {
+            utilities::timer reference_timer;
+            reference.reset();
+            for (size_t k = 0; k < outputs.size(); k++) {
+                reference.proposal(outputs[k].data(), strides[k], anchors[k], class_num, prob_threshold, input_size[0], input_size[1]);
+            }
+            expected = reference.pick(iou_threshold);
+            reference_timer.stop();
+            reference_ms += reference_timer.elapsed<utilities::timer::milliseconds>() / static_cast<float>(repeat);
+
+            utilities::timer fast_timer;
+            fast.reset();
+            for (size_t k = 0; k < outputs.size(); k++) {
+                fast.proposal(outputs[k].data(), strides[k], anchors[k]);
+            }
+            result = fast.pick(input_size[0], input_size[1]);
+            fast_timer.stop();
+            fast_ms += fast_timer.elapsed<utilities::timer::milliseconds>() / static_cast<float>(repeat);
+        }
+
+        // the clamping of pick to the source image is the same for both
+        for (auto& obj : expected) {
+            const float x0 = std::max(std::min(obj.rect.x, static_cast<float>(input_size[1] - 1)), 0.f);
+            const float y0 = std::max(std::min(obj.rect.y, static_cast<float>(input_size[0] - 1)), 0.f);
+            const float x1 = std::max(std::min(obj.rect.x + obj.rect.w, static_cast<float>(input_size[1] - 1)), 0.f);
+            const float y1 = std::max(std::min(obj.rect.y + obj.rect.h, static_cast<float>(input_size[0] - 1)), 0.f);
+            obj.rect = {x0, y0, x1 - x0, y1 - y0};
+        }
+
+        const bool equal = same(expected, result);
+        fprintf(stdout, "    prob %.2f: %6zu proposals, %4zu objects, previous %8.3f ms, current %8.3f ms, x%.2f, same objects: %s\n",
+                prob_threshold, reference.get_proposal_count(), result.size(), reference_ms, fast_ms, reference_ms / fast_ms, equal ? "yes" : "NO");
+        exact &= equal;
+    }
+
+    if (!exact) {
+        fprintf(stderr, "Post process objects differ from the previous implementation.\n");
+        return -1;
+    }
+
+    fprintf(stdout, "quantized heads:\n");
+    exact = compare_quantized<int8_t>("int8 ", outputs, input_size, class_num, iou_threshold, repeat);
+    exact &= compare_quantized<uint8_t>("uint8", outputs, input_size, class_num, iou_threshold, repeat);
+    if (!exact) {
+        fprintf(stderr, "Post process of quantized heads differs from the one of the dequantized heads.\n");
+        return -1;
+    }
+    return 0;
+}
@@ -11,6 +11,7 @@
 #include "common/args.hpp"
 #include "common/types.hpp"
 #include "common/sampler.hpp"
+#include "common/ivps_sampler.hpp"
 #include "common/detection.hpp"
 #include "common/mscoco.hpp"
 #include "common/palette.hpp"
@@ -109,6 +110,7 @@ int main(int argc, char* argv[]) {
     cmd.add<float> ("iou", 'u', "iou threshold", false, DEFAULT_IOU_THRESHOLD, cmdline::range(0.1f, 1.0f));
 
     cmd.add("swap-rb", 's', "swap rgb(bgr) to bgr(rgb)");
+    cmd.add<int>("ivps", 0, "letterbox on device by IVPS from NV12 and compare with the host, 0=off, 1=tdp, 2=vpp, 3=vgp", false, 0, cmdline::range(0, 3));
 
     cmd.add<int>("repeat", 'r', "repeat count", false, DEFAULT_LOOP_COUNT, cmdline::range(1, std::numeric_limits<int>::max()));
     cmd.parse_check(argc, argv);
@@ -369,14 +371,45 @@ int main(int argc, char* argv[]) {
     std::vector<uint8_t> input_buffer(input_size[1] * input_size[0] * 3, 0);
     auto dst = cv::Mat(cv::Size(input_size[1], input_size[0]), CV_8UC3, input_buffer.data());
 
-    // 3-2. resize & swap rgb to bgr
+    // 3-2. resize & swap rgb to bgr on the host, then send input to device
     preprocess::sampler sampler(preprocess::crop_type::letterbox, preprocess::resize_type::linear, cmd.exist("swap-rb"));
-    sampler(src, dst);
+    std::vector<float> host_costs(repeat, 0);
+    for (int i = 0; i < repeat; ++i) {
+        utilities::timer tick;
+        sampler(src, dst);
+        if (const auto ret = axclrtMemcpy(inputs.get()[0], input_buffer.data(), input_buffer.size(), AXCL_MEMCPY_HOST_TO_DEVICE); 0 != ret) {
+            fprintf(stderr, "Copy input data to device failed{0x%08X}.\n", ret);
+            return false;
+        }
+        host_costs[i] = tick.elapsed();
+    }
 
-    // 3-3. send input to device
-    if (const auto ret = axclrtMemcpy(inputs.get()[0], input_buffer.data(), input_buffer.size(), AXCL_MEMCPY_HOST_TO_DEVICE); 0 != ret) {
-        fprintf(stderr, "Copy input data to device failed{0x%08X}.\n", ret);
-        return false;
+    // 3-3. or send NV12 to device, then letterbox & convert color by IVPS into the input buffer;
+    // a frame of VDEC is already on the device and goes to IVPS directly
+    std::vector<float> nv12_costs, ivps_costs;
+    preprocess::ivps_sampler ivps(static_cast<preprocess::ivps_engine>(std::max(cmd.get<int>("ivps") - 1, 0)), cmd.exist("swap-rb"));
+    if (0 != cmd.get<int>("ivps")) {
+        if (!ivps.init()) {
+            return false;
+        }
+
+        std::vector<uint8_t> nv12;
+        uint32_t nv12_w = 0, nv12_h = 0;
+        nv12_costs.resize(repeat, 0);
+        ivps_costs.resize(repeat, 0);
+        for (int i = 0; i < repeat; ++i) {
+            utilities::timer tick;
+            preprocess::ivps_sampler::to_nv12(src, nv12, nv12_w, nv12_h);
+            nv12_costs[i] = tick.elapsed();
+
+            AX_VIDEO_FRAME_T frame;
+            utilities::timer device_tick;
+            if (!ivps.upload(nv12.data(), nv12_w, nv12_h, frame)
+                || !ivps(frame, inputs.get()[0], static_cast<uint32_t>(input_size[1]), static_cast<uint32_t>(input_size[0]))) {
+                return false;
+            }
+            ivps_costs[i] = device_tick.elapsed();
+        }
     }
 
     // 3-4. run model
@@ -422,6 +455,15 @@ int main(int argc, char* argv[]) {
     fprintf(stdout, "Repeat %d times, avg time %.2f ms, max_time %.2f ms, min_time %.2f ms\n",
             static_cast<int>(run_costs.size()), total_time / static_cast<float>(run_costs.size()), *max, *min);
     fprintf(stdout, "--------------------------------------\n");
+    auto average = [](const std::vector<float>& costs) {
+        return costs.empty() ? 0.f : std::accumulate(costs.begin(), costs.end(), 0.f) / static_cast<float>(costs.size());
+    };
+    fprintf(stdout, "Preprocess per frame, host letterbox + upload rgb: %.2f ms\n", average(host_costs));
+    if (!ivps_costs.empty()) {
+        fprintf(stdout, "Preprocess per frame, host nv12 %.2f ms + upload nv12 & ivps letterbox %.2f ms: %.2f ms\n",
+                average(nv12_costs), average(ivps_costs), average(nv12_costs) + average(ivps_costs));
+    }
+    fprintf(stdout, "--------------------------------------\n");
 
     draw_objects(src, "yolov5s_out", objects);
 
@@ -10,10 +10,16 @@
 
 #pragma once
 
+#include "common/quantization.hpp"
 #include "common/sigmoid.hpp"
 
+#include <algorithm>
+#include <array>
+#include <cfloat>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
 #include <vector>
-#include <stack>
 
 namespace detection {
 
@@ -31,6 +37,197 @@ struct object {
     int label;
 };
 
+// class scores only pass the threshold above this logit margin below it, which covers the rounding of sigmoid,
+// so the exact test on the product of the sigmoids still decides alone
+constexpr float LOGIT_MARGIN = 1e-3f;
+
+// index of the first maximum of 'data', as a scalar scan of '>' from -FLT_MAX finds it
+inline int argmax(const float* data, const int count, float& max) {
+    int i = 0;
+    float m = -FLT_MAX;
+#if defined(__AVX__)
+    if (count >= 8) {
+        __m256 v = _mm256_loadu_ps(data);
+        for (i = 8; i + 8 <= count; i += 8) {
+            v = _mm256_max_ps(v, _mm256_loadu_ps(data + i));
+        }
+        __m128 r = _mm_max_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1));
+        r = _mm_max_ps(r, _mm_movehl_ps(r, r));
+        r = _mm_max_ss(r, _mm_shuffle_ps(r, r, 1));
+        m = std::max(m, _mm_cvtss_f32(r));
+    }
+#elif defined(__aarch64__)
+    if (count >= 4) {
+        float32x4_t v = vld1q_f32(data);
+        for (i = 4; i + 4 <= count; i += 4) {
+            v = vmaxq_f32(v, vld1q_f32(data + i));
+        }
+        m = std::max(m, vmaxvq_f32(v));
+    }
+#endif
+    for (; i < count; i++) {
+        m = std::max(m, data[i]);
+    }
+
+    max = m;
+    i = 0;
+#if defined(__AVX__)
+    const __m256 vm = _mm256_set1_ps(m);
+    for (; i + 8 <= count; i += 8) {
+        if (const int mask = _mm256_movemask_ps(_mm256_cmp_ps(_mm256_loadu_ps(data + i), vm, _CMP_EQ_OQ)); 0 != mask) {
+            return i + __builtin_ctz(static_cast<uint32_t>(mask));
+        }
+    }
+#endif
+    for (; i < count; i++) {
+        if (data[i] == m) {
+            return i;
+        }
+    }
+    return 0;
+}
+
+// index of the first maximum of 8 bits quantized 'data', 32 (AVX2) or 16 (NEON) codes at a time
+template<typename T>
+int argmax(const T* data, const int count, T& max) {
+    static_assert(std::is_same_v<T, int8_t> || std::is_same_v<T, uint8_t>, "8 bits codes only");
+
+    int i = 0;
+    T m = std::numeric_limits<T>::lowest();
+#if defined(__AVX2__)
+    if (count >= 32) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data));
+        for (i = 32; i + 32 <= count; i += 32) {
+            const __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+            if constexpr (std::is_signed_v<T>) {
+                v = _mm256_max_epi8(v, x);
+            } else {
+                v = _mm256_max_epu8(v, x);
+            }
+        }
+        alignas(32) T lanes[32];
+        _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), v);
+        for (const T lane : lanes) {
+            m = std::max(m, lane);
+        }
+    }
+#elif defined(__aarch64__)
+    if (count >= 16) {
+        if constexpr (std::is_signed_v<T>) {
+            int8x16_t v = vld1q_s8(data);
+            for (i = 16; i + 16 <= count; i += 16) {
+                v = vmaxq_s8(v, vld1q_s8(data + i));
+            }
+            m = vmaxvq_s8(v);
+        } else {
+            uint8x16_t v = vld1q_u8(data);
+            for (i = 16; i + 16 <= count; i += 16) {
+                v = vmaxq_u8(v, vld1q_u8(data + i));
+            }
+            m = vmaxvq_u8(v);
+        }
+    }
+#endif
+    for (; i < count; i++) {
+        m = std::max(m, data[i]);
+    }
+
+    max = m;
+    i = 0;
+#if defined(__AVX2__)
+    const __m256i vm = _mm256_set1_epi8(static_cast<char>(m));
+    for (; i + 32 <= count; i += 32) {
+        const __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+        if (const int mask = _mm256_movemask_epi8(_mm256_cmpeq_epi8(x, vm)); 0 != mask) {
+            return i + __builtin_ctz(static_cast<uint32_t>(mask));
+        }
+    }
+#endif
+    for (; i < count; i++) {
+        if (data[i] == m) {
+            return i;
+        }
+    }
+    return 0;
+}
+
+// greedy nms of 'count' boxes sorted by score: 'bound(i)' gives {x0, y0, x1, y1} of box i and 'suppress(kept, i)' tells if
+// a kept box suppresses box i. with a threshold of 0 or above, boxes without a positive overlap never suppress each other,
+// so the kept boxes are held as columns and tested for overlap 8 (AVX) or 4 (NEON) at a time, and 'suppress' only runs
+// on the overlapping ones; the picked boxes are the ones of testing all pairs
+template<typename Bound, typename Suppress>
+std::vector<size_t> greedy_nms(const size_t count, Bound&& bound, Suppress&& suppress, const float iou_threshold) {
+    std::vector<size_t> picked;
+
+    if (!(iou_threshold >= 0.f)) {
+        for (size_t i = 0; i < count; i++) {
+            if (std::none_of(picked.begin(), picked.end(), [&suppress, i](const size_t kept) { return suppress(kept, i); })) {
+                picked.push_back(i);
+            }
+        }
+        return picked;
+    }
+
+    std::array<std::vector<float>, 4> columns;
+    for (auto& column : columns) {
+        column.reserve(count);
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        const std::array<float, 4> b = bound(i);
+        const size_t n = picked.size();
+        const float *x0 = columns[0].data(), *y0 = columns[1].data(), *x1 = columns[2].data(), *y1 = columns[3].data();
+
+        bool keep = true;
+        size_t k = 0;
+#if defined(__AVX__)
+        const __m256 bx0 = _mm256_set1_ps(b[0]), by0 = _mm256_set1_ps(b[1]), bx1 = _mm256_set1_ps(b[2]), by1 = _mm256_set1_ps(b[3]);
+        for (; keep && k + 8 <= n; k += 8) {
+            const __m256 overlap_x = _mm256_cmp_ps(_mm256_min_ps(_mm256_loadu_ps(x1 + k), bx1), _mm256_max_ps(_mm256_loadu_ps(x0 + k), bx0), _CMP_GT_OQ);
+            const __m256 overlap_y = _mm256_cmp_ps(_mm256_min_ps(_mm256_loadu_ps(y1 + k), by1), _mm256_max_ps(_mm256_loadu_ps(y0 + k), by0), _CMP_GT_OQ);
+            for (auto mask = static_cast<uint32_t>(_mm256_movemask_ps(_mm256_and_ps(overlap_x, overlap_y))); 0 != mask; mask &= mask - 1) {
+                if (suppress(picked[k + __builtin_ctz(mask)], i)) {
+                    keep = false;
+                    break;
+                }
+            }
+        }
+#elif defined(__aarch64__)
+        const float32x4_t bx0 = vdupq_n_f32(b[0]), by0 = vdupq_n_f32(b[1]), bx1 = vdupq_n_f32(b[2]), by1 = vdupq_n_f32(b[3]);
+        for (; keep && k + 4 <= n; k += 4) {
+            const uint32x4_t overlap_x = vcgtq_f32(vminq_f32(vld1q_f32(x1 + k), bx1), vmaxq_f32(vld1q_f32(x0 + k), bx0));
+            const uint32x4_t overlap_y = vcgtq_f32(vminq_f32(vld1q_f32(y1 + k), by1), vmaxq_f32(vld1q_f32(y0 + k), by0));
+            const uint32x4_t overlap = vandq_u32(overlap_x, overlap_y);
+            if (0 == vmaxvq_u32(overlap)) {
+                continue;
+            }
+            uint32_t lanes[4];
+            vst1q_u32(lanes, overlap);
+            for (int lane = 0; keep && lane < 4; lane++) {
+                if (0 != lanes[lane] && suppress(picked[k + lane], i)) {
+                    keep = false;
+                }
+            }
+        }
+#endif
+        for (; keep && k < n; k++) {
+            if (std::min(x1[k], b[2]) > std::max(x0[k], b[0]) && std::min(y1[k], b[3]) > std::max(y0[k], b[1]) && suppress(picked[k], i)) {
+                keep = false;
+            }
+        }
+        if (!keep) {
+            continue;
+        }
+
+        picked.push_back(i);
+        for (int c = 0; c < 4; c++) {
+            columns[c].push_back(b[c]);
+        }
+    }
+
+    return picked;
+}
+
 // static std::vector<box> generate_anchors(const int stride, const std::vector<float>& ratios, const std::vector<float>& scales) {
 //     std::vector<box> anchors;
 //     for (const float scale : scales) {
@@ -54,11 +251,63 @@ public:
         this->objects_.clear();
     }
 
+    // only the 'count' most probable proposals go to nms, 0 for all of them
+    void set_max_candidates(const size_t count) {
+        this->max_candidates_ = count;
+    }
+
     void proposal(const float* feat, const int stride, const std::vector<box>& anchors) {
         proposal(feat, stride, anchors, input_h_, input_w_);
     }
 
+    // the same proposals as of the dequantized 'feat', but the thresholds are quantized instead: anchors are skipped on
+    // their codes, and only the ones passing them are dequantized
+    template<typename T>
+    void proposal(const T* feat, const int stride, const std::vector<box>& anchors, const quantization::param& param) {
+        const int32_t box_threshold = quantization::threshold<T>(prob_logic_threshold_, param);
+        const int32_t class_threshold = quantization::threshold<T>(prob_logic_threshold_ - LOGIT_MARGIN, param);
+
+        auto feature_ptr = feat;
+        const int feat_h = input_h_ / stride;
+        const int feat_w = input_w_ / stride;
+
+        for (int h = 0; h <= feat_h - 1; h++) {
+            for (int w = 0; w <= feat_w - 1; w++) {
+                for (size_t a = 0; a <= anchors.size() - 1; a++) {
+                    if (static_cast<int32_t>(feature_ptr[4]) < box_threshold) {
+                        feature_ptr += (class_num_ + 5);
+                        continue;
+                    }
+
+                    T class_code = 0;
+                    const int class_index = argmax(feature_ptr + 5, class_num_, class_code);
+                    if (static_cast<int32_t>(class_code) < class_threshold) {
+                        feature_ptr += (class_num_ + 5);
+                        continue;
+                    }
+
+                    const float box_score = quantization::dequantize(feature_ptr[4], param);
+                    const float class_score = quantization::dequantize(class_code, param);
+                    if (const float final_score = sigmoid(box_score) * sigmoid(class_score); final_score >= prob_threshold_) {
+                        const float offsets[4] = {
+                            quantization::dequantize(feature_ptr[0], param), quantization::dequantize(feature_ptr[1], param),
+                            quantization::dequantize(feature_ptr[2], param), quantization::dequantize(feature_ptr[3], param),
+                        };
+                        decode(offsets, h, w, stride, anchors[a], final_score, class_index);
+                    }
+
+                    feature_ptr += (class_num_ + 5);
+                }
+            }
+        }
+    }
+
     std::vector<object> pick(const int src_h, const int src_w) {
+        if (0 < this->max_candidates_ && this->objects_.size() > this->max_candidates_) {
+            std::nth_element(this->objects_.begin(), this->objects_.begin() + static_cast<std::ptrdiff_t>(this->max_candidates_), this->objects_.end(),
+                             [](const object& a, const object& b) { return a.prob > b.prob; });
+            this->objects_.resize(this->max_candidates_);
+        }
         return pick(this->objects_, iou_threshold_, input_h_, input_w_, src_h, src_w);
     }
 
@@ -77,52 +326,26 @@ protected:
     }
 
     static std::vector<object> nms(const std::vector<object>& boxes, const float iou_threshold) {
-        std::vector<object> result;
-        std::vector suppressed(boxes.size(), false);
-
-        for (size_t i = 0; i < boxes.size(); ++i) {
-            if (suppressed[i]) continue;
+        const auto picked = greedy_nms(
+            boxes.size(),
+            [&boxes](const size_t i) {
+                const auto& r = boxes[i].rect;
+                return std::array<float, 4>{r.x, r.y, r.x + r.w, r.y + r.h};
+            },
+            [&boxes, iou_threshold](const size_t kept, const size_t i) { return iou(boxes[kept].rect, boxes[i].rect) > iou_threshold; },
+            iou_threshold);
 
+        std::vector<object> result;
+        result.reserve(picked.size());
+        for (const auto i : picked) {
             result.push_back(boxes[i]);
-            for (size_t j = i + 1; j < boxes.size(); ++j) {
-                if (iou(boxes[i].rect, boxes[j].rect) > iou_threshold) {
-                    suppressed[j] = true;
-                }
-            }
         }
-
         return result;
     }
 
+    // descending by probability, proposals of the same probability keep their order
     static void sort(std::vector<object>& objects) {
-        if (objects.empty()) { return; }
-
-        std::stack<std::pair<int, int>> stack;
-        stack.emplace(0, objects.size() - 1);
-
-        while (!stack.empty()) {
-            int left = stack.top().first;
-            int right = stack.top().second;
-            stack.pop();
-
-            int i = left;
-            int j = right;
-            const float p = objects[(left + right) / 2].prob;
-
-            while (i <= j) {
-                while (objects[i].prob > p) { i++; }
-                while (objects[j].prob < p) { j--; }
-
-                if (i <= j) {
-                    std::swap(objects[i], objects[j]);
-                    i++;
-                    j--;
-                }
-            }
-
-            if (left < j) { stack.emplace(left, j); }
-            if (i < right) { stack.emplace(i, right); }
-        }
+        std::stable_sort(objects.begin(), objects.end(), [](const object& a, const object& b) { return a.prob > b.prob; });
     }
 
     void proposal(const float* feat, const int stride, const std::vector<box>& anchors, const int input_h, const int input_w) {
@@ -139,35 +362,17 @@ protected:
                     }
 
                     //process cls score
-                    int class_index = 0;
                     float class_score = -FLT_MAX;
-                    for (int s = 0; s <= class_num_ - 1; s++) {
-                        if (const float score = feature_ptr[s + 5]; score > class_score) {
-                            class_index = s;
-                            class_score = score;
-                        }
+                    const int class_index = argmax(feature_ptr + 5, class_num_, class_score);
+                    if (class_score < prob_logic_threshold_ - LOGIT_MARGIN) {
+                        feature_ptr += (class_num_ + 5);
+                        continue;
                     }
 
                     //process box score
                     const float box_score = feature_ptr[4];
                     if (const float final_score = sigmoid(box_score) * sigmoid(class_score); final_score >= prob_threshold_) {
-                        const float dx = sigmoid(feature_ptr[0]);
-                        const float dy = sigmoid(feature_ptr[1]);
-                        const float dw = sigmoid(feature_ptr[2]);
-                        const float dh = sigmoid(feature_ptr[3]);
-                        const float pred_cx = (dx * 2.f - 0.5f + static_cast<float>(w)) * static_cast<float>(stride);
-                        const float pred_cy = (dy * 2.f - 0.5f + static_cast<float>(h)) * static_cast<float>(stride);
-                        const float anchor_w = anchors[a].w;
-                        const float anchor_h = anchors[a].h;
-                        const float pred_w = dw * dw * 4.f * anchor_w;
-                        const float pred_h = dh * dh * 4.f * anchor_h;
-                        const float x0 = pred_cx - pred_w * 0.5f;
-                        const float y0 = pred_cy - pred_h * 0.5f;
-                        const float x1 = pred_cx + pred_w * 0.5f;
-                        const float y1 = pred_cy + pred_h * 0.5f;
-
-                        object obj{{x0, y0, x1 - x0, y1 - y0}, final_score, class_index};
-                        this->objects_.push_back(obj);
+                        decode(feature_ptr, h, w, stride, anchors[a], final_score, class_index);
                     }
 
                     feature_ptr += (class_num_ + 5);
@@ -176,6 +381,27 @@ protected:
         }
     }
 
+    // the box of 'anchor' at the cell (h, w) from its 4 offset logits
+    void decode(const float* offsets, const int h, const int w, const int stride, const box& anchor, const float score, const int label) {
+        const float dx = sigmoid(offsets[0]);
+        const float dy = sigmoid(offsets[1]);
+        const float dw = sigmoid(offsets[2]);
+        const float dh = sigmoid(offsets[3]);
+        const float pred_cx = (dx * 2.f - 0.5f + static_cast<float>(w)) * static_cast<float>(stride);
+        const float pred_cy = (dy * 2.f - 0.5f + static_cast<float>(h)) * static_cast<float>(stride);
+        const float anchor_w = anchor.w;
+        const float anchor_h = anchor.h;
+        const float pred_w = dw * dw * 4.f * anchor_w;
+        const float pred_h = dh * dh * 4.f * anchor_h;
+        const float x0 = pred_cx - pred_w * 0.5f;
+        const float y0 = pred_cy - pred_h * 0.5f;
+        const float x1 = pred_cx + pred_w * 0.5f;
+        const float y1 = pred_cy + pred_h * 0.5f;
+
+        object obj{{x0, y0, x1 - x0, y1 - y0}, score, label};
+        this->objects_.push_back(obj);
+    }
+
     static std::vector<object> pick(std::vector<object>& proposals, const float nms_threshold, const int input_h, const int input_w, const int src_h, const int src_w)
     {
         std::vector<object> objects;
@@ -243,6 +469,7 @@ private:
     float prob_threshold_;
     float prob_logic_threshold_;
     float iou_threshold_;
+    size_t max_candidates_ = 0;
     std::vector<object> objects_;
 };
 
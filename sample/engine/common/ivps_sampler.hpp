@@ -0,0 +1,201 @@
+/**************************************************************************************************
+ *
+ * Copyright (c) 2019-2024 Axera Semiconductor Co., Ltd. All Rights Reserved.
+ *
+ * This source file is the property of Axera Semiconductor Co., Ltd. and
+ * may not be copied or distributed in any isomorphic form without the prior
+ * written consent of Axera Semiconductor Co., Ltd.
+ *
+ **************************************************************************************************/
+
+#pragma once
+
+#include <axcl.h>
+#include <axcl_sys.h>
+#include <axcl_ivps.h>
+
+#include <opencv2/opencv.hpp>
+
+#include <cstdio>
+#include <cstring>
+#include <tuple>
+#include <vector>
+
+namespace preprocess {
+
+enum class ivps_engine {
+    tdp,
+    vpp,
+    vgp,
+};
+
+// letterbox, resize and color conversion on the device: a NV12 frame, uploaded or straight from VDEC, is resized by
+// IVPS with centered padding into the device input buffer of the model, as packed 3 channels of height x width
+class ivps_sampler {
+public:
+    static constexpr uint32_t STRIDE_ALIGN = 16;
+
+    explicit ivps_sampler(const ivps_engine engine = ivps_engine::vpp, const bool swap_rb = false, const uint32_t background = 0)
+        : engine_(engine), swap_rb_(swap_rb), background_(background) {}
+
+    ~ivps_sampler() {
+        this->final();
+    }
+
+    ivps_sampler(const ivps_sampler&) = delete;
+    ivps_sampler& operator=(const ivps_sampler&) = delete;
+
+    // the calling thread must be on the device
+    [[nodiscard]] bool init() {
+        if (this->is_initialized_) {
+            return true;
+        }
+        if (const auto ret = AXCL_SYS_Init(); 0 != ret) {
+            fprintf(stderr, "Init axcl sys failed{0x%08X}.\n", ret);
+            return false;
+        }
+        if (const auto ret = AXCL_IVPS_Init(); 0 != ret) {
+            fprintf(stderr, "Init axcl ivps failed{0x%08X}.\n", ret);
+            std::ignore = AXCL_SYS_Deinit();
+            return false;
+        }
+        this->is_initialized_ = true;
+        return true;
+    }
+
+    void final() {
+        if (nullptr != this->frame_buffer_) {
+            std::ignore = axclrtFree(this->frame_buffer_);
+            this->frame_buffer_ = nullptr;
+            this->frame_buffer_size_ = 0;
+        }
+        if (this->is_initialized_) {
+            std::ignore = AXCL_IVPS_Deinit();
+            std::ignore = AXCL_SYS_Deinit();
+            this->is_initialized_ = false;
+        }
+    }
+
+    // BGR image to NV12 on the host, width and height are cropped to even
+    static void to_nv12(const cv::Mat& bgr, std::vector<uint8_t>& nv12, uint32_t& width, uint32_t& height) {
+        width = static_cast<uint32_t>(bgr.cols) & ~1u;
+        height = static_cast<uint32_t>(bgr.rows) & ~1u;
+
+        cv::Mat i420;
+        cv::cvtColor(bgr(cv::Rect(0, 0, static_cast<int>(width), static_cast<int>(height))), i420, cv::COLOR_BGR2YUV_I420);
+
+        const size_t y_size = static_cast<size_t>(width) * height;
+        nv12.resize(y_size * 3 / 2);
+        std::memcpy(nv12.data(), i420.data, y_size);
+
+        const uint8_t* u = i420.data + y_size;
+        const uint8_t* v = u + y_size / 4;
+        uint8_t* uv = nv12.data() + y_size;
+        for (size_t i = 0; i < y_size / 4; i++) {
+            uv[2 * i] = u[i];
+            uv[2 * i + 1] = v[i];
+        }
+    }
+
+    // uploads a host NV12 image into the frame buffer of the sampler, rows are padded to the IVPS stride
+    [[nodiscard]] bool upload(const uint8_t* nv12, const uint32_t& width, const uint32_t& height, AX_VIDEO_FRAME_T& frame) {
+        const uint32_t stride = (width + STRIDE_ALIGN - 1) / STRIDE_ALIGN * STRIDE_ALIGN;
+        const uint64_t size = static_cast<uint64_t>(stride) * height * 3 / 2;
+
+        if (this->frame_buffer_size_ < size) {
+            if (nullptr != this->frame_buffer_) {
+                std::ignore = axclrtFree(this->frame_buffer_);
+                this->frame_buffer_ = nullptr;
+            }
+            if (const auto ret = axclrtMalloc(&this->frame_buffer_, size, AXCL_MEM_MALLOC_NORMAL_ONLY); 0 != ret) {
+                fprintf(stderr, "Memory allocation for NV12 frame failed{0x%08X}.\n", ret);
+                this->frame_buffer_size_ = 0;
+                return false;
+            }
+            this->frame_buffer_size_ = size;
+        }
+
+        // rows are padded on the host, so the frame goes to the device by a single copy
+        const uint8_t* data = nv12;
+        if (stride != width) {
+            this->padded_.resize(size);
+            for (uint32_t row = 0; row < height * 3 / 2; row++) {
+                std::memcpy(this->padded_.data() + static_cast<uint64_t>(row) * stride, nv12 + static_cast<uint64_t>(row) * width, width);
+            }
+            data = this->padded_.data();
+        }
+        if (const auto ret = axclrtMemcpy(this->frame_buffer_, data, size, AXCL_MEMCPY_HOST_TO_DEVICE); 0 != ret) {
+            fprintf(stderr, "Copy NV12 frame to device failed{0x%08X}.\n", ret);
+            return false;
+        }
+
+        std::memset(&frame, 0, sizeof(frame));
+        frame.u32Width = width;
+        frame.u32Height = height;
+        frame.enImgFormat = AX_FORMAT_YUV420_SEMIPLANAR;
+        frame.u32PicStride[0] = stride;
+        frame.u32PicStride[1] = stride;
+        frame.u64PhyAddr[0] = reinterpret_cast<AX_U64>(this->frame_buffer_);
+        frame.u64PhyAddr[1] = frame.u64PhyAddr[0] + static_cast<uint64_t>(stride) * height;
+        frame.u32FrameSize = static_cast<AX_U32>(size);
+        for (auto& id : frame.u32BlkId) {
+            id = AX_INVALID_BLOCKID;
+        }
+
+        return true;
+    }
+
+    // letterboxes 'src' into 'dst', the device input buffer of width x height x 3 bytes
+    [[nodiscard]] bool operator()(const AX_VIDEO_FRAME_T& src, void* dst, const uint32_t& width, const uint32_t& height) const {
+        AX_VIDEO_FRAME_T frame;
+        std::memset(&frame, 0, sizeof(frame));
+        frame.u32Width = width;
+        frame.u32Height = height;
+        // by ax_global_type.h, AX_FORMAT_RGB888 is laid out as BGRBGR..., the same as cv::Mat of the host path
+        frame.enImgFormat = this->swap_rb_ ? AX_FORMAT_BGR888 : AX_FORMAT_RGB888;
+        frame.u32PicStride[0] = width;
+        frame.u64PhyAddr[0] = reinterpret_cast<AX_U64>(dst);
+        frame.u32FrameSize = width * height * 3;
+        for (auto& id : frame.u32BlkId) {
+            id = AX_INVALID_BLOCKID;
+        }
+
+        AX_IVPS_ASPECT_RATIO_T aspect;
+        std::memset(&aspect, 0, sizeof(aspect));
+        aspect.eMode = AX_IVPS_ASPECT_RATIO_AUTO;
+        aspect.nBgColor = this->background_;
+        aspect.eAligns[0] = AX_IVPS_ASPECT_RATIO_HORIZONTAL_CENTER;
+        aspect.eAligns[1] = AX_IVPS_ASPECT_RATIO_VERTICAL_CENTER;
+
+        AX_S32 ret = 0;
+        switch (this->engine_) {
+        case ivps_engine::tdp:
+            ret = AXCL_IVPS_CropResizeTdp(&src, &frame, &aspect);
+            break;
+        case ivps_engine::vpp:
+            ret = AXCL_IVPS_CropResizeVpp(&src, &frame, &aspect);
+            break;
+        case ivps_engine::vgp:
+            ret = AXCL_IVPS_CropResizeVgp(&src, &frame, &aspect);
+            break;
+        }
+        if (0 != ret) {
+            fprintf(stderr, "IVPS letterbox of frame{%ux%u} to {%ux%u} failed{0x%08X}.\n", src.u32Width, src.u32Height, width, height, ret);
+            return false;
+        }
+
+        return true;
+    }
+
+private:
+    ivps_engine engine_{ivps_engine::vpp};
+    bool swap_rb_{false};
+    uint32_t background_{0};
+
+    bool is_initialized_{false};
+    void* frame_buffer_{nullptr};
+    uint64_t frame_buffer_size_{0};
+    std::vector<uint8_t> padded_;
+};
+
+} // namespace preprocess
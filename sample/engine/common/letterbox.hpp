@@ -0,0 +1,363 @@
+/**************************************************************************************************
+ *
+ * Copyright (c) 2019-2024 Axera Semiconductor Co., Ltd. All Rights Reserved.
+ *
+ * This source file is the property of Axera Semiconductor Co., Ltd. and
+ * may not be copied or distributed in any isomorphic form without the prior
+ * written consent of Axera Semiconductor Co., Ltd.
+ *
+ **************************************************************************************************/
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <vector>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+#if defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+namespace preprocess {
+
+enum class layout {
+    nhwc,
+    nchw,
+};
+
+// letterbox of a packed BGR image in one pass over the output: each output row is resized into the centered roi,
+// padded, B/R swapped, laid out as NHWC or NCHW and, for float output, normalized while it is still in cache.
+// the resize reproduces cv::resize of INTER_LINEAR on 8 bits images, as sampler of crop_type::letterbox uses it:
+// 11 bits fixed-point weights, the vertical rounding of the 128 bits SIMD rows and the scalar tail, the 2x area
+// shortcut and the same size copy; the AVX2, NEON and scalar paths give the same bytes
+class fused_letterbox {
+public:
+    static constexpr int COEF_BITS = 11;
+    static constexpr int COEF_SCALE = 1 << COEF_BITS;
+
+    fused_letterbox(const int src_w, const int src_h, const int dst_w, const int dst_h, const bool swap_rb = false,
+                    const layout layout = layout::nhwc, const std::array<uint8_t, 3>& background = {0, 0, 0})
+        : src_w_(src_w), src_h_(src_h), dst_w_(dst_w), dst_h_(dst_h), swap_rb_(swap_rb), layout_(layout), background_(background) {
+        // the same roi as sampler::get_letterbox_rect
+        const auto width_ratio = static_cast<float>(dst_w) / static_cast<float>(src_w);
+        const auto height_ratio = static_cast<float>(dst_h) / static_cast<float>(src_h);
+        if (width_ratio < height_ratio) {
+            this->roi_h_ = static_cast<int>(std::roundf(static_cast<float>(src_h) * width_ratio));
+            this->roi_w_ = dst_w;
+            this->roi_y_ = (dst_h - this->roi_h_) / 2;
+        } else {
+            this->roi_w_ = static_cast<int>(std::roundf(static_cast<float>(src_w) * height_ratio));
+            this->roi_h_ = dst_h;
+            this->roi_x_ = (dst_w - this->roi_w_) / 2;
+        }
+
+        const int width = this->roi_w_ * 3;
+        this->line_.resize(width);
+
+        const double scale_x = 1. / (static_cast<double>(this->roi_w_) / src_w);
+        const double scale_y = 1. / (static_cast<double>(this->roi_h_) / src_h);
+
+        if (this->roi_w_ == src_w && this->roi_h_ == src_h) {
+            this->mode_ = mode::copy;
+            return;
+        }
+        if (constexpr auto epsilon = std::numeric_limits<double>::epsilon(); std::abs(scale_x - 2.) < epsilon && std::abs(scale_y - 2.) < epsilon) {
+            this->mode_ = mode::area;
+            return;
+        }
+        this->mode_ = mode::linear;
+
+        this->x_offset_.resize(width * 2);
+        this->alpha_.resize(width * 2);
+        for (int dx = 0; dx < this->roi_w_; dx++) {
+            auto fx = static_cast<float>((dx + 0.5) * scale_x - 0.5);
+            int sx = static_cast<int>(std::floor(fx));
+            fx -= static_cast<float>(sx);
+            if (sx < 0) {
+                fx = 0.f, sx = 0;
+            }
+            if (sx >= src_w - 1) {
+                fx = 0.f, sx = src_w - 1;
+            }
+            const auto a0 = static_cast<int32_t>(std::lrint((1.f - fx) * COEF_SCALE));
+            const auto a1 = static_cast<int32_t>(std::lrint(fx * COEF_SCALE));
+            for (int c = 0; c < 3; c++) {
+                const int x = dx * 3 + c;
+                this->x_offset_[2 * x] = sx * 3 + c;
+                this->x_offset_[2 * x + 1] = std::min(sx + 1, src_w - 1) * 3 + c;
+                this->alpha_[2 * x] = a0;
+                this->alpha_[2 * x + 1] = a1;
+            }
+        }
+
+        this->y_offset_.resize(this->roi_h_ * 2);
+        this->beta_.resize(this->roi_h_ * 2);
+        for (int dy = 0; dy < this->roi_h_; dy++) {
+            auto fy = static_cast<float>((dy + 0.5) * scale_y - 0.5);
+            const int sy = static_cast<int>(std::floor(fy));
+            fy -= static_cast<float>(sy);
+            this->y_offset_[2 * dy] = std::clamp(sy, 0, src_h - 1);
+            this->y_offset_[2 * dy + 1] = std::clamp(sy + 1, 0, src_h - 1);
+            this->beta_[2 * dy] = static_cast<int16_t>(std::lrint((1.f - fy) * COEF_SCALE));
+            this->beta_[2 * dy + 1] = static_cast<int16_t>(std::lrint(fy * COEF_SCALE));
+        }
+
+        // cv::resize rounds the vertical sums of 16 and then 8 elements by its SIMD formula, and the rest by the scalar one
+        this->simd_width_ = width / 16 * 16;
+        if (width - this->simd_width_ > 8) {
+            this->simd_width_ += 8;
+        }
+        for (auto& row : this->rows_) {
+            row.resize(width);
+        }
+    }
+
+    fused_letterbox(const fused_letterbox&) = delete;
+    fused_letterbox& operator=(const fused_letterbox&) = delete;
+
+    // the scalar path only, for checking and measuring the vectorized one
+    void enable_simd(const bool enable) {
+        this->simd_ = enable;
+    }
+
+    [[nodiscard]] std::array<int, 4> get_roi() const {
+        return {this->roi_x_, this->roi_y_, this->roi_w_, this->roi_h_};
+    }
+
+    // 'src' is src_h rows of 'src_step' bytes, 'dst' takes dst_h x dst_w x 3 bytes
+    void operator()(const uint8_t* src, const size_t src_step, uint8_t* dst) {
+        this->run(src, src_step, [this, dst](const int y, const uint8_t* line) { this->store(y, line, dst); });
+    }
+
+    // as above, with each output channel c normalized as (value - mean[c]) * scale[c], in the output channel order
+    void operator()(const uint8_t* src, const size_t src_step, float* dst, const std::array<float, 3>& mean, const std::array<float, 3>& scale) {
+        this->run(src, src_step, [this, dst, &mean, &scale](const int y, const uint8_t* line) { this->store(y, line, dst, mean, scale); });
+    }
+
+private:
+    enum class mode {
+        copy,
+        area,
+        linear,
+    };
+
+    template<typename F>
+    void run(const uint8_t* src, const size_t src_step, F&& store) {
+        for (auto& tag : this->row_tags_) {
+            tag = -1;
+        }
+
+        for (int y = 0; y < this->dst_h_; y++) {
+            const int dy = y - this->roi_y_;
+            if (dy < 0 || dy >= this->roi_h_) {
+                store(y, nullptr);
+                continue;
+            }
+
+            switch (this->mode_) {
+            case mode::copy:
+                store(y, src + static_cast<size_t>(dy) * src_step);
+                break;
+            case mode::area:
+                this->area_row(src + static_cast<size_t>(2 * dy) * src_step, src + static_cast<size_t>(2 * dy + 1) * src_step);
+                store(y, this->line_.data());
+                break;
+            case mode::linear: {
+                const auto s0 = this->horizontal_row(src, src_step, this->y_offset_[2 * dy], -1);
+                const auto s1 = this->horizontal_row(src, src_step, this->y_offset_[2 * dy + 1], s0);
+                this->vertical_row(this->rows_[s0].data(), this->rows_[s1].data(), this->beta_[2 * dy], this->beta_[2 * dy + 1]);
+                store(y, this->line_.data());
+                break;
+            }
+            }
+        }
+    }
+
+    void area_row(const uint8_t* s0, const uint8_t* s1) {
+        uint8_t* d = this->line_.data();
+        for (int dx = 0; dx < this->roi_w_; dx++) {
+            for (int c = 0; c < 3; c++) {
+                const int x = dx * 6 + c;
+                d[dx * 3 + c] = static_cast<uint8_t>((s0[x] + s0[x + 3] + s1[x] + s1[x + 3] + 2) >> 2);
+            }
+        }
+    }
+
+    // the slot holding the horizontal pass of source row 'sy', rows are reused while the output walks down
+    int horizontal_row(const uint8_t* src, const size_t src_step, const int sy, const int keep) {
+        for (int i = 0; i < 2; i++) {
+            if (sy == this->row_tags_[i]) {
+                return i;
+            }
+        }
+        const int slot = 0 == keep ? 1 : 0;
+        this->row_tags_[slot] = sy;
+
+        const uint8_t* s = src + static_cast<size_t>(sy) * src_step;
+        int32_t* d = this->rows_[slot].data();
+        const int32_t* offset = this->x_offset_.data();
+        const int32_t* alpha = this->alpha_.data();
+        const int width = this->roi_w_ * 3;
+        for (int x = 0; x < width; x++) {
+            d[x] = s[offset[2 * x]] * alpha[2 * x] + s[offset[2 * x + 1]] * alpha[2 * x + 1];
+        }
+        return slot;
+    }
+
+    void vertical_row(const int32_t* s0, const int32_t* s1, const int16_t b0, const int16_t b1) {
+        uint8_t* d = this->line_.data();
+        const int width = this->roi_w_ * 3;
+        int x = 0;
+
+        if (this->simd_) {
+#if defined(__AVX2__)
+            const __m256i vb0 = _mm256_set1_epi16(b0), vb1 = _mm256_set1_epi16(b1), delta = _mm256_set1_epi16(2);
+            const auto blend = [&](const int i) {
+                // packs works in 128 bits lanes, the permute restores the element order
+                const __m256i x0 = _mm256_permute4x64_epi64(_mm256_packs_epi32(
+                    _mm256_srai_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(s0 + i)), 4),
+                    _mm256_srai_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(s0 + i + 8)), 4)), 0xD8);
+                const __m256i x1 = _mm256_permute4x64_epi64(_mm256_packs_epi32(
+                    _mm256_srai_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(s1 + i)), 4),
+                    _mm256_srai_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(s1 + i + 8)), 4)), 0xD8);
+                const __m256i sum = _mm256_add_epi16(_mm256_mulhi_epi16(x0, vb0), _mm256_mulhi_epi16(x1, vb1));
+                return _mm256_srai_epi16(_mm256_add_epi16(sum, delta), 2);
+            };
+            for (; x + 32 <= this->simd_width_; x += 32) {
+                const __m256i packed = _mm256_packus_epi16(blend(x), blend(x + 16));
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(d + x), _mm256_permute4x64_epi64(packed, 0xD8));
+            }
+#elif defined(__aarch64__)
+            const int16x4_t vb0 = vdup_n_s16(b0), vb1 = vdup_n_s16(b1);
+            const int16x8_t delta = vdupq_n_s16(2);
+            const auto mulhi = [](const int32_t* s, const int16x4_t b) {
+                const int16x8_t v = vcombine_s16(vqmovn_s32(vshrq_n_s32(vld1q_s32(s), 4)), vqmovn_s32(vshrq_n_s32(vld1q_s32(s + 4), 4)));
+                return vcombine_s16(vshrn_n_s32(vmull_s16(vget_low_s16(v), b), 16), vshrn_n_s32(vmull_s16(vget_high_s16(v), b), 16));
+            };
+            for (; x + 16 <= this->simd_width_; x += 16) {
+                const int16x8_t lo = vshrq_n_s16(vaddq_s16(vaddq_s16(mulhi(s0 + x, vb0), mulhi(s1 + x, vb1)), delta), 2);
+                const int16x8_t hi = vshrq_n_s16(vaddq_s16(vaddq_s16(mulhi(s0 + x + 8, vb0), mulhi(s1 + x + 8, vb1)), delta), 2);
+                vst1q_u8(d + x, vcombine_u8(vqmovun_s16(lo), vqmovun_s16(hi)));
+            }
+#endif
+        }
+
+        // the SIMD formula of cv::resize: ((s0 >> 4) * b0 >> 16) + ((s1 >> 4) * b1 >> 16), rounded off by 2 bits
+        for (; x < this->simd_width_; x++) {
+            const auto x0 = static_cast<int16_t>(std::min(s0[x] >> 4, 32767));
+            const auto x1 = static_cast<int16_t>(std::min(s1[x] >> 4, 32767));
+            const auto sum = static_cast<int16_t>(((x0 * b0) >> 16) + ((x1 * b1) >> 16));
+            d[x] = static_cast<uint8_t>(std::clamp((sum + 2) >> 2, 0, 255));
+        }
+        // and its scalar one, rounded off by 22 bits
+        for (; x < width; x++) {
+            d[x] = static_cast<uint8_t>(std::clamp((s0[x] * b0 + s1[x] * b1 + (1 << (2 * COEF_BITS - 1))) >> (2 * COEF_BITS), 0, 255));
+        }
+    }
+
+    [[nodiscard]] int source_channel(const int c) const {
+        return this->swap_rb_ ? 2 - c : c;
+    }
+
+    // 'line' is the resized row of the roi in BGR, nullptr for the rows of padding only
+    void store(const int y, const uint8_t* line, uint8_t* dst) const {
+        const size_t plane = static_cast<size_t>(this->dst_w_) * this->dst_h_;
+        const int roi_begin = nullptr == line ? this->dst_w_ : this->roi_x_;
+        const int roi_end = nullptr == line ? this->dst_w_ : this->roi_x_ + this->roi_w_;
+
+        if (layout::nhwc == this->layout_) {
+            uint8_t* d = dst + static_cast<size_t>(y) * this->dst_w_ * 3;
+            for (int x = 0; x < roi_begin; x++) {
+                std::memcpy(d + x * 3, this->background_.data(), 3);
+            }
+            if (nullptr != line) {
+                uint8_t* r = d + roi_begin * 3;
+                if (!this->swap_rb_) {
+                    std::memcpy(r, line, this->roi_w_ * 3);
+                } else {
+                    for (int x = 0; x < this->roi_w_; x++) {
+                        r[x * 3] = line[x * 3 + 2];
+                        r[x * 3 + 1] = line[x * 3 + 1];
+                        r[x * 3 + 2] = line[x * 3];
+                    }
+                }
+            }
+            for (int x = roi_end; x < this->dst_w_; x++) {
+                std::memcpy(d + x * 3, this->background_.data(), 3);
+            }
+            return;
+        }
+
+        for (int c = 0; c < 3; c++) {
+            uint8_t* d = dst + plane * c + static_cast<size_t>(y) * this->dst_w_;
+            std::memset(d, this->background_[c], roi_begin);
+            if (nullptr != line) {
+                const uint8_t* s = line + this->source_channel(c);
+                for (int x = 0; x < this->roi_w_; x++) {
+                    d[roi_begin + x] = s[x * 3];
+                }
+            }
+            std::memset(d + roi_end, this->background_[c], this->dst_w_ - roi_end);
+        }
+    }
+
+    void store(const int y, const uint8_t* line, float* dst, const std::array<float, 3>& mean, const std::array<float, 3>& scale) const {
+        const size_t plane = static_cast<size_t>(this->dst_w_) * this->dst_h_;
+        const int roi_begin = nullptr == line ? this->dst_w_ : this->roi_x_;
+        const int roi_end = nullptr == line ? this->dst_w_ : this->roi_x_ + this->roi_w_;
+
+        std::array<float, 3> padding{};
+        for (int c = 0; c < 3; c++) {
+            padding[c] = (static_cast<float>(this->background_[c]) - mean[c]) * scale[c];
+        }
+
+        // the layouts only differ by the strides of pixels and channels
+        const bool nhwc = layout::nhwc == this->layout_;
+        const size_t pixel_step = nhwc ? 3 : 1;
+        for (int c = 0; c < 3; c++) {
+            float* d = nhwc ? dst + static_cast<size_t>(y) * this->dst_w_ * 3 + c : dst + plane * c + static_cast<size_t>(y) * this->dst_w_;
+            for (int x = 0; x < roi_begin; x++) {
+                d[x * pixel_step] = padding[c];
+            }
+            if (nullptr != line) {
+                const uint8_t* s = line + this->source_channel(c);
+                float* r = d + roi_begin * pixel_step;
+                for (int x = 0; x < this->roi_w_; x++) {
+                    r[x * pixel_step] = (static_cast<float>(s[x * 3]) - mean[c]) * scale[c];
+                }
+            }
+            for (int x = roi_end; x < this->dst_w_; x++) {
+                d[x * pixel_step] = padding[c];
+            }
+        }
+    }
+
+    int src_w_{0}, src_h_{0};
+    int dst_w_{0}, dst_h_{0};
+    bool swap_rb_{false};
+    layout layout_{layout::nhwc};
+    std::array<uint8_t, 3> background_{0, 0, 0};
+
+    int roi_x_{0}, roi_y_{0}, roi_w_{0}, roi_h_{0};
+    mode mode_{mode::linear};
+    bool simd_{true};
+
+    std::vector<int32_t> x_offset_;
+    std::vector<int32_t> alpha_;
+    std::vector<int32_t> y_offset_;
+    std::vector<int16_t> beta_;
+    int simd_width_{0};
+
+    std::array<std::vector<int32_t>, 2> rows_;
+    std::array<int, 2> row_tags_{-1, -1};
+    std::vector<uint8_t> line_;
+};
+
+} // namespace preprocess
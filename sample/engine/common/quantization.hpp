@@ -0,0 +1,58 @@
+/**************************************************************************************************
+ *
+ * Copyright (c) 2019-2024 Axera Semiconductor Co., Ltd. All Rights Reserved.
+ *
+ * This source file is the property of Axera Semiconductor Co., Ltd. and
+ * may not be copied or distributed in any isomorphic form without the prior
+ * written consent of Axera Semiconductor Co., Ltd.
+ *
+ **************************************************************************************************/
+
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+
+namespace quantization {
+
+// affine quantization of a tensor: real = (code - zero_point) * scale, the scale is positive
+struct param {
+    float scale;
+    int32_t zero_point;
+};
+
+template<typename T>
+inline float dequantize(const T code, const param& p) {
+    static_assert(std::is_integral_v<T>, "quantized codes are integers");
+    return static_cast<float>(static_cast<int32_t>(code) - p.zero_point) * p.scale;
+}
+
+// the smallest code of T which dequantizes to 'value' or above, or the largest code + 1 if none does; as dequantize is
+// monotonic, 'code >= threshold<T>(value, p)' is exactly 'dequantize(code, p) >= value'
+template<typename T>
+inline int32_t threshold(const float value, const param& p) {
+    static_assert(std::is_integral_v<T> && sizeof(T) < sizeof(int32_t), "quantized codes are 8 or 16 bits");
+    constexpr auto lowest = static_cast<int32_t>(std::numeric_limits<T>::lowest());
+    constexpr auto highest = static_cast<int32_t>(std::numeric_limits<T>::max());
+
+    // the estimate is only a start, the rounding of the float math is settled by the two scans below
+    const float estimate = std::ceil(value / p.scale) + static_cast<float>(p.zero_point);
+    int32_t code = highest + 1;
+    if (estimate <= static_cast<float>(lowest)) {
+        code = lowest;
+    } else if (estimate < static_cast<float>(highest + 1)) {
+        code = static_cast<int32_t>(estimate);
+    }
+
+    while (code > lowest && dequantize(static_cast<T>(code - 1), p) >= value) {
+        code--;
+    }
+    while (code <= highest && dequantize(static_cast<T>(code), p) < value) {
+        code++;
+    }
+    return code;
+}
+
+}
@@ -37,6 +37,7 @@ namespace detection {
 
 inline float sigmoid(const float x) { return 1.f / (1.f + std::exp(-x)); }
 
+#if defined(__aarch64__)
 // NOTE: ref from: https://github.com/Tencent/ncnn/blob/master/src/layer/arm/neon_mathfun.h
 static inline float32x4_t exp_ps(float32x4_t x)
 {
@@ -85,9 +86,10 @@ static inline float32x4_t exp_ps(float32x4_t x)
     y = vmulq_f32(y, pow2n);
     return y;
 }
+#endif
 
 inline void sigmoid4f(float* dst, const float* src) {
-#if defined(__AVX__)
+#if defined(__AVX__) && (defined(__INTEL_COMPILER) || defined(_MSC_VER))
     __m128 x = _mm_loadu_ps(src);
     x = _mm_sub_ps(_mm_set1_ps(0.0f), x);
     x = _mm_exp_ps(x);
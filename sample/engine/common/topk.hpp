@@ -10,7 +10,10 @@
 
 #pragma once
 
+#include "common/quantization.hpp"
+
 #include <algorithm>
+#include <numeric>
 #include <vector>
 
 namespace classification {
@@ -39,4 +42,32 @@ inline std::vector<std::pair<float, int>> topK(const float* data, const size_t s
     return results;
 }
 
+// top k of a quantized output: the codes rank as their dequantized scores do, so they are ordered as they are, by a
+// partial sort of the k first only, and just the k picked ones are dequantized; codes of the same value keep the order
+// of their index
+template<typename T>
+std::vector<std::pair<float, int>> topK(const T* data, const size_t size, const int topK, const quantization::param& param, const bool reverse = false) {
+    std::vector<int> indices(size);
+    std::iota(indices.begin(), indices.end(), 0);
+
+    const auto count = std::min(static_cast<size_t>(std::max(topK, 0)), size);
+    const auto middle = indices.begin() + static_cast<std::ptrdiff_t>(count);
+    if (reverse) {
+        std::partial_sort(indices.begin(), middle, indices.end(), [data](const int a, const int b) {
+            return data[a] < data[b] || (data[a] == data[b] && a < b);
+        });
+    } else {
+        std::partial_sort(indices.begin(), middle, indices.end(), [data](const int a, const int b) {
+            return data[a] > data[b] || (data[a] == data[b] && a < b);
+        });
+    }
+
+    std::vector<std::pair<float, int>> results(count);
+    for (size_t i = 0; i < count; ++i) {
+        results[i] = {quantization::dequantize(data[indices[i]], param), indices[i]};
+    }
+
+    return results;
+}
+
 }
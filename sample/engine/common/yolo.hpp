@@ -10,6 +10,9 @@
 
 #pragma once
 
+#include "common/detection.hpp"
+#include "common/quantization.hpp"
+
 #include <cstdint>
 #include <opencv2/opencv.hpp>
 #include <vector>
@@ -58,74 +61,33 @@ namespace yolo
 
         return inter_width * inter_height;
     }
-    static void qsort_descent_inplace(std::vector<BBoxRect>& datas, int left, int right)
+    // descending by score, boxes of the same score keep their order
+    static void sort_descent_inplace(std::vector<BBoxRect>& datas)
     {
-        int i = left;
-        int j = right;
-        float p = datas[(left + right) / 2].score;
-
-        while (i <= j)
-        {
-            while (datas[i].score > p)
-                i++;
-
-            while (datas[j].score < p)
-                j--;
-
-            if (i <= j)
-            {
-                // swap
-                std::swap(datas[i], datas[j]);
-
-                i++;
-                j--;
-            }
-        }
-
-        if (left < j)
-            qsort_descent_inplace(datas, left, j);
-
-        if (i < right)
-            qsort_descent_inplace(datas, i, right);
-    }
-
-    static void qsort_descent_inplace(std::vector<BBoxRect>& datas)
-    {
-        if (datas.empty())
-            return;
-
-        qsort_descent_inplace(datas, 0, (int)(datas.size() - 1));
+        std::stable_sort(datas.begin(), datas.end(), [](const BBoxRect& a, const BBoxRect& b) { return a.score > b.score; });
     }
 
     static void nms_sorted_bboxes(std::vector<BBoxRect>& bboxes, std::vector<size_t>& picked, float nms_threshold)
     {
-        picked.clear();
-
-        const size_t n = bboxes.size();
-
-        for (size_t i = 0; i < n; i++)
-        {
-            const BBoxRect& a = bboxes[i];
-
-            int keep = 1;
-            for (unsigned int j : picked)
+        picked = detection::greedy_nms(
+            bboxes.size(),
+            [&bboxes](const size_t i)
             {
-                const BBoxRect& b = bboxes[j];
+                const BBoxRect& r = bboxes[i];
+                return std::array<float, 4>{r.xmin, r.ymin, r.xmax, r.ymax};
+            },
+            [&bboxes, nms_threshold](const size_t kept, const size_t i)
+            {
+                const BBoxRect& a = bboxes[i];
+                const BBoxRect& b = bboxes[kept];
 
                 // intersection over union
                 float inter_area = intersection_area(a, b);
                 float union_area = a.area + b.area - inter_area;
                 // float IoU = inter_area / union_area
-                if (inter_area > nms_threshold * union_area)
-                {
-                    keep = 0;
-                    break;
-                }
-            }
-
-            if (keep)
-                picked.push_back(i);
-        }
+                return inter_area > nms_threshold * union_area;
+            },
+            nms_threshold);
     }
 
     struct TMat
@@ -168,8 +130,13 @@ namespace yolo
         int init(int version, float nms_threshold = 0.45f, float confidence_threshold = 0.48f, int class_num = 80);
         int forward(const std::vector<TMat>& bottom_blobs, std::vector<TMat>& top_blobs);
         int forward_nhwc(const std::vector<TMat>& bottom_blobs, std::vector<TMat>& top_blobs);
+        // int8 or uint8 blobs, each of its own quantization in 'params'
+        template<typename T>
+        int forward_nhwc(const std::vector<TMat>& bottom_blobs, std::vector<TMat>& top_blobs, const std::vector<quantization::param>& params);
 
     private:
+        int output(std::vector<BBoxRect>& all_bbox_rects, std::vector<TMat>& top_blobs);
+
         int m_num_box;
         int m_num_class;
         int m_anchors_scale[32];
@@ -335,15 +302,12 @@ namespace yolo
                             continue;
                         }
 
-                        int class_index = 0;
                         float class_score = -FLT_MAX;
-                        for (int k = 5; k < m_num_class + 5; ++k)
+                        int class_index = detection::argmax(feature_ptr + 5, m_num_class, class_score);
+                        if (class_score < m_confidence_threshold_unsigmoid - detection::LOGIT_MARGIN)
                         {
-                            if (class_score < feature_ptr[k])
-                            {
-                                class_score = feature_ptr[k];
-                                class_index = k - 5;
-                            }
+                            feature_ptr += (m_num_class + 5);
+                            continue;
                         }
 
                         //sigmoid(box_score) * sigmoid(class_score)
@@ -378,46 +342,87 @@ namespace yolo
             }
         }
 
-        // global sort inplace
-        qsort_descent_inplace(all_bbox_rects);
-
-        // apply nms
-        std::vector<size_t> picked;
-        nms_sorted_bboxes(all_bbox_rects, picked, m_nms_threshold);
+        return output(all_bbox_rects, top_blobs);
+    }
 
-        // select
-        std::vector<BBoxRect> bbox_rects;
+    // the same detections as of forward_nhwc on the dequantized blobs, but the threshold is quantized per blob instead:
+    // boxes are skipped on their codes, and only the ones passing it are dequantized
+    template<typename T>
+    int YoloDetectionOutput::forward_nhwc(const std::vector<TMat>& bottom_blobs, std::vector<TMat>& top_blobs, const std::vector<quantization::param>& params)
+    {
+        if (params.size() != bottom_blobs.size())
+            return -1;
 
-        for (unsigned int z : picked)
+        // gather all box
+        std::vector<BBoxRect> all_bbox_rects;
+        for (size_t b = 0; b < bottom_blobs.size(); b++)
         {
-            bbox_rects.push_back(all_bbox_rects[z]);
-        }
+            const TMat& bottom_top_blobs = bottom_blobs[b];
+            const quantization::param& param = params[b];
+            const int32_t box_threshold = quantization::threshold<T>(m_confidence_threshold_unsigmoid, param);
+            const int32_t class_threshold = quantization::threshold<T>(m_confidence_threshold_unsigmoid - detection::LOGIT_MARGIN, param);
 
-        // fill result
-        int num_detected = (int)(bbox_rects.size());
-        if (num_detected == 0)
-        {
-            top_blobs[0].h = 0;
-            return 0;
-        }
+            int w = bottom_top_blobs.w;
+            int h = bottom_top_blobs.h;
+            size_t mask_offset = b * m_num_box;
+            int net_w = (int)(m_anchors_scale[b] * w);
+            int net_h = (int)(m_anchors_scale[b] * h);
 
-        TMat& top_blob = top_blobs[0];
+            auto feature_ptr = (const T*)bottom_top_blobs.data;
+            for (int i = 0; i < h; i++)
+            {
+                for (int j = 0; j < w; j++)
+                {
+                    for (int box = 0; box < m_num_box; ++box)
+                    {
+                        if ((int32_t)feature_ptr[4] < box_threshold)
+                        {
+                            feature_ptr += (m_num_class + 5);
+                            continue;
+                        }
 
-        for (int i = 0; i < num_detected; i++)
-        {
-            const BBoxRect& r = bbox_rects[i];
-            float score = r.score;
-            float* outptr = top_blob.row(i);
+                        T class_code = 0;
+                        int class_index = detection::argmax(feature_ptr + 5, m_num_class, class_code);
+                        if ((int32_t)class_code < class_threshold)
+                        {
+                            feature_ptr += (m_num_class + 5);
+                            continue;
+                        }
 
-            outptr[0] = (float)r.label; // +1 for prepend background class
-            outptr[1] = score;
-            outptr[2] = r.xmin;
-            outptr[3] = r.ymin;
-            outptr[4] = r.xmax;
-            outptr[5] = r.ymax;
+                        //sigmoid(box_score) * sigmoid(class_score)
+                        float box_score = quantization::dequantize(feature_ptr[4], param);
+                        float class_score = quantization::dequantize(class_code, param);
+                        float confidence_1 = 1.0f / ((1.f + std::exp(-box_score)) * (1.f + std::exp(-class_score)));
+                        if (confidence_1 >= m_confidence_threshold)
+                        {
+                            int biases_index = (int)(m_mask[box + mask_offset]);
+                            const float bias_w = m_biases[biases_index * 2];
+                            const float bias_h = m_biases[biases_index * 2 + 1];
+
+                            // region box
+                            float bbox_cx = ((float)j + sigmoid(quantization::dequantize(feature_ptr[0], param))) / (float)w;
+                            float bbox_cy = ((float)i + sigmoid(quantization::dequantize(feature_ptr[1], param))) / (float)h;
+                            auto bbox_w = (float)(std::exp(quantization::dequantize(feature_ptr[2], param)) * bias_w / (float)net_w);
+                            auto bbox_h = (float)(std::exp(quantization::dequantize(feature_ptr[3], param)) * bias_h / (float)net_h);
+
+                            float bbox_xmin = bbox_cx - bbox_w * 0.5f;
+                            float bbox_ymin = bbox_cy - bbox_h * 0.5f;
+                            float bbox_xmax = bbox_cx + bbox_w * 0.5f;
+                            float bbox_ymax = bbox_cy + bbox_h * 0.5f;
+
+                            float area = bbox_w * bbox_h;
+
+                            BBoxRect c = {confidence_1, bbox_xmin, bbox_ymin, bbox_xmax, bbox_ymax, area, class_index};
+                            all_bbox_rects.push_back(c);
+                        }
+
+                        feature_ptr += (m_num_class + 5);
+                    }
+                }
+            }
         }
-        top_blob.h = num_detected;
-        return 0;
+
+        return output(all_bbox_rects, top_blobs);
     }
 
     int YoloDetectionOutput::forward(const std::vector<TMat>& bottom_blobs, std::vector<TMat>& top_blobs)
@@ -469,6 +474,18 @@ namespace yolo
                 {
                     for (int j = 0; j < w; j++)
                     {
+                        // the confidence below can only pass with the box score above the threshold in logit space
+                        if (box_score_ptr[0] < m_confidence_threshold_unsigmoid - detection::LOGIT_MARGIN)
+                        {
+                            xptr++;
+                            yptr++;
+                            wptr++;
+                            hptr++;
+
+                            box_score_ptr++;
+                            continue;
+                        }
+
                         // find class index with max class score
                         int class_index = 0;
                         float class_score = -FLT_MAX;
@@ -522,8 +539,13 @@ namespace yolo
             }
         }
 
+        return output(all_bbox_rects, top_blobs);
+    }
+
+    int YoloDetectionOutput::output(std::vector<BBoxRect>& all_bbox_rects, std::vector<TMat>& top_blobs)
+    {
         // global sort inplace
-        qsort_descent_inplace(all_bbox_rects);
+        sort_descent_inplace(all_bbox_rects);
 
         // apply nms
         std::vector<size_t> picked;
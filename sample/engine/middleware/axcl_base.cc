@@ -19,12 +19,20 @@
 
 #include <axcl.h>
 
+#include <map>
 #include <mutex>
 
 static int static_module_count{0};
 static std::mutex static_module_mutex;
 
-static bool module_init(const std::string& config, const uint32_t& index, const middleware::axcl_base::npu_func& func) {
+// initialized devices, keyed by device index
+struct device_entry {
+    int32_t id = 0;
+    int count = 0;
+};
+static std::map<uint32_t, device_entry> static_devices;
+
+static bool module_init(const std::string& config) {
     // 1. init axcl, using scalar_guard to ensure the finalization
     const auto cfg_flag = utilities::exists(config) && utilities::is_regular_file(config);
     utilities::glog.print(utilities::log::type::info, "axcl initializing...\n");
@@ -44,7 +52,13 @@ static bool module_init(const std::string& config, const uint32_t& index, const
     }
     utilities::glog.print(utilities::log::type::info, "axcl inited.\n");
 
-    // 3. get device list
+    // 3. disengage guard of env
+    env_guard.get() = -1;
+    return true;
+}
+
+static bool device_init(const uint32_t& index, const middleware::axcl_base::npu_func& func, device_entry& entry) {
+    // 1. get device list
     axclrtDeviceList lst;
     if (const auto ret = axclrtGetDeviceList(&lst); 0 != ret || 0 == lst.num) {
         utilities::glog.print(utilities::log::type::error,
@@ -52,14 +66,14 @@ static bool module_init(const std::string& config, const uint32_t& index, const
         return false;
     }
 
-    // 4. check the device index
+    // 2. check the device index
     if (index >= lst.num) {
         utilities::glog.print(utilities::log::type::error,
             "Specified device index{%d} is out of range{total %d}.\n", index, lst.num);
         return false;
     }
 
-    // 5. set device
+    // 3. set device
     if (const auto ret = axclrtSetDevice(lst.devices[index]); 0 != ret) {
         utilities::glog.print(utilities::log::type::error,
             "Set axcl device as index{%d} failed{0x%08X}.\n", index, ret);
@@ -68,59 +82,91 @@ static bool module_init(const std::string& config, const uint32_t& index, const
     utilities::glog.print(utilities::log::type::info,
         "Select axcl device{index: %d} as {%d}.\n", index, lst.devices[index]);
 
-    // 6. init NPU
+    // 4. init NPU of the device
     if (!func()) {
         utilities::glog.print(utilities::log::type::error, "Init NPU failed.\n");
         return false;
     }
 
-    // 7. disengage guard of env
-    env_guard.get() = -1;
+    entry.id = lst.devices[index];
     return true;
 }
 
-static bool module_final(const middleware::axcl_base::npu_func& func) {
-    const auto flag = func();
-    const auto ret = axclFinalize();
-    return flag && (0 == ret);
-}
-
 bool middleware::axcl_base::init(const std::string &config, const uint32_t &index, const npu_func &func) {
-    bool flag = false;
-    {
-        std::lock_guard lock(static_module_mutex);
+    std::lock_guard lock(static_module_mutex);
+
+    if (static_module_count == 0 && !module_init(config)) {
+        return false;
+    }
+
+    // the NPU of every device is inited once, later runners on the device only select it
+    auto flag = true;
+    auto& entry = static_devices[index];
+    if (0 == entry.count) {
+        flag = device_init(index, func, entry);
+    } else if (const auto ret = axclrtSetDevice(entry.id); 0 != ret) {
+        utilities::glog.print(utilities::log::type::error, "Set axcl device as index{%d} failed{0x%08X}.\n", index, ret);
+        flag = false;
+    }
+
+    if (!flag) {
+        if (0 == entry.count) {
+            static_devices.erase(index);
+        }
         if (static_module_count == 0) {
-            flag = module_init(config, index, func);
-            if (flag) {
-                static_module_count++;
-            }
-        } else {
-            static_module_count++;
-            flag = true;
+            std::ignore = axclFinalize();
         }
+        return false;
     }
 
-    return flag;
+    entry.count++;
+    static_module_count++;
+    return true;
 }
 
-bool middleware::axcl_base::final(const npu_func& func) {
-    bool flag = false;
-    {
-        std::lock_guard lock(static_module_mutex);
-        if (static_module_count == 1) {
-            flag = module_final(func);
-            if (flag) {
-                static_module_count--;
-            }
-        } else if (static_module_count > 1) {
-            static_module_count--;
-            flag = true;
-        }
+bool middleware::axcl_base::final(const uint32_t& index, const npu_func& func) {
+    std::lock_guard lock(static_module_mutex);
+
+    auto it = static_devices.find(index);
+    if (static_devices.end() == it || static_module_count <= 0) {
+        return false;
+    }
+
+    auto flag = true;
+    if (1 == it->second.count) {
+        flag &= 0 == axclrtSetDevice(it->second.id);
+        flag &= func();
+        static_devices.erase(it);
+    } else {
+        it->second.count--;
+    }
+
+    if (1 == static_module_count) {
+        flag &= 0 == axclFinalize();
     }
+    static_module_count--;
 
     return flag;
 }
 
+uint32_t middleware::axcl_base::get_device_count() {
+    uint32_t count = 0;
+    if (const auto ret = axclrtGetDeviceCount(&count); 0 != ret) {
+        utilities::glog.print(utilities::log::type::error, "Get axcl device count failed{0x%08X}.\n", ret);
+        return 0;
+    }
+    return count;
+}
+
+intmax_t middleware::axcl_base::get_device_utilization(const int32_t& device) {
+    axclrtUtilizationInfo info{};
+    if (const auto ret = axclrtGetDeviceUtilizationRate(device, &info); 0 != ret) {
+        utilities::glog.print(utilities::log::type::error, "Get utilization of device{%d} failed{0x%08X}.\n", device, ret);
+        return -1;
+    }
+    return info.npuUtilization;
+}
+
 bool middleware::axcl_base::flush_input() const {
     return true;
 }
@@ -129,6 +175,38 @@ bool middleware::axcl_base::invalidate_output() const {
     return true;
 }
 
+bool middleware::axcl_base::upload(const uint32_t& slot, const uint32_t& index, const void* data, const uintmax_t& size) const {
+    void* address = this->get_slot_input_pointer(slot, index);
+    if (nullptr == address) {
+        utilities::glog.print(utilities::log::type::error, "Input tensor{slot: %d, index: %d} is not found.\n", slot, index);
+        return false;
+    }
+
+    if (const auto ret = axclrtMemcpy(address, data, size, AXCL_MEMCPY_HOST_TO_DEVICE); 0 != ret) {
+        utilities::glog.print(utilities::log::type::error,
+            "Upload tensor{slot: %d, index: %d, size: %ld} failed{0x%08X}.\n", slot, index, size, ret);
+        return false;
+    }
+
+    return true;
+}
+
+bool middleware::axcl_base::download(const uint32_t& slot, const uint32_t& index, void* data, const uintmax_t& size) const {
+    void* address = this->get_slot_output_pointer(slot, index);
+    if (nullptr == address) {
+        utilities::glog.print(utilities::log::type::error, "Output tensor{slot: %d, index: %d} is not found.\n", slot, index);
+        return false;
+    }
+
+    if (const auto ret = axclrtMemcpy(data, address, size, AXCL_MEMCPY_DEVICE_TO_HOST); 0 != ret) {
+        utilities::glog.print(utilities::log::type::error,
+            "Download tensor{slot: %d, index: %d, size: %ld} failed{0x%08X}.\n", slot, index, size, ret);
+        return false;
+    }
+
+    return true;
+}
+
 [[nodiscard]] bool middleware::axcl_base::feed(const std::string& input_folder, const std::string& stimulus_name) const {
     for (uint32_t i = 0; i < this->get_input_count(); i++) {
         if (const auto ret = feed(input_folder, stimulus_name, this->get_input_name(i), this->get_input_pointer(i), this->get_input_size(i) * this->get_batch_size()); !ret) {
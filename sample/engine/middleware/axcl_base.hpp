@@ -22,12 +22,20 @@ class axcl_base : public runner {
 public:
     using npu_func = std::function<bool()>;
 
+    // axcl is inited by the first runner and finalized by the last one, the NPU of each device likewise,
+    // init() leaves the calling thread on the device
     [[nodiscard]] static bool init(const std::string& config, const uint32_t& index, const npu_func& func);
-    [[nodiscard]] static bool final(const npu_func& func);
+    [[nodiscard]] static bool final(const uint32_t& index, const npu_func& func);
+
+    [[nodiscard]] static uint32_t get_device_count();
+    [[nodiscard]] static intmax_t get_device_utilization(const int32_t& device);
 
     [[nodiscard]] bool flush_input() const override;
     [[nodiscard]] bool invalidate_output() const override;
 
+    [[nodiscard]] bool upload(const uint32_t& slot, const uint32_t& index, const void* data, const uintmax_t& size) const override;
+    [[nodiscard]] bool download(const uint32_t& slot, const uint32_t& index, void* data, const uintmax_t& size) const override;
+
     [[nodiscard]] bool feed(const std::string& input_folder, const std::string& stimulus_name) const override;
     [[nodiscard]] bool verify(const std::string& output_folder, const std::string& stimulus_name) const override;
     [[nodiscard]] bool save(const std::string& output_folder, const std::string& stimulus_name) const override;
@@ -0,0 +1,65 @@
+/**************************************************************************************************
+ *
+ * Copyright (c) 2019-2024 Axera Semiconductor Co., Ltd. All Rights Reserved.
+ *
+ * This source file is the property of Axera Semiconductor Co., Ltd. and
+ * may not be copied or distributed in any isomorphic form without the prior
+ * written consent of Axera Semiconductor Co., Ltd.
+ *
+ **************************************************************************************************/
+
+#include "middleware/axcl_device_group_impl.hpp"
+
+#if defined(ENV_AXCL_RUNTIME_API_ENABLE) || defined(ENV_AXCL_NATIVE_API_ENABLE)
+middleware::device_group::device_group(factory make_runner) {
+    this->impl_ = new impl(std::move(make_runner));
+}
+
+middleware::device_group::~device_group() {
+    delete this->impl_;
+}
+
+bool middleware::device_group::init(const std::string& config_file, const std::vector<uint32_t>& devices, const uint32_t& kind) {
+    return this->impl_->init(config_file, devices, kind);
+}
+
+bool middleware::device_group::final() {
+    return this->impl_->final();
+}
+
+bool middleware::device_group::load(const std::string& model_path) {
+    return this->impl_->load(model_path);
+}
+
+bool middleware::device_group::prepare(const uint32_t& group, const uint32_t& batch, const uint32_t& depth, const bool& parallel) {
+    return this->impl_->prepare(group, batch, depth, parallel);
+}
+
+bool middleware::device_group::dispatch(const std::vector<const void*>& inputs, const std::vector<void*>& outputs, const policy& how, callback done) {
+    return this->impl_->dispatch(inputs, outputs, how, std::move(done));
+}
+
+void middleware::device_group::drain() const {
+    this->impl_->drain();
+}
+
+uint32_t middleware::device_group::get_device_count() const {
+    return this->impl_->get_device_count();
+}
+
+uint32_t middleware::device_group::get_device_index(const uint32_t& device) const {
+    return this->impl_->get_device_index(device);
+}
+
+middleware::runner& middleware::device_group::get_runner(const uint32_t& device) const {
+    return this->impl_->get_runner(device);
+}
+
+uint64_t middleware::device_group::get_done_count(const uint32_t& device) const {
+    return this->impl_->get_done_count(device);
+}
+
+uint64_t middleware::device_group::get_failed_count(const uint32_t& device) const {
+    return this->impl_->get_failed_count(device);
+}
+#endif
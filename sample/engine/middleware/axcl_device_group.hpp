@@ -0,0 +1,65 @@
+/**************************************************************************************************
+ *
+ * Copyright (c) 2019-2024 Axera Semiconductor Co., Ltd. All Rights Reserved.
+ *
+ * This source file is the property of Axera Semiconductor Co., Ltd. and
+ * may not be copied or distributed in any isomorphic form without the prior
+ * written consent of Axera Semiconductor Co., Ltd.
+ *
+ **************************************************************************************************/
+
+#pragma once
+
+#include "middleware/axcl_base.hpp"
+
+#include <functional>
+#include <memory>
+
+namespace middleware {
+
+#if defined(ENV_AXCL_RUNTIME_API_ENABLE) || defined(ENV_AXCL_NATIVE_API_ENABLE)
+// the same model loaded by one runner on each device, requests are dispatched to the devices and run
+// by a worker thread of each device with 'depth' IO sets in flight
+class device_group final {
+public:
+    enum class policy : uint32_t {
+        round_robin = 0,
+        least_queued = 1,
+    };
+
+    using factory = std::function<std::unique_ptr<runner>()>;
+    // called on the worker thread of 'device' when the request is done
+    using callback = std::function<void(const uint32_t& device, const bool& result)>;
+
+    explicit device_group(factory make_runner);
+    ~device_group();
+
+    device_group(const device_group&) = delete;
+    device_group& operator=(const device_group&) = delete;
+
+    // 'devices' are indexes of axclrtGetDeviceList, empty takes all devices
+    [[nodiscard]] bool init(const std::string& config_file, const std::vector<uint32_t>& devices, const uint32_t& kind);
+    [[nodiscard]] bool final();
+
+    [[nodiscard]] bool load(const std::string& model_path);
+    [[nodiscard]] bool prepare(const uint32_t& group, const uint32_t& batch, const uint32_t& depth, const bool& parallel);
+
+    // queues a request on the device selected by 'how', blocks while that device already has 2 x depth requests;
+    // inputs are host buffers of get_input_size() x batch bytes and must be kept until done, outputs may be empty
+    [[nodiscard]] bool dispatch(const std::vector<const void*>& inputs, const std::vector<void*>& outputs, const policy& how, callback done);
+    // blocks until all dispatched requests are done
+    void drain() const;
+
+    [[nodiscard]] uint32_t get_device_count() const;
+    [[nodiscard]] uint32_t get_device_index(const uint32_t& device) const;
+    [[nodiscard]] runner& get_runner(const uint32_t& device) const;
+    [[nodiscard]] uint64_t get_done_count(const uint32_t& device) const;
+    [[nodiscard]] uint64_t get_failed_count(const uint32_t& device) const;
+
+private:
+    struct impl;
+    impl *impl_;
+};
+#endif
+
+}
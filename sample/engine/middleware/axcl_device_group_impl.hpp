@@ -0,0 +1,312 @@
+/**************************************************************************************************
+ *
+ * Copyright (c) 2019-2024 Axera Semiconductor Co., Ltd. All Rights Reserved.
+ *
+ * This source file is the property of Axera Semiconductor Co., Ltd. and
+ * may not be copied or distributed in any isomorphic form without the prior
+ * written consent of Axera Semiconductor Co., Ltd.
+ *
+ **************************************************************************************************/
+
+#pragma once
+
+#include "middleware/axcl_device_group.hpp"
+
+#include "utilities/log.hpp"
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+#if defined(ENV_AXCL_RUNTIME_API_ENABLE) || defined(ENV_AXCL_NATIVE_API_ENABLE)
+struct middleware::device_group::impl {
+    explicit impl(factory make_runner) : make_runner_(std::move(make_runner)) {}
+
+    ~impl() {
+        std::ignore = this->final();
+    }
+
+    [[nodiscard]] bool init(const std::string& config_file, const std::vector<uint32_t>& devices, const uint32_t& kind) {
+        if (!this->members_.empty()) {
+            utilities::glog.print(utilities::log::type::error, "Device group is already inited.\n");
+            return false;
+        }
+
+        auto add = [&](const uint32_t& index) {
+            auto m = std::make_unique<member>();
+            m->index = index;
+            m->instance = this->make_runner_();
+            if (nullptr == m->instance || !m->instance->init(config_file, index, kind)) {
+                utilities::glog.print(utilities::log::type::error, "Init runner on device{index: %d} failed.\n", index);
+                return false;
+            }
+            this->members_.push_back(std::move(m));
+            return true;
+        };
+
+        // axcl is inited by the first runner, then all devices can be listed
+        const auto first = devices.empty() ? 0 : devices[0];
+        if (!add(first)) {
+            std::ignore = this->final();
+            return false;
+        }
+
+        std::vector<uint32_t> others(devices.begin() + (devices.empty() ? 0 : 1), devices.end());
+        if (devices.empty()) {
+            for (uint32_t i = 1; i < axcl_base::get_device_count(); i++) {
+                others.push_back(i);
+            }
+        }
+
+        for (const auto& index : others) {
+            if (!add(index)) {
+                std::ignore = this->final();
+                return false;
+            }
+        }
+        utilities::glog.print(utilities::log::type::info, "Device group of %d devices inited.\n", this->members_.size());
+
+        return true;
+    }
+
+    [[nodiscard]] bool final() {
+        auto flag = true;
+
+        for (auto& m : this->members_) {
+            {
+                std::lock_guard lock(m->mutex);
+                m->exit = true;
+            }
+            m->cond.notify_all();
+            if (m->worker.joinable()) {
+                m->worker.join();
+            }
+        }
+
+        // release in reverse, the last runner finalizes axcl
+        for (auto it = this->members_.rbegin(); it != this->members_.rend(); ++it) {
+            flag &= (*it)->instance->attach_thread();
+            flag &= (*it)->instance->final();
+        }
+        this->members_.clear();
+
+        return flag;
+    }
+
+    [[nodiscard]] bool load(const std::string& model_path) {
+        for (auto& m : this->members_) {
+            if (!m->instance->attach_thread() || !m->instance->load(model_path)) {
+                utilities::glog.print(utilities::log::type::error, "Load model on device{index: %d} failed.\n", m->index);
+                return false;
+            }
+        }
+        return true;
+    }
+
+    [[nodiscard]] bool prepare(const uint32_t& group, const uint32_t& batch, const uint32_t& depth, const bool& parallel) {
+        if (this->members_.empty()) {
+            utilities::glog.print(utilities::log::type::error, "Device group is not inited.\n");
+            return false;
+        }
+
+        for (auto& m : this->members_) {
+            if (m->worker.joinable()) {
+                utilities::glog.print(utilities::log::type::error, "Device group is already prepared.\n");
+                return false;
+            }
+
+            auto& r = *m->instance;
+            if (!r.attach_thread() || !r.prepare(false, false, group, batch) || !r.prepare_async(depth)) {
+                utilities::glog.print(utilities::log::type::error, "Prepare model on device{index: %d} failed.\n", m->index);
+                return false;
+            }
+
+            m->depth = r.get_async_depth();
+            m->parallel = parallel;
+            m->scratch.resize(r.get_output_count());
+            for (uint32_t i = 0; i < m->scratch.size(); i++) {
+                m->scratch[i].resize(r.get_output_size(i) * r.get_batch_size());
+            }
+        }
+
+        for (auto& m : this->members_) {
+            m->worker = std::thread(&impl::work, m.get());
+        }
+
+        return true;
+    }
+
+    [[nodiscard]] bool dispatch(const std::vector<const void*>& inputs, const std::vector<void*>& outputs, const policy& how, callback done) {
+        if (this->members_.empty() || !this->members_[0]->worker.joinable()) {
+            utilities::glog.print(utilities::log::type::error, "Device group is not prepared.\n");
+            return false;
+        }
+
+        member* target = nullptr;
+        if (policy::least_queued == how) {
+            target = this->members_[0].get();
+            for (auto& m : this->members_) {
+                if (m->load.load(std::memory_order_relaxed) < target->load.load(std::memory_order_relaxed)) {
+                    target = m.get();
+                }
+            }
+        } else {
+            target = this->members_[this->next_.fetch_add(1, std::memory_order_relaxed) % this->members_.size()].get();
+        }
+
+        {
+            std::unique_lock lock(target->mutex);
+            target->cond.wait(lock, [target]() { return target->exit || target->load.load() < 2 * target->depth; });
+            if (target->exit) {
+                return false;
+            }
+            target->queue.push_back({inputs, outputs, std::move(done)});
+            target->load++;
+        }
+        target->cond.notify_all();
+
+        return true;
+    }
+
+    void drain() const {
+        for (auto& m : this->members_) {
+            std::unique_lock lock(m->mutex);
+            m->cond.wait(lock, [&m]() { return m->exit || 0 == m->load.load(); });
+        }
+    }
+
+    [[nodiscard]] uint32_t get_device_count() const {
+        return static_cast<uint32_t>(this->members_.size());
+    }
+
+    [[nodiscard]] uint32_t get_device_index(const uint32_t& device) const {
+        return this->members_.at(device)->index;
+    }
+
+    [[nodiscard]] runner& get_runner(const uint32_t& device) const {
+        return *this->members_.at(device)->instance;
+    }
+
+    [[nodiscard]] uint64_t get_done_count(const uint32_t& device) const {
+        return this->members_.at(device)->done.load();
+    }
+
+    [[nodiscard]] uint64_t get_failed_count(const uint32_t& device) const {
+        return this->members_.at(device)->failed.load();
+    }
+
+private:
+    struct request {
+        std::vector<const void*> inputs;
+        std::vector<void*> outputs;
+        callback done;
+    };
+
+    struct member {
+        uint32_t index = 0;
+        std::unique_ptr<middleware::runner> instance;
+
+        uint32_t depth = 1;
+        bool parallel = false;
+        std::vector<std::vector<uint8_t>> scratch;
+
+        // requests queued or running, read without lock by least_queued dispatching
+        std::atomic<uint32_t> load{0};
+        std::atomic<uint64_t> done{0};
+        std::atomic<uint64_t> failed{0};
+
+        std::deque<request> queue;
+        std::mutex mutex;
+        std::condition_variable cond;
+        std::thread worker;
+        bool exit = false;
+    };
+
+    static bool upload(member* m, const uint32_t& slot, const request& req) {
+        for (uint32_t i = 0; i < req.inputs.size(); i++) {
+            const auto size = m->instance->get_input_size(i) * m->instance->get_batch_size();
+            if (!m->instance->upload(slot, i, req.inputs[i], size)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    static bool download(member* m, const uint32_t& slot, const request& req) {
+        for (uint32_t i = 0; i < m->scratch.size(); i++) {
+            void* data = (i < req.outputs.size() && nullptr != req.outputs[i]) ? req.outputs[i] : m->scratch[i].data();
+            if (!m->instance->download(slot, i, data, m->scratch[i].size())) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    static void finish(member* m, request& req, const bool& result) {
+        (result ? m->done : m->failed)++;
+        if (req.done) {
+            req.done(m->index, result);
+        }
+        {
+            std::lock_guard lock(m->mutex);
+            m->load--;
+        }
+        m->cond.notify_all();
+    }
+
+    // fills free slots from the queue, collects the oldest running slot when no slot is free or nothing is queued
+    static void work(member* m) {
+        if (!m->instance->attach_thread()) {
+            utilities::glog.print(utilities::log::type::error, "Worker of device{index: %d} cannot attach.\n", m->index);
+        }
+
+        std::deque<std::pair<uint32_t, request>> running;
+        std::vector<uint32_t> slots;
+        for (uint32_t i = m->depth; i > 0; i--) {
+            slots.push_back(i - 1);
+        }
+
+        for (;;) {
+            request req;
+            auto fetched = false;
+            {
+                std::unique_lock lock(m->mutex);
+                if (running.empty()) {
+                    m->cond.wait(lock, [m]() { return m->exit || !m->queue.empty(); });
+                    if (m->queue.empty()) {
+                        return;
+                    }
+                }
+                if (!slots.empty() && !m->queue.empty()) {
+                    req = std::move(m->queue.front());
+                    m->queue.pop_front();
+                    fetched = true;
+                }
+            }
+
+            if (fetched) {
+                const auto slot = slots.back();
+                if (upload(m, slot, req) && m->instance->submit(slot, m->parallel)) {
+                    slots.pop_back();
+                    running.emplace_back(slot, std::move(req));
+                } else {
+                    finish(m, req, false);
+                }
+                continue;
+            }
+
+            auto [slot, oldest] = std::move(running.front());
+            running.pop_front();
+            const auto result = m->instance->wait(slot) && download(m, slot, oldest);
+            slots.push_back(slot);
+            finish(m, oldest, result);
+        }
+    }
+
+    factory make_runner_;
+    std::vector<std::unique_ptr<member>> members_;
+    std::atomic<uint32_t> next_{0};
+};
+#endif
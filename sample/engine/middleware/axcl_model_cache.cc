@@ -0,0 +1,173 @@
+/**************************************************************************************************
+ *
+ * Copyright (c) 2019-2024 Axera Semiconductor Co., Ltd. All Rights Reserved.
+ *
+ * This source file is the property of Axera Semiconductor Co., Ltd. and
+ * may not be copied or distributed in any isomorphic form without the prior
+ * written consent of Axera Semiconductor Co., Ltd.
+ *
+ **************************************************************************************************/
+
+#include "middleware/axcl_model_cache.hpp"
+
+#if defined(ENV_AXCL_RUNTIME_API_ENABLE)
+
+#include "utilities/timer.hpp"
+#include "utilities/log.hpp"
+
+#include <axcl.h>
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <utility>
+
+// a model of a device, loaded by the first acquiring; the following ones wait for the loading on its own mutex,
+// so loads of other models and devices are not serialized behind it
+struct model_entry {
+    std::mutex load_mutex;
+    uint64_t model_id = 0;                          // 0 until loaded, set with both mutexes held
+    int count = 0;                                  // acquiring, including the ones waiting for the loading
+    middleware::model_cache::contexts free_contexts; // given back by the released runners
+};
+
+static std::mutex static_cache_mutex;
+static std::map<std::pair<int32_t, std::string>, std::shared_ptr<model_entry>> static_models;
+static middleware::model_cache::statistics static_statistics;
+
+// the caller holds static_cache_mutex
+static auto find_loaded(const int32_t& device, const uint64_t& model_id) {
+    auto it = static_models.begin();
+    for (; it != static_models.end(); ++it) {
+        if (device == it->first.first && model_id == it->second->model_id) {
+            break;
+        }
+    }
+    return it;
+}
+
+bool middleware::model_cache::acquire(const std::string& model_path, uint64_t& model_id) {
+    int32_t device = 0;
+    if (const auto ret = ::axclrtGetDevice(&device); 0 != ret) {
+        utilities::glog.print(utilities::log::type::error, "Get device of model{%s} failed{0x%08X}.\n", model_path.c_str(), ret);
+        return false;
+    }
+
+    std::shared_ptr<model_entry> entry;
+    {
+        std::lock_guard lock(static_cache_mutex);
+        auto& slot = static_models[{device, model_path}];
+        if (nullptr == slot) {
+            slot = std::make_shared<model_entry>();
+        }
+        slot->count++;
+        entry = slot;
+    }
+
+    std::lock_guard load_lock(entry->load_mutex);
+
+    if (0 != entry->model_id) {
+        int64_t sys_size = 0, cmm_size = 0;
+        const auto usage = ::axclrtEngineGetUsageFromModelId(entry->model_id, &sys_size, &cmm_size);
+
+        std::lock_guard lock(static_cache_mutex);
+        if (0 == usage) {
+            static_statistics.cmm_saved += cmm_size;
+        }
+        static_statistics.hits++;
+        model_id = entry->model_id;
+        return true;
+    }
+
+    utilities::timer timer;
+
+    uint64_t id = 0;
+    if (const auto ret = ::axclrtEngineLoadFromFile(model_path.c_str(), &id); 0 != ret) {
+        utilities::glog.print(utilities::log::type::error, "Load model{%s} failed{0x%08X}.\n", model_path.c_str(), ret);
+
+        std::lock_guard lock(static_cache_mutex);
+        if (0 == --entry->count) {
+            static_models.erase({device, model_path});
+        }
+        return false;
+    }
+
+    timer.stop();
+
+    std::lock_guard lock(static_cache_mutex);
+    static_statistics.load_ms += timer.elapsed<utilities::timer::milliseconds>();
+    static_statistics.loads++;
+
+    entry->model_id = id;
+    model_id = id;
+    utilities::glog.print(utilities::log::type::info, "Model{%s} loaded on device{id: %d}.\n", model_path.c_str(), device);
+
+    return true;
+}
+
+bool middleware::model_cache::take_context(const uint64_t& model_id, const uint32_t& affinity, uint64_t& context_id) {
+    int32_t device = 0;
+    if (0 != ::axclrtGetDevice(&device)) {
+        return false;
+    }
+
+    std::lock_guard lock(static_cache_mutex);
+
+    const auto it = find_loaded(device, model_id);
+    if (static_models.end() == it) {
+        return false;
+    }
+
+    const auto pool = it->second->free_contexts.find(affinity);
+    if (it->second->free_contexts.end() == pool || pool->second.empty()) {
+        return false;
+    }
+
+    context_id = pool->second.back();
+    pool->second.pop_back();
+    return true;
+}
+
+bool middleware::model_cache::release(const uint64_t& model_id, const contexts& used) {
+    int32_t device = 0;
+    if (const auto ret = ::axclrtGetDevice(&device); 0 != ret) {
+        utilities::glog.print(utilities::log::type::error, "Get device of model{id: %lu} failed{0x%08X}.\n", model_id, ret);
+        return false;
+    }
+
+    std::string path;
+    {
+        std::lock_guard lock(static_cache_mutex);
+
+        const auto it = find_loaded(device, model_id);
+        if (static_models.end() == it) {
+            utilities::glog.print(utilities::log::type::error, "Model{id: %lu} is not in the cache.\n", model_id);
+            return false;
+        }
+
+        if (0 < --it->second->count) {
+            for (const auto& [affinity, ids] : used) {
+                auto& pool = it->second->free_contexts[affinity];
+                pool.insert(pool.end(), ids.begin(), ids.end());
+            }
+            return true;
+        }
+
+        path = it->first.second;
+        static_models.erase(it);
+    }
+
+    // the contexts are freed with the model
+    if (const auto ret = ::axclrtEngineUnload(model_id); 0 != ret) {
+        utilities::glog.print(utilities::log::type::error, "Unload model{%s} failed{0x%08X}.\n", path.c_str(), ret);
+        return false;
+    }
+
+    return true;
+}
+
+middleware::model_cache::statistics middleware::model_cache::get_statistics() {
+    std::lock_guard lock(static_cache_mutex);
+    return static_statistics;
+}
+#endif
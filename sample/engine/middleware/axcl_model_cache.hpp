@@ -0,0 +1,52 @@
+/**************************************************************************************************
+ *
+ * Copyright (c) 2019-2024 Axera Semiconductor Co., Ltd. All Rights Reserved.
+ *
+ * This source file is the property of Axera Semiconductor Co., Ltd. and
+ * may not be copied or distributed in any isomorphic form without the prior
+ * written consent of Axera Semiconductor Co., Ltd.
+ *
+ **************************************************************************************************/
+
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+#if defined(ENV_AXCL_RUNTIME_API_ENABLE)
+namespace middleware {
+
+// models of the process loaded by the runtime API, keyed by device and model path: each device loads a model
+// once by axclrtEngineLoadFromFile, and every runner only creates its own contexts
+//
+// contexts cannot be destroyed without unloading the model, so a runner gives its contexts back to the cache
+// when releasing the model; they are reused by the next runners of the model and freed when it is unloaded,
+// so a shared model holds as many contexts as its runners held at most at the same time
+class model_cache final {
+public:
+    // contexts keyed by affinity, 0 is the affinity as loaded
+    using contexts = std::map<uint32_t, std::vector<uint64_t>>;
+
+    struct statistics {
+        uint64_t loads = 0;       // models loaded on a device
+        uint64_t hits = 0;        // acquiring served by a loaded model
+        float load_ms = 0.f;      // loading time of all loads
+        intmax_t cmm_saved = 0;   // CMM bytes the hits would have taken on the devices
+    };
+
+    model_cache() = delete;
+
+    // the calling threads must be on the device; loads of different models or devices run in parallel
+    [[nodiscard]] static bool acquire(const std::string& model_path, uint64_t& model_id);
+    // takes a context of the affinity given back by a released runner, false if there is none
+    [[nodiscard]] static bool take_context(const uint64_t& model_id, const uint32_t& affinity, uint64_t& context_id);
+    // gives the contexts back, the model is unloaded with all of its contexts when the last acquiring is released
+    [[nodiscard]] static bool release(const uint64_t& model_id, const contexts& used);
+
+    [[nodiscard]] static statistics get_statistics();
+};
+
+}
+#endif
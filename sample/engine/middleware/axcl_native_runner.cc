@@ -39,6 +39,42 @@ bool middleware::native_runner::run(const bool& parallel) {
     return this->impl_->run(parallel);
 }
 
+bool middleware::native_runner::prepare_async(const uint32_t& depth) {
+    return this->impl_->prepare_async(depth);
+}
+
+uint32_t middleware::native_runner::get_async_depth() const {
+    return this->impl_->get_async_depth();
+}
+
+bool middleware::native_runner::submit(const uint32_t& slot, const bool& parallel) {
+    return this->impl_->submit(slot, parallel);
+}
+
+bool middleware::native_runner::wait(const uint32_t& slot) {
+    return this->impl_->wait(slot);
+}
+
+void *middleware::native_runner::get_slot_input_pointer(const uint32_t& slot, const uint32_t& index) const {
+    return this->impl_->get_slot_input_pointer(slot, index);
+}
+
+void *middleware::native_runner::get_slot_output_pointer(const uint32_t& slot, const uint32_t& index) const {
+    return this->impl_->get_slot_output_pointer(slot, index);
+}
+
+bool middleware::native_runner::set_dynamic_batch(const uint32_t& slot, const uint32_t& batch) {
+    return this->impl_->set_dynamic_batch(slot, batch);
+}
+
+bool middleware::native_runner::attach_thread() const {
+    return this->impl_->attach_thread();
+}
+
+intmax_t middleware::native_runner::get_npu_utilization() const {
+    return this->impl_->get_npu_utilization();
+}
+
 uint32_t middleware::native_runner::get_input_count() const {
     return this->impl_->get_input_count();
 }
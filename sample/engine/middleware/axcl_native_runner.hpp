@@ -29,6 +29,17 @@ public:
 
     [[nodiscard]] bool run(const bool& parallel) override;
 
+    [[nodiscard]] bool prepare_async(const uint32_t& depth) override;
+    [[nodiscard]] uint32_t get_async_depth() const override;
+    [[nodiscard]] bool submit(const uint32_t& slot, const bool& parallel) override;
+    [[nodiscard]] bool wait(const uint32_t& slot) override;
+    [[nodiscard]] void *get_slot_input_pointer(const uint32_t& slot, const uint32_t& index) const override;
+    [[nodiscard]] void *get_slot_output_pointer(const uint32_t& slot, const uint32_t& index) const override;
+
+    [[nodiscard]] bool set_dynamic_batch(const uint32_t& slot, const uint32_t& batch) override;
+    [[nodiscard]] bool attach_thread() const override;
+    [[nodiscard]] intmax_t get_npu_utilization() const override;
+
     [[nodiscard]] uint32_t get_input_count() const override;
     [[nodiscard]] uint32_t get_output_count() const override;
     [[nodiscard]] std::string get_input_name(const uint32_t& index) const override;
@@ -19,6 +19,11 @@
 
 #include <axcl.h>
 
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
 #if defined(ENV_AXCL_NATIVE_API_ENABLE)
 #define MODEL_LEADING_NAME "axcl npu "
 
@@ -55,7 +60,12 @@ struct middleware::native_runner::impl {
             return false;
         }
 
-        // 3. set the flag
+        // 3. keep the device, so other threads can work on it
+        std::ignore = ::axclrtGetCurrentContext(&this->axcl_context_);
+        std::ignore = ::axclrtGetDevice(&this->device_id_);
+        this->device_index_ = index;
+
+        // 4. set the flag
         this->is_initialized_ = true;
         return true;
     }
@@ -65,6 +75,8 @@ struct middleware::native_runner::impl {
 
         if (this->is_initialized_) {
             if (nullptr != this->handle_) {
+                flag &= this->release_slots();
+
                 for (auto& input : inputs_) {
                     if (0 != input.phyAddr) {
                         flag &= 0 == ::axclrtFree(reinterpret_cast<void *>(input.phyAddr));
@@ -81,7 +93,7 @@ struct middleware::native_runner::impl {
                 flag &= 0 == ::AXCL_ENGINE_DestroyHandle(this->handle_);
             }
 
-            flag &= 0 == axcl_base::final([&]() {
+            flag &= 0 == axcl_base::final(this->device_index_, [&]() {
                if (const auto ret = ::AXCL_ENGINE_Deinit(); 0 != ret) {
                    utilities::glog.print(utilities::log::type::error, "Final axcl NPU failed{0x%08X}.\n", ret);
                    return false;
@@ -287,17 +299,7 @@ struct middleware::native_runner::impl {
             return false;
         }
 
-        ::AX_S32 ret = 0;
-        // Note: this is a workaround for the case that the model has only ONE group,
-        //       currently AXCL_ENGINE_GetGroupIOInfo will return error.
-        //       the bug of libax_engine.so will be fixed in the future.
-        if (1 == this->group_count_) {
-            ret = ::AXCL_ENGINE_RunSyncV2(this->handle_, this->context_, &this->io_);
-        } else {
-            ret = ::AXCL_ENGINE_RunGroupIOSync(this->handle_, this->context_, this->group_, &this->io_);
-        }
-        if (0 != ret) {
-            utilities::glog.print(utilities::log::type::error, "Run model failed{0x%08X}.\n", ret);
+        if (!this->execute(this->io_)) {
             return false;
         }
         utilities::glog.print(utilities::log::type::info, "Running done.\n");
@@ -305,6 +307,140 @@ struct middleware::native_runner::impl {
         return true;
     }
 
+    [[nodiscard]] bool prepare_async(const uint32_t& depth) {
+        if (0 == this->io_.nInputSize || 0 == this->io_.nOutputSize) {
+            utilities::glog.print(utilities::log::type::error, "Model io is not set, prepare first.\n");
+            return false;
+        }
+
+        if (0 == depth || depth > max_async_depth) {
+            utilities::glog.print(utilities::log::type::error, "Async depth{%d} is out of range{1 ~ %d}.\n", depth, max_async_depth);
+            return false;
+        }
+
+        if (!this->release_slots()) {
+            return false;
+        }
+
+        // slot 0 shares the IO set of run(), AXCL_ENGINE has no async api, slots are run one by one on a worker
+        this->slots_.resize(depth);
+        for (uint32_t i = 0; i < depth; i++) {
+            auto& slot = this->slots_[i];
+            if (0 == i) {
+                slot.io = this->io_;
+            } else if (!this->create_slot(i, slot)) {
+                std::ignore = this->release_slots();
+                return false;
+            }
+        }
+
+        this->exit_ = false;
+        this->worker_ = std::thread(&impl::work, this);
+        utilities::glog.print(utilities::log::type::info, "%d async IO sets are prepared.\n", depth);
+
+        return true;
+    }
+
+    [[nodiscard]] uint32_t get_async_depth() const {
+        return this->slots_.empty() ? 1 : static_cast<uint32_t>(this->slots_.size());
+    }
+
+    [[nodiscard]] bool submit(const uint32_t& index, const bool& parallel) {
+        if (index >= this->slots_.size()) {
+            utilities::glog.print(utilities::log::type::error,
+                "Slot{%d} is out of range{total %d}, prepare async first.\n", index, this->slots_.size());
+            return false;
+        }
+
+        {
+            std::lock_guard guard(this->mutex_);
+            auto& slot = this->slots_[index];
+            if (slot.pending) {
+                utilities::glog.print(utilities::log::type::error, "Slot{%d} is still running, wait it first.\n", index);
+                return false;
+            }
+
+            slot.io.nParallelRun = (parallel ? 1 : 0);
+            slot.pending = true;
+            slot.done = false;
+            this->queue_.push_back(index);
+        }
+        this->cond_.notify_all();
+
+        return true;
+    }
+
+    [[nodiscard]] bool wait(const uint32_t& index) {
+        if (index >= this->slots_.size()) {
+            utilities::glog.print(utilities::log::type::error, "Slot{%d} is out of range{total %d}.\n", index, this->slots_.size());
+            return false;
+        }
+
+        std::unique_lock lock(this->mutex_);
+        auto& slot = this->slots_[index];
+        if (!slot.pending) {
+            return true;
+        }
+
+        this->cond_.wait(lock, [&slot]() { return slot.done; });
+        slot.pending = false;
+
+        return slot.result;
+    }
+
+    [[nodiscard]] void *get_slot_input_pointer(const uint32_t& index, const uint32_t& tensor) const {
+        if (this->slots_.empty() && 0 == index) {
+            return this->get_input_pointer(tensor);
+        }
+
+        if (index >= this->slots_.size() || tensor >= this->slots_[index].io.nInputSize) {
+            return nullptr;
+        }
+        return reinterpret_cast<void *>(this->slots_[index].io.pInputs[tensor].phyAddr);
+    }
+
+    [[nodiscard]] void *get_slot_output_pointer(const uint32_t& index, const uint32_t& tensor) const {
+        if (this->slots_.empty() && 0 == index) {
+            return this->get_output_pointer(tensor);
+        }
+
+        if (index >= this->slots_.size() || tensor >= this->slots_[index].io.nOutputSize) {
+            return nullptr;
+        }
+        return reinterpret_cast<void *>(this->slots_[index].io.pOutputs[tensor].phyAddr);
+    }
+
+    [[nodiscard]] bool set_dynamic_batch(const uint32_t& index, const uint32_t& batch) {
+        if (0 == batch || batch > this->batch_) {
+            utilities::glog.print(utilities::log::type::error, "Dynamic batch{%d} is out of range{1 ~ %d}.\n", batch, this->batch_);
+            return false;
+        }
+
+        // slot 0 holds a copy of the IO of run()
+        if (0 == index) {
+            this->io_.nBatchSize = batch;
+        }
+        if (index < this->slots_.size()) {
+            this->slots_[index].io.nBatchSize = batch;
+        } else if (0 != index) {
+            utilities::glog.print(utilities::log::type::error, "Slot{%d} is not prepared.\n", index);
+            return false;
+        }
+        return true;
+    }
+
+    [[nodiscard]] bool attach_thread() const {
+        if (const auto ret = ::axclrtSetCurrentContext(this->axcl_context_); 0 != ret) {
+            utilities::glog.print(utilities::log::type::error, "Attach thread to axcl device{%d} failed{0x%08X}.\n", this->device_id_, ret);
+            return false;
+        }
+        return true;
+    }
+
+    [[nodiscard]] intmax_t get_npu_utilization() const {
+        return axcl_base::get_device_utilization(this->device_id_);
+    }
+
     [[nodiscard]] uint32_t get_input_count() const {
         if (nullptr == this->info_) {
             utilities::glog.print(utilities::log::type::error, "Model io info is not set, prepare first.\n");
@@ -488,6 +624,127 @@ struct middleware::native_runner::impl {
     }
 
 private:
+    static constexpr uint32_t max_async_depth = 16;
+
+    struct io_set {
+        ::AX_ENGINE_IO_T io{};
+        std::vector<::AX_ENGINE_IO_BUFFER_T> inputs;
+        std::vector<::AX_ENGINE_IO_BUFFER_T> outputs;
+        bool pending = false;
+        bool done = false;
+        bool result = false;
+    };
+
+    [[nodiscard]] bool execute(::AX_ENGINE_IO_T& io) {
+        ::AX_S32 ret = 0;
+        // Note: this is a workaround for the case that the model has only ONE group,
+        //       currently AXCL_ENGINE_GetGroupIOInfo will return error.
+        //       the bug of libax_engine.so will be fixed in the future.
+        if (1 == this->group_count_) {
+            ret = ::AXCL_ENGINE_RunSyncV2(this->handle_, this->context_, &io);
+        } else {
+            ret = ::AXCL_ENGINE_RunGroupIOSync(this->handle_, this->context_, this->group_, &io);
+        }
+        if (0 != ret) {
+            utilities::glog.print(utilities::log::type::error, "Run model failed{0x%08X}.\n", ret);
+            return false;
+        }
+
+        return true;
+    }
+
+    void work() {
+        if (const auto ret = ::axclrtSetCurrentContext(this->axcl_context_); 0 != ret) {
+            utilities::glog.print(utilities::log::type::error, "Set axcl context for async worker failed{0x%08X}.\n", ret);
+        }
+
+        for (;;) {
+            uint32_t index = 0;
+            {
+                std::unique_lock lock(this->mutex_);
+                this->cond_.wait(lock, [this]() { return this->exit_ || !this->queue_.empty(); });
+                if (this->queue_.empty()) {
+                    return;
+                }
+                index = this->queue_.front();
+                this->queue_.pop_front();
+            }
+
+            auto& slot = this->slots_[index];
+            const auto flag = this->execute(slot.io);
+            {
+                std::lock_guard guard(this->mutex_);
+                slot.result = flag;
+                slot.done = true;
+            }
+            this->cond_.notify_all();
+        }
+    }
+
+    [[nodiscard]] bool create_slot(const uint32_t& index, io_set& slot) {
+        slot.io = this->io_;
+
+        slot.inputs.resize(this->io_.nInputSize, ::AX_ENGINE_IO_BUFFER_T{});
+        for (::AX_U32 i = 0; i < this->io_.nInputSize; i++) {
+            slot.inputs[i].nSize = this->io_.pInputs[i].nSize;
+            if (const auto ret = ::axclrtMalloc(reinterpret_cast<void **>(&slot.inputs[i].phyAddr), slot.inputs[i].nSize,
+                                                ::axclrtMemMallocPolicy{}); 0 != ret) {
+                utilities::glog.print(utilities::log::type::error,
+                    "Memory allocation for slot{%d} tensor {%s} failed{0x%08X}.\n", index, this->info_->pInputs[i].pName, ret);
+                return false;
+            }
+        }
+        slot.io.pInputs = slot.inputs.data();
+
+        slot.outputs.resize(this->io_.nOutputSize, ::AX_ENGINE_IO_BUFFER_T{});
+        for (::AX_U32 i = 0; i < this->io_.nOutputSize; i++) {
+            slot.outputs[i].nSize = this->io_.pOutputs[i].nSize;
+            if (const auto ret = ::axclrtMalloc(reinterpret_cast<void **>(&slot.outputs[i].phyAddr), slot.outputs[i].nSize,
+                                                ::axclrtMemMallocPolicy{}); 0 != ret) {
+                utilities::glog.print(utilities::log::type::error,
+                    "Memory allocation for slot{%d} tensor {%s} failed{0x%08X}.\n", index, this->info_->pOutputs[i].pName, ret);
+                return false;
+            }
+        }
+        slot.io.pOutputs = slot.outputs.data();
+
+        return true;
+    }
+
+    [[nodiscard]] bool release_slots() {
+        auto flag = true;
+
+        if (this->worker_.joinable()) {
+            {
+                std::lock_guard guard(this->mutex_);
+                this->exit_ = true;
+            }
+            this->cond_.notify_all();
+            this->worker_.join();
+        }
+        this->queue_.clear();
+
+        // slot 0 shares the IO set of run()
+        for (size_t i = 1; i < this->slots_.size(); i++) {
+            for (auto& input : this->slots_[i].inputs) {
+                if (0 != input.phyAddr) {
+                    flag &= 0 == ::axclrtFree(reinterpret_cast<void *>(input.phyAddr));
+                }
+            }
+            for (auto& output : this->slots_[i].outputs) {
+                if (0 != output.phyAddr) {
+                    flag &= 0 == ::axclrtFree(reinterpret_cast<void *>(output.phyAddr));
+                }
+            }
+        }
+        this->slots_.clear();
+
+        if (!flag) {
+            utilities::glog.print(utilities::log::type::error, "Release async IO sets failed.\n");
+        }
+        return flag;
+    }
+
     uint32_t group_count_ = 0;
     uint32_t group_ = 0;
     uint32_t batch_ = 0;
@@ -499,6 +756,16 @@ private:
     std::vector<::AX_ENGINE_IO_BUFFER_T> inputs_;
     std::vector<::AX_ENGINE_IO_BUFFER_T> outputs_;
 
+    std::vector<io_set> slots_;
+    std::deque<uint32_t> queue_;
+    std::mutex mutex_;
+    std::condition_variable cond_;
+    std::thread worker_;
+    bool exit_ = false;
+    ::axclrtContext axcl_context_{};
+    int32_t device_id_ = 0;
+    uint32_t device_index_ = 0;
+
     bool is_initialized_ = false;
 };
 #endif
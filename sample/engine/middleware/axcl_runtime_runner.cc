@@ -39,6 +39,46 @@ bool middleware::runtime_runner::run(const bool& parallel) {
     return this->impl_->run(parallel);
 }
 
+bool middleware::runtime_runner::prepare_async(const uint32_t& depth) {
+    return this->impl_->prepare_async(depth);
+}
+
+uint32_t middleware::runtime_runner::get_async_depth() const {
+    return this->impl_->get_async_depth();
+}
+
+bool middleware::runtime_runner::submit(const uint32_t& slot, const bool& parallel) {
+    return this->impl_->submit(slot, parallel);
+}
+
+bool middleware::runtime_runner::wait(const uint32_t& slot) {
+    return this->impl_->wait(slot);
+}
+
+void *middleware::runtime_runner::get_slot_input_pointer(const uint32_t& slot, const uint32_t& index) const {
+    return this->impl_->get_slot_input_pointer(slot, index);
+}
+
+void *middleware::runtime_runner::get_slot_output_pointer(const uint32_t& slot, const uint32_t& index) const {
+    return this->impl_->get_slot_output_pointer(slot, index);
+}
+
+bool middleware::runtime_runner::prepare_affinity(const uint32_t& count, const std::vector<uint32_t>& affinities) {
+    return this->impl_->prepare_affinity(count, affinities);
+}
+
+bool middleware::runtime_runner::set_dynamic_batch(const uint32_t& slot, const uint32_t& batch) {
+    return this->impl_->set_dynamic_batch(slot, batch);
+}
+
+bool middleware::runtime_runner::attach_thread() const {
+    return this->impl_->attach_thread();
+}
+
+intmax_t middleware::runtime_runner::get_npu_utilization() const {
+    return this->impl_->get_npu_utilization();
+}
+
 uint32_t middleware::runtime_runner::get_input_count() const {
     return this->impl_->get_input_count();
 }
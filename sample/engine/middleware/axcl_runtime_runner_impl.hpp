@@ -13,12 +13,16 @@
 #include "middleware/axcl_runtime_runner.hpp"
 
 #include "middleware/axcl_base.hpp"
+#include "middleware/axcl_model_cache.hpp"
 #include "utilities/scalar_guard.hpp"
 #include "utilities/file.hpp"
 #include "utilities/log.hpp"
 
 #include <axcl.h>
 
+#include <map>
+#include <mutex>
+
 #if defined(ENV_AXCL_RUNTIME_API_ENABLE)
 struct middleware::runtime_runner::impl {
     impl() = default;
@@ -50,7 +54,12 @@ struct middleware::runtime_runner::impl {
             return false;
         }
 
-        // 3. set the flag
+        // 3. keep the device, so other threads can work on it
+        std::ignore = axclrtGetCurrentContext(&this->axcl_context_);
+        std::ignore = axclrtGetDevice(&this->device_id_);
+        this->device_index_ = index;
+
+        // 4. set the flag
         this->is_initialized_ = true;
         return true;
     }
@@ -60,6 +69,8 @@ struct middleware::runtime_runner::impl {
 
         if (this->is_initialized_) {
             if (0 != this->model_id_) {
+                flag &= this->release_slots();
+
                 for (auto& input : inputs_) {
                     if (nullptr != input) {
                         std::ignore = axclrtFree(input);
@@ -75,10 +86,17 @@ struct middleware::runtime_runner::impl {
 
                 flag &= 0 == axclrtEngineDestroyIOInfo(this->info_);
                 flag &= 0 == axclrtEngineDestroyIO(this->io_);
-                flag &= 0 == axclrtEngineUnload(this->model_id_);
+                // the contexts go back to the cache, to be reused by other runners of the model or freed by unloading
+                if (0 != this->context_id_) {
+                    this->contexts_[0].push_back(this->context_id_);
+                }
+                flag &= model_cache::release(this->model_id_, this->contexts_);
+                this->model_id_ = 0;
+                this->context_id_ = 0;
+                this->contexts_.clear();
             }
 
-             flag &= 0 == axcl_base::final([&]() {
+             flag &= 0 == axcl_base::final(this->device_index_, [&]() {
                 if (const auto ret = axclrtEngineFinalize(); 0 != ret) {
                     utilities::glog.print(utilities::log::type::error, "Final AXCLRT Engine failed{0x%08X}.\n", ret);
                     return false;
@@ -112,11 +130,16 @@ struct middleware::runtime_runner::impl {
             return false;
         }
 
-        if (const auto ret = axclrtEngineLoadFromFile(model_path.c_str(), &this->model_id_); 0 != ret) {
+        // runners of the same model on a device share one loading, each takes its own contexts
+        if (!model_cache::acquire(model_path, this->model_id_)) {
             utilities::glog.print(utilities::log::type::error, "Create model{%s} handle failed.\n", model_path.c_str());
             return false;
         }
 
+        if (model_cache::take_context(this->model_id_, 0, this->context_id_)) {
+            return true;
+        }
+
         if (const auto ret = axclrtEngineCreateContext(this->model_id_, &this->context_id_); 0 != ret) {
             utilities::glog.print(utilities::log::type::error, "Create model{%s} context failed.\n", model_path.c_str());
             return false;
@@ -276,6 +299,130 @@ struct middleware::runtime_runner::impl {
         return true;
     }
 
+    [[nodiscard]] bool prepare_async(const uint32_t& depth) {
+        if (0 == depth || depth > max_async_depth) {
+            utilities::glog.print(utilities::log::type::error, "Async depth{%d} is out of range{1 ~ %d}.\n", depth, max_async_depth);
+            return false;
+        }
+
+        return this->prepare_slots(depth, {});
+    }
+
+    [[nodiscard]] bool prepare_affinity(const uint32_t& count, const std::vector<uint32_t>& affinities) {
+        if (0 == count || count > max_slot_count) {
+            utilities::glog.print(utilities::log::type::error, "Slot count{%d} is out of range{1 ~ %d}.\n", count, max_slot_count);
+            return false;
+        }
+
+        return this->prepare_slots(count, affinities);
+    }
+
+    [[nodiscard]] uint32_t get_async_depth() const {
+        return this->slots_.empty() ? 1 : static_cast<uint32_t>(this->slots_.size());
+    }
+
+    [[nodiscard]] bool submit(const uint32_t& index, const bool& parallel) {
+        std::ignore = parallel;
+
+        if (index >= this->slots_.size()) {
+            utilities::glog.print(utilities::log::type::error,
+                "Slot{%d} is out of range{total %d}, prepare async first.\n", index, this->slots_.size());
+            return false;
+        }
+
+        auto& slot = this->slots_[index];
+        if (slot.pending) {
+            utilities::glog.print(utilities::log::type::error, "Slot{%d} is still running, wait it first.\n", index);
+            return false;
+        }
+
+        if (const auto ret = axclrtEngineExecuteAsync(this->model_id_, slot.context_id, this->group_, slot.io, slot.stream); 0 != ret) {
+            utilities::glog.print(utilities::log::type::error, "Submit slot{%d} failed{0x%08X}.\n", index, ret);
+            return false;
+        }
+        slot.pending = true;
+
+        return true;
+    }
+
+    [[nodiscard]] bool wait(const uint32_t& index) {
+        if (index >= this->slots_.size()) {
+            utilities::glog.print(utilities::log::type::error, "Slot{%d} is out of range{total %d}.\n", index, this->slots_.size());
+            return false;
+        }
+
+        auto& slot = this->slots_[index];
+        if (!slot.pending) {
+            return true;
+        }
+
+        slot.pending = false;
+        if (const auto ret = axclrtSynchronizeStream(slot.stream); 0 != ret) {
+            utilities::glog.print(utilities::log::type::error, "Wait slot{%d} failed{0x%08X}.\n", index, ret);
+            return false;
+        }
+
+        return true;
+    }
+
+    [[nodiscard]] void *get_slot_input_pointer(const uint32_t& index, const uint32_t& tensor) const {
+        if (this->slots_.empty() && 0 == index) {
+            return this->get_input_pointer(tensor);
+        }
+
+        if (index >= this->slots_.size() || tensor >= this->slots_[index].inputs.size()) {
+            return nullptr;
+        }
+        return this->slots_[index].inputs[tensor];
+    }
+
+    [[nodiscard]] void *get_slot_output_pointer(const uint32_t& index, const uint32_t& tensor) const {
+        if (this->slots_.empty() && 0 == index) {
+            return this->get_output_pointer(tensor);
+        }
+
+        if (index >= this->slots_.size() || tensor >= this->slots_[index].outputs.size()) {
+            return nullptr;
+        }
+        return this->slots_[index].outputs[tensor];
+    }
+
+    [[nodiscard]] bool set_dynamic_batch(const uint32_t& index, const uint32_t& batch) {
+        if (0 == batch || batch > this->batch_) {
+            utilities::glog.print(utilities::log::type::error, "Dynamic batch{%d} is out of range{1 ~ %d}.\n", batch, this->batch_);
+            return false;
+        }
+
+        axclrtEngineIO io = nullptr;
+        if (this->slots_.empty() && 0 == index) {
+            io = this->io_;
+        } else if (index < this->slots_.size()) {
+            io = this->slots_[index].io;
+        }
+        if (nullptr == io) {
+            utilities::glog.print(utilities::log::type::error, "Slot{%d} is not prepared.\n", index);
+            return false;
+        }
+
+        if (const auto ret = axclrtEngineSetDynamicBatchSize(io, batch); 0 != ret) {
+            utilities::glog.print(utilities::log::type::error, "Set slot{%d} batch size{%d} failed{0x%08X}.\n", index, batch, ret);
+            return false;
+        }
+        return true;
+    }
+
+    [[nodiscard]] bool attach_thread() const {
+        if (const auto ret = axclrtSetCurrentContext(this->axcl_context_); 0 != ret) {
+            utilities::glog.print(utilities::log::type::error, "Attach thread to axcl device{%d} failed{0x%08X}.\n", this->device_id_, ret);
+            return false;
+        }
+        return true;
+    }
+
+    [[nodiscard]] intmax_t get_npu_utilization() const {
+        return axcl_base::get_device_utilization(this->device_id_);
+    }
+
     [[nodiscard]] uint32_t get_input_count() const {
         if (nullptr == this->info_) {
             utilities::glog.print(utilities::log::type::error, "Model io info is not set, prepare first.\n");
@@ -465,6 +612,193 @@ struct middleware::runtime_runner::impl {
     }
 
 private:
+    static constexpr uint32_t max_async_depth = 16;
+    static constexpr uint32_t max_slot_count = 64;
+
+    struct io_set {
+        uint64_t context_id{};
+        axclrtEngineIO io{};
+        axclrtStream stream{};
+        std::vector<void*> inputs;
+        std::vector<void*> outputs;
+        bool pending = false;
+    };
+
+    [[nodiscard]] bool prepare_slots(const uint32_t& count, const std::vector<uint32_t>& affinities) {
+        if (nullptr == this->io_) {
+            utilities::glog.print(utilities::log::type::error, "Model io is not set, prepare first.\n");
+            return false;
+        }
+
+        if (!this->release_slots()) {
+            return false;
+        }
+
+        // slot 0 shares the IO set of run(), each slot has its own context and stream
+        std::map<uint32_t, size_t> used;
+        this->slots_.resize(count);
+        for (uint32_t i = 0; i < count; i++) {
+            auto& slot = this->slots_[i];
+            const uint32_t affinity = affinities.empty() ? 0 : affinities[i % affinities.size()];
+
+            if (0 == i && 0 == affinity) {
+                slot.context_id = this->context_id_;
+            } else if (!this->acquire_context(i, affinity, used, slot.context_id)) {
+                std::ignore = this->release_slots();
+                return false;
+            }
+
+            if (0 == i) {
+                slot.io = this->io_;
+                slot.inputs = this->inputs_;
+                slot.outputs = this->outputs_;
+            } else if (!this->create_slot(i, slot)) {
+                std::ignore = this->release_slots();
+                return false;
+            }
+
+            if (const auto ret = axclrtCreateStream(&slot.stream); 0 != ret) {
+                utilities::glog.print(utilities::log::type::error, "Create stream for slot{%d} failed{0x%08X}.\n", i, ret);
+                std::ignore = this->release_slots();
+                return false;
+            }
+        }
+        utilities::glog.print(utilities::log::type::info, "%d async IO sets are prepared.\n", count);
+
+        return true;
+    }
+
+    // contexts cannot be destroyed until unloading, so reuse them; the affinity of the model is
+    // taken by the contexts created after setting it, 0 keeps the affinity as loaded
+    [[nodiscard]] bool acquire_context(const uint32_t& index, const uint32_t& affinity, std::map<uint32_t, size_t>& used, uint64_t& context_id) {
+        auto& pool = this->contexts_[affinity];
+        auto& next = used[affinity];
+
+        // contexts given back by the released runners of the shared model come first
+        if (uint64_t id = 0; pool.size() <= next && model_cache::take_context(this->model_id_, affinity, id)) {
+            pool.push_back(id);
+        }
+
+        if (pool.size() <= next) {
+            // the model may be shared with other runners, which set its affinity too
+            static std::mutex affinity_mutex;
+            std::lock_guard lock(affinity_mutex);
+
+            axclrtEngineSet original = 0;
+            if (0 != affinity) {
+                if (const auto ret = axclrtEngineGetAffinity(this->model_id_, &original); 0 != ret) {
+                    utilities::glog.print(utilities::log::type::error, "Get model affinity failed{0x%08X}.\n", ret);
+                    return false;
+                }
+                if (const auto ret = axclrtEngineSetAffinity(this->model_id_, affinity); 0 != ret) {
+                    utilities::glog.print(utilities::log::type::error,
+                        "Set affinity{0x%X} for slot{%d} failed{0x%08X}.\n", affinity, index, ret);
+                    return false;
+                }
+            }
+
+            uint64_t id = 0;
+            const auto ret = axclrtEngineCreateContext(this->model_id_, &id);
+
+            if (0 != affinity) {
+                std::ignore = axclrtEngineSetAffinity(this->model_id_, original);
+            }
+            if (0 != ret) {
+                utilities::glog.print(utilities::log::type::error, "Create context for slot{%d} failed{0x%08X}.\n", index, ret);
+                return false;
+            }
+            pool.push_back(id);
+        }
+        context_id = pool[next++];
+
+        return true;
+    }
+
+    [[nodiscard]] bool create_slot(const uint32_t& index, io_set& slot) {
+        slot.inputs.resize(this->inputs_.size(), nullptr);
+        for (size_t i = 0; i < slot.inputs.size(); i++) {
+            if (const auto ret = axclrtMalloc(&slot.inputs[i], this->inputs_size_[i], axclrtMemMallocPolicy{}); 0 != ret) {
+                utilities::glog.print(utilities::log::type::error,
+                    "Memory allocation for slot{%d} tensor{index: %d} failed{0x%08X}.\n", index, i, ret);
+                return false;
+            }
+        }
+
+        slot.outputs.resize(this->outputs_.size(), nullptr);
+        for (size_t i = 0; i < slot.outputs.size(); i++) {
+            if (const auto ret = axclrtMalloc(&slot.outputs[i], this->outputs_size_[i], axclrtMemMallocPolicy{}); 0 != ret) {
+                utilities::glog.print(utilities::log::type::error,
+                    "Memory allocation for slot{%d} tensor{index: %d} failed{0x%08X}.\n", index, i, ret);
+                return false;
+            }
+        }
+
+        if (const auto ret = axclrtEngineCreateIO(this->info_, &slot.io); 0 != ret) {
+            utilities::glog.print(utilities::log::type::error, "Create model io for slot{%d} failed{0x%08X}.\n", index, ret);
+            return false;
+        }
+
+        for (uint32_t i = 0; i < slot.inputs.size(); i++) {
+            if (const auto ret = axclrtEngineSetInputBufferByIndex(slot.io, i, slot.inputs[i], this->inputs_size_[i]); 0 != ret) {
+                utilities::glog.print(utilities::log::type::error, "Set slot{%d} input buffer{index: %d} failed{0x%08X}.\n", index, i, ret);
+                return false;
+            }
+        }
+        for (uint32_t i = 0; i < slot.outputs.size(); i++) {
+            if (const auto ret = axclrtEngineSetOutputBufferByIndex(slot.io, i, slot.outputs[i], this->outputs_size_[i]); 0 != ret) {
+                utilities::glog.print(utilities::log::type::error, "Set slot{%d} output buffer{index: %d} failed{0x%08X}.\n", index, i, ret);
+                return false;
+            }
+        }
+
+        if (const auto ret = axclrtEngineSetDynamicBatchSize(slot.io, this->batch_); 0 != ret) {
+            utilities::glog.print(utilities::log::type::error, "Set slot{%d} batch size{%d} failed{0x%08X}.\n", index, this->batch_, ret);
+            return false;
+        }
+
+        return true;
+    }
+
+    [[nodiscard]] bool release_slots() {
+        auto flag = true;
+
+        for (size_t i = 0; i < this->slots_.size(); i++) {
+            auto& slot = this->slots_[i];
+            if (slot.pending) {
+                flag &= 0 == axclrtSynchronizeStream(slot.stream);
+                slot.pending = false;
+            }
+            if (nullptr != slot.stream) {
+                flag &= 0 == axclrtDestroyStream(slot.stream);
+            }
+
+            // slot 0 shares the IO set of run()
+            if (0 == i) {
+                continue;
+            }
+
+            for (auto& input : slot.inputs) {
+                if (nullptr != input) {
+                    flag &= 0 == axclrtFree(input);
+                }
+            }
+            for (auto& output : slot.outputs) {
+                if (nullptr != output) {
+                    flag &= 0 == axclrtFree(output);
+                }
+            }
+            if (nullptr != slot.io) {
+                flag &= 0 == axclrtEngineDestroyIO(slot.io);
+            }
+        }
+        this->slots_.clear();
+
+        if (!flag) {
+            utilities::glog.print(utilities::log::type::error, "Release async IO sets failed.\n");
+        }
+        return flag;
+    }
+
     int32_t group_ = 0;
     uint32_t batch_ = 0;
 
@@ -477,6 +811,13 @@ private:
     std::vector<uintmax_t> inputs_size_;
     std::vector<uintmax_t> outputs_size_;
 
+    std::map<uint32_t, std::vector<uint64_t>> contexts_;
+    std::vector<io_set> slots_;
+
+    axclrtContext axcl_context_{};
+    int32_t device_id_ = 0;
+    uint32_t device_index_ = 0;
+
     bool is_initialized_ = false;
 };
 #endif
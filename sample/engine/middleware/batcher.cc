@@ -0,0 +1,39 @@
+/**************************************************************************************************
+ *
+ * Copyright (c) 2019-2024 Axera Semiconductor Co., Ltd. All Rights Reserved.
+ *
+ * This source file is the property of Axera Semiconductor Co., Ltd. and
+ * may not be copied or distributed in any isomorphic form without the prior
+ * written consent of Axera Semiconductor Co., Ltd.
+ *
+ **************************************************************************************************/
+
+#include "middleware/batcher_impl.hpp"
+
+middleware::batcher::batcher(runner& instance) {
+    this->impl_ = new impl(instance);
+}
+
+middleware::batcher::~batcher() {
+    delete this->impl_;
+}
+
+bool middleware::batcher::start(const config& cfg) {
+    return this->impl_->start(cfg);
+}
+
+bool middleware::batcher::stop() {
+    return this->impl_->stop();
+}
+
+std::future<middleware::batcher::result> middleware::batcher::infer(const std::vector<const void*>& inputs) {
+    return this->impl_->infer(inputs);
+}
+
+uint64_t middleware::batcher::get_batch_count() const {
+    return this->impl_->get_batch_count();
+}
+
+uint64_t middleware::batcher::get_request_count() const {
+    return this->impl_->get_request_count();
+}
@@ -0,0 +1,58 @@
+/**************************************************************************************************
+ *
+ * Copyright (c) 2019-2024 Axera Semiconductor Co., Ltd. All Rights Reserved.
+ *
+ * This source file is the property of Axera Semiconductor Co., Ltd. and
+ * may not be copied or distributed in any isomorphic form without the prior
+ * written consent of Axera Semiconductor Co., Ltd.
+ *
+ **************************************************************************************************/
+
+#pragma once
+
+#include "middleware/runner.hpp"
+
+#include <future>
+
+namespace middleware {
+
+// dynamic batching: single requests from many threads are packed into one batch of a prepared runner,
+// which runs with set_dynamic_batch() when the batch is full or its first request waited max_delay_us
+class batcher final {
+public:
+    struct config {
+        uint32_t max_batch = 0;        // 0 takes get_batch_size() of the runner
+        uint32_t max_delay_us = 2000;  // the longest a request waits for the batch to fill
+        uint32_t depth = 2;            // batches in flight, so a batch fills while others run
+        bool parallel = false;
+    };
+
+    struct result {
+        bool ok = false;
+        uint32_t batch = 0;                         // size of the batch the request ran in
+        std::vector<std::vector<uint8_t>> outputs;  // one item of each output tensor
+    };
+
+    explicit batcher(runner& instance);
+    ~batcher();
+
+    batcher(const batcher&) = delete;
+    batcher& operator=(const batcher&) = delete;
+
+    [[nodiscard]] bool start(const config& cfg);
+    // the requests already accepted are run before stopping
+    [[nodiscard]] bool stop();
+
+    // 'inputs' hold one item of each input tensor (get_input_size() bytes), copied before returning;
+    // the future is invalid if the batcher is not started
+    [[nodiscard]] std::future<result> infer(const std::vector<const void*>& inputs);
+
+    [[nodiscard]] uint64_t get_batch_count() const;
+    [[nodiscard]] uint64_t get_request_count() const;
+
+private:
+    struct impl;
+    impl *impl_;
+};
+
+}
@@ -0,0 +1,315 @@
+/**************************************************************************************************
+ *
+ * Copyright (c) 2019-2024 Axera Semiconductor Co., Ltd. All Rights Reserved.
+ *
+ * This source file is the property of Axera Semiconductor Co., Ltd. and
+ * may not be copied or distributed in any isomorphic form without the prior
+ * written consent of Axera Semiconductor Co., Ltd.
+ *
+ **************************************************************************************************/
+
+#pragma once
+
+#include "middleware/batcher.hpp"
+
+#include "utilities/log.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+struct middleware::batcher::impl {
+    explicit impl(runner& instance) : runner_(instance) {}
+
+    ~impl() {
+        std::ignore = this->stop();
+    }
+
+    [[nodiscard]] bool start(const config& cfg) {
+        if (this->dispatcher_.joinable()) {
+            utilities::glog.print(utilities::log::type::error, "Batcher is already started.\n");
+            return false;
+        }
+
+        const auto batch = static_cast<uint32_t>(this->runner_.get_batch_size());
+        this->max_batch_ = 0 == cfg.max_batch ? batch : cfg.max_batch;
+        if (this->max_batch_ > batch || 0 == this->max_batch_) {
+            utilities::glog.print(utilities::log::type::error, "Max batch{%d} is out of range[1, %d].\n", this->max_batch_, batch);
+            return false;
+        }
+        this->delay_ = std::chrono::microseconds(cfg.max_delay_us);
+        this->parallel_ = cfg.parallel;
+
+        if (!this->runner_.prepare_async(cfg.depth)) {
+            utilities::glog.print(utilities::log::type::error, "Prepare %d batches in flight failed.\n", cfg.depth);
+            return false;
+        }
+
+        this->batches_.clear();
+        this->free_.clear();
+        for (uint32_t slot = 0; slot < this->runner_.get_async_depth(); slot++) {
+            auto b = std::make_unique<batch_t>();
+            b->slot = slot;
+            b->inputs.resize(this->runner_.get_input_count());
+            for (uint32_t i = 0; i < b->inputs.size(); i++) {
+                b->inputs[i].resize(this->runner_.get_input_size(i) * this->max_batch_);
+            }
+            b->outputs.resize(this->runner_.get_output_count());
+            for (uint32_t i = 0; i < b->outputs.size(); i++) {
+                b->outputs[i].resize(this->runner_.get_output_size(i) * this->max_batch_);
+            }
+            this->free_.push_back(b.get());
+            this->batches_.push_back(std::move(b));
+        }
+
+        {
+            std::lock_guard lock(this->mutex_);
+            this->started_ = true;
+            this->stopping_ = false;
+            this->dispatched_ = false;
+        }
+        this->dispatcher_ = std::thread(&impl::dispatch, this);
+        this->collector_ = std::thread(&impl::collect, this);
+
+        return true;
+    }
+
+    [[nodiscard]] bool stop() {
+        if (!this->dispatcher_.joinable()) {
+            return true;
+        }
+
+        {
+            std::lock_guard lock(this->mutex_);
+            this->stopping_ = true;
+        }
+        this->cond_.notify_all();
+
+        this->dispatcher_.join();
+        this->collector_.join();
+
+        {
+            std::lock_guard lock(this->mutex_);
+            this->started_ = false;
+        }
+
+        return this->runner_.attach_thread();
+    }
+
+    [[nodiscard]] std::future<result> infer(const std::vector<const void*>& inputs) {
+        if (inputs.size() != this->runner_.get_input_count()) {
+            utilities::glog.print(utilities::log::type::error, "Request has %d inputs, model needs %d.\n", inputs.size(), this->runner_.get_input_count());
+            return {};
+        }
+
+        batch_t* b = nullptr;
+        uint32_t item = 0;
+        std::future<result> future;
+        {
+            std::unique_lock lock(this->mutex_);
+            this->cond_.wait(lock, [this]() { return !this->started_ || this->stopping_ || nullptr != this->forming_ || !this->free_.empty(); });
+            if (!this->started_ || this->stopping_) {
+                utilities::glog.print(utilities::log::type::error, "Batcher is not started.\n");
+                return {};
+            }
+
+            if (nullptr == this->forming_) {
+                this->forming_ = this->free_.front();
+                this->free_.pop_front();
+                this->forming_->reserved = 0;
+                this->forming_->copied = 0;
+                this->forming_->first = std::chrono::steady_clock::now();
+                this->forming_->promises = std::vector<std::promise<result>>(this->max_batch_);
+            }
+
+            b = this->forming_;
+            item = b->reserved++;
+            future = b->promises[item].get_future();
+
+            // a full batch is closed here, the dispatcher runs it once all items are copied
+            if (this->max_batch_ == b->reserved) {
+                this->full_.push_back(b);
+                this->forming_ = nullptr;
+            }
+        }
+        this->cond_.notify_all();
+
+        // copied out of the lock, so producers fill the same batch concurrently
+        for (uint32_t i = 0; i < inputs.size(); i++) {
+            const auto size = this->runner_.get_input_size(i);
+            std::memcpy(b->inputs[i].data() + size * item, inputs[i], size);
+        }
+
+        {
+            std::lock_guard lock(this->mutex_);
+            b->copied++;
+        }
+        this->cond_.notify_all();
+
+        return future;
+    }
+
+    [[nodiscard]] uint64_t get_batch_count() const {
+        return this->batch_count_.load();
+    }
+
+    [[nodiscard]] uint64_t get_request_count() const {
+        return this->request_count_.load();
+    }
+
+private:
+    struct batch_t {
+        uint32_t slot = 0;
+        std::vector<std::vector<uint8_t>> inputs;
+        std::vector<std::vector<uint8_t>> outputs;
+        std::vector<std::promise<result>> promises;
+
+        // items taken by producers, and items of them already copied in
+        uint32_t reserved = 0;
+        uint32_t copied = 0;
+        std::chrono::steady_clock::time_point first;
+    };
+
+    static void fail(batch_t* b) {
+        for (uint32_t i = 0; i < b->reserved; i++) {
+            b->promises[i].set_value(result{});
+        }
+    }
+
+    void recycle(batch_t* b) {
+        {
+            std::lock_guard lock(this->mutex_);
+            this->free_.push_back(b);
+        }
+        this->cond_.notify_all();
+    }
+
+    // closes the forming batch when it is full or its deadline passed, then uploads and submits it
+    void dispatch() {
+        if (!this->runner_.attach_thread()) {
+            utilities::glog.print(utilities::log::type::error, "Batcher dispatcher cannot attach.\n");
+        }
+
+        for (;;) {
+            batch_t* b = nullptr;
+            {
+                std::unique_lock lock(this->mutex_);
+                for (;;) {
+                    if (nullptr != this->forming_ && (this->stopping_ || std::chrono::steady_clock::now() >= this->forming_->first + this->delay_)) {
+                        this->full_.push_back(this->forming_);
+                        this->forming_ = nullptr;
+                    }
+                    if (!this->full_.empty() && this->full_.front()->copied == this->full_.front()->reserved) {
+                        break;
+                    }
+                    if (this->stopping_ && nullptr == this->forming_ && this->full_.empty()) {
+                        this->dispatched_ = true;
+                        lock.unlock();
+                        this->cond_.notify_all();
+                        return;
+                    }
+                    if (nullptr != this->forming_ && this->full_.empty()) {
+                        this->cond_.wait_until(lock, this->forming_->first + this->delay_);
+                    } else {
+                        this->cond_.wait(lock);
+                    }
+                }
+                b = this->full_.front();
+                this->full_.pop_front();
+            }
+
+            auto flag = true;
+            for (uint32_t i = 0; flag && i < b->inputs.size(); i++) {
+                flag = this->runner_.upload(b->slot, i, b->inputs[i].data(), this->runner_.get_input_size(i) * b->reserved);
+            }
+            flag = flag && this->runner_.set_dynamic_batch(b->slot, b->reserved) && this->runner_.submit(b->slot, this->parallel_);
+            if (!flag) {
+                utilities::glog.print(utilities::log::type::error, "Submit batch{size: %d} on slot{%d} failed.\n", b->reserved, b->slot);
+                fail(b);
+                this->recycle(b);
+                continue;
+            }
+
+            {
+                std::lock_guard lock(this->mutex_);
+                this->running_.push_back(b);
+            }
+            this->cond_.notify_all();
+        }
+    }
+
+    // waits the batches in submitted order, scatters the outputs to the requests
+    void collect() {
+        if (!this->runner_.attach_thread()) {
+            utilities::glog.print(utilities::log::type::error, "Batcher collector cannot attach.\n");
+        }
+
+        for (;;) {
+            batch_t* b = nullptr;
+            {
+                std::unique_lock lock(this->mutex_);
+                this->cond_.wait(lock, [this]() { return this->dispatched_ || !this->running_.empty(); });
+                if (this->running_.empty()) {
+                    return;
+                }
+                b = this->running_.front();
+                this->running_.pop_front();
+            }
+
+            auto flag = this->runner_.wait(b->slot);
+            for (uint32_t i = 0; flag && i < b->outputs.size(); i++) {
+                flag = this->runner_.download(b->slot, i, b->outputs[i].data(), this->runner_.get_output_size(i) * b->reserved);
+            }
+
+            if (flag) {
+                for (uint32_t item = 0; item < b->reserved; item++) {
+                    result r;
+                    r.ok = true;
+                    r.batch = b->reserved;
+                    r.outputs.resize(b->outputs.size());
+                    for (uint32_t i = 0; i < b->outputs.size(); i++) {
+                        const auto size = this->runner_.get_output_size(i);
+                        const auto* data = b->outputs[i].data() + size * item;
+                        r.outputs[i].assign(data, data + size);
+                    }
+                    b->promises[item].set_value(std::move(r));
+                }
+                this->batch_count_++;
+                this->request_count_ += b->reserved;
+            } else {
+                utilities::glog.print(utilities::log::type::error, "Wait batch{size: %d} on slot{%d} failed.\n", b->reserved, b->slot);
+                fail(b);
+            }
+
+            this->recycle(b);
+        }
+    }
+
+    runner& runner_;
+
+    uint32_t max_batch_ = 1;
+    std::chrono::microseconds delay_{0};
+    bool parallel_ = false;
+
+    std::vector<std::unique_ptr<batch_t>> batches_;
+    std::deque<batch_t*> free_;
+    batch_t* forming_ = nullptr;
+    std::deque<batch_t*> full_;
+    std::deque<batch_t*> running_;
+
+    std::mutex mutex_;
+    std::condition_variable cond_;
+    std::thread dispatcher_;
+    std::thread collector_;
+    bool started_ = false;
+    bool stopping_ = false;
+    bool dispatched_ = false;
+
+    std::atomic<uint64_t> batch_count_{0};
+    std::atomic<uint64_t> request_count_{0};
+};
@@ -14,12 +14,92 @@
 #include "utilities/log.hpp"
 
 #include <chrono>
+#include <cstring>
 #include <thread>
 
 void middleware::runner::sleep_for(const uint32_t sleep_duration) const {
     std::this_thread::sleep_for(std::chrono::milliseconds(sleep_duration));
 }
 
+bool middleware::runner::prepare_async(const uint32_t& depth) {
+    if (1 != depth) {
+        utilities::glog.print(utilities::log::type::error, "Async depth{%d} is not supported, only 1.\n", depth);
+        return false;
+    }
+    return true;
+}
+
+uint32_t middleware::runner::get_async_depth() const {
+    return 1;
+}
+
+bool middleware::runner::submit(const uint32_t& slot, const bool& parallel) {
+    if (0 != slot) {
+        utilities::glog.print(utilities::log::type::error, "Slot{%d} is out of range{total 1}.\n", slot);
+        return false;
+    }
+    return this->run(parallel);
+}
+
+bool middleware::runner::wait(const uint32_t& slot) {
+    return 0 == slot;
+}
+
+void *middleware::runner::get_slot_input_pointer(const uint32_t& slot, const uint32_t& index) const {
+    return (0 == slot) ? this->get_input_pointer(index) : nullptr;
+}
+
+void *middleware::runner::get_slot_output_pointer(const uint32_t& slot, const uint32_t& index) const {
+    return (0 == slot) ? this->get_output_pointer(index) : nullptr;
+}
+
+bool middleware::runner::set_dynamic_batch(const uint32_t& slot, const uint32_t& batch) {
+    if (batch != static_cast<uint32_t>(this->get_batch_size())) {
+        utilities::glog.print(utilities::log::type::error,
+            "Dynamic batch{%d} of slot{%d} is not supported, only %d.\n", batch, slot, this->get_batch_size());
+        return false;
+    }
+    return true;
+}
+
+bool middleware::runner::prepare_affinity(const uint32_t& count, const std::vector<uint32_t>& affinities) {
+    for (const auto& affinity : affinities) {
+        if (0 != affinity) {
+            utilities::glog.print(utilities::log::type::error, "NPU affinity{0x%X} of slots is not supported.\n", affinity);
+            return false;
+        }
+    }
+    return this->prepare_async(count);
+}
+
+bool middleware::runner::attach_thread() const {
+    return true;
+}
+
+intmax_t middleware::runner::get_npu_utilization() const {
+    return -1;
+}
+
+bool middleware::runner::upload(const uint32_t& slot, const uint32_t& index, const void* data, const uintmax_t& size) const {
+    void* address = this->get_slot_input_pointer(slot, index);
+    if (nullptr == address) {
+        utilities::glog.print(utilities::log::type::error, "Input tensor{slot: %d, index: %d} is not found.\n", slot, index);
+        return false;
+    }
+    std::memcpy(address, data, size);
+    return true;
+}
+
+bool middleware::runner::download(const uint32_t& slot, const uint32_t& index, void* data, const uintmax_t& size) const {
+    const void* address = this->get_slot_output_pointer(slot, index);
+    if (nullptr == address) {
+        utilities::glog.print(utilities::log::type::error, "Output tensor{slot: %d, index: %d} is not found.\n", slot, index);
+        return false;
+    }
+    std::memcpy(data, address, size);
+    return true;
+}
+
 std::vector<std::string> middleware::runner::read(const std::string& list_file) {
     if (!utilities::exists(list_file) || !utilities::is_regular_file(list_file)) {
         utilities::glog.print(utilities::log::type::error,
@@ -28,6 +28,31 @@ public:
 
     [[nodiscard]] virtual bool run(const bool& parallel) = 0;
 
+    // pipelined running: prepare_async() allocates 'depth' IO sets (slots), slot 0 is the IO set of run();
+    // submit() queues one running on a slot and returns at once, wait() blocks until that running is done,
+    // so inputs of slot k+1 can be uploaded while slot k is running.
+    [[nodiscard]] virtual bool prepare_async(const uint32_t& depth);
+    [[nodiscard]] virtual uint32_t get_async_depth() const;
+    [[nodiscard]] virtual bool submit(const uint32_t& slot, const bool& parallel);
+    [[nodiscard]] virtual bool wait(const uint32_t& slot);
+    [[nodiscard]] virtual void *get_slot_input_pointer(const uint32_t& slot, const uint32_t& index) const;
+    [[nodiscard]] virtual void *get_slot_output_pointer(const uint32_t& slot, const uint32_t& index) const;
+
+    // throughput running: prepare_affinity() allocates 'count' slots as prepare_async(), the context of slot i takes
+    // the NPU affinity affinities[i % affinities.size()] (0 keeps the affinity of the model); slots are independent,
+    // so threads may submit() and wait() on different slots at the same time after attach_thread().
+    [[nodiscard]] virtual bool prepare_affinity(const uint32_t& count, const std::vector<uint32_t>& affinities);
+    [[nodiscard]] virtual bool attach_thread() const;
+    // dynamic batch: the next running of the slot takes only the first 'batch' (1 ~ get_batch_size()) items of its
+    // tensors, the setting stays until changed
+    [[nodiscard]] virtual bool set_dynamic_batch(const uint32_t& slot, const uint32_t& batch);
+    // NPU utilization of the device in percent since the last query, -1 if not supported
+    [[nodiscard]] virtual intmax_t get_npu_utilization() const;
+
+    // copy between host memory and the tensor {slot, index}, size is in bytes
+    [[nodiscard]] virtual bool upload(const uint32_t& slot, const uint32_t& index, const void* data, const uintmax_t& size) const;
+    [[nodiscard]] virtual bool download(const uint32_t& slot, const uint32_t& index, void* data, const uintmax_t& size) const;
+
     [[nodiscard]] virtual uint32_t get_input_count() const = 0;
     [[nodiscard]] virtual uint32_t get_output_count() const = 0;
     [[nodiscard]] virtual std::string get_input_name(const uint32_t& index) const = 0;
@@ -0,0 +1,121 @@
+/**************************************************************************************************
+ *
+ * Copyright (c) 2019-2024 Axera Semiconductor Co., Ltd. All Rights Reserved.
+ *
+ * This source file is the property of Axera Semiconductor Co., Ltd. and
+ * may not be copied or distributed in any isomorphic form without the prior
+ * written consent of Axera Semiconductor Co., Ltd.
+ *
+ **************************************************************************************************/
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace utilities {
+
+// HDR style log-linear histogram: each power of 2 is split into 2^precision linear buckets,
+// so a recorded value is kept with a relative error below 1 / 2^precision, in constant memory.
+class histogram {
+public:
+    explicit histogram(const uint32_t& precision = 7)
+        : precision_(std::clamp<uint32_t>(precision, 1, 16)),
+          counts_(static_cast<size_t>(64 - precision_ + 1) << precision_, 0) {}
+
+    void record(const uint64_t& value) {
+        this->counts_[this->index(value)]++;
+        this->count_++;
+        this->sum_ += static_cast<double>(value);
+        this->min_ = std::min(this->min_, value);
+        this->max_ = std::max(this->max_, value);
+    }
+
+    void merge(const histogram& other) {
+        if (other.precision_ != this->precision_) {
+            return;
+        }
+        for (size_t i = 0; i < this->counts_.size(); i++) {
+            this->counts_[i] += other.counts_[i];
+        }
+        this->count_ += other.count_;
+        this->sum_ += other.sum_;
+        this->min_ = std::min(this->min_, other.min_);
+        this->max_ = std::max(this->max_, other.max_);
+    }
+
+    void reset() {
+        std::fill(this->counts_.begin(), this->counts_.end(), 0);
+        this->count_ = 0;
+        this->sum_ = 0.;
+        this->min_ = std::numeric_limits<uint64_t>::max();
+        this->max_ = 0;
+    }
+
+    // the highest value equivalent to the bucket holding the 'percent' ranked value, 0 if empty
+    [[nodiscard]] uint64_t percentile(const double& percent) const {
+        if (0 == this->count_) {
+            return 0;
+        }
+
+        const double exact = std::clamp(percent, 0., 100.) / 100. * static_cast<double>(this->count_);
+        auto rank = static_cast<uint64_t>(exact);
+        rank += (static_cast<double>(rank) < exact || 0 == rank) ? 1 : 0;
+        uint64_t accumulated = 0;
+        for (size_t i = 0; i < this->counts_.size(); i++) {
+            accumulated += this->counts_[i];
+            if (accumulated >= rank) {
+                return std::clamp(this->highest(i), this->min_, this->max_);
+            }
+        }
+        return this->max_;
+    }
+
+    [[nodiscard]] uint64_t count() const {
+        return this->count_;
+    }
+
+    [[nodiscard]] uint64_t min() const {
+        return 0 == this->count_ ? 0 : this->min_;
+    }
+
+    [[nodiscard]] uint64_t max() const {
+        return this->max_;
+    }
+
+    [[nodiscard]] double mean() const {
+        return 0 == this->count_ ? 0. : this->sum_ / static_cast<double>(this->count_);
+    }
+
+private:
+    [[nodiscard]] size_t index(const uint64_t& value) const {
+        if (value < (uint64_t{1} << this->precision_)) {
+            return static_cast<size_t>(value);
+        }
+
+        const uint32_t exponent = 63 - static_cast<uint32_t>(__builtin_clzll(value));
+        const uint32_t shift = exponent - this->precision_;
+        return (static_cast<size_t>(shift + 1) << this->precision_) + static_cast<size_t>((value >> shift) - (uint64_t{1} << this->precision_));
+    }
+
+    [[nodiscard]] uint64_t highest(const size_t& index) const {
+        if (index < (size_t{1} << this->precision_)) {
+            return static_cast<uint64_t>(index);
+        }
+
+        const auto shift = static_cast<uint32_t>(index >> this->precision_) - 1;
+        const auto mantissa = static_cast<uint64_t>(index & ((size_t{1} << this->precision_) - 1)) + (uint64_t{1} << this->precision_);
+        return ((mantissa + 1) << shift) - 1;
+    }
+
+    uint32_t precision_;
+    std::vector<uint64_t> counts_;
+    uint64_t count_ = 0;
+    double sum_ = 0.;
+    uint64_t min_ = std::numeric_limits<uint64_t>::max();
+    uint64_t max_ = 0;
+};
+
+}
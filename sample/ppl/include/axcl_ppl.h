@@ -28,6 +28,7 @@ axclError axcl_ppl_destroy(axcl_ppl ppl);
  *  axcl.ppl.transcode.vdec.grp             [R  ]       int32_t                            allocated by ax_vdec.ko
  *  axcl.ppl.transcode.ivps.grp             [R  ]       int32_t                            allocated by ax_ivps.ko
  *  axcl.ppl.transcode.venc.chn             [R  ]       int32_t                            allocated by ax_venc.ko
+ *  axcl.ppl.transcode.link.setup.us        [R  ]       uint64_t                           microseconds to link VDEC, IVPS and VENC
  *
  *  the following attributes take effect BEFORE the axcl_ppl_create function is called:
  *  axcl.ppl.transcode.vdec.blk.cnt         [R/W]       uint32_t          8                depend on stream DPB size and decode mode
@@ -34,6 +34,7 @@ typedef struct {
     AX_U32 modules;
     AX_U32 max_vdec_grp;
     AX_U32 max_venc_thd;
+    AX_U16 metrics_port; /* serve Prometheus metrics on http://127.0.0.1:port/metrics, 0: disabled */
 } axcl_ppl_init_param;
 
 typedef enum {
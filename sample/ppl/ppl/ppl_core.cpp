@@ -81,6 +81,11 @@ axclError ppl_core::init(axcl_ppl_init_param *param) {
         return ret;
     }
 
+    /* metrics are for monitoring, the pipeline still runs if the port is taken */
+    if (param->metrics_port > 0) {
+        (void)m_metrics.start(param->metrics_port);
+    }
+
     m_inited = true;
     return AXCL_SUCC;
 }
@@ -93,6 +98,8 @@ axclError ppl_core::deinit() {
         return AXCL_SUCC;
     }
 
+    m_metrics.stop();
+
     axclError ret;
     if (ret = MSYS()->deinit(); AXCL_SUCC != ret) {
         return ret;
@@ -150,11 +157,21 @@ axclError ppl_core::destroy(axcl_ppl ppl) {
 }
 
 axclError ppl_core::start(axcl_ppl ppl) {
-    return GET_PPL(ppl)->start();
+    axclError ret = GET_PPL(ppl)->start();
+    if (AXCL_SUCC == ret) {
+        m_running.add(1);
+    }
+
+    return ret;
 }
 
 axclError ppl_core::stop(axcl_ppl ppl) {
-    return GET_PPL(ppl)->stop();
+    axclError ret = GET_PPL(ppl)->stop();
+    if (AXCL_SUCC == ret) {
+        m_running.add(-1);
+    }
+
+    return ret;
 }
 
 axclError ppl_core::send_stream(axcl_ppl ppl, const axcl_ppl_input_stream *stream, AX_S32 timeout) {
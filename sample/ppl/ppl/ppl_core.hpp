@@ -13,6 +13,7 @@
 #include <atomic>
 #include <mutex>
 #include "axcl_ppl.h"
+#include "metrics.hpp"
 
 class ppl_core final {
 public:
@@ -40,4 +41,6 @@ private:
     std::mutex m_mtx;
     std::atomic<int32_t> m_id = {0};
     bool m_inited = false;
+    axcl::metrics_server m_metrics;
+    axcl::metric_gauge& m_running = axcl::metrics_registry::get_instance()->gauge("axcl_ppl_running", "pipelines started and not stopped");
 };
@@ -24,7 +24,7 @@ static AX_U64 get_ms_ticks() {
 }
 
 ppl_transcode::ppl_transcode(int32_t id, int32_t device, const axcl_ppl_transcode_param& param)
-    : m_device(device), m_id(id), m_param(param), m_sink(this, param.cb, param.userdata) {
+    : m_device(device), m_id(id), m_param(param), m_sink(this, param.cb, param.userdata), m_graph(id) {
     m_vdec = std::make_unique<axclite::vdec>();
     m_venc = std::make_unique<axclite::venc>();
 
@@ -58,11 +58,16 @@ axclError ppl_transcode::init() {
 
     m_venc->register_sink(&m_sink);
 
-    if (m_ivps) {
-        MSYS()->link({AX_ID_VDEC, m_vdec->get_grp_id(), 0}, {AX_ID_IVPS, m_ivps->get_grp_id(), 0});
-        MSYS()->link({AX_ID_IVPS, m_ivps->get_grp_id(), 0}, {AX_ID_VENC, 0, m_venc->get_chn_id()});
-    } else {
-        MSYS()->link({AX_ID_VDEC, m_vdec->get_grp_id(), 1}, {AX_ID_VENC, 0, m_venc->get_chn_id()});
+    make_link_graph();
+    if (ret = MSYS()->link(m_graph); AXCL_SUCC != ret) {
+        m_venc->unregister_sink(&m_sink);
+        m_venc->deinit();
+        if (m_ivps) {
+            m_ivps->deinit();
+        }
+
+        m_vdec->deinit();
+        return ret;
     }
 
     return AXCL_SUCC;
@@ -71,12 +76,7 @@ axclError ppl_transcode::init() {
 axclError ppl_transcode::deinit() {
     m_venc->unregister_sink(&m_sink);
 
-    if (m_ivps) {
-        MSYS()->unlink({AX_ID_VDEC, m_vdec->get_grp_id(), 0}, {AX_ID_IVPS, m_ivps->get_grp_id(), 0});
-        MSYS()->unlink({AX_ID_IVPS, m_ivps->get_grp_id(), 0}, {AX_ID_VENC, 0, m_venc->get_chn_id()});
-    } else {
-        MSYS()->unlink({AX_ID_VDEC, m_vdec->get_grp_id(), 1}, {AX_ID_VENC, 0, m_venc->get_chn_id()});
-    }
+    MSYS()->unlink(m_graph);
 
     axclError ret;
     if (ret = m_venc->deinit(); AXCL_SUCC != ret) {
@@ -207,6 +207,8 @@ axclError ppl_transcode::get_attr(const char* name, void* attr) {
         *(reinterpret_cast<uint32_t*>(attr)) = m_venc_out_fifo_depth;
     } else if (0 == strcmp(name, "axcl.ppl.transcode.venc.stop.wait")) {
         *(reinterpret_cast<int32_t*>(attr)) = m_venc_stop_wait_time;
+    } else if (0 == strcmp(name, "axcl.ppl.transcode.link.setup.us")) {
+        *(reinterpret_cast<uint64_t*>(attr)) = m_graph.setup_us();
     } else {
         LOG_MM_E(TAG, "unsupport attribute {}", name);
         return AXCL_ERR_LITE_PPL_UNSUPPORT;
@@ -324,4 +326,25 @@ axclite_venc_attr ppl_transcode::get_venc_attr() {
     attr.gop = m_param.venc.gop;
 
     return attr;
-}
\ No newline at end of file
+}
+
+void ppl_transcode::make_link_graph() {
+    const axclite_vdec_attr vdec = get_vdec_attr();
+    const axclite_venc_attr venc = get_venc_attr();
+    const axclite::link_port venc_in = {{AX_ID_VENC, 0, m_venc->get_chn_id()}, venc.chn.width, venc.chn.height,
+                                        AX_FORMAT_YUV420_SEMIPLANAR, 0, venc.chn.in_fifo_depth};
+
+    m_graph.clear();
+    if (m_ivps) {
+        const axclite_ivps_attr ivps = get_ivps_attr();
+        const axclite_vdec_chn_attr& vdec_chn = vdec.chn[0];
+        const axclite_ivps_chn_attr& ivps_chn = ivps.chn[0];
+        m_graph.add({{AX_ID_VDEC, m_vdec->get_grp_id(), 0}, vdec_chn.width, vdec_chn.height, AX_FORMAT_YUV420_SEMIPLANAR, vdec_chn.blk_cnt, 0},
+                    {{AX_ID_IVPS, m_ivps->get_grp_id(), 0}, 0, 0, AX_FORMAT_INVALID, 0, ivps.grp.fifo_depth});
+        m_graph.add({{AX_ID_IVPS, m_ivps->get_grp_id(), 0}, ivps_chn.width, ivps_chn.height, ivps_chn.pix_fmt, ivps_chn.blk_cnt, 0}, venc_in);
+    } else {
+        const axclite_vdec_chn_attr& vdec_chn = vdec.chn[1];
+        m_graph.add({{AX_ID_VDEC, m_vdec->get_grp_id(), 1}, vdec_chn.width, vdec_chn.height, AX_FORMAT_YUV420_SEMIPLANAR, vdec_chn.blk_cnt, 0},
+                    venc_in);
+    }
+}
@@ -13,6 +13,7 @@
 #include <atomic>
 #include <memory>
 #include "axclite_ivps.hpp"
+#include "axclite_link.hpp"
 #include "axclite_vdec.hpp"
 #include "axclite_venc.hpp"
 #include "axclite_venc_sink.hpp"
@@ -41,6 +42,7 @@ protected:
     axclite_vdec_attr get_vdec_attr();
     axclite_ivps_attr get_ivps_attr();
     axclite_venc_attr get_venc_attr();
+    void make_link_graph();
 
 private:
     int32_t m_device;
@@ -50,6 +52,7 @@ private:
     std::unique_ptr<axclite::venc> m_venc;
     std::unique_ptr<axclite::ivps> m_ivps;
     axclite::venc_sinker m_sink;
+    axclite::link_graph m_graph;
     std::atomic<bool> m_started = {false};
 
     uint32_t m_vdec_blk_cnt = 8;
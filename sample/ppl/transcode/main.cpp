@@ -78,6 +78,7 @@ int main(int argc, char *argv[]) {
     a.add<std::string>("json", '\0', "axcl.json path", false, "./axcl.json");
     a.add<int32_t>("loop", '\0', "1: loop demux for local file  0: no loop(default)", false, 0, cmdline::oneof(0, 1));
     a.add<int32_t>("dump", '\0', "1: dump file  0: no dump(default)", false, 0, cmdline::oneof(0, 1));
+    a.add<uint16_t>("metrics_port", '\0', "serve Prometheus metrics on http://127.0.0.1:port/metrics, 0: disabled(default)", false, 0);
     a.add("ut", '\0', "unittest");
     a.parse_check(argc, argv);
     const std::string url = a.get<std::string>("url");
@@ -128,6 +129,7 @@ int main(int argc, char *argv[]) {
      */
     init_param.max_vdec_grp = 32;
     init_param.max_venc_thd = 1;
+    init_param.metrics_port = a.get<uint16_t>("metrics_port");
     if (ret = axcl_ppl_init(&init_param); AXCL_SUCC != ret) {
         SAMPLE_LOG_E("axcl_ppl_init(device %d) fail, ret = 0x%x", device, ret);
         return 1;
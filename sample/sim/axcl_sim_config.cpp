@@ -0,0 +1,163 @@
+/**************************************************************************************************
+ *
+ * Copyright (c) 2019-2024 Axera Semiconductor Co., Ltd. All Rights Reserved.
+ *
+ * This source file is the property of Axera Semiconductor Co., Ltd. and
+ * may not be copied or distributed in any isomorphic form without the prior
+ * written consent of Axera Semiconductor Co., Ltd.
+ *
+ **************************************************************************************************/
+
+#include "axcl_sim_config.hpp"
+#include <stdlib.h>
+#include <fstream>
+#include "axcl.h"
+#include "log/logger.hpp"
+
+#define TAG "axcl-sim-config"
+
+namespace axclsim {
+
+static std::map<std::string, std::string> default_config() {
+    return {
+        /* devices */
+        {"device.num", "1"},
+        {"device.first_id", "129"},
+        {"device.cmm_mb", "4096"},
+        /* divide every latency by speed, > 1 to run faster than the card */
+        {"sim.speed", "1.0"},
+        /* PCIe and on-chip DMA, rate in MB/s */
+        {"h2d.cores", "1"},
+        {"h2d.latency_us", "20"},
+        {"h2d.rate", "1800"},
+        {"d2h.cores", "1"},
+        {"d2h.latency_us", "20"},
+        {"d2h.rate", "1800"},
+        {"dma.cores", "1"},
+        {"dma.latency_us", "5"},
+        {"dma.rate", "6000"},
+        /* media units, rate in Mpixel/s */
+        {"vdec.cores", "1"},
+        {"vdec.latency_us", "300"},
+        {"vdec.rate", "1000"},
+        {"vdec.max_grp", std::to_string(AX_VDEC_MAX_GRP_NUM)},
+        {"jdec.cores", "1"},
+        {"jdec.latency_us", "200"},
+        {"jdec.rate", "400"},
+        {"venc.cores", "1"},
+        {"venc.latency_us", "500"},
+        {"venc.rate", "500"},
+        {"venc.max_chn", std::to_string(MAX_VENC_CHN_NUM)},
+        {"venc.gop", "30"},
+        {"venc.i_ratio", "0.1"}, /* stream bytes / NV12 bytes */
+        {"venc.p_ratio", "0.02"},
+        {"jenc.cores", "1"},
+        {"jenc.latency_us", "200"},
+        {"jenc.rate", "400"},
+        {"tdp.cores", "1"},
+        {"tdp.latency_us", "100"},
+        {"tdp.rate", "400"},
+        {"vpp.cores", "1"},
+        {"vpp.latency_us", "80"},
+        {"vpp.rate", "800"},
+        {"vgp.cores", "1"},
+        {"vgp.latency_us", "100"},
+        {"vgp.rate", "600"},
+        {"ivps.max_grp", std::to_string(AX_IVPS_MAX_GRP_NUM)},
+        /* NPU, models without a <model>.sim description use engine.* */
+        {"npu.cores", "3"},
+        {"engine.input", "images:1x640x640x3:uint8"},
+        {"engine.output", "output0:1x80x80x255:float32,output1:1x40x40x255:float32,output2:1x20x20x255:float32"},
+        {"engine.latency_us", "8000"},
+        {"engine.batch_latency_us", "6000"},
+        {"engine.cores", "3"},
+        {"engine.max_batch", "1"},
+        {"engine.groups", "1"},
+    };
+}
+
+config &config::get() {
+    static config instance;
+    return instance;
+}
+
+config::config() : m_kv(default_config()) {
+    if (const char *path = getenv("AXCL_SIM_CONFIG"); path && path[0]) {
+        (void)load(path);
+    }
+}
+
+bool config::parse_file(const std::string &path, std::map<std::string, std::string> &kv) {
+    std::ifstream ifs(path);
+    if (!ifs) {
+        return false;
+    }
+
+    auto trim = [](const std::string &s) -> std::string {
+        const auto b = s.find_first_not_of(" \t\r\n");
+        const auto e = s.find_last_not_of(" \t\r\n");
+        return (std::string::npos == b) ? std::string() : s.substr(b, e - b + 1);
+    };
+
+    std::string line;
+    while (std::getline(ifs, line)) {
+        if (auto pos = line.find('#'); std::string::npos != pos) {
+            line.erase(pos);
+        }
+
+        const auto pos = line.find('=');
+        if (std::string::npos == pos) {
+            continue;
+        }
+
+        const std::string key = trim(line.substr(0, pos));
+        if (!key.empty()) {
+            kv[key] = trim(line.substr(pos + 1));
+        }
+    }
+
+    return true;
+}
+
+bool config::load(const std::string &path) {
+    std::map<std::string, std::string> kv;
+    if (!parse_file(path, kv)) {
+        LOG_MM_E(TAG, "open {} fail", path);
+        return false;
+    }
+
+    for (auto &&[key, value] : kv) {
+        if (!set(key, value)) {
+            LOG_MM_W(TAG, "{}: unknown key {}", path, key);
+        }
+    }
+
+    return true;
+}
+
+bool config::set(const std::string &key, const std::string &value) {
+    std::lock_guard<std::mutex> lck(m_mtx);
+    auto it = m_kv.find(key);
+    if (it == m_kv.end()) {
+        return false;
+    }
+
+    it->second = value;
+    return true;
+}
+
+std::string config::get_str(const std::string &key) const {
+    std::lock_guard<std::mutex> lck(m_mtx);
+    auto it = m_kv.find(key);
+    return (it != m_kv.end()) ? it->second : std::string();
+}
+
+double config::get_f64(const std::string &key) const {
+    return strtod(get_str(key).c_str(), nullptr);
+}
+
+int64_t config::get_i64(const std::string &key) const {
+    return strtoll(get_str(key).c_str(), nullptr, 0);
+}
+
+}  // namespace axclsim
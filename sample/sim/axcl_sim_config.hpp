@@ -0,0 +1,44 @@
+/**************************************************************************************************
+ *
+ * Copyright (c) 2019-2024 Axera Semiconductor Co., Ltd. All Rights Reserved.
+ *
+ * This source file is the property of Axera Semiconductor Co., Ltd. and
+ * may not be copied or distributed in any isomorphic form without the prior
+ * written consent of Axera Semiconductor Co., Ltd.
+ *
+ **************************************************************************************************/
+
+#pragma once
+
+#include <map>
+#include <mutex>
+#include <string>
+
+namespace axclsim {
+
+/**
+ * @brief key = value settings of the simulator, see default_config() for all keys.
+ */
+class config {
+public:
+    static config &get();
+
+    bool load(const std::string &path);
+    bool set(const std::string &key, const std::string &value);
+
+    std::string get_str(const std::string &key) const;
+    double get_f64(const std::string &key) const;
+    int64_t get_i64(const std::string &key) const;
+
+    /* parse one "key = value" file into kv, '#' starts a comment */
+    static bool parse_file(const std::string &path, std::map<std::string, std::string> &kv);
+
+private:
+    config();
+
+private:
+    mutable std::mutex m_mtx;
+    std::map<std::string, std::string> m_kv;
+};
+
+}  // namespace axclsim
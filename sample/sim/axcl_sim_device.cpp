@@ -0,0 +1,567 @@
+/**************************************************************************************************
+ *
+ * Copyright (c) 2019-2024 Axera Semiconductor Co., Ltd. All Rights Reserved.
+ *
+ * This source file is the property of Axera Semiconductor Co., Ltd. and
+ * may not be copied or distributed in any isomorphic form without the prior
+ * written consent of Axera Semiconductor Co., Ltd.
+ *
+ **************************************************************************************************/
+
+#include "axcl_sim_device.hpp"
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <numeric>
+#include <thread>
+#include "axcl_sim_config.hpp"
+#include "axcl_sim_engine.hpp"
+#include "axcl_sim_ivps.hpp"
+#include "axcl_sim_vdec.hpp"
+#include "axcl_sim_venc.hpp"
+#include "log/logger.hpp"
+
+#define TAG "axcl-sim-device"
+
+namespace axclsim {
+
+hw_unit::hw_unit(const std::string &name, uint32_t cores, double latency_us, double rate, double speed)
+    : m_name(name), m_latency_us(latency_us), m_rate(rate), m_speed(speed), m_free_at(std::max(cores, 1u), sim_clock::now()) {
+}
+
+void hw_unit::run(double work, uint32_t cores, double extra_us, uint32_t mask) {
+    double cost = m_latency_us + extra_us + ((m_rate > 0) ? (work / m_rate) : 0);
+    if (m_speed > 0) {
+        cost /= m_speed;
+    }
+
+    sim_clock::time_point end;
+    {
+        std::lock_guard<std::mutex> lck(m_mtx);
+
+        const auto now = sim_clock::now();
+
+        std::vector<uint32_t> index;
+        for (uint32_t i = 0; i < m_free_at.size(); ++i) {
+            if (0 == mask || (mask & (1u << i))) {
+                index.push_back(i);
+            }
+        }
+        if (index.empty()) {
+            index.resize(m_free_at.size());
+            std::iota(index.begin(), index.end(), 0);
+        }
+        cores = std::min(std::max(cores, 1u), static_cast<uint32_t>(index.size()));
+
+        /* a job of k cores starts when the k earliest free cores are all free */
+        std::partial_sort(index.begin(), index.begin() + cores, index.end(),
+                          [this](uint32_t a, uint32_t b) { return m_free_at[a] < m_free_at[b]; });
+
+        auto start = std::max(now, m_free_at[index[cores - 1]]);
+        end = start + std::chrono::microseconds(static_cast<int64_t>(cost));
+        for (uint32_t i = 0; i < cores; ++i) {
+            m_free_at[index[i]] = end;
+        }
+
+        ++m_jobs;
+        m_busy_us += cost * cores;
+        m_wait_us += std::chrono::duration<double, std::micro>(start - now).count();
+    }
+
+    std::this_thread::sleep_until(end);
+}
+
+void hw_unit::get_stat(axcl_sim_unit_stat &stat) const {
+    std::lock_guard<std::mutex> lck(m_mtx);
+    memset(&stat, 0, sizeof(stat));
+    strncpy(stat.name, m_name.c_str(), sizeof(stat.name) - 1);
+    stat.cores = static_cast<AX_U32>(m_free_at.size());
+    stat.jobs = m_jobs;
+    stat.busy_us = static_cast<AX_U64>(m_busy_us);
+    stat.wait_us = static_cast<AX_U64>(m_wait_us);
+}
+
+void hw_unit::reset_stat() {
+    std::lock_guard<std::mutex> lck(m_mtx);
+    m_jobs = 0;
+    m_busy_us = 0;
+    m_wait_us = 0;
+}
+
+vb_registry &vb_registry::get() {
+    static vb_registry instance;
+    return instance;
+}
+
+AX_BLK vb_registry::add(vb_block *blk) {
+    std::lock_guard<std::mutex> lck(m_mtx);
+    while (AX_INVALID_BLOCKID == m_next || m_blocks.end() != m_blocks.find(m_next)) {
+        ++m_next;
+    }
+
+    blk->id = m_next++;
+    m_blocks[blk->id] = blk;
+    return blk->id;
+}
+
+void vb_registry::remove(AX_BLK id) {
+    std::lock_guard<std::mutex> lck(m_mtx);
+    m_blocks.erase(id);
+}
+
+bool vb_registry::increase(AX_BLK id) {
+    std::lock_guard<std::mutex> lck(m_mtx);
+    auto it = m_blocks.find(id);
+    if (it == m_blocks.end() || it->second->ref <= 0) {
+        return false;
+    }
+
+    ++it->second->ref;
+    return true;
+}
+
+bool vb_registry::decrease(AX_BLK id) {
+    vb_block *blk = nullptr;
+    {
+        std::lock_guard<std::mutex> lck(m_mtx);
+        auto it = m_blocks.find(id);
+        if (it == m_blocks.end() || it->second->ref <= 0) {
+            return false;
+        }
+
+        if (--it->second->ref > 0) {
+            return true;
+        }
+
+        blk = it->second;
+    }
+
+    /* nobody else holds the block, give it back without the registry lock (pool -> registry lock order) */
+    std::shared_ptr<vb_pool> pool = blk->pool;
+    pool->release(blk);
+    return true;
+}
+
+bool vb_registry::query(AX_BLK id, AX_U64 &phy, AX_U32 &size) {
+    std::lock_guard<std::mutex> lck(m_mtx);
+    auto it = m_blocks.find(id);
+    if (it == m_blocks.end()) {
+        return false;
+    }
+
+    phy = it->second->phy;
+    size = it->second->size;
+    return true;
+}
+
+std::shared_ptr<vb_pool> vb_pool::create(device *dev, AX_U32 cnt, AX_U32 size) {
+    std::shared_ptr<vb_pool> pool(new vb_pool(dev, size));
+    for (AX_U32 i = 0; i < cnt; ++i) {
+        void *mem = dev->cmm_alloc(size, 4096);
+        if (!mem) {
+            pool->close();
+            return nullptr;
+        }
+
+        auto *blk = new vb_block{AX_INVALID_BLOCKID, reinterpret_cast<AX_U64>(mem), size, 0, pool};
+        vb_registry::get().add(blk);
+        pool->m_all.push_back(blk);
+        pool->m_free.push_back(blk);
+    }
+
+    return pool;
+}
+
+vb_pool::~vb_pool() {
+    close();
+}
+
+AX_BLK vb_pool::get(int32_t timeout) {
+    std::unique_lock<std::mutex> lck(m_mtx);
+    if (!wait_for(m_cv, lck, timeout, [this]() { return m_closed || !m_free.empty(); }) || m_closed) {
+        return AX_INVALID_BLOCKID;
+    }
+
+    vb_block *blk = m_free.back();
+    m_free.pop_back();
+    blk->ref = 1;
+    return blk->id;
+}
+
+vb_block *vb_pool::find(AX_BLK id) {
+    std::lock_guard<std::mutex> lck(m_mtx);
+    auto it = std::find_if(m_all.begin(), m_all.end(), [id](const vb_block *m) { return m->id == id; });
+    return (it != m_all.end()) ? *it : nullptr;
+}
+
+void vb_pool::close() {
+    std::lock_guard<std::mutex> lck(m_mtx);
+    if (m_closed) {
+        return;
+    }
+
+    m_closed = true;
+
+    /* blocks held by users are destroyed on their last release */
+    for (auto &&blk : m_free) {
+        destroy(blk);
+    }
+
+    m_free.clear();
+    m_cv.notify_all();
+}
+
+void vb_pool::release(vb_block *blk) {
+    std::lock_guard<std::mutex> lck(m_mtx);
+    if (m_closed) {
+        destroy(blk);
+        return;
+    }
+
+    m_free.push_back(blk);
+    m_cv.notify_one();
+}
+
+void vb_pool::destroy(vb_block *blk) {
+    vb_registry::get().remove(blk->id);
+    m_dev->cmm_free(reinterpret_cast<void *>(blk->phy));
+    m_all.erase(std::remove(m_all.begin(), m_all.end(), blk), m_all.end());
+
+    /* the block may hold the last reference of this pool, the caller keeps another one */
+    blk->pool.reset();
+    delete blk;
+}
+
+device::device(int32_t id) : m_id(id) {
+    const config &cfg = config::get();
+    const double speed = cfg.get_f64("sim.speed");
+    for (auto &&name : {"vdec", "jdec", "venc", "jenc", "tdp", "vpp", "vgp", "npu", "h2d", "d2h", "dma"}) {
+        const std::string prefix(name);
+        m_units[prefix] = std::make_unique<hw_unit>(prefix, static_cast<uint32_t>(cfg.get_i64(prefix + ".cores")),
+                                                    cfg.get_f64(prefix + ".latency_us"), cfg.get_f64(prefix + ".rate"), speed);
+    }
+
+    m_cmm_total = static_cast<uint64_t>(cfg.get_i64("device.cmm_mb")) << 20;
+    m_util_time = sim_clock::now();
+
+    vdec = std::make_unique<vdec_module>(this);
+    venc = std::make_unique<venc_module>(this);
+    ivps = std::make_unique<ivps_module>(this);
+    engine = std::make_unique<engine_module>(this);
+}
+
+device::~device() {
+    /* downstream first, upstream modules may still forward frames */
+    engine.reset();
+    vdec.reset();
+    ivps.reset();
+    venc.reset();
+
+    std::lock_guard<std::mutex> lck(m_mtx_cmm);
+    for (auto &&[addr, size] : m_cmm) {
+        free(reinterpret_cast<void *>(addr));
+    }
+}
+
+hw_unit *device::unit(const std::string &name) {
+    auto it = m_units.find(name);
+    return (it != m_units.end()) ? it->second.get() : nullptr;
+}
+
+void *device::cmm_alloc(uint64_t size, uint32_t align) {
+    if (0 == size) {
+        return nullptr;
+    }
+
+    std::lock_guard<std::mutex> lck(m_mtx_cmm);
+    if (m_cmm_used + size > m_cmm_total) {
+        LOG_MM_W(TAG, "device {}: cmm exhausted, used {} + {} > total {}", m_id, m_cmm_used, size, m_cmm_total);
+        return nullptr;
+    }
+
+    void *ptr = nullptr;
+    if (0 != posix_memalign(&ptr, std::max<size_t>(align, 64), size)) {
+        return nullptr;
+    }
+
+    m_cmm[reinterpret_cast<uintptr_t>(ptr)] = size;
+    m_cmm_used += size;
+    return ptr;
+}
+
+bool device::cmm_free(void *ptr) {
+    std::lock_guard<std::mutex> lck(m_mtx_cmm);
+    auto it = m_cmm.find(reinterpret_cast<uintptr_t>(ptr));
+    if (it == m_cmm.end()) {
+        return false;
+    }
+
+    m_cmm_used -= it->second;
+    m_cmm.erase(it);
+    free(ptr);
+    return true;
+}
+
+bool device::is_cmm(const void *ptr, uint64_t size) {
+    const uintptr_t addr = reinterpret_cast<uintptr_t>(ptr);
+
+    std::lock_guard<std::mutex> lck(m_mtx_cmm);
+    auto it = m_cmm.upper_bound(addr);
+    if (it == m_cmm.begin()) {
+        return false;
+    }
+
+    --it;
+    return (addr + size <= it->first + it->second);
+}
+
+static bool operator==(const AX_MOD_INFO_T &a, const AX_MOD_INFO_T &b) {
+    return a.enModId == b.enModId && a.s32GrpId == b.s32GrpId && a.s32ChnId == b.s32ChnId;
+}
+
+bool device::link(const AX_MOD_INFO_T &src, const AX_MOD_INFO_T &dst) {
+    std::lock_guard<std::mutex> lck(m_mtx_link);
+    for (auto &&m : m_links) {
+        if (m.first == src || m.second == dst) {
+            return false;
+        }
+    }
+
+    m_links.emplace_back(src, dst);
+    return true;
+}
+
+bool device::unlink(const AX_MOD_INFO_T &src, const AX_MOD_INFO_T &dst) {
+    std::lock_guard<std::mutex> lck(m_mtx_link);
+    for (auto it = m_links.begin(); it != m_links.end(); ++it) {
+        if (it->first == src && it->second == dst) {
+            m_links.erase(it);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+bool device::get_link(const AX_MOD_INFO_T &src, AX_MOD_INFO_T &dst) {
+    std::lock_guard<std::mutex> lck(m_mtx_link);
+    for (auto &&m : m_links) {
+        if (m.first == src) {
+            dst = m.second;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+bool device::get_link_by_dest(const AX_MOD_INFO_T &dst, AX_MOD_INFO_T &src) {
+    std::lock_guard<std::mutex> lck(m_mtx_link);
+    for (auto &&m : m_links) {
+        if (m.second == dst) {
+            src = m.first;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+bool device::forward(const AX_MOD_INFO_T &src, const AX_VIDEO_FRAME_T &frame) {
+    AX_MOD_INFO_T dst;
+    if (!get_link(src, dst)) {
+        return false;
+    }
+
+    switch (dst.enModId) {
+        case AX_ID_IVPS:
+            ivps->recv_linked_frame(dst.s32GrpId, frame);
+            break;
+        case AX_ID_VENC:
+        case AX_ID_JENC:
+            venc->recv_linked_frame(dst.s32ChnId, frame);
+            break;
+        default:
+            LOG_MM_W(TAG, "device {}: link to module {} is not simulated, drop frame {}", m_id, static_cast<int32_t>(dst.enModId),
+                     frame.u64SeqNum);
+            break;
+    }
+
+    return true;
+}
+
+int32_t device::npu_utilization() {
+    axcl_sim_unit_stat stat;
+    unit("npu")->get_stat(stat);
+
+    std::lock_guard<std::mutex> lck(m_mtx_util);
+    const auto now = sim_clock::now();
+    const double elapsed = std::chrono::duration<double, std::micro>(now - m_util_time).count() * stat.cores;
+    const double busy = static_cast<double>(stat.busy_us - std::min<uint64_t>(stat.busy_us, m_util_busy_us));
+    m_util_time = now;
+    m_util_busy_us = stat.busy_us;
+
+    return (elapsed > 0) ? static_cast<int32_t>(std::min(100.0, busy * 100.0 / elapsed)) : 0;
+}
+
+simulator &simulator::get() {
+    static simulator instance;
+    return instance;
+}
+
+bool simulator::init() {
+    std::lock_guard<std::mutex> lck(m_mtx);
+    if (m_init) {
+        return true;
+    }
+
+    const config &cfg = config::get();
+    const int64_t num = cfg.get_i64("device.num");
+    const int64_t first = cfg.get_i64("device.first_id");
+    if (num <= 0 || num > AXCL_MAX_DEVICE_COUNT) {
+        LOG_MM_E(TAG, "invalid device.num {}", num);
+        return false;
+    }
+
+    for (int64_t i = 0; i < num; ++i) {
+        m_devices.push_back(std::make_unique<device>(static_cast<int32_t>(first + i)));
+    }
+
+    LOG_MM_I(TAG, "{} simulated devices from {}", num, first);
+    m_init = true;
+    return true;
+}
+
+void simulator::finalize() {
+    std::lock_guard<std::mutex> lck(m_mtx);
+    if (!m_init) {
+        return;
+    }
+
+    m_init = false;
+    m_contexts.clear();
+    m_devices.clear();
+    current_context() = nullptr;
+}
+
+std::vector<int32_t> simulator::device_ids() {
+    std::lock_guard<std::mutex> lck(m_mtx);
+    std::vector<int32_t> ids;
+    for (auto &&m : m_devices) {
+        ids.push_back(m->id());
+    }
+
+    return ids;
+}
+
+device *simulator::find(int32_t id) {
+    std::lock_guard<std::mutex> lck(m_mtx);
+    for (auto &&m : m_devices) {
+        if (m->id() == id) {
+            return m.get();
+        }
+    }
+
+    return nullptr;
+}
+
+context *simulator::create_context(device *dev) {
+    std::lock_guard<std::mutex> lck(m_mtx);
+    m_contexts.push_back(std::make_unique<context>(context{dev}));
+    return m_contexts.back().get();
+}
+
+bool simulator::destroy_context(context *ctx) {
+    std::lock_guard<std::mutex> lck(m_mtx);
+    auto it = std::find_if(m_contexts.begin(), m_contexts.end(), [ctx](const std::unique_ptr<context> &m) { return m.get() == ctx; });
+    if (it == m_contexts.end()) {
+        return false;
+    }
+
+    m_contexts.erase(it);
+    return true;
+}
+
+bool simulator::valid_context(context *ctx) {
+    std::lock_guard<std::mutex> lck(m_mtx);
+    return m_contexts.end() !=
+           std::find_if(m_contexts.begin(), m_contexts.end(), [ctx](const std::unique_ptr<context> &m) { return m.get() == ctx; });
+}
+
+context *&simulator::current_context() {
+    thread_local context *ctx = nullptr;
+    return ctx;
+}
+
+device *simulator::current() {
+    context *ctx = current_context();
+    if (!ctx || !get().m_init) {
+        return nullptr;
+    }
+
+    return ctx->dev;
+}
+
+AX_U64 frame_size(AX_IMG_FORMAT_E fmt, AX_U32 stride, AX_U32 height) {
+    const AX_U64 pixels = static_cast<AX_U64>(stride) * height;
+    switch (fmt) {
+        case AX_FORMAT_YUV400:
+            return pixels;
+        case AX_FORMAT_YUV420_PLANAR:
+        case AX_FORMAT_YUV420_PLANAR_VU:
+        case AX_FORMAT_YUV420_SEMIPLANAR:
+        case AX_FORMAT_YUV420_SEMIPLANAR_VU:
+            return pixels * 3 / 2;
+        case AX_FORMAT_RGB888:
+        case AX_FORMAT_BGR888:
+            return pixels * 3;
+        case AX_FORMAT_YUV422_PLANAR:
+        case AX_FORMAT_YUV422_PLANAR_VU:
+        case AX_FORMAT_YUV422_SEMIPLANAR:
+        case AX_FORMAT_YUV422_SEMIPLANAR_VU:
+        case AX_FORMAT_YUV422_INTERLEAVED_YUYV:
+        case AX_FORMAT_YUV422_INTERLEAVED_UYVY:
+        case AX_FORMAT_RGB565:
+        case AX_FORMAT_BGR565:
+            return pixels * 2;
+        default:
+            /* 32bpp and 10 bit formats, never undersize a block */
+            return pixels * 4;
+    }
+}
+
+void fill_frame(AX_VIDEO_FRAME_T &frame, const vb_block *blk, AX_U32 width, AX_U32 height, AX_U32 stride, AX_IMG_FORMAT_E fmt) {
+    memset(&frame, 0, sizeof(frame));
+    frame.u32Width = width;
+    frame.u32Height = height;
+    frame.enImgFormat = fmt;
+    frame.u32PicStride[0] = stride;
+    frame.u64PhyAddr[0] = blk->phy;
+    frame.u64VirAddr[0] = blk->phy;
+    frame.u32BlkId[0] = blk->id;
+    if (AX_FORMAT_YUV420_SEMIPLANAR == fmt || AX_FORMAT_YUV420_SEMIPLANAR_VU == fmt) {
+        frame.u32PicStride[1] = stride;
+        frame.u64PhyAddr[1] = blk->phy + static_cast<AX_U64>(stride) * height;
+        frame.u64VirAddr[1] = frame.u64PhyAddr[1];
+    }
+
+    frame.u32FrameSize = static_cast<AX_U32>(frame_size(fmt, stride, height));
+}
+
+void ref_frame(const AX_VIDEO_FRAME_T &frame) {
+    for (uint32_t i = 0; i < AX_MAX_COLOR_COMPONENT; ++i) {
+        if (AX_INVALID_BLOCKID != frame.u32BlkId[i]) {
+            vb_registry::get().increase(frame.u32BlkId[i]);
+        }
+    }
+}
+
+void unref_frame(const AX_VIDEO_FRAME_T &frame) {
+    for (uint32_t i = 0; i < AX_MAX_COLOR_COMPONENT; ++i) {
+        if (AX_INVALID_BLOCKID != frame.u32BlkId[i]) {
+            vb_registry::get().decrease(frame.u32BlkId[i]);
+        }
+    }
+}
+
+}  // namespace axclsim
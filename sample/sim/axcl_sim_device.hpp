@@ -0,0 +1,248 @@
+/**************************************************************************************************
+ *
+ * Copyright (c) 2019-2024 Axera Semiconductor Co., Ltd. All Rights Reserved.
+ *
+ * This source file is the property of Axera Semiconductor Co., Ltd. and
+ * may not be copied or distributed in any isomorphic form without the prior
+ * written consent of Axera Semiconductor Co., Ltd.
+ *
+ **************************************************************************************************/
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "axcl_sim.h"
+
+namespace axclsim {
+
+using sim_clock = std::chrono::steady_clock;
+
+/**
+ * @brief wait until pred() is true, timeout (ms): < 0 forever, 0 try once.
+ */
+template <typename Pred>
+bool wait_for(std::condition_variable &cv, std::unique_lock<std::mutex> &lck, int32_t timeout, Pred pred) {
+    if (timeout < 0) {
+        cv.wait(lck, pred);
+        return true;
+    }
+
+    return cv.wait_for(lck, std::chrono::milliseconds(timeout), pred);
+}
+
+/**
+ * @brief a hardware unit of N cores, a job takes the earliest free core(s) for latency_us + work / rate.
+ */
+class hw_unit {
+public:
+    hw_unit(const std::string &name, uint32_t cores, double latency_us, double rate, double speed);
+
+    /* blocks the caller until the job is done, mask selects the cores the job may take (bit i: core i), 0 for all */
+    void run(double work, uint32_t cores = 1, double extra_us = 0, uint32_t mask = 0);
+
+    uint32_t cores() const {
+        return static_cast<uint32_t>(m_free_at.size());
+    }
+
+    void get_stat(axcl_sim_unit_stat &stat) const;
+    void reset_stat();
+
+private:
+    const std::string m_name;
+    const double m_latency_us;
+    const double m_rate;
+    const double m_speed;
+    mutable std::mutex m_mtx;
+    std::vector<sim_clock::time_point> m_free_at;
+    uint64_t m_jobs = 0;
+    double m_busy_us = 0;
+    double m_wait_us = 0;
+};
+
+class vb_pool;
+
+struct vb_block {
+    AX_BLK id;
+    AX_U64 phy;
+    AX_U32 size;
+    int32_t ref;
+    std::shared_ptr<vb_pool> pool;
+};
+
+/**
+ * @brief all VB blocks of all devices, AXCL_POOL_*RefCnt() work on global block ids.
+ */
+class vb_registry {
+public:
+    static vb_registry &get();
+
+    AX_BLK add(vb_block *blk);
+    void remove(AX_BLK id);
+
+    bool increase(AX_BLK id);
+    bool decrease(AX_BLK id);
+    bool query(AX_BLK id, AX_U64 &phy, AX_U32 &size);
+
+private:
+    vb_registry() = default;
+
+private:
+    std::mutex m_mtx;
+    std::map<AX_BLK, vb_block *> m_blocks;
+    AX_BLK m_next = 1;
+};
+
+class device;
+
+/**
+ * @brief fixed number of equal blocks carved from device CMM, blocks are recycled when their reference drops to 0.
+ *        close() frees idle blocks at once and busy blocks on their last release.
+ */
+class vb_pool : public std::enable_shared_from_this<vb_pool> {
+public:
+    static std::shared_ptr<vb_pool> create(device *dev, AX_U32 cnt, AX_U32 size);
+    ~vb_pool();
+
+    /* returns AX_INVALID_BLOCKID on timeout or close, the block is referenced once */
+    AX_BLK get(int32_t timeout);
+    vb_block *find(AX_BLK id);
+    void close();
+
+    AX_U32 size() const {
+        return m_size;
+    }
+
+protected:
+    vb_pool(device *dev, AX_U32 size) : m_dev(dev), m_size(size) {
+    }
+
+    friend class vb_registry;
+    void release(vb_block *blk);
+    void destroy(vb_block *blk);
+
+private:
+    device *m_dev;
+    const AX_U32 m_size;
+    std::mutex m_mtx;
+    std::condition_variable m_cv;
+    std::vector<vb_block *> m_all;
+    std::vector<vb_block *> m_free;
+    bool m_closed = false;
+};
+
+class vdec_module;
+class venc_module;
+class ivps_module;
+class engine_module;
+
+class device {
+public:
+    explicit device(int32_t id);
+    ~device();
+
+    int32_t id() const {
+        return m_id;
+    }
+
+    hw_unit *unit(const std::string &name);
+
+    /* CMM is host memory accounted against device.cmm_mb, physical address == virtual address */
+    void *cmm_alloc(uint64_t size, uint32_t align = 0);
+    bool cmm_free(void *ptr);
+    bool is_cmm(const void *ptr, uint64_t size);
+    uint64_t cmm_used() const {
+        return m_cmm_used;
+    }
+    uint64_t cmm_total() const {
+        return m_cmm_total;
+    }
+
+    bool link(const AX_MOD_INFO_T &src, const AX_MOD_INFO_T &dst);
+    bool unlink(const AX_MOD_INFO_T &src, const AX_MOD_INFO_T &dst);
+    bool get_link(const AX_MOD_INFO_T &src, AX_MOD_INFO_T &dst);
+    bool get_link_by_dest(const AX_MOD_INFO_T &dst, AX_MOD_INFO_T &src);
+
+    /* deliver a frame to the linked receiver, returns false if src is not linked */
+    bool forward(const AX_MOD_INFO_T &src, const AX_VIDEO_FRAME_T &frame);
+
+    /* NPU busy percent since the last call */
+    int32_t npu_utilization();
+
+    std::unique_ptr<vdec_module> vdec;
+    std::unique_ptr<venc_module> venc;
+    std::unique_ptr<ivps_module> ivps;
+    std::unique_ptr<engine_module> engine;
+
+private:
+    const int32_t m_id;
+    std::map<std::string, std::unique_ptr<hw_unit>> m_units;
+
+    std::mutex m_mtx_cmm;
+    std::map<uintptr_t, uint64_t> m_cmm;
+    uint64_t m_cmm_used = 0;
+    uint64_t m_cmm_total = 0;
+
+    std::mutex m_mtx_link;
+    std::vector<std::pair<AX_MOD_INFO_T, AX_MOD_INFO_T>> m_links;
+
+    std::mutex m_mtx_util;
+    sim_clock::time_point m_util_time;
+    uint64_t m_util_busy_us = 0;
+};
+
+struct context {
+    device *dev;
+};
+
+/**
+ * @brief process wide state: devices created by axclInit() and the context bound to each thread.
+ */
+class simulator {
+public:
+    static simulator &get();
+
+    bool init();
+    void finalize();
+    bool initialized() const {
+        return m_init;
+    }
+
+    std::vector<int32_t> device_ids();
+    device *find(int32_t id);
+
+    context *create_context(device *dev);
+    bool destroy_context(context *ctx);
+    bool valid_context(context *ctx);
+
+    /* device of the context bound to the calling thread */
+    static device *current();
+    static context *&current_context();
+
+private:
+    simulator() = default;
+
+private:
+    std::mutex m_mtx;
+    std::atomic<bool> m_init = {false};
+    std::vector<std::unique_ptr<device>> m_devices;
+    std::vector<std::unique_ptr<context>> m_contexts;
+};
+
+/* bytes of a frame of fmt, stride in pixels */
+AX_U64 frame_size(AX_IMG_FORMAT_E fmt, AX_U32 stride, AX_U32 height);
+
+/* fill frame with the geometry and the block */
+void fill_frame(AX_VIDEO_FRAME_T &frame, const vb_block *blk, AX_U32 width, AX_U32 height, AX_U32 stride, AX_IMG_FORMAT_E fmt);
+
+/* reference all blocks of frame, or drop the references */
+void ref_frame(const AX_VIDEO_FRAME_T &frame);
+void unref_frame(const AX_VIDEO_FRAME_T &frame);
+
+}  // namespace axclsim
@@ -0,0 +1,752 @@
+/**************************************************************************************************
+ *
+ * Copyright (c) 2019-2024 Axera Semiconductor Co., Ltd. All Rights Reserved.
+ *
+ * This source file is the property of Axera Semiconductor Co., Ltd. and
+ * may not be copied or distributed in any isomorphic form without the prior
+ * written consent of Axera Semiconductor Co., Ltd.
+ *
+ **************************************************************************************************/
+
+#include "axcl_sim_engine.hpp"
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <sstream>
+#include "axcl_sim_config.hpp"
+#include "axcl_sim_stream.hpp"
+#include "log/logger.hpp"
+
+#define TAG "axcl-sim-engine"
+
+namespace axclsim {
+
+static bool parse_type(const std::string &name, axclrtEngineDataType &type, uint32_t &bytes) {
+    static const struct {
+        const char *name;
+        axclrtEngineDataType type;
+        uint32_t bytes;
+    } types[] = {
+        {"uint8", AXCL_DATA_TYPE_UINT8, 1},     {"int8", AXCL_DATA_TYPE_INT8, 1},       {"uint16", AXCL_DATA_TYPE_UINT16, 2},
+        {"int16", AXCL_DATA_TYPE_INT16, 2},     {"uint32", AXCL_DATA_TYPE_UINT32, 4},   {"int32", AXCL_DATA_TYPE_INT32, 4},
+        {"float16", AXCL_DATA_TYPE_FP16, 2},    {"bfloat16", AXCL_DATA_TYPE_BF16, 2},   {"float32", AXCL_DATA_TYPE_FP32, 4},
+    };
+
+    for (auto &&m : types) {
+        if (name == m.name) {
+            type = m.type;
+            bytes = m.bytes;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+bool model_desc::parse_tensors(const std::string &spec, std::vector<tensor_desc> &tensors) {
+    tensors.clear();
+
+    std::stringstream ss(spec);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        /* name:AxBxC:dtype */
+        const size_t p1 = item.find(':');
+        const size_t p2 = item.rfind(':');
+        if (std::string::npos == p1 || p1 == p2) {
+            return false;
+        }
+
+        tensor_desc t;
+        t.name = item.substr(0, p1);
+        uint32_t bytes;
+        if (t.name.empty() || !parse_type(item.substr(p2 + 1), t.type, bytes)) {
+            return false;
+        }
+
+        std::stringstream ds(item.substr(p1 + 1, p2 - p1 - 1));
+        std::string dim;
+        t.size = bytes;
+        while (std::getline(ds, dim, 'x')) {
+            const int32_t n = static_cast<int32_t>(strtol(dim.c_str(), nullptr, 10));
+            if (n <= 0 || t.dims.size() >= AXCLRT_ENGINE_MAX_DIM_CNT) {
+                return false;
+            }
+
+            t.dims.push_back(n);
+            t.size *= static_cast<uint64_t>(n);
+        }
+
+        if (t.dims.empty()) {
+            return false;
+        }
+
+        tensors.push_back(std::move(t));
+    }
+
+    return !tensors.empty();
+}
+
+bool model_desc::parse(const std::map<std::string, std::string> &kv, model_desc &desc) {
+    auto value = [&kv](const char *key) -> std::string {
+        auto it = kv.find(key);
+        return (it != kv.end()) ? it->second : std::string();
+    };
+
+    if (!parse_tensors(value("input"), desc.inputs) || !parse_tensors(value("output"), desc.outputs)) {
+        return false;
+    }
+
+    desc.latency_us = strtod(value("latency_us").c_str(), nullptr);
+    desc.batch_latency_us = strtod(value("batch_latency_us").c_str(), nullptr);
+    desc.cores = static_cast<uint32_t>(std::max(1L, strtol(value("cores").c_str(), nullptr, 10)));
+    desc.max_batch = static_cast<uint32_t>(std::max(1L, strtol(value("max_batch").c_str(), nullptr, 10)));
+    desc.groups = static_cast<uint32_t>(std::max(1L, strtol(value("groups").c_str(), nullptr, 10)));
+    return true;
+}
+
+static std::map<std::string, std::string> default_desc() {
+    const config &cfg = config::get();
+    std::map<std::string, std::string> kv;
+    for (auto &&key : {"input", "output", "latency_us", "batch_latency_us", "cores", "max_batch", "groups"}) {
+        kv[key] = cfg.get_str(std::string("engine.") + key);
+    }
+
+    return kv;
+}
+
+engine_module::engine_module(device *dev) : m_dev(dev) {
+}
+
+engine_module::~engine_module() {
+    std::lock_guard<std::mutex> lck(m_mtx);
+    for (auto &&m : m_models) {
+        m_dev->cmm_free(m.second.cmm);
+    }
+
+    m_models.clear();
+}
+
+axclError engine_module::init(axclrtEngineVNpuKind kind) {
+    std::lock_guard<std::mutex> lck(m_mtx);
+    m_vnpu = kind;
+    return AXCL_SUCC;
+}
+
+axclError engine_module::finalize() {
+    return AXCL_SUCC;
+}
+
+axclError engine_module::load(const model_desc &desc, uint64_t size, uint64_t &id) {
+    /* the model image stays in device CMM until unloaded */
+    void *cmm = m_dev->cmm_alloc(std::max<uint64_t>(size, 1), 4096);
+    if (!cmm) {
+        LOG_MM_E(TAG, "device {}: no memory for model of {} bytes", m_dev->id(), size);
+        return AXCL_ERR_ENGINE_EXECUTE_FAIL;
+    }
+
+    std::lock_guard<std::mutex> lck(m_mtx);
+    id = m_next++;
+    m_models[id] = {desc, size, cmm, all_cores(), {}};
+    return AXCL_SUCC;
+}
+
+axclError engine_module::load_from_file(const char *path, uint64_t &id) {
+    struct stat st;
+    if (0 != stat(path, &st)) {
+        LOG_MM_E(TAG, "model {} not exist", path);
+        return AXCL_ERR_ENGINE_ILLEGAL_PARAM;
+    }
+
+    std::map<std::string, std::string> kv = default_desc();
+    const std::string sidecar = std::string(path) + ".sim";
+    if (0 == access(sidecar.c_str(), R_OK)) {
+        std::map<std::string, std::string> sim;
+        if (!config::parse_file(sidecar, sim)) {
+            return AXCL_ERR_ENGINE_ILLEGAL_PARAM;
+        }
+
+        for (auto &&m : sim) {
+            kv[m.first] = m.second;
+        }
+    }
+
+    model_desc desc;
+    if (!model_desc::parse(kv, desc)) {
+        LOG_MM_E(TAG, "invalid description of model {}", path);
+        return AXCL_ERR_ENGINE_ILLEGAL_PARAM;
+    }
+
+    return load(desc, static_cast<uint64_t>(st.st_size), id);
+}
+
+axclError engine_module::load_from_mem(const void *model, uint64_t size, uint64_t &id) {
+    (void)model;
+    model_desc desc;
+    if (!model_desc::parse(default_desc(), desc)) {
+        LOG_MM_E(TAG, "invalid engine.* description");
+        return AXCL_ERR_ENGINE_ILLEGAL_PARAM;
+    }
+
+    return load(desc, size, id);
+}
+
+axclError engine_module::unload(uint64_t id) {
+    std::lock_guard<std::mutex> lck(m_mtx);
+    auto it = m_models.find(id);
+    if (it == m_models.end()) {
+        return AXCL_ERR_ENGINE_ILLEGAL_PARAM;
+    }
+
+    m_dev->cmm_free(it->second.cmm);
+    m_models.erase(it);
+    return AXCL_SUCC;
+}
+
+axclError engine_module::get_desc(uint64_t id, model_desc &desc, uint64_t *size) {
+    std::lock_guard<std::mutex> lck(m_mtx);
+    auto it = m_models.find(id);
+    if (it == m_models.end()) {
+        return AXCL_ERR_ENGINE_ILLEGAL_PARAM;
+    }
+
+    desc = it->second.desc;
+    if (size) {
+        *size = it->second.size;
+    }
+
+    return AXCL_SUCC;
+}
+
+axclrtEngineSet engine_module::all_cores() const {
+    return static_cast<axclrtEngineSet>((1ull << m_dev->unit("npu")->cores()) - 1);
+}
+
+axclError engine_module::set_affinity(uint64_t id, axclrtEngineSet set) {
+    if (0 == set || 0 != (set & ~all_cores())) {
+        return AXCL_ERR_ENGINE_ILLEGAL_PARAM;
+    }
+
+    std::lock_guard<std::mutex> lck(m_mtx);
+    auto it = m_models.find(id);
+    if (it == m_models.end()) {
+        return AXCL_ERR_ENGINE_ILLEGAL_PARAM;
+    }
+
+    it->second.affinity = set;
+    return AXCL_SUCC;
+}
+
+axclError engine_module::get_affinity(uint64_t id, axclrtEngineSet &set) {
+    std::lock_guard<std::mutex> lck(m_mtx);
+    auto it = m_models.find(id);
+    if (it == m_models.end()) {
+        return AXCL_ERR_ENGINE_ILLEGAL_PARAM;
+    }
+
+    set = it->second.affinity;
+    return AXCL_SUCC;
+}
+
+axclError engine_module::create_context(uint64_t id, uint64_t &context) {
+    std::lock_guard<std::mutex> lck(m_mtx);
+    auto it = m_models.find(id);
+    if (it == m_models.end()) {
+        return AXCL_ERR_ENGINE_ILLEGAL_PARAM;
+    }
+
+    it->second.contexts.push_back(it->second.affinity);
+    context = it->second.contexts.size();
+    return AXCL_SUCC;
+}
+
+axclError engine_module::execute(uint64_t id, uint64_t context, uint32_t group, const io_buffers &io) {
+    model_desc desc;
+    axclrtEngineSet affinity;
+    {
+        std::lock_guard<std::mutex> lck(m_mtx);
+        auto it = m_models.find(id);
+        if (it == m_models.end() || 0 == context || context > it->second.contexts.size()) {
+            return AXCL_ERR_ENGINE_ILLEGAL_PARAM;
+        }
+
+        desc = it->second.desc;
+        affinity = it->second.contexts[context - 1];
+    }
+
+    if (group >= desc.groups) {
+        return AXCL_ERR_ENGINE_INVALID_INDEX;
+    }
+
+    const uint32_t batch = std::max<uint32_t>(io.batch, 1);
+    if (batch > desc.max_batch) {
+        return AXCL_ERR_ENGINE_ILLEGAL_PARAM;
+    }
+
+    auto check = [this](const std::vector<std::pair<const void *, uint64_t>> &buffers) -> bool {
+        for (auto &&m : buffers) {
+            if (!m.first || !m_dev->is_cmm(m.first, m.second)) {
+                return false;
+            }
+        }
+
+        return true;
+    };
+
+    if (!check(io.inputs) || !check(io.outputs)) {
+        LOG_MM_E(TAG, "model {}: io buffers are not set or not device memory", id);
+        return AXCL_ERR_ENGINE_ILLEGAL_PARAM;
+    }
+
+    m_dev->unit("npu")->run(0, desc.cores, desc.latency_us + (batch - 1) * desc.batch_latency_us, affinity);
+    return AXCL_SUCC;
+}
+
+}  // namespace axclsim
+
+using namespace axclsim;
+
+static engine_module *current_engine() {
+    device *dev = simulator::current();
+    return dev ? dev->engine.get() : nullptr;
+}
+
+axclError axclrtEngineInit(axclrtEngineVNpuKind npuKind) {
+    engine_module *engine = current_engine();
+    return engine ? engine->init(npuKind) : AXCL_ERR_CONTEXT_NO_BIND_CONTEXT;
+}
+
+axclError axclrtEngineGetVNpuKind(axclrtEngineVNpuKind *npuKind) {
+    if (!npuKind) {
+        return AXCL_ERR_ENGINE_NULL_POINTER;
+    }
+
+    engine_module *engine = current_engine();
+    if (!engine) {
+        return AXCL_ERR_CONTEXT_NO_BIND_CONTEXT;
+    }
+
+    *npuKind = engine->vnpu_kind();
+    return AXCL_SUCC;
+}
+
+axclError axclrtEngineFinalize() {
+    engine_module *engine = current_engine();
+    return engine ? engine->finalize() : AXCL_ERR_CONTEXT_NO_BIND_CONTEXT;
+}
+
+axclError axclrtEngineLoadFromFile(const char *modelPath, uint64_t *modelId) {
+    if (!modelPath || !modelId) {
+        return AXCL_ERR_ENGINE_NULL_POINTER;
+    }
+
+    engine_module *engine = current_engine();
+    return engine ? engine->load_from_file(modelPath, *modelId) : AXCL_ERR_CONTEXT_NO_BIND_CONTEXT;
+}
+
+axclError axclrtEngineLoadFromMem(const void *model, uint64_t modelSize, uint64_t *modelId) {
+    if (!model || !modelId) {
+        return AXCL_ERR_ENGINE_NULL_POINTER;
+    }
+
+    engine_module *engine = current_engine();
+    return engine ? engine->load_from_mem(model, modelSize, *modelId) : AXCL_ERR_CONTEXT_NO_BIND_CONTEXT;
+}
+
+axclError axclrtEngineUnload(uint64_t modelId) {
+    engine_module *engine = current_engine();
+    return engine ? engine->unload(modelId) : AXCL_ERR_CONTEXT_NO_BIND_CONTEXT;
+}
+
+const char *axclrtEngineGetModelCompilerVersion(uint64_t modelId) {
+    (void)modelId;
+    return "sim";
+}
+
+axclError axclrtEngineGetUsageFromModelId(uint64_t modelId, int64_t *sysSize, int64_t *cmmSize) {
+    if (!sysSize || !cmmSize) {
+        return AXCL_ERR_ENGINE_NULL_POINTER;
+    }
+
+    engine_module *engine = current_engine();
+    if (!engine) {
+        return AXCL_ERR_CONTEXT_NO_BIND_CONTEXT;
+    }
+
+    model_desc desc;
+    uint64_t size = 0;
+    if (axclError ret = engine->get_desc(modelId, desc, &size); AXCL_SUCC != ret) {
+        return ret;
+    }
+
+    *sysSize = 0;
+    *cmmSize = static_cast<int64_t>(size);
+    return AXCL_SUCC;
+}
+
+axclError axclrtEngineGetModelTypeFromModelId(uint64_t modelId, axclrtEngineModelKind *modelType) {
+    if (!modelType) {
+        return AXCL_ERR_ENGINE_NULL_POINTER;
+    }
+
+    engine_module *engine = current_engine();
+    if (!engine) {
+        return AXCL_ERR_CONTEXT_NO_BIND_CONTEXT;
+    }
+
+    model_desc desc;
+    if (axclError ret = engine->get_desc(modelId, desc); AXCL_SUCC != ret) {
+        return ret;
+    }
+
+    *modelType = static_cast<axclrtEngineModelKind>(std::min<uint32_t>(desc.cores, 3) - 1);
+    return AXCL_SUCC;
+}
+
+axclError axclrtEngineGetIOInfo(uint64_t modelId, axclrtEngineIOInfo *ioInfo) {
+    if (!ioInfo) {
+        return AXCL_ERR_ENGINE_NULL_POINTER;
+    }
+
+    engine_module *engine = current_engine();
+    if (!engine) {
+        return AXCL_ERR_CONTEXT_NO_BIND_CONTEXT;
+    }
+
+    auto info = std::make_unique<io_info>();
+    if (axclError ret = engine->get_desc(modelId, info->desc); AXCL_SUCC != ret) {
+        return ret;
+    }
+
+    *ioInfo = info.release();
+    return AXCL_SUCC;
+}
+
+axclError axclrtEngineDestroyIOInfo(axclrtEngineIOInfo ioInfo) {
+    if (!ioInfo) {
+        return AXCL_ERR_ENGINE_NULL_POINTER;
+    }
+
+    delete reinterpret_cast<io_info *>(ioInfo);
+    return AXCL_SUCC;
+}
+
+static const model_desc *desc_of(axclrtEngineIOInfo ioInfo) {
+    return ioInfo ? &reinterpret_cast<io_info *>(ioInfo)->desc : nullptr;
+}
+
+static const tensor_desc *tensor_of(axclrtEngineIOInfo ioInfo, uint32_t index, bool input) {
+    const model_desc *desc = desc_of(ioInfo);
+    if (!desc) {
+        return nullptr;
+    }
+
+    const auto &tensors = input ? desc->inputs : desc->outputs;
+    return (index < tensors.size()) ? &tensors[index] : nullptr;
+}
+
+axclError axclrtEngineGetShapeGroupsCount(axclrtEngineIOInfo ioInfo, int32_t *count) {
+    const model_desc *desc = desc_of(ioInfo);
+    if (!desc || !count) {
+        return AXCL_ERR_ENGINE_NULL_POINTER;
+    }
+
+    *count = static_cast<int32_t>(desc->groups);
+    return AXCL_SUCC;
+}
+
+uint32_t axclrtEngineGetNumInputs(axclrtEngineIOInfo ioInfo) {
+    const model_desc *desc = desc_of(ioInfo);
+    return desc ? static_cast<uint32_t>(desc->inputs.size()) : 0;
+}
+
+uint32_t axclrtEngineGetNumOutputs(axclrtEngineIOInfo ioInfo) {
+    const model_desc *desc = desc_of(ioInfo);
+    return desc ? static_cast<uint32_t>(desc->outputs.size()) : 0;
+}
+
+uint64_t axclrtEngineGetInputSizeByIndex(axclrtEngineIOInfo ioInfo, uint32_t group, uint32_t index) {
+    (void)group;
+    const tensor_desc *t = tensor_of(ioInfo, index, true);
+    return t ? t->size : 0;
+}
+
+uint64_t axclrtEngineGetOutputSizeByIndex(axclrtEngineIOInfo ioInfo, uint32_t group, uint32_t index) {
+    (void)group;
+    const tensor_desc *t = tensor_of(ioInfo, index, false);
+    return t ? t->size : 0;
+}
+
+const char *axclrtEngineGetInputNameByIndex(axclrtEngineIOInfo ioInfo, uint32_t index) {
+    const tensor_desc *t = tensor_of(ioInfo, index, true);
+    return t ? t->name.c_str() : nullptr;
+}
+
+const char *axclrtEngineGetOutputNameByIndex(axclrtEngineIOInfo ioInfo, uint32_t index) {
+    const tensor_desc *t = tensor_of(ioInfo, index, false);
+    return t ? t->name.c_str() : nullptr;
+}
+
+static int32_t index_of(axclrtEngineIOInfo ioInfo, const char *name, bool input) {
+    const model_desc *desc = desc_of(ioInfo);
+    if (!desc || !name) {
+        return -1;
+    }
+
+    const auto &tensors = input ? desc->inputs : desc->outputs;
+    for (size_t i = 0; i < tensors.size(); ++i) {
+        if (tensors[i].name == name) {
+            return static_cast<int32_t>(i);
+        }
+    }
+
+    return -1;
+}
+
+int32_t axclrtEngineGetInputIndexByName(axclrtEngineIOInfo ioInfo, const char *name) {
+    return index_of(ioInfo, name, true);
+}
+
+int32_t axclrtEngineGetOutputIndexByName(axclrtEngineIOInfo ioInfo, const char *name) {
+    return index_of(ioInfo, name, false);
+}
+
+static axclError dims_of(axclrtEngineIOInfo ioInfo, uint32_t index, bool input, axclrtEngineIODims *dims) {
+    if (!ioInfo || !dims) {
+        return AXCL_ERR_ENGINE_NULL_POINTER;
+    }
+
+    const tensor_desc *t = tensor_of(ioInfo, index, input);
+    if (!t) {
+        return AXCL_ERR_ENGINE_INVALID_INDEX;
+    }
+
+    memset(dims, 0, sizeof(*dims));
+    dims->dimCount = static_cast<int32_t>(t->dims.size());
+    std::copy(t->dims.begin(), t->dims.end(), dims->dims);
+    return AXCL_SUCC;
+}
+
+axclError axclrtEngineGetInputDims(axclrtEngineIOInfo ioInfo, uint32_t group, uint32_t index, axclrtEngineIODims *dims) {
+    (void)group;
+    return dims_of(ioInfo, index, true, dims);
+}
+
+axclError axclrtEngineGetOutputDims(axclrtEngineIOInfo ioInfo, uint32_t group, uint32_t index, axclrtEngineIODims *dims) {
+    (void)group;
+    return dims_of(ioInfo, index, false, dims);
+}
+
+int32_t axclrtEngineGetInputDataType(axclrtEngineIOInfo ioInfo, uint32_t index, axclrtEngineDataType *type) {
+    const tensor_desc *t = tensor_of(ioInfo, index, true);
+    if (!t || !type) {
+        return AXCL_ERR_ENGINE_INVALID_INDEX;
+    }
+
+    *type = t->type;
+    return AXCL_SUCC;
+}
+
+int32_t axclrtEngineGetOutputDataType(axclrtEngineIOInfo ioInfo, uint32_t index, axclrtEngineDataType *type) {
+    const tensor_desc *t = tensor_of(ioInfo, index, false);
+    if (!t || !type) {
+        return AXCL_ERR_ENGINE_INVALID_INDEX;
+    }
+
+    *type = t->type;
+    return AXCL_SUCC;
+}
+
+int32_t axclrtEngineGetInputDataLayout(axclrtEngineIOInfo ioInfo, uint32_t index, axclrtEngineDataLayout *layout) {
+    if (!tensor_of(ioInfo, index, true) || !layout) {
+        return AXCL_ERR_ENGINE_INVALID_INDEX;
+    }
+
+    *layout = AXCL_DATA_LAYOUT_NHWC;
+    return AXCL_SUCC;
+}
+
+int32_t axclrtEngineGetOutputDataLayout(axclrtEngineIOInfo ioInfo, uint32_t index, axclrtEngineDataLayout *layout) {
+    if (!tensor_of(ioInfo, index, false) || !layout) {
+        return AXCL_ERR_ENGINE_INVALID_INDEX;
+    }
+
+    *layout = AXCL_DATA_LAYOUT_NHWC;
+    return AXCL_SUCC;
+}
+
+axclError axclrtEngineCreateIO(axclrtEngineIOInfo ioInfo, axclrtEngineIO *io) {
+    const model_desc *desc = desc_of(ioInfo);
+    if (!desc || !io) {
+        return AXCL_ERR_ENGINE_NULL_POINTER;
+    }
+
+    auto buffers = std::make_unique<io_buffers>();
+    buffers->desc = *desc;
+    buffers->inputs.resize(desc->inputs.size(), {nullptr, 0});
+    buffers->outputs.resize(desc->outputs.size(), {nullptr, 0});
+    *io = buffers.release();
+    return AXCL_SUCC;
+}
+
+axclError axclrtEngineDestroyIO(axclrtEngineIO io) {
+    if (!io) {
+        return AXCL_ERR_ENGINE_NULL_POINTER;
+    }
+
+    delete reinterpret_cast<io_buffers *>(io);
+    return AXCL_SUCC;
+}
+
+static axclError set_buffer(axclrtEngineIO io, uint32_t index, bool input, const void *dataBuffer, uint64_t size) {
+    if (!io) {
+        return AXCL_ERR_ENGINE_NULL_POINTER;
+    }
+
+    auto &buffers = input ? reinterpret_cast<io_buffers *>(io)->inputs : reinterpret_cast<io_buffers *>(io)->outputs;
+    if (index >= buffers.size()) {
+        return AXCL_ERR_ENGINE_INVALID_INDEX;
+    }
+
+    buffers[index] = {dataBuffer, size};
+    return AXCL_SUCC;
+}
+
+static axclError get_buffer(axclrtEngineIO io, uint32_t index, bool input, void **dataBuffer, uint64_t *size) {
+    if (!io || !dataBuffer || !size) {
+        return AXCL_ERR_ENGINE_NULL_POINTER;
+    }
+
+    auto &buffers = input ? reinterpret_cast<io_buffers *>(io)->inputs : reinterpret_cast<io_buffers *>(io)->outputs;
+    if (index >= buffers.size()) {
+        return AXCL_ERR_ENGINE_INVALID_INDEX;
+    }
+
+    *dataBuffer = const_cast<void *>(buffers[index].first);
+    *size = buffers[index].second;
+    return AXCL_SUCC;
+}
+
+static int32_t io_index_of(axclrtEngineIO io, const char *name, bool input) {
+    if (!io || !name) {
+        return -1;
+    }
+
+    const model_desc &desc = reinterpret_cast<io_buffers *>(io)->desc;
+    const auto &tensors = input ? desc.inputs : desc.outputs;
+    for (size_t i = 0; i < tensors.size(); ++i) {
+        if (tensors[i].name == name) {
+            return static_cast<int32_t>(i);
+        }
+    }
+
+    return -1;
+}
+
+axclError axclrtEngineSetInputBufferByIndex(axclrtEngineIO io, uint32_t index, const void *dataBuffer, uint64_t size) {
+    return set_buffer(io, index, true, dataBuffer, size);
+}
+
+axclError axclrtEngineSetOutputBufferByIndex(axclrtEngineIO io, uint32_t index, const void *dataBuffer, uint64_t size) {
+    return set_buffer(io, index, false, dataBuffer, size);
+}
+
+axclError axclrtEngineSetInputBufferByName(axclrtEngineIO io, const char *name, const void *dataBuffer, uint64_t size) {
+    const int32_t index = io_index_of(io, name, true);
+    return (index < 0) ? AXCL_ERR_ENGINE_INVALID_INDEX : set_buffer(io, index, true, dataBuffer, size);
+}
+
+axclError axclrtEngineSetOutputBufferByName(axclrtEngineIO io, const char *name, const void *dataBuffer, uint64_t size) {
+    const int32_t index = io_index_of(io, name, false);
+    return (index < 0) ? AXCL_ERR_ENGINE_INVALID_INDEX : set_buffer(io, index, false, dataBuffer, size);
+}
+
+axclError axclrtEngineGetInputBufferByIndex(axclrtEngineIO io, uint32_t index, void **dataBuffer, uint64_t *size) {
+    return get_buffer(io, index, true, dataBuffer, size);
+}
+
+axclError axclrtEngineGetOutputBufferByIndex(axclrtEngineIO io, uint32_t index, void **dataBuffer, uint64_t *size) {
+    return get_buffer(io, index, false, dataBuffer, size);
+}
+
+axclError axclrtEngineGetInputBufferByName(axclrtEngineIO io, const char *name, void **dataBuffer, uint64_t *size) {
+    const int32_t index = io_index_of(io, name, true);
+    return (index < 0) ? AXCL_ERR_ENGINE_INVALID_INDEX : get_buffer(io, index, true, dataBuffer, size);
+}
+
+axclError axclrtEngineGetOutputBufferByName(axclrtEngineIO io, const char *name, void **dataBuffer, uint64_t *size) {
+    const int32_t index = io_index_of(io, name, false);
+    return (index < 0) ? AXCL_ERR_ENGINE_INVALID_INDEX : get_buffer(io, index, false, dataBuffer, size);
+}
+
+axclError axclrtEngineSetDynamicBatchSize(axclrtEngineIO io, uint32_t batchSize) {
+    if (!io) {
+        return AXCL_ERR_ENGINE_NULL_POINTER;
+    }
+
+    io_buffers *buffers = reinterpret_cast<io_buffers *>(io);
+    if (0 == batchSize || batchSize > buffers->desc.max_batch) {
+        return AXCL_ERR_ENGINE_ILLEGAL_PARAM;
+    }
+
+    buffers->batch = batchSize;
+    return AXCL_SUCC;
+}
+
+axclError axclrtEngineCreateContext(uint64_t modelId, uint64_t *contextId) {
+    if (!contextId) {
+        return AXCL_ERR_ENGINE_NULL_POINTER;
+    }
+
+    engine_module *engine = current_engine();
+    return engine ? engine->create_context(modelId, *contextId) : AXCL_ERR_CONTEXT_NO_BIND_CONTEXT;
+}
+
+axclError axclrtEngineSetAffinity(uint64_t modelId, axclrtEngineSet set) {
+    engine_module *engine = current_engine();
+    return engine ? engine->set_affinity(modelId, set) : AXCL_ERR_CONTEXT_NO_BIND_CONTEXT;
+}
+
+axclError axclrtEngineGetAffinity(uint64_t modelId, axclrtEngineSet *set) {
+    if (!set) {
+        return AXCL_ERR_ENGINE_NULL_POINTER;
+    }
+
+    engine_module *engine = current_engine();
+    return engine ? engine->get_affinity(modelId, *set) : AXCL_ERR_CONTEXT_NO_BIND_CONTEXT;
+}
+
+axclError axclrtEngineExecute(uint64_t modelId, uint64_t contextId, uint32_t group, axclrtEngineIO io) {
+    if (!io) {
+        return AXCL_ERR_ENGINE_NULL_POINTER;
+    }
+
+    engine_module *engine = current_engine();
+    return engine ? engine->execute(modelId, contextId, group, *reinterpret_cast<io_buffers *>(io)) : AXCL_ERR_CONTEXT_NO_BIND_CONTEXT;
+}
+
+axclError axclrtEngineExecuteAsync(uint64_t modelId, uint64_t contextId, uint32_t group, axclrtEngineIO io, axclrtStream stream) {
+    if (!io) {
+        return AXCL_ERR_ENGINE_NULL_POINTER;
+    }
+
+    engine_module *engine = current_engine();
+    if (!engine) {
+        return AXCL_ERR_CONTEXT_NO_BIND_CONTEXT;
+    }
+
+    axclsim::stream *s = axclsim::stream::from(stream);
+    if (!s) {
+        return AXCL_ERR_STREAM_NULL_POINTER;
+    }
+
+    /* buffers are read when the task runs, the caller keeps io until the stream is synchronized */
+    io_buffers *buffers = reinterpret_cast<io_buffers *>(io);
+    s->push([engine, modelId, contextId, group, buffers]() {
+        if (axclError ret = engine->execute(modelId, contextId, group, *buffers); AXCL_SUCC != ret) {
+            LOG_MM_E(TAG, "async execute model {} fail, ret = {:#x}", modelId, static_cast<uint32_t>(ret));
+        }
+    });
+
+    return AXCL_SUCC;
+}
@@ -0,0 +1,99 @@
+/**************************************************************************************************
+ *
+ * Copyright (c) 2019-2024 Axera Semiconductor Co., Ltd. All Rights Reserved.
+ *
+ * This source file is the property of Axera Semiconductor Co., Ltd. and
+ * may not be copied or distributed in any isomorphic form without the prior
+ * written consent of Axera Semiconductor Co., Ltd.
+ *
+ **************************************************************************************************/
+
+#pragma once
+
+#include <string>
+#include "axcl_sim_device.hpp"
+
+namespace axclsim {
+
+struct tensor_desc {
+    std::string name;
+    std::vector<int32_t> dims;
+    axclrtEngineDataType type;
+    uint64_t size;
+};
+
+struct model_desc {
+    std::vector<tensor_desc> inputs;
+    std::vector<tensor_desc> outputs;
+    double latency_us;
+    double batch_latency_us;
+    uint32_t cores;
+    uint32_t max_batch;
+    uint32_t groups;
+
+    /* keys of engine.* or of the <model>.sim sidecar without the prefix */
+    static bool parse(const std::map<std::string, std::string> &kv, model_desc &desc);
+    static bool parse_tensors(const std::string &spec, std::vector<tensor_desc> &tensors);
+};
+
+/* handle of axclrtEngineIOInfo */
+struct io_info {
+    model_desc desc;
+};
+
+/* handle of axclrtEngineIO */
+struct io_buffers {
+    model_desc desc;
+    std::vector<std::pair<const void *, uint64_t>> inputs;
+    std::vector<std::pair<const void *, uint64_t>> outputs;
+    uint32_t batch = 0;
+};
+
+/**
+ * @brief runtime engine of one device.
+ * A model is described by <model>.sim next to the model file, or by engine.* of the config;
+ * a run occupies `cores` NPU cores for latency_us + (batch - 1) * batch_latency_us,
+ * picked from the affinity set of its context.
+ */
+class engine_module {
+public:
+    explicit engine_module(device *dev);
+    ~engine_module();
+
+    axclError init(axclrtEngineVNpuKind kind);
+    axclError finalize();
+    axclrtEngineVNpuKind vnpu_kind() const {
+        return m_vnpu;
+    }
+
+    axclError load_from_file(const char *path, uint64_t &id);
+    axclError load_from_mem(const void *model, uint64_t size, uint64_t &id);
+    axclError unload(uint64_t id);
+    axclError get_desc(uint64_t id, model_desc &desc, uint64_t *size = nullptr);
+    axclError set_affinity(uint64_t id, axclrtEngineSet set);
+    axclError get_affinity(uint64_t id, axclrtEngineSet &set);
+    axclError create_context(uint64_t id, uint64_t &context);
+    axclError execute(uint64_t id, uint64_t context, uint32_t group, const io_buffers &io);
+
+private:
+    struct model {
+        model_desc desc;
+        uint64_t size;
+        void *cmm;
+        axclrtEngineSet affinity;
+        /* affinity of each context, taken from the model when the context is created */
+        std::vector<axclrtEngineSet> contexts;
+    };
+
+    axclError load(const model_desc &desc, uint64_t size, uint64_t &id);
+    axclrtEngineSet all_cores() const;
+
+private:
+    device *m_dev;
+    axclrtEngineVNpuKind m_vnpu = AXCL_VNPU_DISABLE;
+    std::mutex m_mtx;
+    std::map<uint64_t, model> m_models;
+    uint64_t m_next = 1;
+};
+
+}  // namespace axclsim
@@ -0,0 +1,642 @@
+/**************************************************************************************************
+ *
+ * Copyright (c) 2019-2024 Axera Semiconductor Co., Ltd. All Rights Reserved.
+ *
+ * This source file is the property of Axera Semiconductor Co., Ltd. and
+ * may not be copied or distributed in any isomorphic form without the prior
+ * written consent of Axera Semiconductor Co., Ltd.
+ *
+ **************************************************************************************************/
+
+#include "axcl_sim_ivps.hpp"
+#include <string.h>
+#include <algorithm>
+#include "axcl_sim_config.hpp"
+#include "log/logger.hpp"
+
+#define TAG "axcl-sim-ivps"
+
+namespace axclsim {
+
+ivps_module::ivps_module(device *dev) : m_dev(dev) {
+    m_max_grp = static_cast<uint32_t>(std::min<int64_t>(config::get().get_i64("ivps.max_grp"), AX_IVPS_MAX_GRP_NUM));
+}
+
+ivps_module::~ivps_module() {
+    deinit();
+}
+
+AX_S32 ivps_module::init() {
+    std::lock_guard<std::mutex> lck(m_mtx);
+    m_init = true;
+    return AX_SUCCESS;
+}
+
+AX_S32 ivps_module::deinit() {
+    std::vector<IVPS_GRP> grps;
+    {
+        std::lock_guard<std::mutex> lck(m_mtx);
+        for (auto &&m : m_grps) {
+            grps.push_back(m.first);
+        }
+    }
+
+    for (auto &&grp : grps) {
+        destroy_grp(grp);
+    }
+
+    std::lock_guard<std::mutex> lck(m_mtx);
+    m_init = false;
+    return AX_SUCCESS;
+}
+
+ivps_module::group *ivps_module::find(IVPS_GRP grp) {
+    auto it = m_grps.find(grp);
+    return (it != m_grps.end()) ? it->second.get() : nullptr;
+}
+
+hw_unit *ivps_module::engine_unit(AX_IVPS_ENGINE_E engine) {
+    switch (engine) {
+        case AX_IVPS_ENGINE_VPP:
+            return m_dev->unit("vpp");
+        case AX_IVPS_ENGINE_VGP:
+            return m_dev->unit("vgp");
+        default:
+            return m_dev->unit("tdp");
+    }
+}
+
+AX_S32 ivps_module::create_grp(IVPS_GRP grp, const AX_IVPS_GRP_ATTR_T &attr) {
+    if (grp < 0 || static_cast<uint32_t>(grp) >= m_max_grp) {
+        return AX_ERR_IVPS_ILLEGAL_PARAM;
+    }
+
+    std::lock_guard<std::mutex> lck(m_mtx);
+    if (!m_init) {
+        return AX_ERR_IVPS_NOT_INIT;
+    }
+
+    if (find(grp)) {
+        return AX_ERR_IVPS_EXIST;
+    }
+
+    auto g = std::make_unique<group>();
+    g->id = grp;
+    g->in_depth = (attr.nInFifoDepth > 0) ? attr.nInFifoDepth : 2;
+    g->worker = std::thread(&ivps_module::process_thread, this, g.get());
+    m_grps[grp] = std::move(g);
+    return AX_SUCCESS;
+}
+
+AX_S32 ivps_module::create_grp_ex(IVPS_GRP &grp, const AX_IVPS_GRP_ATTR_T &attr) {
+    IVPS_GRP id = 0;
+    {
+        std::lock_guard<std::mutex> lck(m_mtx);
+        while (static_cast<uint32_t>(id) < m_max_grp && find(id)) {
+            ++id;
+        }
+
+        if (static_cast<uint32_t>(id) >= m_max_grp) {
+            return AX_ERR_IVPS_NOBUF;
+        }
+    }
+
+    if (AX_S32 ret = create_grp(id, attr); AX_SUCCESS != ret) {
+        return ret;
+    }
+
+    grp = id;
+    return AX_SUCCESS;
+}
+
+AX_S32 ivps_module::destroy_grp(IVPS_GRP grp) {
+    group *g;
+    {
+        std::lock_guard<std::mutex> lck(m_mtx);
+        g = find(grp);
+        if (!g) {
+            return AX_ERR_IVPS_UNEXIST;
+        }
+
+        if (g->exit) {
+            return AX_ERR_IVPS_BUSY;
+        }
+
+        g->exit = true;
+        g->started = false;
+        for (auto &&c : g->chns) {
+            if (c.pool) {
+                c.pool->close();
+            }
+        }
+
+        m_cv.notify_all();
+    }
+
+    g->worker.join();
+
+    std::lock_guard<std::mutex> lck(m_mtx);
+    flush(g);
+    m_grps.erase(grp);
+    m_cv.notify_all();
+    return AX_SUCCESS;
+}
+
+void ivps_module::flush(group *g) {
+    for (auto &&m : g->in) {
+        unref_frame(m);
+    }
+
+    g->in.clear();
+    for (auto &&c : g->chns) {
+        for (auto &&m : c.fifo) {
+            unref_frame(m);
+        }
+
+        c.fifo.clear();
+    }
+}
+
+AX_S32 ivps_module::set_pipeline_attr(IVPS_GRP grp, const AX_IVPS_PIPELINE_ATTR_T &attr) {
+    if (0 == attr.nOutChnNum || attr.nOutChnNum > AX_IVPS_MAX_OUTCHN_NUM) {
+        return AX_ERR_IVPS_ILLEGAL_PARAM;
+    }
+
+    std::lock_guard<std::mutex> lck(m_mtx);
+    group *g = find(grp);
+    if (!g) {
+        return AX_ERR_IVPS_UNEXIST;
+    }
+
+    g->pipe = attr;
+    g->configured = true;
+    return AX_SUCCESS;
+}
+
+AX_S32 ivps_module::set_chn_pool_attr(IVPS_GRP grp, IVPS_CHN chn, const AX_IVPS_POOL_ATTR_T &attr) {
+    if (chn < 0 || chn >= AX_IVPS_MAX_OUTCHN_NUM) {
+        return AX_ERR_IVPS_INVALID_CHNID;
+    }
+
+    std::lock_guard<std::mutex> lck(m_mtx);
+    group *g = find(grp);
+    if (!g) {
+        return AX_ERR_IVPS_UNEXIST;
+    }
+
+    /* user pools are not simulated, every channel owns a private pool */
+    if (POOL_SOURCE_PRIVATE == attr.ePoolSrc && attr.nFrmBufNum > 0) {
+        g->chns[chn].blk_cnt = attr.nFrmBufNum;
+    }
+
+    return AX_SUCCESS;
+}
+
+AX_S32 ivps_module::enable_chn(IVPS_GRP grp, IVPS_CHN chn) {
+    if (chn < 0 || chn >= AX_IVPS_MAX_OUTCHN_NUM) {
+        return AX_ERR_IVPS_INVALID_CHNID;
+    }
+
+    std::lock_guard<std::mutex> lck(m_mtx);
+    group *g = find(grp);
+    if (!g) {
+        return AX_ERR_IVPS_UNEXIST;
+    }
+
+    if (!g->configured || chn >= g->pipe.nOutChnNum) {
+        return AX_ERR_IVPS_NOT_CONFIG;
+    }
+
+    channel &c = g->chns[chn];
+    if (c.enabled) {
+        return AX_SUCCESS;
+    }
+
+    const AX_IVPS_FILTER_T &filter = g->pipe.tFilter[chn + 1][0];
+    if (filter.bEngage) {
+        if (0 == filter.nDstPicWidth || 0 == filter.nDstPicHeight) {
+            return AX_ERR_IVPS_ILLEGAL_PARAM;
+        }
+
+        const AX_U32 stride = (filter.nDstPicStride > 0) ? filter.nDstPicStride : (filter.nDstPicWidth + 15) / 16 * 16;
+        const AX_U64 size = frame_size(filter.eDstPicFormat, stride, filter.nDstPicHeight);
+        c.pool = vb_pool::create(m_dev, c.blk_cnt, static_cast<AX_U32>(size));
+        if (!c.pool) {
+            LOG_MM_E(TAG, "device {} ivGrp {} ivChn {}: no memory for {} x {} bytes", m_dev->id(), grp, chn, c.blk_cnt, size);
+            return AX_ERR_IVPS_NOMEM;
+        }
+    }
+
+    c.enabled = true;
+    return AX_SUCCESS;
+}
+
+AX_S32 ivps_module::disable_chn(IVPS_GRP grp, IVPS_CHN chn) {
+    if (chn < 0 || chn >= AX_IVPS_MAX_OUTCHN_NUM) {
+        return AX_ERR_IVPS_INVALID_CHNID;
+    }
+
+    std::lock_guard<std::mutex> lck(m_mtx);
+    group *g = find(grp);
+    if (!g) {
+        return AX_ERR_IVPS_UNEXIST;
+    }
+
+    channel &c = g->chns[chn];
+    if (!c.enabled) {
+        return AX_SUCCESS;
+    }
+
+    c.enabled = false;
+    for (auto &&m : c.fifo) {
+        unref_frame(m);
+    }
+
+    c.fifo.clear();
+    if (c.pool) {
+        c.pool->close();
+        c.pool.reset();
+    }
+
+    m_cv.notify_all();
+    return AX_SUCCESS;
+}
+
+AX_S32 ivps_module::start_grp(IVPS_GRP grp) {
+    std::lock_guard<std::mutex> lck(m_mtx);
+    group *g = find(grp);
+    if (!g) {
+        return AX_ERR_IVPS_UNEXIST;
+    }
+
+    if (!g->configured) {
+        return AX_ERR_IVPS_NOT_CONFIG;
+    }
+
+    g->started = true;
+    m_cv.notify_all();
+    return AX_SUCCESS;
+}
+
+AX_S32 ivps_module::stop_grp(IVPS_GRP grp) {
+    std::lock_guard<std::mutex> lck(m_mtx);
+    group *g = find(grp);
+    if (!g) {
+        return AX_ERR_IVPS_UNEXIST;
+    }
+
+    g->started = false;
+    for (auto &&m : g->in) {
+        unref_frame(m);
+    }
+
+    g->in.clear();
+    m_cv.notify_all();
+    return AX_SUCCESS;
+}
+
+AX_S32 ivps_module::set_backup_frame(IVPS_GRP grp, bool enable) {
+    /* the backup fifo only keeps the last input for the region redraw, no cost */
+    (void)enable;
+    std::lock_guard<std::mutex> lck(m_mtx);
+    return find(grp) ? AX_SUCCESS : AX_ERR_IVPS_UNEXIST;
+}
+
+AX_S32 ivps_module::send_frame(IVPS_GRP grp, const AX_VIDEO_FRAME_T &frame, AX_S32 timeout) {
+    if (0 == frame.u32Width || 0 == frame.u32Height || 0 == frame.u64PhyAddr[0]) {
+        return AX_ERR_IVPS_ILLEGAL_PARAM;
+    }
+
+    std::unique_lock<std::mutex> lck(m_mtx);
+    group *g = nullptr;
+    if (!wait_for(m_cv, lck, timeout, [this, grp, &g]() {
+            g = find(grp);
+            return !g || !g->started || g->in.size() < g->in_depth;
+        })) {
+        return (0 == timeout) ? AX_ERR_IVPS_BUF_FULL : AX_ERR_IVPS_TIMED_OUT;
+    }
+
+    if (!g) {
+        return AX_ERR_IVPS_UNEXIST;
+    }
+
+    if (!g->started) {
+        return AX_ERR_IVPS_NOT_PERM;
+    }
+
+    ref_frame(frame);
+    g->in.push_back(frame);
+    m_cv.notify_all();
+    return AX_SUCCESS;
+}
+
+void ivps_module::recv_linked_frame(IVPS_GRP grp, const AX_VIDEO_FRAME_T &frame) {
+    if (AX_S32 ret = send_frame(grp, frame, -1); AX_SUCCESS != ret) {
+        LOG_MM_D(TAG, "device {} ivGrp {}: drop linked frame {}, ret = {:#x}", m_dev->id(), grp, frame.u64SeqNum,
+                 static_cast<uint32_t>(ret));
+    }
+}
+
+AX_S32 ivps_module::get_chn_frame(IVPS_GRP grp, IVPS_CHN chn, AX_VIDEO_FRAME_T &frame, AX_S32 timeout) {
+    if (chn < 0 || chn >= AX_IVPS_MAX_OUTCHN_NUM) {
+        return AX_ERR_IVPS_INVALID_CHNID;
+    }
+
+    std::unique_lock<std::mutex> lck(m_mtx);
+    group *g = nullptr;
+    wait_for(m_cv, lck, timeout, [this, grp, chn, &g]() {
+        g = find(grp);
+        return !g || g->exit || !g->chns[chn].enabled || !g->chns[chn].fifo.empty();
+    });
+
+    if (!g || g->exit) {
+        return AX_ERR_IVPS_UNEXIST;
+    }
+
+    channel &c = g->chns[chn];
+    if (!c.enabled) {
+        return AX_ERR_IVPS_NOT_PERM;
+    }
+
+    if (c.fifo.empty()) {
+        return AX_ERR_IVPS_BUF_EMPTY;
+    }
+
+    frame = c.fifo.front();
+    c.fifo.pop_front();
+    return AX_SUCCESS;
+}
+
+AX_S32 ivps_module::release_chn_frame(IVPS_GRP grp, IVPS_CHN chn, const AX_VIDEO_FRAME_T &frame) {
+    (void)grp;
+    (void)chn;
+    return vb_registry::get().decrease(frame.u32BlkId[0]) ? AX_SUCCESS : AX_ERR_IVPS_ILLEGAL_PARAM;
+}
+
+AX_S32 ivps_module::crop_resize(AX_IVPS_ENGINE_E engine, const AX_VIDEO_FRAME_T &src, AX_VIDEO_FRAME_T *const dst[], AX_U32 num) {
+    if (0 == src.u32Width || 0 == src.u32Height || 0 == src.u64PhyAddr[0]) {
+        return AX_ERR_IVPS_ILLEGAL_PARAM;
+    }
+
+    double pixels = 0;
+    for (AX_U32 i = 0; i < num; ++i) {
+        if (!dst[i]) {
+            return AX_ERR_IVPS_NULL_PTR;
+        }
+
+        const AX_VIDEO_FRAME_T &m = *dst[i];
+        if (0 == m.u32Width || 0 == m.u32Height || 0 == m.u64PhyAddr[0]) {
+            return AX_ERR_IVPS_ILLEGAL_PARAM;
+        }
+
+        const AX_U32 stride = (m.u32PicStride[0] > 0) ? m.u32PicStride[0] : m.u32Width;
+        if (!m_dev->is_cmm(reinterpret_cast<void *>(m.u64PhyAddr[0]), frame_size(m.enImgFormat, stride, m.u32Height))) {
+            return AX_ERR_IVPS_BAD_ADDR;
+        }
+
+        pixels += static_cast<double>(m.u32Width) * m.u32Height;
+    }
+
+    engine_unit(engine)->run(pixels);
+    for (AX_U32 i = 0; i < num; ++i) {
+        dst[i]->u64PTS = src.u64PTS;
+        dst[i]->u64SeqNum = src.u64SeqNum;
+    }
+
+    return AX_SUCCESS;
+}
+
+void ivps_module::output(group *g, IVPS_CHN chn, const AX_VIDEO_FRAME_T &frame) {
+    const AX_MOD_INFO_T src = {AX_ID_IVPS, g->id, chn};
+    if (m_dev->forward(src, frame)) {
+        unref_frame(frame);
+        return;
+    }
+
+    std::lock_guard<std::mutex> lck(m_mtx);
+    channel &c = g->chns[chn];
+    const size_t depth = g->pipe.nOutFifoDepth[chn];
+    if (!c.enabled || 0 == depth) {
+        /* nobody takes frames from this channel */
+        unref_frame(frame);
+        return;
+    }
+
+    while (c.fifo.size() >= depth) {
+        unref_frame(c.fifo.front());
+        c.fifo.pop_front();
+    }
+
+    c.fifo.push_back(frame);
+    m_cv.notify_all();
+}
+
+void ivps_module::process_thread(group *g) {
+    struct target {
+        IVPS_CHN chn;
+        AX_IVPS_FILTER_T filter;
+        std::shared_ptr<vb_pool> pool;
+    };
+
+    std::unique_lock<std::mutex> lck(m_mtx);
+    while (true) {
+        m_cv.wait(lck, [g]() { return g->exit || (g->started && !g->in.empty()); });
+        if (g->exit) {
+            break;
+        }
+
+        const AX_VIDEO_FRAME_T src = g->in.front();
+        g->in.pop_front();
+        m_cv.notify_all();
+
+        std::vector<target> targets;
+        for (IVPS_CHN chn = 0; chn < g->pipe.nOutChnNum; ++chn) {
+            if (g->chns[chn].enabled) {
+                targets.push_back({chn, g->pipe.tFilter[chn + 1][0], g->chns[chn].pool});
+            }
+        }
+
+        lck.unlock();
+
+        for (auto &&t : targets) {
+            if (!t.filter.bEngage || !t.pool) {
+                ref_frame(src);
+                output(g, t.chn, src);
+                continue;
+            }
+
+            engine_unit(t.filter.eEngine)->run(static_cast<double>(t.filter.nDstPicWidth) * t.filter.nDstPicHeight);
+
+            AX_BLK blk = t.pool->get(-1);
+            if (AX_INVALID_BLOCKID == blk) {
+                continue;
+            }
+
+            const AX_U32 stride = (t.filter.nDstPicStride > 0) ? t.filter.nDstPicStride : (t.filter.nDstPicWidth + 15) / 16 * 16;
+            AX_VIDEO_FRAME_T frame;
+            fill_frame(frame, t.pool->find(blk), t.filter.nDstPicWidth, t.filter.nDstPicHeight, stride, t.filter.eDstPicFormat);
+            frame.u64PTS = src.u64PTS;
+            frame.u64SeqNum = src.u64SeqNum;
+            frame.u64UserData = src.u64UserData;
+            output(g, t.chn, frame);
+        }
+
+        unref_frame(src);
+        lck.lock();
+    }
+}
+
+}  // namespace axclsim
+
+using namespace axclsim;
+
+static ivps_module *current_ivps() {
+    device *dev = simulator::current();
+    return dev ? dev->ivps.get() : nullptr;
+}
+
+#define IVPS_CALL(expr)                        \
+    do {                                       \
+        ivps_module *ivps = current_ivps();    \
+        if (!ivps) {                           \
+            return AX_ERR_IVPS_SYS_NOTREADY;   \
+        }                                      \
+        return ivps->expr;                     \
+    } while (0)
+
+AX_S32 AXCL_IVPS_Init(AX_VOID) {
+    IVPS_CALL(init());
+}
+
+AX_S32 AXCL_IVPS_Deinit(AX_VOID) {
+    IVPS_CALL(deinit());
+}
+
+AX_S32 AXCL_IVPS_CreateGrp(IVPS_GRP IvpsGrp, const AX_IVPS_GRP_ATTR_T *ptGrpAttr) {
+    if (!ptGrpAttr) {
+        return AX_ERR_IVPS_NULL_PTR;
+    }
+
+    IVPS_CALL(create_grp(IvpsGrp, *ptGrpAttr));
+}
+
+AX_S32 AXCL_IVPS_CreateGrpEx(IVPS_GRP *IvpsGrp, const AX_IVPS_GRP_ATTR_T *ptGrpAttr) {
+    if (!IvpsGrp || !ptGrpAttr) {
+        return AX_ERR_IVPS_NULL_PTR;
+    }
+
+    IVPS_CALL(create_grp_ex(*IvpsGrp, *ptGrpAttr));
+}
+
+AX_S32 AXCL_IVPS_DestoryGrp(IVPS_GRP IvpsGrp) {
+    IVPS_CALL(destroy_grp(IvpsGrp));
+}
+
+AX_S32 AXCL_IVPS_SetPipelineAttr(IVPS_GRP IvpsGrp, AX_IVPS_PIPELINE_ATTR_T *ptPipelineAttr) {
+    if (!ptPipelineAttr) {
+        return AX_ERR_IVPS_NULL_PTR;
+    }
+
+    IVPS_CALL(set_pipeline_attr(IvpsGrp, *ptPipelineAttr));
+}
+
+AX_S32 AXCL_IVPS_SetChnPoolAttr(IVPS_GRP IvpsGrp, IVPS_CHN IvpsChn, const AX_IVPS_POOL_ATTR_T *ptPoolAttr) {
+    if (!ptPoolAttr) {
+        return AX_ERR_IVPS_NULL_PTR;
+    }
+
+    IVPS_CALL(set_chn_pool_attr(IvpsGrp, IvpsChn, *ptPoolAttr));
+}
+
+AX_S32 AXCL_IVPS_EnableChn(IVPS_GRP IvpsGrp, IVPS_CHN IvpsChn) {
+    IVPS_CALL(enable_chn(IvpsGrp, IvpsChn));
+}
+
+AX_S32 AXCL_IVPS_DisableChn(IVPS_GRP IvpsGrp, IVPS_CHN IvpsChn) {
+    IVPS_CALL(disable_chn(IvpsGrp, IvpsChn));
+}
+
+AX_S32 AXCL_IVPS_StartGrp(IVPS_GRP IvpsGrp) {
+    IVPS_CALL(start_grp(IvpsGrp));
+}
+
+AX_S32 AXCL_IVPS_StopGrp(IVPS_GRP IvpsGrp) {
+    IVPS_CALL(stop_grp(IvpsGrp));
+}
+
+AX_S32 AXCL_IVPS_EnableBackupFrame(IVPS_GRP IvpsGrp, AX_U8 nFifoDepth) {
+    (void)nFifoDepth;
+    IVPS_CALL(set_backup_frame(IvpsGrp, true));
+}
+
+AX_S32 AXCL_IVPS_DisableBackupFrame(IVPS_GRP IvpsGrp) {
+    IVPS_CALL(set_backup_frame(IvpsGrp, false));
+}
+
+AX_S32 AXCL_IVPS_SendFrame(IVPS_GRP IvpsGrp, const AX_VIDEO_FRAME_T *ptFrame, AX_S32 nMilliSec) {
+    if (!ptFrame) {
+        return AX_ERR_IVPS_NULL_PTR;
+    }
+
+    IVPS_CALL(send_frame(IvpsGrp, *ptFrame, nMilliSec));
+}
+
+AX_S32 AXCL_IVPS_GetChnFrame(IVPS_GRP IvpsGrp, IVPS_CHN IvpsChn, AX_VIDEO_FRAME_T *ptFrame, AX_S32 nMilliSec) {
+    if (!ptFrame) {
+        return AX_ERR_IVPS_NULL_PTR;
+    }
+
+    IVPS_CALL(get_chn_frame(IvpsGrp, IvpsChn, *ptFrame, nMilliSec));
+}
+
+AX_S32 AXCL_IVPS_ReleaseChnFrame(IVPS_GRP IvpsGrp, IVPS_CHN IvpsChn, AX_VIDEO_FRAME_T *ptFrame) {
+    if (!ptFrame) {
+        return AX_ERR_IVPS_NULL_PTR;
+    }
+
+    IVPS_CALL(release_chn_frame(IvpsGrp, IvpsChn, *ptFrame));
+}
+
+static AX_S32 crop_resize(AX_IVPS_ENGINE_E engine, const AX_VIDEO_FRAME_T *ptSrc, AX_VIDEO_FRAME_T *const ptDst[], AX_U32 nNum) {
+    if (!ptSrc || !ptDst || 0 == nNum) {
+        return AX_ERR_IVPS_NULL_PTR;
+    }
+
+    IVPS_CALL(crop_resize(engine, *ptSrc, ptDst, nNum));
+}
+
+AX_S32 AXCL_IVPS_CropResizeTdp(const AX_VIDEO_FRAME_T *ptSrc, AX_VIDEO_FRAME_T *ptDst, const AX_IVPS_ASPECT_RATIO_T *ptAspectRatio) {
+    (void)ptAspectRatio;
+    return crop_resize(AX_IVPS_ENGINE_TDP, ptSrc, &ptDst, 1);
+}
+
+AX_S32 AXCL_IVPS_CropResizeVpp(const AX_VIDEO_FRAME_T *ptSrc, AX_VIDEO_FRAME_T *ptDst, const AX_IVPS_ASPECT_RATIO_T *ptAspectRatio) {
+    (void)ptAspectRatio;
+    return crop_resize(AX_IVPS_ENGINE_VPP, ptSrc, &ptDst, 1);
+}
+
+AX_S32 AXCL_IVPS_CropResizeVgp(const AX_VIDEO_FRAME_T *ptSrc, AX_VIDEO_FRAME_T *ptDst, const AX_IVPS_ASPECT_RATIO_T *ptAspectRatio) {
+    (void)ptAspectRatio;
+    return crop_resize(AX_IVPS_ENGINE_VGP, ptSrc, &ptDst, 1);
+}
+
+AX_S32 AXCL_IVPS_CropResizeV2Tdp(const AX_VIDEO_FRAME_T *ptSrc, const AX_IVPS_RECT_T tBox[], AX_U32 nCropNum, AX_VIDEO_FRAME_T *ptDst[],
+                                 const AX_IVPS_ASPECT_RATIO_T *ptAspectRatio) {
+    (void)tBox;
+    (void)ptAspectRatio;
+    return crop_resize(AX_IVPS_ENGINE_TDP, ptSrc, ptDst, nCropNum);
+}
+
+AX_S32 AXCL_IVPS_CropResizeV2Vpp(const AX_VIDEO_FRAME_T *ptSrc, const AX_IVPS_RECT_T tBox[], AX_U32 nCropNum, AX_VIDEO_FRAME_T *ptDst[],
+                                 const AX_IVPS_ASPECT_RATIO_T *ptAspectRatio) {
+    (void)tBox;
+    (void)ptAspectRatio;
+    return crop_resize(AX_IVPS_ENGINE_VPP, ptSrc, ptDst, nCropNum);
+}
+
+AX_S32 AXCL_IVPS_CropResizeV2Vgp(const AX_VIDEO_FRAME_T *ptSrc, const AX_IVPS_RECT_T tBox[], AX_U32 nCropNum, AX_VIDEO_FRAME_T *ptDst[],
+                                 const AX_IVPS_ASPECT_RATIO_T *ptAspectRatio) {
+    (void)tBox;
+    (void)ptAspectRatio;
+    return crop_resize(AX_IVPS_ENGINE_VGP, ptSrc, ptDst, nCropNum);
+}
@@ -0,0 +1,88 @@
+/**************************************************************************************************
+ *
+ * Copyright (c) 2019-2024 Axera Semiconductor Co., Ltd. All Rights Reserved.
+ *
+ * This source file is the property of Axera Semiconductor Co., Ltd. and
+ * may not be copied or distributed in any isomorphic form without the prior
+ * written consent of Axera Semiconductor Co., Ltd.
+ *
+ **************************************************************************************************/
+
+#pragma once
+
+#include <deque>
+#include <thread>
+#include "axcl_sim_device.hpp"
+
+namespace axclsim {
+
+/**
+ * @brief IVPS groups of one device.
+ * Each group runs the channel filters of its input frames on a worker thread, an engaged filter costs one job
+ * of its engine (TDP, VPP or VGP) on the output pixels, a bypassed channel passes the input frame through.
+ */
+class ivps_module {
+public:
+    explicit ivps_module(device *dev);
+    ~ivps_module();
+
+    AX_S32 init();
+    AX_S32 deinit();
+
+    AX_S32 create_grp(IVPS_GRP grp, const AX_IVPS_GRP_ATTR_T &attr);
+    AX_S32 create_grp_ex(IVPS_GRP &grp, const AX_IVPS_GRP_ATTR_T &attr);
+    AX_S32 destroy_grp(IVPS_GRP grp);
+    AX_S32 set_pipeline_attr(IVPS_GRP grp, const AX_IVPS_PIPELINE_ATTR_T &attr);
+    AX_S32 set_chn_pool_attr(IVPS_GRP grp, IVPS_CHN chn, const AX_IVPS_POOL_ATTR_T &attr);
+    AX_S32 enable_chn(IVPS_GRP grp, IVPS_CHN chn);
+    AX_S32 disable_chn(IVPS_GRP grp, IVPS_CHN chn);
+    AX_S32 start_grp(IVPS_GRP grp);
+    AX_S32 stop_grp(IVPS_GRP grp);
+    AX_S32 set_backup_frame(IVPS_GRP grp, bool enable);
+
+    AX_S32 send_frame(IVPS_GRP grp, const AX_VIDEO_FRAME_T &frame, AX_S32 timeout);
+    AX_S32 get_chn_frame(IVPS_GRP grp, IVPS_CHN chn, AX_VIDEO_FRAME_T &frame, AX_S32 timeout);
+    AX_S32 release_chn_frame(IVPS_GRP grp, IVPS_CHN chn, const AX_VIDEO_FRAME_T &frame);
+
+    /* frame from a linked VDEC or IVPS channel, waits for space in the input fifo */
+    void recv_linked_frame(IVPS_GRP grp, const AX_VIDEO_FRAME_T &frame);
+
+    /* one synchronous job of the engine for all dst frames */
+    AX_S32 crop_resize(AX_IVPS_ENGINE_E engine, const AX_VIDEO_FRAME_T &src, AX_VIDEO_FRAME_T *const dst[], AX_U32 num);
+
+private:
+    struct channel {
+        bool enabled = false;
+        AX_U32 blk_cnt = 4;
+        std::shared_ptr<vb_pool> pool;
+        std::deque<AX_VIDEO_FRAME_T> fifo;
+    };
+
+    struct group {
+        IVPS_GRP id;
+        size_t in_depth;
+        AX_IVPS_PIPELINE_ATTR_T pipe = {};
+        bool configured = false;
+        channel chns[AX_IVPS_MAX_OUTCHN_NUM];
+        std::deque<AX_VIDEO_FRAME_T> in;
+        bool started = false;
+        bool exit = false;
+        std::thread worker;
+    };
+
+    group *find(IVPS_GRP grp);
+    hw_unit *engine_unit(AX_IVPS_ENGINE_E engine);
+    void process_thread(group *g);
+    void output(group *g, IVPS_CHN chn, const AX_VIDEO_FRAME_T &frame);
+    void flush(group *g);
+
+private:
+    device *m_dev;
+    uint32_t m_max_grp;
+    bool m_init = false;
+    std::mutex m_mtx;
+    std::condition_variable m_cv;
+    std::map<IVPS_GRP, std::unique_ptr<group>> m_grps;
+};
+
+}  // namespace axclsim
@@ -0,0 +1,548 @@
+/**************************************************************************************************
+ *
+ * Copyright (c) 2019-2024 Axera Semiconductor Co., Ltd. All Rights Reserved.
+ *
+ * This source file is the property of Axera Semiconductor Co., Ltd. and
+ * may not be copied or distributed in any isomorphic form without the prior
+ * written consent of Axera Semiconductor Co., Ltd.
+ *
+ **************************************************************************************************/
+
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <set>
+#include "axcl_sim_config.hpp"
+#include "axcl_sim_device.hpp"
+#include "axcl_sim_stream.hpp"
+#include "log/logger.hpp"
+
+#define TAG "axcl-sim-rt"
+
+using namespace axclsim;
+
+namespace axclsim {
+
+static std::mutex s_mtx_streams;
+static std::set<stream *> s_streams;
+
+stream::stream(context *ctx) : m_ctx(ctx) {
+    m_thread = std::thread(&stream::run, this);
+
+    std::lock_guard<std::mutex> lck(s_mtx_streams);
+    s_streams.insert(this);
+}
+
+stream::~stream() {
+    {
+        std::lock_guard<std::mutex> lck(s_mtx_streams);
+        s_streams.erase(this);
+    }
+
+    {
+        std::lock_guard<std::mutex> lck(m_mtx);
+        m_exit = true;
+        m_cv.notify_all();
+    }
+
+    m_thread.join();
+}
+
+stream *stream::from(void *handle) {
+    std::lock_guard<std::mutex> lck(s_mtx_streams);
+    auto it = s_streams.find(reinterpret_cast<stream *>(handle));
+    return (it != s_streams.end()) ? *it : nullptr;
+}
+
+void stream::push(std::function<void()> task) {
+    std::lock_guard<std::mutex> lck(m_mtx);
+    m_tasks.push_back(std::move(task));
+    m_cv.notify_all();
+}
+
+bool stream::synchronize(int32_t timeout) {
+    std::unique_lock<std::mutex> lck(m_mtx);
+    return wait_for(m_cv, lck, timeout, [this]() { return m_tasks.empty() && !m_busy; });
+}
+
+void stream::discard() {
+    std::lock_guard<std::mutex> lck(m_mtx);
+    m_tasks.clear();
+    m_cv.notify_all();
+}
+
+void stream::run() {
+    simulator::current_context() = m_ctx;
+
+    std::unique_lock<std::mutex> lck(m_mtx);
+    while (true) {
+        m_cv.wait(lck, [this]() { return m_exit || !m_tasks.empty(); });
+        if (m_tasks.empty()) {
+            /* exit after all queued tasks are done */
+            break;
+        }
+
+        auto task = std::move(m_tasks.front());
+        m_tasks.pop_front();
+        m_busy = true;
+
+        lck.unlock();
+        task();
+        lck.lock();
+
+        m_busy = false;
+        m_cv.notify_all();
+    }
+}
+
+}  // namespace axclsim
+
+static device *current_device() {
+    return simulator::current();
+}
+
+axclError axclInit(const char *config) {
+    /* the json of the real runtime is not used, the simulator reads $AXCL_SIM_CONFIG */
+    (void)config;
+    if (!simulator::get().init()) {
+        return AXCL_ERR_DEVICE_PROBE;
+    }
+
+    return AXCL_SUCC;
+}
+
+axclError axclFinalize() {
+    simulator::get().finalize();
+    return AXCL_SUCC;
+}
+
+axclError axclSetLogLevel(int32_t lv) {
+    AXCL_LOGGER->set_level(axcl::logger::get_level(lv));
+    return AXCL_SUCC;
+}
+
+axclError axclrtGetVersion(int32_t *major, int32_t *minor, int32_t *patch) {
+    if (!major || !minor || !patch) {
+        return AXCL_ERR_DEVICE_NULL_POINTER;
+    }
+
+    *major = 0;
+    *minor = 0;
+    *patch = 0;
+    return AXCL_SUCC;
+}
+
+axclError axclrtCreateContext(axclrtContext *ctx, int32_t deviceId) {
+    if (!ctx) {
+        return AXCL_ERR_CONTEXT_NULL_POINTER;
+    }
+
+    device *dev = simulator::get().find(deviceId);
+    if (!dev) {
+        return AXCL_ERR_DEVICE_INVALID_ID;
+    }
+
+    context *c = simulator::get().create_context(dev);
+    simulator::current_context() = c;
+    *ctx = c;
+    return AXCL_SUCC;
+}
+
+axclError axclrtDestroyContext(axclrtContext ctx) {
+    context *c = reinterpret_cast<context *>(ctx);
+    if (!c) {
+        return AXCL_ERR_CONTEXT_NULL_POINTER;
+    }
+
+    if (simulator::current_context() == c) {
+        simulator::current_context() = nullptr;
+    }
+
+    return simulator::get().destroy_context(c) ? AXCL_SUCC : AXCL_ERR_CONTEXT_DESTROY;
+}
+
+axclError axclrtSetCurrentContext(axclrtContext ctx) {
+    context *c = reinterpret_cast<context *>(ctx);
+    if (!c) {
+        return AXCL_ERR_CONTEXT_NULL_POINTER;
+    }
+
+    if (!simulator::get().valid_context(c)) {
+        return AXCL_ERR_CONTEXT_BIND_THREAD;
+    }
+
+    simulator::current_context() = c;
+    return AXCL_SUCC;
+}
+
+axclError axclrtGetCurrentContext(axclrtContext *ctx) {
+    if (!ctx) {
+        return AXCL_ERR_CONTEXT_NULL_POINTER;
+    }
+
+    if (!simulator::current_context()) {
+        return AXCL_ERR_CONTEXT_NO_BIND_CONTEXT;
+    }
+
+    *ctx = simulator::current_context();
+    return AXCL_SUCC;
+}
+
+/* default context of each device, created by axclrtSetDevice() */
+static std::mutex s_mtx_default;
+static std::map<int32_t, context *> s_default_contexts;
+
+static context *default_context(int32_t deviceId, bool create) {
+    std::lock_guard<std::mutex> lck(s_mtx_default);
+    auto it = s_default_contexts.find(deviceId);
+    if (it != s_default_contexts.end() && simulator::get().valid_context(it->second)) {
+        return it->second;
+    }
+
+    if (!create) {
+        return nullptr;
+    }
+
+    device *dev = simulator::get().find(deviceId);
+    if (!dev) {
+        return nullptr;
+    }
+
+    context *c = simulator::get().create_context(dev);
+    s_default_contexts[deviceId] = c;
+    return c;
+}
+
+axclError axclrtGetDefaultContext(axclrtContext *ctx, int32_t deviceId) {
+    if (!ctx) {
+        return AXCL_ERR_CONTEXT_NULL_POINTER;
+    }
+
+    context *c = default_context(deviceId, false);
+    if (!c) {
+        return AXCL_ERR_CONTEXT_NO_BIND_CONTEXT;
+    }
+
+    *ctx = c;
+    return AXCL_SUCC;
+}
+
+axclError axclrtSetDevice(int32_t deviceId) {
+    if (!simulator::get().initialized()) {
+        return AXCL_ERR_DEVICE_NO_ACTIVE_DEVICE;
+    }
+
+    context *c = default_context(deviceId, true);
+    if (!c) {
+        return AXCL_ERR_DEVICE_INVALID_ID;
+    }
+
+    simulator::current_context() = c;
+    return AXCL_SUCC;
+}
+
+axclError axclrtResetDevice(int32_t deviceId) {
+    if (!simulator::get().find(deviceId)) {
+        return AXCL_ERR_DEVICE_INVALID_ID;
+    }
+
+    context *c = default_context(deviceId, false);
+    if (c && simulator::current_context() == c) {
+        simulator::current_context() = nullptr;
+    }
+
+    return AXCL_SUCC;
+}
+
+axclError axclrtGetDevice(int32_t *deviceId) {
+    if (!deviceId) {
+        return AXCL_ERR_DEVICE_NULL_POINTER;
+    }
+
+    device *dev = current_device();
+    if (!dev) {
+        return AXCL_ERR_CONTEXT_NO_BIND_CONTEXT;
+    }
+
+    *deviceId = dev->id();
+    return AXCL_SUCC;
+}
+
+axclError axclrtGetDeviceCount(uint32_t *count) {
+    if (!count) {
+        return AXCL_ERR_DEVICE_NULL_POINTER;
+    }
+
+    *count = static_cast<uint32_t>(simulator::get().device_ids().size());
+    return AXCL_SUCC;
+}
+
+axclError axclrtGetDeviceList(axclrtDeviceList *deviceList) {
+    if (!deviceList) {
+        return AXCL_ERR_DEVICE_NULL_POINTER;
+    }
+
+    memset(deviceList, 0, sizeof(*deviceList));
+    for (auto &&id : simulator::get().device_ids()) {
+        deviceList->devices[deviceList->num++] = id;
+    }
+
+    return AXCL_SUCC;
+}
+
+axclError axclrtSynchronizeDevice() {
+    return current_device() ? AXCL_SUCC : AXCL_ERR_CONTEXT_NO_BIND_CONTEXT;
+}
+
+axclError axclrtGetDeviceUtilizationRate(int32_t deviceId, axclrtUtilizationInfo *utilizationInfo) {
+    if (!utilizationInfo) {
+        return AXCL_ERR_DEVICE_NULL_POINTER;
+    }
+
+    device *dev = simulator::get().find(deviceId);
+    if (!dev) {
+        return AXCL_ERR_DEVICE_INVALID_ID;
+    }
+
+    utilizationInfo->cpuUtilization = 0;
+    utilizationInfo->npuUtilization = dev->npu_utilization();
+    utilizationInfo->memUtilization = (dev->cmm_total() > 0) ? static_cast<int32_t>(dev->cmm_used() * 100 / dev->cmm_total()) : 0;
+    return AXCL_SUCC;
+}
+
+axclError axclrtMalloc(void **devPtr, size_t size, axclrtMemMallocPolicy policy) {
+    (void)policy;
+    if (!devPtr) {
+        return AXCL_ERR_MEMORY_NULL_POINTER;
+    }
+
+    device *dev = current_device();
+    if (!dev) {
+        return AXCL_ERR_CONTEXT_NO_BIND_CONTEXT;
+    }
+
+    *devPtr = dev->cmm_alloc(size, 4096);
+    return (*devPtr) ? AXCL_SUCC : AXCL_ERR_MEMORY_EXECUTE_FAIL;
+}
+
+axclError axclrtMallocCached(void **devPtr, size_t size, axclrtMemMallocPolicy policy) {
+    return axclrtMalloc(devPtr, size, policy);
+}
+
+axclError axclrtFree(void *devPtr) {
+    if (!devPtr) {
+        return AXCL_ERR_MEMORY_NULL_POINTER;
+    }
+
+    device *dev = current_device();
+    if (!dev) {
+        return AXCL_ERR_CONTEXT_NO_BIND_CONTEXT;
+    }
+
+    return dev->cmm_free(devPtr) ? AXCL_SUCC : AXCL_ERR_MEMORY_NOT_DEVICE_MEMORY;
+}
+
+axclError axclrtMemFlush(void *devPtr, size_t size) {
+    device *dev = current_device();
+    if (!dev) {
+        return AXCL_ERR_CONTEXT_NO_BIND_CONTEXT;
+    }
+
+    return dev->is_cmm(devPtr, size) ? AXCL_SUCC : AXCL_ERR_MEMORY_NOT_DEVICE_MEMORY;
+}
+
+axclError axclrtMemInvalidate(void *devPtr, size_t size) {
+    return axclrtMemFlush(devPtr, size);
+}
+
+axclError axclrtMallocHost(void **hostPtr, size_t size) {
+    if (!hostPtr) {
+        return AXCL_ERR_MEMORY_NULL_POINTER;
+    }
+
+    if (!current_device()) {
+        return AXCL_ERR_CONTEXT_NO_BIND_CONTEXT;
+    }
+
+    return (0 == posix_memalign(hostPtr, 4096, size)) ? AXCL_SUCC : AXCL_ERR_MEMORY_EXECUTE_FAIL;
+}
+
+axclError axclrtFreeHost(void *hostPtr) {
+    if (!hostPtr) {
+        return AXCL_ERR_MEMORY_NULL_POINTER;
+    }
+
+    free(hostPtr);
+    return AXCL_SUCC;
+}
+
+axclError axclrtMemset(void *devPtr, uint8_t value, size_t count) {
+    device *dev = current_device();
+    if (!dev) {
+        return AXCL_ERR_CONTEXT_NO_BIND_CONTEXT;
+    }
+
+    if (!dev->is_cmm(devPtr, count)) {
+        return AXCL_ERR_MEMORY_NOT_DEVICE_MEMORY;
+    }
+
+    dev->unit("dma")->run(static_cast<double>(count));
+    memset(devPtr, value, count);
+    return AXCL_SUCC;
+}
+
+axclError axclrtMemcpy(void *dstPtr, const void *srcPtr, size_t count, axclrtMemcpyKind kind) {
+    if (!dstPtr || !srcPtr) {
+        return AXCL_ERR_MEMORY_NULL_POINTER;
+    }
+
+    device *dev = current_device();
+    if (!dev) {
+        return AXCL_ERR_CONTEXT_NO_BIND_CONTEXT;
+    }
+
+    const char *unit = nullptr;
+    switch (kind) {
+        case AXCL_MEMCPY_HOST_TO_HOST:
+            break;
+        case AXCL_MEMCPY_HOST_TO_DEVICE:
+        case AXCL_MEMCPY_HOST_PHY_TO_DEVICE:
+            if (!dev->is_cmm(dstPtr, count)) {
+                return AXCL_ERR_MEMORY_NOT_DEVICE_MEMORY;
+            }
+            unit = "h2d";
+            break;
+        case AXCL_MEMCPY_DEVICE_TO_HOST:
+        case AXCL_MEMCPY_DEVICE_TO_HOST_PHY:
+            if (!dev->is_cmm(srcPtr, count)) {
+                return AXCL_ERR_MEMORY_NOT_DEVICE_MEMORY;
+            }
+            unit = "d2h";
+            break;
+        case AXCL_MEMCPY_DEVICE_TO_DEVICE:
+            if (!dev->is_cmm(srcPtr, count) || !dev->is_cmm(dstPtr, count)) {
+                return AXCL_ERR_MEMORY_NOT_DEVICE_MEMORY;
+            }
+            unit = "dma";
+            break;
+        default:
+            return AXCL_ERR_MEMORY_EXECUTE_FAIL;
+    }
+
+    if (unit) {
+        dev->unit(unit)->run(static_cast<double>(count));
+    }
+
+    memcpy(dstPtr, srcPtr, count);
+    return AXCL_SUCC;
+}
+
+axclError axclrtMemcmp(const void *devPtr1, const void *devPtr2, size_t count) {
+    device *dev = current_device();
+    if (!dev) {
+        return AXCL_ERR_CONTEXT_NO_BIND_CONTEXT;
+    }
+
+    if (!dev->is_cmm(devPtr1, count) || !dev->is_cmm(devPtr2, count)) {
+        return AXCL_ERR_MEMORY_NOT_DEVICE_MEMORY;
+    }
+
+    return (0 == memcmp(devPtr1, devPtr2, count)) ? AXCL_SUCC : AXCL_ERR_MEMORY_EXECUTE_FAIL;
+}
+
+axclError axclrtCreateStream(axclrtStream *s) {
+    if (!s) {
+        return AXCL_ERR_STREAM_NULL_POINTER;
+    }
+
+    context *ctx = simulator::current_context();
+    if (!ctx) {
+        return AXCL_ERR_CONTEXT_NO_BIND_CONTEXT;
+    }
+
+    *s = new stream(ctx);
+    return AXCL_SUCC;
+}
+
+axclError axclrtDestroyStream(axclrtStream s) {
+    stream *st = stream::from(s);
+    if (!st) {
+        return AXCL_ERR_STREAM_DESTROY;
+    }
+
+    delete st;
+    return AXCL_SUCC;
+}
+
+axclError axclrtDestroyStreamForce(axclrtStream s) {
+    stream *st = stream::from(s);
+    if (!st) {
+        return AXCL_ERR_STREAM_DESTROY;
+    }
+
+    st->discard();
+    delete st;
+    return AXCL_SUCC;
+}
+
+axclError axclrtSynchronizeStream(axclrtStream s) {
+    return axclrtSynchronizeStreamWithTimeout(s, -1);
+}
+
+axclError axclrtSynchronizeStreamWithTimeout(axclrtStream s, int32_t timeout) {
+    stream *st = stream::from(s);
+    if (!st) {
+        return AXCL_ERR_STREAM_NULL_POINTER;
+    }
+
+    return st->synchronize(timeout) ? AXCL_SUCC : AXCL_ERR_STREAM_TIMEOUT;
+}
+
+AX_S32 AXCL_SIM_LoadConfig(const AX_CHAR *path) {
+    if (!path) {
+        return AXCL_ERR_DEVICE_NULL_POINTER;
+    }
+
+    return config::get().load(path) ? AXCL_SUCC : AXCL_ERR_DEVICE_OPEN;
+}
+
+AX_S32 AXCL_SIM_SetConfig(const AX_CHAR *key, const AX_CHAR *value) {
+    if (!key || !value) {
+        return AXCL_ERR_DEVICE_NULL_POINTER;
+    }
+
+    /* units and devices are created by axclInit(), set the config before */
+    return config::get().set(key, value) ? AXCL_SUCC : AXCL_ERR_DEVICE_UNSUPPORT;
+}
+
+AX_S32 AXCL_SIM_GetUnitStat(AX_S32 deviceId, const AX_CHAR *name, axcl_sim_unit_stat *stat) {
+    if (!name || !stat) {
+        return AXCL_ERR_DEVICE_NULL_POINTER;
+    }
+
+    device *dev = simulator::get().find(deviceId);
+    if (!dev) {
+        return AXCL_ERR_DEVICE_INVALID_ID;
+    }
+
+    hw_unit *unit = dev->unit(name);
+    if (!unit) {
+        return AXCL_ERR_DEVICE_UNSUPPORT;
+    }
+
+    unit->get_stat(*stat);
+    return AXCL_SUCC;
+}
+
+AX_S32 AXCL_SIM_ResetUnitStat(AX_S32 deviceId) {
+    device *dev = simulator::get().find(deviceId);
+    if (!dev) {
+        return AXCL_ERR_DEVICE_INVALID_ID;
+    }
+
+    for (auto &&name : {"vdec", "jdec", "venc", "jenc", "tdp", "vpp", "vgp", "npu", "h2d", "d2h", "dma"}) {
+        dev->unit(name)->reset_stat();
+    }
+
+    return AXCL_SUCC;
+}
@@ -0,0 +1,53 @@
+/**************************************************************************************************
+ *
+ * Copyright (c) 2019-2024 Axera Semiconductor Co., Ltd. All Rights Reserved.
+ *
+ * This source file is the property of Axera Semiconductor Co., Ltd. and
+ * may not be copied or distributed in any isomorphic form without the prior
+ * written consent of Axera Semiconductor Co., Ltd.
+ *
+ **************************************************************************************************/
+
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include "axcl_sim_device.hpp"
+
+namespace axclsim {
+
+/**
+ * @brief in-order task queue of an axclrtStream, tasks run on one thread bound to the creator's context.
+ */
+class stream {
+public:
+    explicit stream(context *ctx);
+    ~stream();
+
+    void push(std::function<void()> task);
+
+    /* false on timeout (ms, < 0 forever) */
+    bool synchronize(int32_t timeout);
+
+    /* drop the tasks not started yet */
+    void discard();
+
+    static stream *from(void *handle);
+
+private:
+    void run();
+
+private:
+    context *m_ctx;
+    std::mutex m_mtx;
+    std::condition_variable m_cv;
+    std::deque<std::function<void()>> m_tasks;
+    bool m_busy = false;
+    bool m_exit = false;
+    std::thread m_thread;
+};
+
+}  // namespace axclsim
@@ -0,0 +1,233 @@
+/**************************************************************************************************
+ *
+ * Copyright (c) 2019-2024 Axera Semiconductor Co., Ltd. All Rights Reserved.
+ *
+ * This source file is the property of Axera Semiconductor Co., Ltd. and
+ * may not be copied or distributed in any isomorphic form without the prior
+ * written consent of Axera Semiconductor Co., Ltd.
+ *
+ **************************************************************************************************/
+
+#include <string.h>
+#include "axcl_sim_device.hpp"
+#include "log/logger.hpp"
+
+#define TAG "axcl-sim-sys"
+
+using namespace axclsim;
+
+namespace {
+
+struct user_pool {
+    device *dev;
+    std::shared_ptr<vb_pool> pool;
+};
+
+std::mutex s_mtx_pools;
+std::map<AX_POOL, user_pool> s_pools;
+AX_POOL s_next_pool = 0;
+
+}  // namespace
+
+AX_S32 AXCL_SYS_Init(AX_VOID) {
+    return simulator::current() ? AX_SUCCESS : AX_ERR_CMM_NOTREADY;
+}
+
+AX_S32 AXCL_SYS_Deinit(AX_VOID) {
+    return AX_SUCCESS;
+}
+
+AX_S32 AXCL_SYS_MemAlloc(AX_U64 *phyaddr, AX_VOID **pviraddr, AX_U32 size, AX_U32 align, const AX_S8 *token) {
+    (void)token;
+    if (!phyaddr || !pviraddr) {
+        return AX_ERR_CMM_NULL_PTR;
+    }
+
+    device *dev = simulator::current();
+    if (!dev) {
+        return AX_ERR_CMM_NOTREADY;
+    }
+
+    void *mem = dev->cmm_alloc(size, align);
+    if (!mem) {
+        LOG_MM_E(TAG, "device {}: alloc {} bytes fail, used {} of {}", dev->id(), size, dev->cmm_used(), dev->cmm_total());
+        return AX_ERR_CMM_NOMEM;
+    }
+
+    *phyaddr = reinterpret_cast<AX_U64>(mem);
+    *pviraddr = mem;
+    return AX_SUCCESS;
+}
+
+AX_S32 AXCL_SYS_MemAllocCached(AX_U64 *phyaddr, AX_VOID **pviraddr, AX_U32 size, AX_U32 align, const AX_S8 *token) {
+    return AXCL_SYS_MemAlloc(phyaddr, pviraddr, size, align, token);
+}
+
+AX_S32 AXCL_SYS_MemFree(AX_U64 phyaddr, AX_VOID *pviraddr) {
+    (void)pviraddr;
+    device *dev = simulator::current();
+    if (!dev) {
+        return AX_ERR_CMM_NOTREADY;
+    }
+
+    return dev->cmm_free(reinterpret_cast<void *>(phyaddr)) ? AX_SUCCESS : AX_ERR_CMM_FREE_FAIL;
+}
+
+AX_S32 AXCL_SYS_MflushCache(AX_U64 phyaddr, AX_VOID *pviraddr, AX_U32 size) {
+    (void)pviraddr;
+    device *dev = simulator::current();
+    if (!dev) {
+        return AX_ERR_CMM_NOTREADY;
+    }
+
+    return dev->is_cmm(reinterpret_cast<void *>(phyaddr), size) ? AX_SUCCESS : AX_ERR_CMM_ILLEGAL_PARAM;
+}
+
+AX_S32 AXCL_SYS_MinvalidateCache(AX_U64 phyaddr, AX_VOID *pviraddr, AX_U32 size) {
+    return AXCL_SYS_MflushCache(phyaddr, pviraddr, size);
+}
+
+AX_S32 AXCL_SYS_Link(const AX_MOD_INFO_T *pSrc, const AX_MOD_INFO_T *pDest) {
+    if (!pSrc || !pDest) {
+        return AX_ERR_LINK_NULL_PTR;
+    }
+
+    device *dev = simulator::current();
+    if (!dev) {
+        return AX_ERR_LINK_NOTREADY;
+    }
+
+    return dev->link(*pSrc, *pDest) ? AX_SUCCESS : AX_ERR_LINK_NOT_PERM;
+}
+
+AX_S32 AXCL_SYS_UnLink(const AX_MOD_INFO_T *pSrc, const AX_MOD_INFO_T *pDest) {
+    if (!pSrc || !pDest) {
+        return AX_ERR_LINK_NULL_PTR;
+    }
+
+    device *dev = simulator::current();
+    if (!dev) {
+        return AX_ERR_LINK_NOTREADY;
+    }
+
+    return dev->unlink(*pSrc, *pDest) ? AX_SUCCESS : AX_ERR_LINK_UNEXIST;
+}
+
+AX_S32 AXCL_SYS_GetLinkByDest(const AX_MOD_INFO_T *pDest, AX_MOD_INFO_T *pSrc) {
+    if (!pSrc || !pDest) {
+        return AX_ERR_LINK_NULL_PTR;
+    }
+
+    device *dev = simulator::current();
+    if (!dev) {
+        return AX_ERR_LINK_NOTREADY;
+    }
+
+    return dev->get_link_by_dest(*pDest, *pSrc) ? AX_SUCCESS : AX_ERR_LINK_UNEXIST;
+}
+
+AX_S32 AXCL_SYS_GetCurPTS(AX_U64 *pu64CurPTS) {
+    if (!pu64CurPTS) {
+        return AX_ERR_PTS_NULL_PTR;
+    }
+
+    *pu64CurPTS = std::chrono::duration_cast<std::chrono::microseconds>(sim_clock::now().time_since_epoch()).count();
+    return AX_SUCCESS;
+}
+
+AX_S32 AXCL_POOL_Init(AX_VOID) {
+    return simulator::current() ? AX_SUCCESS : AX_ERR_POOL_NOTREADY;
+}
+
+AX_S32 AXCL_POOL_Exit(AX_VOID) {
+    device *dev = simulator::current();
+    if (!dev) {
+        return AX_ERR_POOL_NOTREADY;
+    }
+
+    std::lock_guard<std::mutex> lck(s_mtx_pools);
+    for (auto it = s_pools.begin(); it != s_pools.end();) {
+        if (it->second.dev == dev) {
+            it->second.pool->close();
+            it = s_pools.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    return AX_SUCCESS;
+}
+
+AX_POOL AXCL_POOL_CreatePool(AX_POOL_CONFIG_T *pPoolConfig) {
+    if (!pPoolConfig || 0 == pPoolConfig->BlkCnt || 0 == pPoolConfig->BlkSize) {
+        return AX_INVALID_POOLID;
+    }
+
+    device *dev = simulator::current();
+    if (!dev) {
+        return AX_INVALID_POOLID;
+    }
+
+    auto pool = vb_pool::create(dev, pPoolConfig->BlkCnt, static_cast<AX_U32>(pPoolConfig->MetaSize + pPoolConfig->BlkSize));
+    if (!pool) {
+        LOG_MM_E(TAG, "device {}: create pool of {} x {} bytes fail", dev->id(), pPoolConfig->BlkCnt, pPoolConfig->BlkSize);
+        return AX_INVALID_POOLID;
+    }
+
+    std::lock_guard<std::mutex> lck(s_mtx_pools);
+    AX_POOL id = s_next_pool++;
+    s_pools[id] = {dev, pool};
+    return id;
+}
+
+AX_S32 AXCL_POOL_DestroyPool(AX_POOL PoolId) {
+    std::lock_guard<std::mutex> lck(s_mtx_pools);
+    auto it = s_pools.find(PoolId);
+    if (it == s_pools.end()) {
+        return AX_ERR_POOL_UNEXIST;
+    }
+
+    it->second.pool->close();
+    s_pools.erase(it);
+    return AX_SUCCESS;
+}
+
+AX_BLK AXCL_POOL_GetBlock(AX_POOL PoolId, AX_U64 BlkSize, const AX_S8 *pPartitionName) {
+    (void)pPartitionName;
+    std::shared_ptr<vb_pool> pool;
+    {
+        std::lock_guard<std::mutex> lck(s_mtx_pools);
+        auto it = s_pools.find(PoolId);
+        if (it == s_pools.end() || BlkSize > it->second.pool->size()) {
+            return AX_INVALID_BLOCKID;
+        }
+
+        pool = it->second.pool;
+    }
+
+    return pool->get(0);
+}
+
+AX_S32 AXCL_POOL_ReleaseBlock(AX_BLK BlockId) {
+    return vb_registry::get().decrease(BlockId) ? AX_SUCCESS : AX_ERR_POOL_ILLEGAL_PARAM;
+}
+
+AX_U64 AXCL_POOL_Handle2PhysAddr(AX_BLK BlockId) {
+    AX_U64 phy = 0;
+    AX_U32 size = 0;
+    return vb_registry::get().query(BlockId, phy, size) ? phy : 0;
+}
+
+AX_U64 AXCL_POOL_Handle2BlkSize(AX_BLK BlockId) {
+    AX_U64 phy = 0;
+    AX_U32 size = 0;
+    return vb_registry::get().query(BlockId, phy, size) ? size : 0;
+}
+
+AX_S32 AXCL_POOL_IncreaseRefCnt(AX_BLK BlockId) {
+    return vb_registry::get().increase(BlockId) ? AX_SUCCESS : AX_ERR_POOL_ILLEGAL_PARAM;
+}
+
+AX_S32 AXCL_POOL_DecreaseRefCnt(AX_BLK BlockId) {
+    return vb_registry::get().decrease(BlockId) ? AX_SUCCESS : AX_ERR_POOL_ILLEGAL_PARAM;
+}
@@ -0,0 +1,718 @@
+/**************************************************************************************************
+ *
+ * Copyright (c) 2019-2024 Axera Semiconductor Co., Ltd. All Rights Reserved.
+ *
+ * This source file is the property of Axera Semiconductor Co., Ltd. and
+ * may not be copied or distributed in any isomorphic form without the prior
+ * written consent of Axera Semiconductor Co., Ltd.
+ *
+ **************************************************************************************************/
+
+#include "axcl_sim_vdec.hpp"
+#include <string.h>
+#include <algorithm>
+#include "axcl_sim_config.hpp"
+#include "log/logger.hpp"
+
+#define TAG "axcl-sim-vdec"
+
+namespace axclsim {
+
+vdec_module::vdec_module(device *dev) : m_dev(dev) {
+    m_max_grp = static_cast<uint32_t>(std::min<int64_t>(config::get().get_i64("vdec.max_grp"), AX_VDEC_MAX_GRP_NUM));
+}
+
+vdec_module::~vdec_module() {
+    deinit();
+}
+
+AX_S32 vdec_module::init() {
+    std::lock_guard<std::mutex> lck(m_mtx);
+    m_init = true;
+    return AX_SUCCESS;
+}
+
+AX_S32 vdec_module::deinit() {
+    std::vector<AX_VDEC_GRP> grps;
+    {
+        std::lock_guard<std::mutex> lck(m_mtx);
+        for (auto &&m : m_grps) {
+            grps.push_back(m.first);
+        }
+    }
+
+    for (auto &&grp : grps) {
+        destroy_grp(grp);
+    }
+
+    std::lock_guard<std::mutex> lck(m_mtx);
+    m_init = false;
+    return AX_SUCCESS;
+}
+
+vdec_module::group *vdec_module::find(AX_VDEC_GRP grp) {
+    auto it = m_grps.find(grp);
+    return (it != m_grps.end()) ? it->second.get() : nullptr;
+}
+
+AX_S32 vdec_module::create_grp(AX_VDEC_GRP grp, const AX_VDEC_GRP_ATTR_T &attr) {
+    if (grp < 0 || static_cast<uint32_t>(grp) >= m_max_grp) {
+        return AX_ERR_VDEC_INVALID_GRPID;
+    }
+
+    if (0 == attr.u32MaxPicWidth || 0 == attr.u32MaxPicHeight || attr.u32MaxPicWidth > AX_VDEC_MAX_WIDTH ||
+        attr.u32MaxPicHeight > AX_VDEC_MAX_HEIGHT) {
+        return AX_ERR_VDEC_ILLEGAL_PARAM;
+    }
+
+    std::lock_guard<std::mutex> lck(m_mtx);
+    if (!m_init) {
+        return AX_ERR_VDEC_NOT_INIT;
+    }
+
+    if (find(grp)) {
+        return AX_ERR_VDEC_EXIST;
+    }
+
+    auto g = std::make_unique<group>();
+    g->id = grp;
+    g->attr = attr;
+    if (0 == g->attr.u32StreamBufSize) {
+        g->attr.u32StreamBufSize = attr.u32MaxPicWidth * attr.u32MaxPicHeight * 3 / 2;
+    }
+
+    g->worker = std::thread(&vdec_module::decode_thread, this, g.get());
+    m_grps[grp] = std::move(g);
+    return AX_SUCCESS;
+}
+
+AX_S32 vdec_module::create_grp_ex(AX_VDEC_GRP &grp, const AX_VDEC_GRP_ATTR_T &attr) {
+    AX_VDEC_GRP id = 0;
+    {
+        std::lock_guard<std::mutex> lck(m_mtx);
+        while (static_cast<uint32_t>(id) < m_max_grp && find(id)) {
+            ++id;
+        }
+
+        if (static_cast<uint32_t>(id) >= m_max_grp) {
+            return AX_ERR_VDEC_NO_AVAILABLE_GRP;
+        }
+    }
+
+    if (AX_S32 ret = create_grp(id, attr); AX_SUCCESS != ret) {
+        return ret;
+    }
+
+    grp = id;
+    return AX_SUCCESS;
+}
+
+AX_S32 vdec_module::destroy_grp(AX_VDEC_GRP grp) {
+    group *g;
+    {
+        std::lock_guard<std::mutex> lck(m_mtx);
+        g = find(grp);
+        if (!g) {
+            return AX_ERR_VDEC_UNEXIST;
+        }
+
+        if (g->exit) {
+            /* destroying by another thread */
+            return AX_ERR_VDEC_BUSY;
+        }
+
+        g->exit = true;
+        g->started = false;
+        for (auto &&c : g->chns) {
+            if (c.pool) {
+                /* wake the worker waiting for a free block */
+                c.pool->close();
+            }
+        }
+
+        m_cv.notify_all();
+    }
+
+    g->worker.join();
+
+    std::lock_guard<std::mutex> lck(m_mtx);
+    flush(g);
+    m_grps.erase(grp);
+    m_cv.notify_all();
+    return AX_SUCCESS;
+}
+
+AX_S32 vdec_module::set_grp_param(AX_VDEC_GRP grp, const AX_VDEC_GRP_PARAM_T &param) {
+    /* decode mode and output order do not change the cost */
+    (void)param;
+    std::lock_guard<std::mutex> lck(m_mtx);
+    return find(grp) ? AX_SUCCESS : AX_ERR_VDEC_UNEXIST;
+}
+
+AX_S32 vdec_module::set_display_mode(AX_VDEC_GRP grp, AX_VDEC_DISPLAY_MODE_E mode) {
+    std::lock_guard<std::mutex> lck(m_mtx);
+    group *g = find(grp);
+    if (!g) {
+        return AX_ERR_VDEC_UNEXIST;
+    }
+
+    g->display_mode = mode;
+    return AX_SUCCESS;
+}
+
+AX_S32 vdec_module::set_chn_attr(AX_VDEC_GRP grp, AX_VDEC_CHN chn, const AX_VDEC_CHN_ATTR_T &attr) {
+    if (chn < 0 || chn >= AX_DEC_MAX_CHN_NUM) {
+        return AX_ERR_VDEC_INVALID_CHNID;
+    }
+
+    std::lock_guard<std::mutex> lck(m_mtx);
+    group *g = find(grp);
+    if (!g) {
+        return AX_ERR_VDEC_UNEXIST;
+    }
+
+    channel &c = g->chns[chn];
+    if (c.enabled) {
+        return AX_ERR_VDEC_NOT_PERM;
+    }
+
+    c.attr = attr;
+    if (0 == c.attr.u32PicWidth || 0 == c.attr.u32PicHeight) {
+        c.attr.u32PicWidth = g->attr.u32MaxPicWidth;
+        c.attr.u32PicHeight = g->attr.u32MaxPicHeight;
+    }
+
+    if (0 == c.attr.u32FrameStride) {
+        c.attr.u32FrameStride = (c.attr.u32PicWidth + 15) / 16 * 16;
+    }
+
+    if (0 == c.attr.u32FrameBufCnt) {
+        c.attr.u32FrameBufCnt = 8;
+    }
+
+    const AX_U64 size = frame_size(c.attr.enImgFormat, c.attr.u32FrameStride, c.attr.u32PicHeight);
+    if (c.attr.u32FrameBufSize < size) {
+        c.attr.u32FrameBufSize = static_cast<AX_U32>(size);
+    }
+
+    c.configured = true;
+    return AX_SUCCESS;
+}
+
+AX_S32 vdec_module::enable_chn(AX_VDEC_GRP grp, AX_VDEC_CHN chn) {
+    if (chn < 0 || chn >= AX_DEC_MAX_CHN_NUM) {
+        return AX_ERR_VDEC_INVALID_CHNID;
+    }
+
+    std::lock_guard<std::mutex> lck(m_mtx);
+    group *g = find(grp);
+    if (!g) {
+        return AX_ERR_VDEC_UNEXIST;
+    }
+
+    channel &c = g->chns[chn];
+    if (!c.configured) {
+        return AX_ERR_VDEC_NOT_CONFIG;
+    }
+
+    if (c.enabled) {
+        return AX_SUCCESS;
+    }
+
+    c.pool = vb_pool::create(m_dev, c.attr.u32FrameBufCnt, c.attr.u32FrameBufSize);
+    if (!c.pool) {
+        LOG_MM_E(TAG, "device {} vdGrp {} vdChn {}: no memory for {} x {} bytes", m_dev->id(), grp, chn, c.attr.u32FrameBufCnt,
+                 c.attr.u32FrameBufSize);
+        return AX_ERR_VDEC_NOMEM;
+    }
+
+    c.enabled = true;
+    c.eos = false;
+    c.eos_reported = false;
+    return AX_SUCCESS;
+}
+
+AX_S32 vdec_module::disable_chn(AX_VDEC_GRP grp, AX_VDEC_CHN chn) {
+    if (chn < 0 || chn >= AX_DEC_MAX_CHN_NUM) {
+        return AX_ERR_VDEC_INVALID_CHNID;
+    }
+
+    std::lock_guard<std::mutex> lck(m_mtx);
+    group *g = find(grp);
+    if (!g) {
+        return AX_ERR_VDEC_UNEXIST;
+    }
+
+    channel &c = g->chns[chn];
+    if (!c.enabled) {
+        return AX_SUCCESS;
+    }
+
+    c.enabled = false;
+    for (auto &&m : c.fifo) {
+        unref_frame(m.stVFrame);
+    }
+
+    c.fifo.clear();
+    c.pool->close();
+    c.pool.reset();
+    m_cv.notify_all();
+    return AX_SUCCESS;
+}
+
+AX_S32 vdec_module::start_recv(AX_VDEC_GRP grp) {
+    std::lock_guard<std::mutex> lck(m_mtx);
+    group *g = find(grp);
+    if (!g) {
+        return AX_ERR_VDEC_UNEXIST;
+    }
+
+    g->started = true;
+    m_cv.notify_all();
+    return AX_SUCCESS;
+}
+
+AX_S32 vdec_module::stop_recv(AX_VDEC_GRP grp) {
+    std::lock_guard<std::mutex> lck(m_mtx);
+    group *g = find(grp);
+    if (!g) {
+        return AX_ERR_VDEC_UNEXIST;
+    }
+
+    g->started = false;
+    m_cv.notify_all();
+    return AX_SUCCESS;
+}
+
+AX_S32 vdec_module::reset_grp(AX_VDEC_GRP grp) {
+    std::lock_guard<std::mutex> lck(m_mtx);
+    group *g = find(grp);
+    if (!g) {
+        return AX_ERR_VDEC_UNEXIST;
+    }
+
+    if (g->started || g->busy) {
+        return AX_ERR_VDEC_BUSY;
+    }
+
+    flush(g);
+    g->recv_frames = 0;
+    g->decoded_frames = 0;
+    g->seq = 0;
+    m_cv.notify_all();
+    return AX_SUCCESS;
+}
+
+void vdec_module::flush(group *g) {
+    g->packets.clear();
+    g->packet_bytes = 0;
+    for (auto &&c : g->chns) {
+        for (auto &&m : c.fifo) {
+            unref_frame(m.stVFrame);
+        }
+
+        c.fifo.clear();
+        c.eos = false;
+        c.eos_reported = false;
+    }
+}
+
+AX_S32 vdec_module::query_status(AX_VDEC_GRP grp, AX_VDEC_GRP_STATUS_T &status) {
+    std::lock_guard<std::mutex> lck(m_mtx);
+    group *g = find(grp);
+    if (!g) {
+        return AX_ERR_VDEC_UNEXIST;
+    }
+
+    memset(&status, 0, sizeof(status));
+    status.enCodecType = g->attr.enCodecType;
+    status.u32LeftStreamBytes = static_cast<AX_U32>(g->packet_bytes);
+    status.u32LeftStreamFrames = static_cast<AX_U32>(g->packets.size());
+    for (AX_U32 i = 0; i < AX_DEC_MAX_CHN_NUM; ++i) {
+        status.u32LeftPics[i] = static_cast<AX_U32>(g->chns[i].fifo.size());
+    }
+
+    status.bStartRecvStream = g->started ? AX_TRUE : AX_FALSE;
+    status.u32RecvStreamFrames = g->recv_frames;
+    status.u32DecodeStreamFrames = g->decoded_frames;
+    status.u32PicWidth = g->attr.u32MaxPicWidth;
+    status.u32PicHeight = g->attr.u32MaxPicHeight;
+    status.bInputFifoIsFull = (g->packet_bytes >= g->attr.u32StreamBufSize) ? AX_TRUE : AX_FALSE;
+    return AX_SUCCESS;
+}
+
+AX_S32 vdec_module::select(AX_VDEC_GRP_SET_INFO_T &info, AX_S32 timeout) {
+    auto collect = [this, &info]() -> bool {
+        info.u32GrpCount = 0;
+        for (auto &&m : m_grps) {
+            auto &set = info.stChnSet[info.u32GrpCount];
+            set.VdGrp = m.first;
+            set.u32ChnCount = 0;
+            for (AX_VDEC_CHN chn = 0; chn < AX_DEC_MAX_CHN_NUM; ++chn) {
+                const channel &c = m.second->chns[chn];
+                if (c.enabled && (!c.fifo.empty() || (c.eos && !c.eos_reported))) {
+                    set.VdChn[set.u32ChnCount] = chn;
+                    set.u64ChnFrameNum[set.u32ChnCount] = c.fifo.size();
+                    ++set.u32ChnCount;
+                }
+            }
+
+            if (set.u32ChnCount > 0) {
+                ++info.u32GrpCount;
+            }
+        }
+
+        return info.u32GrpCount > 0;
+    };
+
+    std::unique_lock<std::mutex> lck(m_mtx);
+    if (!m_init) {
+        return AX_ERR_VDEC_NOT_INIT;
+    }
+
+    return wait_for(m_cv, lck, timeout, collect) ? AX_SUCCESS : AX_ERR_VDEC_TIMED_OUT;
+}
+
+AX_S32 vdec_module::send_stream(AX_VDEC_GRP grp, const AX_VDEC_STREAM_T &stream, AX_S32 timeout) {
+    const AX_U32 len = stream.u32StreamPackLen;
+    if (len > 0 && !stream.pu8Addr && 0 == stream.u64PhyAddr) {
+        return AX_ERR_VDEC_NULL_PTR;
+    }
+
+    AX_U32 buf_size;
+    {
+        std::lock_guard<std::mutex> lck(m_mtx);
+        group *g = find(grp);
+        if (!g) {
+            return AX_ERR_VDEC_UNEXIST;
+        }
+
+        if (!g->started) {
+            return AX_ERR_VDEC_NOT_PERM;
+        }
+
+        buf_size = g->attr.u32StreamBufSize;
+        if (len > buf_size) {
+            return AX_ERR_VDEC_ILLEGAL_PARAM;
+        }
+    }
+
+    if (len > 0 && stream.pu8Addr) {
+        /* host memory is copied to the device stream buffer over PCIe */
+        m_dev->unit("h2d")->run(static_cast<double>(len));
+    }
+
+    std::unique_lock<std::mutex> lck(m_mtx);
+    group *g = nullptr;
+    if (!wait_for(m_cv, lck, timeout, [this, grp, len, buf_size, &g]() {
+            g = find(grp);
+            return !g || !g->started || g->packet_bytes + len <= buf_size;
+        })) {
+        return AX_ERR_VDEC_BUF_FULL;
+    }
+
+    if (!g) {
+        return AX_ERR_VDEC_UNEXIST;
+    }
+
+    if (!g->started) {
+        return AX_ERR_VDEC_NOT_PERM;
+    }
+
+    if (len > 0) {
+        g->packets.push_back({stream.u64PTS, stream.u64PrivateData, stream.u64UserData, len, false, AX_TRUE == stream.bSkipDisplay});
+        g->packet_bytes += len;
+        ++g->recv_frames;
+    }
+
+    if (stream.bEndOfStream) {
+        g->packets.push_back({stream.u64PTS, stream.u64PrivateData, stream.u64UserData, 0, true, false});
+    }
+
+    m_cv.notify_all();
+    return AX_SUCCESS;
+}
+
+AX_S32 vdec_module::get_chn_frame(AX_VDEC_GRP grp, AX_VDEC_CHN chn, AX_VIDEO_FRAME_INFO_T &frame, AX_S32 timeout) {
+    if (chn < 0 || chn >= AX_DEC_MAX_CHN_NUM) {
+        return AX_ERR_VDEC_INVALID_CHNID;
+    }
+
+    std::unique_lock<std::mutex> lck(m_mtx);
+    group *g = nullptr;
+    wait_for(m_cv, lck, timeout, [this, grp, chn, &g]() {
+        g = find(grp);
+        if (!g || g->exit || !g->chns[chn].enabled) {
+            return true;
+        }
+
+        const channel &c = g->chns[chn];
+        return !c.fifo.empty() || c.eos;
+    });
+
+    if (!g || g->exit || !g->chns[chn].enabled) {
+        return AX_ERR_VDEC_UNEXIST;
+    }
+
+    channel &c = g->chns[chn];
+    if (!c.fifo.empty()) {
+        frame = c.fifo.front();
+        c.fifo.pop_front();
+        m_cv.notify_all();
+        return AX_SUCCESS;
+    }
+
+    if (c.eos) {
+        c.eos_reported = true;
+        return AX_ERR_VDEC_FLOW_END;
+    }
+
+    return (0 == timeout) ? AX_ERR_VDEC_BUF_EMPTY : AX_ERR_VDEC_TIMED_OUT;
+}
+
+AX_S32 vdec_module::release_chn_frame(AX_VDEC_GRP grp, AX_VDEC_CHN chn, const AX_VIDEO_FRAME_INFO_T &frame) {
+    (void)grp;
+    (void)chn;
+    if (!vb_registry::get().decrease(frame.stVFrame.u32BlkId[0])) {
+        return AX_ERR_VDEC_ILLEGAL_PARAM;
+    }
+
+    return AX_SUCCESS;
+}
+
+void vdec_module::output(group *g, AX_VDEC_CHN chn, const AX_VIDEO_FRAME_INFO_T &frame) {
+    const AX_MOD_INFO_T src = {AX_ID_VDEC, g->id, chn};
+    if (m_dev->forward(src, frame.stVFrame)) {
+        /* the receiver holds its own reference */
+        unref_frame(frame.stVFrame);
+        return;
+    }
+
+    std::unique_lock<std::mutex> lck(m_mtx);
+    channel &c = g->chns[chn];
+    const size_t depth = std::max<AX_U32>(c.attr.u32OutputFifoDepth, 1);
+    if (AX_VDEC_DISPLAY_MODE_PLAYBACK == g->display_mode) {
+        m_cv.wait(lck, [g, &c, depth]() { return g->exit || !c.enabled || c.fifo.size() < depth; });
+        if (g->exit || !c.enabled) {
+            unref_frame(frame.stVFrame);
+            return;
+        }
+    } else {
+        /* preview drops the oldest frame */
+        while (c.fifo.size() >= depth) {
+            unref_frame(c.fifo.front().stVFrame);
+            c.fifo.pop_front();
+        }
+    }
+
+    c.fifo.push_back(frame);
+    m_cv.notify_all();
+}
+
+void vdec_module::decode_thread(group *g) {
+    struct target {
+        AX_VDEC_CHN chn;
+        AX_VDEC_CHN_ATTR_T attr;
+        std::shared_ptr<vb_pool> pool;
+    };
+
+    const bool jpeg = (PT_JPEG == g->attr.enCodecType || PT_MJPEG == g->attr.enCodecType);
+    hw_unit *unit = m_dev->unit(jpeg ? "jdec" : "vdec");
+    const double pixels = static_cast<double>(g->attr.u32MaxPicWidth) * g->attr.u32MaxPicHeight;
+
+    std::unique_lock<std::mutex> lck(m_mtx);
+    while (true) {
+        m_cv.wait(lck, [g]() { return g->exit || !g->packets.empty(); });
+        if (g->exit) {
+            break;
+        }
+
+        const packet pkt = g->packets.front();
+        g->packets.pop_front();
+        g->packet_bytes -= pkt.len;
+        m_cv.notify_all();
+
+        if (pkt.eos) {
+            for (auto &&c : g->chns) {
+                if (c.enabled) {
+                    c.eos = true;
+                    c.eos_reported = false;
+                }
+            }
+
+            continue;
+        }
+
+        std::vector<target> targets;
+        for (AX_VDEC_CHN chn = 0; chn < AX_DEC_MAX_CHN_NUM; ++chn) {
+            if (g->chns[chn].enabled) {
+                targets.push_back({chn, g->chns[chn].attr, g->chns[chn].pool});
+            }
+        }
+
+        const bool preview = (AX_VDEC_DISPLAY_MODE_PREVIEW == g->display_mode);
+        const AX_U64 seq = g->seq++;
+        g->busy = true;
+        lck.unlock();
+
+        unit->run(pixels);
+
+        for (auto &&t : targets) {
+            /* preview never waits for a block, the picture is dropped */
+            AX_BLK blk = t.pool->get(preview ? 0 : -1);
+            if (AX_INVALID_BLOCKID == blk) {
+                continue;
+            }
+
+            AX_VIDEO_FRAME_INFO_T frame;
+            memset(&frame, 0, sizeof(frame));
+            fill_frame(frame.stVFrame, t.pool->find(blk), t.attr.u32PicWidth, t.attr.u32PicHeight, t.attr.u32FrameStride,
+                       t.attr.enImgFormat);
+            frame.stVFrame.u64PTS = pkt.pts;
+            frame.stVFrame.u64SeqNum = seq;
+            frame.stVFrame.u64UserData = pkt.user_data;
+            frame.stVFrame.u64PrivateData = pkt.private_data;
+            frame.enModId = AX_ID_VDEC;
+
+            if (pkt.skip) {
+                unref_frame(frame.stVFrame);
+            } else {
+                output(g, t.chn, frame);
+            }
+        }
+
+        lck.lock();
+        g->busy = false;
+        ++g->decoded_frames;
+        m_cv.notify_all();
+    }
+}
+
+}  // namespace axclsim
+
+using namespace axclsim;
+
+static vdec_module *current_vdec() {
+    device *dev = simulator::current();
+    return dev ? dev->vdec.get() : nullptr;
+}
+
+#define VDEC_CALL(expr)                        \
+    do {                                       \
+        vdec_module *vdec = current_vdec();    \
+        if (!vdec) {                           \
+            return AX_ERR_VDEC_SYS_NOTREADY;   \
+        }                                      \
+        return vdec->expr;                     \
+    } while (0)
+
+AX_S32 AXCL_VDEC_Init(const AX_VDEC_MOD_ATTR_T *pstModAttr) {
+    (void)pstModAttr;
+    VDEC_CALL(init());
+}
+
+AX_S32 AXCL_VDEC_Deinit(AX_VOID) {
+    VDEC_CALL(deinit());
+}
+
+AX_S32 AXCL_VDEC_CreateGrp(AX_VDEC_GRP VdGrp, const AX_VDEC_GRP_ATTR_T *pstGrpAttr) {
+    if (!pstGrpAttr) {
+        return AX_ERR_VDEC_NULL_PTR;
+    }
+
+    VDEC_CALL(create_grp(VdGrp, *pstGrpAttr));
+}
+
+AX_S32 AXCL_VDEC_CreateGrpEx(AX_VDEC_GRP *VdGrp, const AX_VDEC_GRP_ATTR_T *pstGrpAttr) {
+    if (!VdGrp || !pstGrpAttr) {
+        return AX_ERR_VDEC_NULL_PTR;
+    }
+
+    VDEC_CALL(create_grp_ex(*VdGrp, *pstGrpAttr));
+}
+
+AX_S32 AXCL_VDEC_DestroyGrp(AX_VDEC_GRP VdGrp) {
+    VDEC_CALL(destroy_grp(VdGrp));
+}
+
+AX_S32 AXCL_VDEC_SetGrpParam(AX_VDEC_GRP VdGrp, const AX_VDEC_GRP_PARAM_T *pstGrpParam) {
+    if (!pstGrpParam) {
+        return AX_ERR_VDEC_NULL_PTR;
+    }
+
+    VDEC_CALL(set_grp_param(VdGrp, *pstGrpParam));
+}
+
+AX_S32 AXCL_VDEC_SetDisplayMode(AX_VDEC_GRP VdGrp, AX_VDEC_DISPLAY_MODE_E enDisplayMode) {
+    VDEC_CALL(set_display_mode(VdGrp, enDisplayMode));
+}
+
+AX_S32 AXCL_VDEC_SetChnAttr(AX_VDEC_GRP VdGrp, AX_VDEC_CHN VdChn, const AX_VDEC_CHN_ATTR_T *pstVdChnAttr) {
+    if (!pstVdChnAttr) {
+        return AX_ERR_VDEC_NULL_PTR;
+    }
+
+    VDEC_CALL(set_chn_attr(VdGrp, VdChn, *pstVdChnAttr));
+}
+
+AX_S32 AXCL_VDEC_EnableChn(AX_VDEC_GRP VdGrp, AX_VDEC_CHN VdChn) {
+    VDEC_CALL(enable_chn(VdGrp, VdChn));
+}
+
+AX_S32 AXCL_VDEC_DisableChn(AX_VDEC_GRP VdGrp, AX_VDEC_CHN VdChn) {
+    VDEC_CALL(disable_chn(VdGrp, VdChn));
+}
+
+AX_S32 AXCL_VDEC_StartRecvStream(AX_VDEC_GRP VdGrp, const AX_VDEC_RECV_PIC_PARAM_T *pstRecvParam) {
+    /* the number of pictures to receive is not limited */
+    (void)pstRecvParam;
+    VDEC_CALL(start_recv(VdGrp));
+}
+
+AX_S32 AXCL_VDEC_StopRecvStream(AX_VDEC_GRP VdGrp) {
+    VDEC_CALL(stop_recv(VdGrp));
+}
+
+AX_S32 AXCL_VDEC_ResetGrp(AX_VDEC_GRP VdGrp) {
+    VDEC_CALL(reset_grp(VdGrp));
+}
+
+AX_S32 AXCL_VDEC_QueryStatus(AX_VDEC_GRP VdGrp, AX_VDEC_GRP_STATUS_T *pstGrpStatus) {
+    if (!pstGrpStatus) {
+        return AX_ERR_VDEC_NULL_PTR;
+    }
+
+    VDEC_CALL(query_status(VdGrp, *pstGrpStatus));
+}
+
+AX_S32 AXCL_VDEC_SelectGrp(AX_VDEC_GRP_SET_INFO_T *pstGrpSet, AX_S32 s32MilliSec) {
+    if (!pstGrpSet) {
+        return AX_ERR_VDEC_NULL_PTR;
+    }
+
+    VDEC_CALL(select(*pstGrpSet, s32MilliSec));
+}
+
+AX_S32 AXCL_VDEC_SendStream(AX_VDEC_GRP VdGrp, const AX_VDEC_STREAM_T *pstStream, AX_S32 s32MilliSec) {
+    if (!pstStream) {
+        return AX_ERR_VDEC_NULL_PTR;
+    }
+
+    VDEC_CALL(send_stream(VdGrp, *pstStream, s32MilliSec));
+}
+
+AX_S32 AXCL_VDEC_GetChnFrame(AX_VDEC_GRP VdGrp, AX_VDEC_CHN VdChn, AX_VIDEO_FRAME_INFO_T *pstFrameInfo, AX_S32 s32MilliSec) {
+    if (!pstFrameInfo) {
+        return AX_ERR_VDEC_NULL_PTR;
+    }
+
+    VDEC_CALL(get_chn_frame(VdGrp, VdChn, *pstFrameInfo, s32MilliSec));
+}
+
+AX_S32 AXCL_VDEC_ReleaseChnFrame(AX_VDEC_GRP VdGrp, AX_VDEC_CHN VdChn, const AX_VIDEO_FRAME_INFO_T *pstFrameInfo) {
+    if (!pstFrameInfo) {
+        return AX_ERR_VDEC_NULL_PTR;
+    }
+
+    VDEC_CALL(release_chn_frame(VdGrp, VdChn, *pstFrameInfo));
+}
@@ -0,0 +1,100 @@
+/**************************************************************************************************
+ *
+ * Copyright (c) 2019-2024 Axera Semiconductor Co., Ltd. All Rights Reserved.
+ *
+ * This source file is the property of Axera Semiconductor Co., Ltd. and
+ * may not be copied or distributed in any isomorphic form without the prior
+ * written consent of Axera Semiconductor Co., Ltd.
+ *
+ **************************************************************************************************/
+
+#pragma once
+
+#include <deque>
+#include <thread>
+#include "axcl_sim_device.hpp"
+
+namespace axclsim {
+
+/**
+ * @brief VDEC/JDEC groups of one device.
+ * Each group decodes its packets on a worker thread, every enabled channel gets one frame per packet
+ * from its own VB pool, output goes to the linked module or to the channel fifo.
+ */
+class vdec_module {
+public:
+    explicit vdec_module(device *dev);
+    ~vdec_module();
+
+    AX_S32 init();
+    AX_S32 deinit();
+
+    AX_S32 create_grp(AX_VDEC_GRP grp, const AX_VDEC_GRP_ATTR_T &attr);
+    AX_S32 create_grp_ex(AX_VDEC_GRP &grp, const AX_VDEC_GRP_ATTR_T &attr);
+    AX_S32 destroy_grp(AX_VDEC_GRP grp);
+    AX_S32 set_grp_param(AX_VDEC_GRP grp, const AX_VDEC_GRP_PARAM_T &param);
+    AX_S32 set_display_mode(AX_VDEC_GRP grp, AX_VDEC_DISPLAY_MODE_E mode);
+    AX_S32 set_chn_attr(AX_VDEC_GRP grp, AX_VDEC_CHN chn, const AX_VDEC_CHN_ATTR_T &attr);
+    AX_S32 enable_chn(AX_VDEC_GRP grp, AX_VDEC_CHN chn);
+    AX_S32 disable_chn(AX_VDEC_GRP grp, AX_VDEC_CHN chn);
+    AX_S32 start_recv(AX_VDEC_GRP grp);
+    AX_S32 stop_recv(AX_VDEC_GRP grp);
+    AX_S32 reset_grp(AX_VDEC_GRP grp);
+    AX_S32 query_status(AX_VDEC_GRP grp, AX_VDEC_GRP_STATUS_T &status);
+
+    AX_S32 select(AX_VDEC_GRP_SET_INFO_T &info, AX_S32 timeout);
+    AX_S32 send_stream(AX_VDEC_GRP grp, const AX_VDEC_STREAM_T &stream, AX_S32 timeout);
+    AX_S32 get_chn_frame(AX_VDEC_GRP grp, AX_VDEC_CHN chn, AX_VIDEO_FRAME_INFO_T &frame, AX_S32 timeout);
+    AX_S32 release_chn_frame(AX_VDEC_GRP grp, AX_VDEC_CHN chn, const AX_VIDEO_FRAME_INFO_T &frame);
+
+private:
+    struct packet {
+        AX_U64 pts;
+        AX_U64 private_data;
+        AX_U64 user_data;
+        AX_U32 len;
+        bool eos;
+        bool skip;
+    };
+
+    struct channel {
+        AX_VDEC_CHN_ATTR_T attr = {};
+        bool configured = false;
+        bool enabled = false;
+        std::shared_ptr<vb_pool> pool;
+        std::deque<AX_VIDEO_FRAME_INFO_T> fifo;
+        bool eos = false;          /* flow end is pending behind the fifo */
+        bool eos_reported = false; /* GetChnFrame already returned flow end */
+    };
+
+    struct group {
+        AX_VDEC_GRP id;
+        AX_VDEC_GRP_ATTR_T attr;
+        AX_VDEC_DISPLAY_MODE_E display_mode = AX_VDEC_DISPLAY_MODE_PLAYBACK;
+        channel chns[AX_DEC_MAX_CHN_NUM];
+        std::deque<packet> packets;
+        AX_U64 packet_bytes = 0;
+        bool started = false;
+        bool busy = false;
+        bool exit = false;
+        AX_U32 recv_frames = 0;
+        AX_U32 decoded_frames = 0;
+        AX_U64 seq = 0;
+        std::thread worker;
+    };
+
+    group *find(AX_VDEC_GRP grp);
+    void decode_thread(group *g);
+    void output(group *g, AX_VDEC_CHN chn, const AX_VIDEO_FRAME_INFO_T &frame);
+    void flush(group *g);
+
+private:
+    device *m_dev;
+    uint32_t m_max_grp;
+    bool m_init = false;
+    std::mutex m_mtx;
+    std::condition_variable m_cv;
+    std::map<AX_VDEC_GRP, std::unique_ptr<group>> m_grps;
+};
+
+}  // namespace axclsim
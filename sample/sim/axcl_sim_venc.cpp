@@ -0,0 +1,523 @@
+/**************************************************************************************************
+ *
+ * Copyright (c) 2019-2024 Axera Semiconductor Co., Ltd. All Rights Reserved.
+ *
+ * This source file is the property of Axera Semiconductor Co., Ltd. and
+ * may not be copied or distributed in any isomorphic form without the prior
+ * written consent of Axera Semiconductor Co., Ltd.
+ *
+ **************************************************************************************************/
+
+#include "axcl_sim_venc.hpp"
+#include <string.h>
+#include <algorithm>
+#include "axcl_sim_config.hpp"
+#include "log/logger.hpp"
+
+#define TAG "axcl-sim-venc"
+
+namespace axclsim {
+
+venc_module::venc_module(device *dev) : m_dev(dev) {
+    const config &cfg = config::get();
+    m_max_chn = static_cast<uint32_t>(std::min<int64_t>(cfg.get_i64("venc.max_chn"), MAX_VENC_CHN_NUM));
+    m_gop = static_cast<uint32_t>(std::max<int64_t>(cfg.get_i64("venc.gop"), 1));
+    m_i_ratio = cfg.get_f64("venc.i_ratio");
+    m_p_ratio = cfg.get_f64("venc.p_ratio");
+}
+
+venc_module::~venc_module() {
+    deinit();
+}
+
+AX_S32 venc_module::init() {
+    std::lock_guard<std::mutex> lck(m_mtx);
+    m_init = true;
+    return AX_SUCCESS;
+}
+
+AX_S32 venc_module::deinit() {
+    std::vector<VENC_CHN> chns;
+    {
+        std::lock_guard<std::mutex> lck(m_mtx);
+        for (auto &&m : m_chns) {
+            chns.push_back(m.first);
+        }
+    }
+
+    for (auto &&chn : chns) {
+        destroy_chn(chn);
+    }
+
+    std::lock_guard<std::mutex> lck(m_mtx);
+    m_init = false;
+    return AX_SUCCESS;
+}
+
+venc_module::channel *venc_module::find(VENC_CHN chn) {
+    auto it = m_chns.find(chn);
+    return (it != m_chns.end()) ? it->second.get() : nullptr;
+}
+
+AX_S32 venc_module::create_chn(VENC_CHN chn, const AX_VENC_CHN_ATTR_T &attr) {
+    if (chn < 0 || static_cast<uint32_t>(chn) >= m_max_chn) {
+        return AX_ERR_VENC_INVALID_CHNID;
+    }
+
+    const AX_VENC_ATTR_T &venc = attr.stVencAttr;
+    const AX_U32 width = std::max(venc.u32MaxPicWidth, venc.u32PicWidthSrc);
+    const AX_U32 height = std::max(venc.u32MaxPicHeight, venc.u32PicHeightSrc);
+    if (0 == width || 0 == height) {
+        return AX_ERR_VENC_ILLEGAL_PARAM;
+    }
+
+    if (PT_H264 != venc.enType && PT_H265 != venc.enType && PT_JPEG != venc.enType && PT_MJPEG != venc.enType) {
+        return AX_ERR_VENC_NOT_SUPPORT;
+    }
+
+    std::lock_guard<std::mutex> lck(m_mtx);
+    if (!m_init) {
+        return AX_ERR_VENC_NOT_INIT;
+    }
+
+    if (find(chn)) {
+        return AX_ERR_VENC_EXIST;
+    }
+
+    auto c = std::make_unique<channel>();
+    c->id = chn;
+    c->attr = attr;
+    c->jpeg_type = (PT_JPEG == venc.enType || PT_MJPEG == venc.enType);
+    c->jpeg.u32Qfactor = 90;
+    c->in_depth = (venc.u8InFifoDepth > 0) ? venc.u8InFifoDepth : 4;
+
+    const AX_U32 slots = (venc.u8OutFifoDepth > 0) ? venc.u8OutFifoDepth : 4;
+    c->slot_size = (venc.u32BufSize > 0) ? venc.u32BufSize : (width * height * 3 / 2);
+    c->buf = reinterpret_cast<AX_U8 *>(m_dev->cmm_alloc(static_cast<uint64_t>(c->slot_size) * slots, 4096));
+    if (!c->buf) {
+        LOG_MM_E(TAG, "device {} veChn {}: no memory for stream buffer {} x {}", m_dev->id(), chn, slots, c->slot_size);
+        return AX_ERR_VENC_NOMEM;
+    }
+
+    for (AX_U32 i = 0; i < slots; ++i) {
+        c->free_slots.push_back(i);
+    }
+
+    c->worker = std::thread(&venc_module::encode_thread, this, c.get());
+    m_chns[chn] = std::move(c);
+    return AX_SUCCESS;
+}
+
+AX_S32 venc_module::create_chn_ex(VENC_CHN &chn, const AX_VENC_CHN_ATTR_T &attr) {
+    VENC_CHN id = 0;
+    {
+        std::lock_guard<std::mutex> lck(m_mtx);
+        while (static_cast<uint32_t>(id) < m_max_chn && find(id)) {
+            ++id;
+        }
+
+        if (static_cast<uint32_t>(id) >= m_max_chn) {
+            return AX_ERR_VENC_CREATE_CHAN_ERR;
+        }
+    }
+
+    if (AX_S32 ret = create_chn(id, attr); AX_SUCCESS != ret) {
+        return ret;
+    }
+
+    chn = id;
+    return AX_SUCCESS;
+}
+
+AX_S32 venc_module::destroy_chn(VENC_CHN chn) {
+    channel *c;
+    {
+        std::lock_guard<std::mutex> lck(m_mtx);
+        c = find(chn);
+        if (!c) {
+            return AX_ERR_VENC_UNEXIST;
+        }
+
+        if (c->exit) {
+            return AX_ERR_VENC_NOT_PERMIT;
+        }
+
+        c->exit = true;
+        c->started = false;
+        m_cv.notify_all();
+    }
+
+    c->worker.join();
+
+    std::lock_guard<std::mutex> lck(m_mtx);
+    for (auto &&m : c->in) {
+        unref_frame(m);
+    }
+
+    m_dev->cmm_free(c->buf);
+    m_chns.erase(chn);
+    m_cv.notify_all();
+    return AX_SUCCESS;
+}
+
+AX_S32 venc_module::start_recv(VENC_CHN chn) {
+    std::lock_guard<std::mutex> lck(m_mtx);
+    channel *c = find(chn);
+    if (!c) {
+        return AX_ERR_VENC_UNEXIST;
+    }
+
+    c->started = true;
+    c->stopped = false;
+    m_cv.notify_all();
+    return AX_SUCCESS;
+}
+
+AX_S32 venc_module::stop_recv(VENC_CHN chn) {
+    std::lock_guard<std::mutex> lck(m_mtx);
+    channel *c = find(chn);
+    if (!c) {
+        return AX_ERR_VENC_UNEXIST;
+    }
+
+    /* frames already received are still encoded, GetStream returns flow end after them */
+    c->started = false;
+    c->stopped = true;
+    m_cv.notify_all();
+    return AX_SUCCESS;
+}
+
+AX_S32 venc_module::reset_chn(VENC_CHN chn) {
+    std::lock_guard<std::mutex> lck(m_mtx);
+    channel *c = find(chn);
+    if (!c) {
+        return AX_ERR_VENC_UNEXIST;
+    }
+
+    if (c->started || c->busy) {
+        return AX_ERR_VENC_NOT_PERMIT;
+    }
+
+    for (auto &&m : c->in) {
+        unref_frame(m);
+    }
+
+    c->in.clear();
+    for (auto &&m : c->out) {
+        free_slot(c, m.stPack.ulPhyAddr);
+    }
+
+    c->out.clear();
+    c->encoded = 0;
+    m_cv.notify_all();
+    return AX_SUCCESS;
+}
+
+AX_S32 venc_module::query_status(VENC_CHN chn, AX_VENC_CHN_STATUS_T &status) {
+    std::lock_guard<std::mutex> lck(m_mtx);
+    channel *c = find(chn);
+    if (!c) {
+        return AX_ERR_VENC_UNEXIST;
+    }
+
+    memset(&status, 0, sizeof(status));
+    status.u32LeftPics = static_cast<AX_U32>(c->in.size() + (c->busy ? 1 : 0));
+    status.u32LeftStreamFrames = static_cast<AX_U32>(c->out.size());
+    for (auto &&m : c->out) {
+        status.u32LeftStreamBytes += m.stPack.u32Len;
+    }
+
+    return AX_SUCCESS;
+}
+
+AX_S32 venc_module::get_jpeg_param(VENC_CHN chn, AX_VENC_JPEG_PARAM_T &param) {
+    std::lock_guard<std::mutex> lck(m_mtx);
+    channel *c = find(chn);
+    if (!c) {
+        return AX_ERR_VENC_UNEXIST;
+    }
+
+    if (!c->jpeg_type) {
+        return AX_ERR_VENC_NOT_SUPPORT;
+    }
+
+    param = c->jpeg;
+    return AX_SUCCESS;
+}
+
+AX_S32 venc_module::set_jpeg_param(VENC_CHN chn, const AX_VENC_JPEG_PARAM_T &param) {
+    if (param.u32Qfactor < 1 || param.u32Qfactor > 99) {
+        return AX_ERR_VENC_ILLEGAL_PARAM;
+    }
+
+    std::lock_guard<std::mutex> lck(m_mtx);
+    channel *c = find(chn);
+    if (!c) {
+        return AX_ERR_VENC_UNEXIST;
+    }
+
+    if (!c->jpeg_type) {
+        return AX_ERR_VENC_NOT_SUPPORT;
+    }
+
+    c->jpeg = param;
+    return AX_SUCCESS;
+}
+
+AX_S32 venc_module::send_frame(VENC_CHN chn, const AX_VIDEO_FRAME_T &frame, AX_S32 timeout) {
+    if (0 == frame.u32Width || 0 == frame.u32Height) {
+        return AX_ERR_VENC_ILLEGAL_PARAM;
+    }
+
+    std::unique_lock<std::mutex> lck(m_mtx);
+    channel *c = nullptr;
+    if (!wait_for(m_cv, lck, timeout, [this, chn, &c]() {
+            c = find(chn);
+            return !c || !c->started || c->in.size() < c->in_depth;
+        })) {
+        return AX_ERR_VENC_QUEUE_FULL;
+    }
+
+    if (!c) {
+        return AX_ERR_VENC_UNEXIST;
+    }
+
+    if (!c->started) {
+        return AX_ERR_VENC_NOT_PERMIT;
+    }
+
+    /* the encoder holds the frame until it is encoded */
+    ref_frame(frame);
+    c->in.push_back(frame);
+    m_cv.notify_all();
+    return AX_SUCCESS;
+}
+
+void venc_module::recv_linked_frame(VENC_CHN chn, const AX_VIDEO_FRAME_T &frame) {
+    if (AX_S32 ret = send_frame(chn, frame, -1); AX_SUCCESS != ret) {
+        LOG_MM_D(TAG, "device {} veChn {}: drop linked frame {}, ret = {:#x}", m_dev->id(), chn, frame.u64SeqNum,
+                 static_cast<uint32_t>(ret));
+    }
+}
+
+AX_S32 venc_module::get_stream(VENC_CHN chn, AX_VENC_STREAM_T &stream, AX_S32 timeout) {
+    std::unique_lock<std::mutex> lck(m_mtx);
+    channel *c = nullptr;
+    wait_for(m_cv, lck, timeout, [this, chn, &c]() {
+        c = find(chn);
+        return !c || c->exit || !c->out.empty() || (c->stopped && c->in.empty() && !c->busy);
+    });
+
+    if (!c || c->exit) {
+        return AX_ERR_VENC_UNEXIST;
+    }
+
+    if (!c->out.empty()) {
+        stream = c->out.front();
+        c->out.pop_front();
+        c->held.push_back(stream.stPack.ulPhyAddr);
+        return AX_SUCCESS;
+    }
+
+    if (c->stopped && c->in.empty() && !c->busy) {
+        return AX_ERR_VENC_FLOW_END;
+    }
+
+    return AX_ERR_VENC_QUEUE_EMPTY;
+}
+
+AX_S32 venc_module::release_stream(VENC_CHN chn, const AX_VENC_STREAM_T &stream) {
+    std::lock_guard<std::mutex> lck(m_mtx);
+    channel *c = find(chn);
+    if (!c) {
+        return AX_ERR_VENC_UNEXIST;
+    }
+
+    /* pu8Addr may be replaced by the caller, the stream is matched by the physical address */
+    auto it = std::find(c->held.begin(), c->held.end(), stream.stPack.ulPhyAddr);
+    if (it == c->held.end()) {
+        return AX_ERR_VENC_ILLEGAL_PARAM;
+    }
+
+    c->held.erase(it);
+    free_slot(c, stream.stPack.ulPhyAddr);
+    m_cv.notify_all();
+    return AX_SUCCESS;
+}
+
+void venc_module::free_slot(channel *c, AX_U64 phy) {
+    c->free_slots.push_back(static_cast<AX_U32>((phy - reinterpret_cast<AX_U64>(c->buf)) / c->slot_size));
+}
+
+void venc_module::encode_thread(channel *c) {
+    hw_unit *unit = m_dev->unit(c->jpeg_type ? "jenc" : "venc");
+    const AX_PAYLOAD_TYPE_E type = c->attr.stVencAttr.enType;
+
+    std::unique_lock<std::mutex> lck(m_mtx);
+    while (true) {
+        m_cv.wait(lck, [c]() { return c->exit || (!c->in.empty() && !c->free_slots.empty()); });
+        if (c->exit) {
+            break;
+        }
+
+        const AX_VIDEO_FRAME_T frame = c->in.front();
+        c->in.pop_front();
+        const AX_U32 slot = c->free_slots.back();
+        c->free_slots.pop_back();
+        const bool idr = (0 == (c->encoded % m_gop));
+        const double ratio = c->jpeg_type ? (0.02 + 0.2 * c->jpeg.u32Qfactor / 99.0) : (idr ? m_i_ratio : m_p_ratio);
+        ++c->encoded;
+        c->busy = true;
+        m_cv.notify_all();
+        lck.unlock();
+
+        const double pixels = static_cast<double>(frame.u32Width) * frame.u32Height;
+        unit->run(pixels);
+
+        AX_U8 *data = c->buf + static_cast<uint64_t>(slot) * c->slot_size;
+        const AX_U32 len = std::min(c->slot_size, std::max<AX_U32>(64, static_cast<AX_U32>(pixels * 1.5 * ratio)));
+        if (c->jpeg_type) {
+            data[0] = 0xFF;
+            data[1] = 0xD8;
+            data[len - 2] = 0xFF;
+            data[len - 1] = 0xD9;
+        } else {
+            data[0] = 0x00;
+            data[1] = 0x00;
+            data[2] = 0x00;
+            data[3] = 0x01;
+            if (PT_H264 == type) {
+                data[4] = idr ? 0x65 : 0x41;
+            } else {
+                data[4] = idr ? 0x26 : 0x02;
+                data[5] = 0x01;
+            }
+        }
+
+        AX_VENC_STREAM_T stream;
+        memset(&stream, 0, sizeof(stream));
+        stream.stPack.ulPhyAddr = reinterpret_cast<AX_U64>(data);
+        stream.stPack.pu8Addr = data;
+        stream.stPack.u32Len = len;
+        stream.stPack.u64PTS = frame.u64PTS;
+        stream.stPack.u64SeqNum = frame.u64SeqNum;
+        stream.stPack.u64UserData = frame.u64UserData;
+        stream.stPack.enType = type;
+        stream.stPack.enCodingType = (c->jpeg_type || idr) ? AX_VENC_INTRA_FRAME : AX_VENC_PREDICTED_FRAME;
+
+        unref_frame(frame);
+
+        lck.lock();
+        c->out.push_back(stream);
+        c->busy = false;
+        m_cv.notify_all();
+    }
+}
+
+}  // namespace axclsim
+
+using namespace axclsim;
+
+static venc_module *current_venc() {
+    device *dev = simulator::current();
+    return dev ? dev->venc.get() : nullptr;
+}
+
+#define VENC_CALL(expr)                        \
+    do {                                       \
+        venc_module *venc = current_venc();    \
+        if (!venc) {                           \
+            return AX_ERR_VENC_SYS_NOTREADY;   \
+        }                                      \
+        return venc->expr;                     \
+    } while (0)
+
+AX_S32 AXCL_VENC_Init(const AX_VENC_MOD_ATTR_T *pstModAttr) {
+    (void)pstModAttr;
+    VENC_CALL(init());
+}
+
+AX_S32 AXCL_VENC_Deinit() {
+    VENC_CALL(deinit());
+}
+
+AX_S32 AXCL_VENC_CreateChn(VENC_CHN VeChn, const AX_VENC_CHN_ATTR_T *pstAttr) {
+    if (!pstAttr) {
+        return AX_ERR_VENC_NULL_PTR;
+    }
+
+    VENC_CALL(create_chn(VeChn, *pstAttr));
+}
+
+AX_S32 AXCL_VENC_CreateChnEx(VENC_CHN *pVeChn, const AX_VENC_CHN_ATTR_T *pstAttr) {
+    if (!pVeChn || !pstAttr) {
+        return AX_ERR_VENC_NULL_PTR;
+    }
+
+    VENC_CALL(create_chn_ex(*pVeChn, *pstAttr));
+}
+
+AX_S32 AXCL_VENC_DestroyChn(VENC_CHN VeChn) {
+    VENC_CALL(destroy_chn(VeChn));
+}
+
+AX_S32 AXCL_VENC_StartRecvFrame(VENC_CHN VeChn, const AX_VENC_RECV_PIC_PARAM_T *pstRecvParam) {
+    (void)pstRecvParam;
+    VENC_CALL(start_recv(VeChn));
+}
+
+AX_S32 AXCL_VENC_StopRecvFrame(VENC_CHN VeChn) {
+    VENC_CALL(stop_recv(VeChn));
+}
+
+AX_S32 AXCL_VENC_ResetChn(VENC_CHN VeChn) {
+    VENC_CALL(reset_chn(VeChn));
+}
+
+AX_S32 AXCL_VENC_QueryStatus(VENC_CHN VeChn, AX_VENC_CHN_STATUS_T *pstStatus) {
+    if (!pstStatus) {
+        return AX_ERR_VENC_NULL_PTR;
+    }
+
+    VENC_CALL(query_status(VeChn, *pstStatus));
+}
+
+AX_S32 AXCL_VENC_GetJpegParam(VENC_CHN VeChn, AX_VENC_JPEG_PARAM_T *pstJpegParam) {
+    if (!pstJpegParam) {
+        return AX_ERR_VENC_NULL_PTR;
+    }
+
+    VENC_CALL(get_jpeg_param(VeChn, *pstJpegParam));
+}
+
+AX_S32 AXCL_VENC_SetJpegParam(VENC_CHN VeChn, const AX_VENC_JPEG_PARAM_T *pstJpegParam) {
+    if (!pstJpegParam) {
+        return AX_ERR_VENC_NULL_PTR;
+    }
+
+    VENC_CALL(set_jpeg_param(VeChn, *pstJpegParam));
+}
+
+AX_S32 AXCL_VENC_SendFrame(VENC_CHN VeChn, const AX_VIDEO_FRAME_INFO_T *pstFrame, AX_S32 s32MilliSec) {
+    if (!pstFrame) {
+        return AX_ERR_VENC_NULL_PTR;
+    }
+
+    VENC_CALL(send_frame(VeChn, pstFrame->stVFrame, s32MilliSec));
+}
+
+AX_S32 AXCL_VENC_GetStream(VENC_CHN VeChn, AX_VENC_STREAM_T *pstStream, AX_S32 s32MilliSec) {
+    if (!pstStream) {
+        return AX_ERR_VENC_NULL_PTR;
+    }
+
+    VENC_CALL(get_stream(VeChn, *pstStream, s32MilliSec));
+}
+
+AX_S32 AXCL_VENC_ReleaseStream(VENC_CHN VeChn, const AX_VENC_STREAM_T *pstStream) {
+    if (!pstStream) {
+        return AX_ERR_VENC_NULL_PTR;
+    }
+
+    VENC_CALL(release_stream(VeChn, *pstStream));
+}
@@ -0,0 +1,87 @@
+/**************************************************************************************************
+ *
+ * Copyright (c) 2019-2024 Axera Semiconductor Co., Ltd. All Rights Reserved.
+ *
+ * This source file is the property of Axera Semiconductor Co., Ltd. and
+ * may not be copied or distributed in any isomorphic form without the prior
+ * written consent of Axera Semiconductor Co., Ltd.
+ *
+ **************************************************************************************************/
+
+#pragma once
+
+#include <deque>
+#include <thread>
+#include "axcl_sim_device.hpp"
+
+namespace axclsim {
+
+/**
+ * @brief VENC/JENC channels of one device.
+ * Each channel encodes its input fifo on a worker thread into a CMM stream buffer of out fifo depth slots,
+ * the stream carries a start code or JPEG markers and a size derived from venc.i_ratio/p_ratio or the qfactor.
+ */
+class venc_module {
+public:
+    explicit venc_module(device *dev);
+    ~venc_module();
+
+    AX_S32 init();
+    AX_S32 deinit();
+
+    AX_S32 create_chn(VENC_CHN chn, const AX_VENC_CHN_ATTR_T &attr);
+    AX_S32 create_chn_ex(VENC_CHN &chn, const AX_VENC_CHN_ATTR_T &attr);
+    AX_S32 destroy_chn(VENC_CHN chn);
+    AX_S32 start_recv(VENC_CHN chn);
+    AX_S32 stop_recv(VENC_CHN chn);
+    AX_S32 reset_chn(VENC_CHN chn);
+    AX_S32 query_status(VENC_CHN chn, AX_VENC_CHN_STATUS_T &status);
+    AX_S32 get_jpeg_param(VENC_CHN chn, AX_VENC_JPEG_PARAM_T &param);
+    AX_S32 set_jpeg_param(VENC_CHN chn, const AX_VENC_JPEG_PARAM_T &param);
+
+    AX_S32 send_frame(VENC_CHN chn, const AX_VIDEO_FRAME_T &frame, AX_S32 timeout);
+    AX_S32 get_stream(VENC_CHN chn, AX_VENC_STREAM_T &stream, AX_S32 timeout);
+    AX_S32 release_stream(VENC_CHN chn, const AX_VENC_STREAM_T &stream);
+
+    /* frame from a linked VDEC or IVPS channel, waits for space in the input fifo */
+    void recv_linked_frame(VENC_CHN chn, const AX_VIDEO_FRAME_T &frame);
+
+private:
+    struct channel {
+        VENC_CHN id;
+        AX_VENC_CHN_ATTR_T attr;
+        AX_VENC_JPEG_PARAM_T jpeg = {};
+        bool jpeg_type = false;
+        size_t in_depth = 0;
+        std::deque<AX_VIDEO_FRAME_T> in;
+        std::deque<AX_VENC_STREAM_T> out;
+        std::vector<AX_U64> held;
+        /* stream buffer slots, one per output fifo entry */
+        AX_U8 *buf = nullptr;
+        AX_U32 slot_size = 0;
+        std::vector<AX_U32> free_slots;
+        bool started = false;
+        bool stopped = false;
+        bool busy = false;
+        bool exit = false;
+        AX_U64 encoded = 0;
+        std::thread worker;
+    };
+
+    channel *find(VENC_CHN chn);
+    void encode_thread(channel *c);
+    void free_slot(channel *c, AX_U64 phy);
+
+private:
+    device *m_dev;
+    uint32_t m_max_chn;
+    uint32_t m_gop;
+    double m_i_ratio;
+    double m_p_ratio;
+    bool m_init = false;
+    std::mutex m_mtx;
+    std::condition_variable m_cv;
+    std::map<VENC_CHN, std::unique_ptr<channel>> m_chns;
+};
+
+}  // namespace axclsim
@@ -0,0 +1,53 @@
+/**************************************************************************************************
+ *
+ * Copyright (c) 2019-2024 Axera Semiconductor Co., Ltd. All Rights Reserved.
+ *
+ * This source file is the property of Axera Semiconductor Co., Ltd. and
+ * may not be copied or distributed in any isomorphic form without the prior
+ * written consent of Axera Semiconductor Co., Ltd.
+ *
+ **************************************************************************************************/
+
+#ifndef __AXCL_SIM_H__
+#define __AXCL_SIM_H__
+
+#include "axcl.h"
+
+/**
+ * libaxcl_sim: hardware-free backend of the AXCL runtime, SYS/POOL, VDEC, VENC, IVPS and runtime engine APIs.
+ * Link -laxcl_sim instead of the AXCL libraries, or LD_PRELOAD libaxcl_sim.so in front of an existing binary.
+ *
+ * Every hardware unit (VDEC, JDEC, VENC, JENC, IVPS TDP/VPP/VGP, NPU, PCIe and DMA) is modelled as N cores,
+ * a job occupies the earliest free core for: latency_us + work / rate, rates are in units per microsecond
+ * (Mpixel/s for media units, MB/s for transfers). Device CMM, VB blocks and channel numbers are limited as on a card.
+ * Pixel and tensor contents are not processed.
+ *
+ * Configuration: built-in defaults, then the file in $AXCL_SIM_CONFIG (key = value per line), then AXCL_SIM_SetConfig().
+ */
+
+#define AXCL_SIM_UNIT_NAME_MAX_LEN (16)
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+    char name[AXCL_SIM_UNIT_NAME_MAX_LEN];
+    AX_U32 cores;
+    AX_U64 jobs;
+    AX_U64 busy_us;  /* sum of the job costs */
+    AX_U64 wait_us;  /* sum of the time jobs waited for a free core */
+} axcl_sim_unit_stat;
+
+AX_S32 AXCL_SIM_LoadConfig(const AX_CHAR *path);
+AX_S32 AXCL_SIM_SetConfig(const AX_CHAR *key, const AX_CHAR *value);
+
+/* unit: vdec, jdec, venc, jenc, tdp, vpp, vgp, npu, h2d, d2h, dma */
+AX_S32 AXCL_SIM_GetUnitStat(AX_S32 device, const AX_CHAR *unit, axcl_sim_unit_stat *stat);
+AX_S32 AXCL_SIM_ResetUnitStat(AX_S32 device);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __AXCL_SIM_H__ */
@@ -0,0 +1,283 @@
+/**************************************************************************************************
+ *
+ * Copyright (c) 2019-2024 Axera Semiconductor Co., Ltd. All Rights Reserved.
+ *
+ * This source file is the property of Axera Semiconductor Co., Ltd. and
+ * may not be copied or distributed in any isomorphic form without the prior
+ * written consent of Axera Semiconductor Co., Ltd.
+ *
+ **************************************************************************************************/
+
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "axcl.h"
+#include "axclite_helper.hpp"
+#include "axclite_jdec.hpp"
+#include "axclite_jenc.hpp"
+#include "axclite_msys.hpp"
+#include "cmdline.h"
+#include "logger.h"
+
+static int32_t setup(const std::string &json, int32_t &device_id, AX_U32 max_chn);
+static void cleanup(int32_t device_id);
+
+struct thumbnail_option {
+    uint32_t width;
+    uint32_t height;
+    uint32_t thumb_width;
+    uint32_t thumb_height;
+    uint32_t qfactor;
+    uint32_t count;
+};
+
+struct bench_result {
+    double total_ms = 0;
+    uint64_t bytes = 0;
+    std::vector<double> costs;
+};
+
+static void report(uint32_t chn_num, const bench_result &result) {
+    std::vector<double> costs = result.costs;
+    if (costs.empty()) {
+        return;
+    }
+
+    std::sort(costs.begin(), costs.end());
+    const double fps = costs.size() * 1000.0 / result.total_ms;
+    SAMPLE_LOG_I("%8d | %6ld | %10.2f | %9ld | %9.3f | %9.3f | %9.3f", chn_num, costs.size(), fps, (long)(result.bytes / costs.size()),
+                 costs[costs.size() / 2], costs[costs.size() * 99 / 100], costs.back());
+}
+
+/* moves decoded pictures into the encoder until stopped, the encoder holds its own VB reference */
+static void forward_thread(int32_t device, axclite::jdec &jdec, axclite::jenc &jenc, const std::atomic<bool> &running) {
+    axclite::context_guard context_holder(device);
+
+    while (running) {
+        axclite::axclite_frame frame;
+        if (AXCL_SUCC != jdec.get_frame(frame, 100)) {
+            continue;
+        }
+
+        const AX_VIDEO_FRAME_T &picture = frame.frame.stVFrame;
+        if (axclError ret = jenc.send_frame(picture, picture.u64UserData, -1); AXCL_SUCC != ret) {
+            SAMPLE_LOG_E("jenc send picture %lld fail, ret = 0x%x", picture.u64UserData, ret);
+        }
+
+        jdec.release_frame(frame);
+    }
+}
+
+/**
+ * jdec scales every picture to the thumbnail size, jenc encodes it again; chn_num groups and channels work in parallel.
+ * up to 2 pictures per channel are in flight, latency is measured from send_stream() to get_stream().
+ */
+static int32_t bench_thumbnail(int32_t device, const std::vector<uint8_t> &jpeg, const thumbnail_option &option, uint32_t chn_num,
+                               bench_result &result) {
+    const uint32_t depth = 2 * chn_num;
+
+    axclite_jdec_attr jdec_attr = {};
+    jdec_attr.chn_num = chn_num;
+    jdec_attr.width = option.width;
+    jdec_attr.height = option.height;
+    jdec_attr.out_width = option.thumb_width;
+    jdec_attr.out_height = option.thumb_height;
+    jdec_attr.blk_cnt = 3;
+    jdec_attr.fifo_depth = depth;
+
+    axclite_jenc_attr jenc_attr = {};
+    jenc_attr.chn_num = chn_num;
+    jenc_attr.width = option.thumb_width;
+    jenc_attr.height = option.thumb_height;
+    jenc_attr.qfactor = option.qfactor;
+    jenc_attr.in_fifo_depth = 2;
+    jenc_attr.out_fifo_depth = 2;
+    jenc_attr.fifo_depth = depth;
+
+    axclite::jdec jdec;
+    axclite::jenc jenc;
+    if (axclError ret = jdec.init(jdec_attr); AXCL_SUCC != ret) {
+        return ret;
+    }
+
+    if (axclError ret = jenc.init(jenc_attr); AXCL_SUCC != ret) {
+        jdec.deinit();
+        return ret;
+    }
+
+    if (axclError ret = jdec.start(device); AXCL_SUCC != ret) {
+        jenc.deinit();
+        jdec.deinit();
+        return ret;
+    }
+
+    if (axclError ret = jenc.start(device); AXCL_SUCC != ret) {
+        jdec.stop();
+        jenc.deinit();
+        jdec.deinit();
+        return ret;
+    }
+
+    std::atomic<bool> running = {true};
+    std::thread forwarder(forward_thread, device, std::ref(jdec), std::ref(jenc), std::cref(running));
+
+    std::vector<std::chrono::steady_clock::time_point> sends(option.count);
+    uint32_t sent = 0;
+    uint32_t received = 0;
+    int32_t ret = 0;
+
+    auto begin = std::chrono::steady_clock::now();
+    while (received < option.count) {
+        while (sent < option.count && sent - received < depth) {
+            sends[sent] = std::chrono::steady_clock::now();
+            if (AXCL_SUCC != jdec.send_stream(jpeg.data(), jpeg.size(), sent, 0)) {
+                break;
+            }
+
+            ++sent;
+        }
+
+        axclite_jpeg_stream stream;
+        if (AXCL_SUCC != jenc.get_stream(stream, 1000)) {
+            SAMPLE_LOG_E("get thumbnail timeout, sent %d received %d", sent, received);
+            ret = -1;
+            break;
+        }
+
+        result.costs.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - sends[stream.userdata]).count());
+        result.bytes += stream.len;
+        jenc.release_stream(stream);
+        ++received;
+    }
+
+    result.total_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+
+    running = false;
+    forwarder.join();
+
+    jenc.stop();
+    jdec.stop();
+    jenc.deinit();
+    jdec.deinit();
+    return ret;
+}
+
+int main(int argc, char *argv[]) {
+    SAMPLE_LOG_I("============== %s sample started %s %s ==============\n", AXCL_BUILD_VERSION, __DATE__, __TIME__);
+
+    cmdline::parser a;
+    a.add<int32_t>("device", 'd', "device id", false, 0);
+    a.add<std::string>("json", '\0', "axcl.json path", false, "./axcl.json");
+    a.add<std::string>("input", 'i', "jpeg file", true, "");
+    a.add<uint32_t>("width", 'w', "max. jpeg width", false, 3840);
+    a.add<uint32_t>("height", 'h', "max. jpeg height", false, 2160);
+    a.add<uint32_t>("thumb_width", '\0', "thumbnail width", false, 320);
+    a.add<uint32_t>("thumb_height", '\0', "thumbnail height", false, 180);
+    a.add<uint32_t>("qfactor", 'q', "thumbnail qfactor [1, 99]", false, 75);
+    a.add<uint32_t>("chn", 'c', "max. jdec groups and jenc channels, 1, 2, 4 ... up to it are measured", false, 4,
+                    cmdline::range(1, AXCL_LITE_JPEG_MAX_CHN_NUM));
+    a.add<uint32_t>("count", 'n', "pictures of each run", false, 500);
+    a.parse_check(argc, argv);
+    int32_t device_id = a.get<int32_t>("device");
+    const std::string json = a.get<std::string>("json");
+    const std::string input = a.get<std::string>("input");
+    const uint32_t max_chn = a.get<uint32_t>("chn");
+    thumbnail_option option;
+    option.width = a.get<uint32_t>("width");
+    option.height = a.get<uint32_t>("height");
+    option.thumb_width = a.get<uint32_t>("thumb_width");
+    option.thumb_height = a.get<uint32_t>("thumb_height");
+    option.qfactor = a.get<uint32_t>("qfactor");
+    option.count = a.get<uint32_t>("count");
+    if (0 == option.count) {
+        SAMPLE_LOG_E("invalid count %d", option.count);
+        return 1;
+    }
+
+    std::ifstream fs(input, std::ios::binary);
+    if (!fs) {
+        SAMPLE_LOG_E("open %s fail", input.c_str());
+        return 1;
+    }
+
+    std::vector<uint8_t> jpeg((std::istreambuf_iterator<char>(fs)), std::istreambuf_iterator<char>());
+    if (jpeg.empty()) {
+        SAMPLE_LOG_E("%s is empty", input.c_str());
+        return 1;
+    }
+
+    if (AXCL_SUCC != setup(json, device_id, max_chn)) {
+        return 1;
+    }
+
+    SAMPLE_LOG_I("jpeg %s of %ld bytes, %dx%d -> thumbnail %dx%d qfactor %d, %d pictures per run", input.c_str(), jpeg.size(), option.width,
+                 option.height, option.thumb_width, option.thumb_height, option.qfactor, option.count);
+    SAMPLE_LOG_I("%8s | %6s | %10s | %9s | %9s | %9s | %9s", "channels", "pics", "pics/s", "bytes/pic", "p50 ms", "p99 ms", "max ms");
+    for (uint32_t chn_num = 1; chn_num <= max_chn; chn_num *= 2) {
+        bench_result result;
+        if (0 != bench_thumbnail(device_id, jpeg, option, chn_num, result)) {
+            break;
+        }
+
+        report(chn_num, result);
+    }
+
+    cleanup(device_id);
+
+    SAMPLE_LOG_I("============== %s sample exited %s %s ==============\n", AXCL_BUILD_VERSION, __DATE__, __TIME__);
+    return 0;
+}
+
+static int32_t setup(const std::string &json, int32_t &device_id, AX_U32 max_chn) {
+    axclError ret;
+    SAMPLE_LOG_I("json: %s", json.c_str());
+    if (ret = axclInit(json.c_str()); AXCL_SUCC != ret) {
+        SAMPLE_LOG_E("axclInit(%s) fail, ret = 0x%x", json.c_str(), ret);
+        return ret;
+    }
+
+    if (device_id <= 0) {
+        axclrtDeviceList lst;
+        if (axclError ret = axclrtGetDeviceList(&lst); AXCL_SUCC != ret || 0 == lst.num) {
+            SAMPLE_LOG_E("no device is connected");
+            axclFinalize();
+            return ret;
+        }
+
+        device_id = lst.devices[0];
+        SAMPLE_LOG_I("device id: %d", device_id);
+    }
+
+    if (ret = axclrtSetDevice(device_id); AXCL_SUCC != ret) {
+        SAMPLE_LOG_E("axclrtSetDevice(%d) fail, ret = 0x%x", device_id, ret);
+        axclFinalize();
+        return ret;
+    }
+
+    axclite_msys_attr attr = {};
+    attr.modules = AXCL_LITE_JDEC | AXCL_LITE_JENC;
+    attr.max_vdec_grp = max_chn;
+    attr.max_venc_thd = max_chn;
+    if (ret = MSYS()->init(attr); AXCL_SUCC != ret) {
+        SAMPLE_LOG_E("init jdec and jenc modules fail, ret = 0x%x", ret);
+        axclrtResetDevice(device_id);
+        axclFinalize();
+        return ret;
+    }
+
+    return ret;
+}
+
+static void cleanup(int32_t device_id) {
+    MSYS()->deinit();
+    axclrtResetDevice(device_id);
+    axclFinalize();
+    SAMPLE_LOG_I("deactive device %d and cleanup axcl", device_id);
+}
@@ -0,0 +1,46 @@
+/**************************************************************************************************
+ *
+ * Copyright (c) 2019-2024 Axera Semiconductor Co., Ltd. All Rights Reserved.
+ *
+ * This source file is the property of Axera Semiconductor Co., Ltd. and
+ * may not be copied or distributed in any isomorphic form without the prior
+ * written consent of Axera Semiconductor Co., Ltd.
+ *
+ **************************************************************************************************/
+
+#pragma once
+
+#include <cstdint>
+
+struct bench_option {
+    uint32_t count;       /* items (tasks, copies ...) per run */
+    uint32_t depth;       /* queue capacity */
+    uint32_t max_threads; /* threads of the matrix go 1, 2, 4 ... up to max_threads, also workers of a pool */
+};
+
+/* lock_queue, CAXLockQ and mpmc_queue for 1..max_threads producers x 1..max_threads consumers */
+int32_t bench_queue(const bench_option &option);
+
+/* thread_pool vs ws_thread_pool: flat batch throughput, nested fan-out and high lane latency under load */
+int32_t bench_pool(const bench_option &option);
+
+/* libc memcpy/memset vs axcl::mem_helper for 1KB .. 32MB, and a strided NV12 frame copy */
+int32_t bench_memory(const bench_option &option);
+
+/* dma_buffer alloc/free vs dma_buffer_pool latency percentiles, then threads sharing the pool */
+int32_t bench_dma(const bench_option &option);
+
+/* LOG_MM_x per call cost: legacy vs level checked vs deferred vs compiled out, with the level disabled and enabled */
+int32_t bench_log(const bench_option &option);
+
+/* metric_counter / metric_histogram updates vs a shared std::atomic for 1..max_threads threads, then a scrape over HTTP */
+int32_t bench_metrics(const bench_option &option);
+
+/* latency_histogram percentiles vs exact ones, latency_recorder merge / interval, and the cost of a record for 1..max_threads threads */
+int32_t bench_latency(const bench_option &option);
+
+/* ringbuf_broadcast with outputs keeping up, skipping and disconnected, then publish cost vs a ringbuf_nowarp copy per output */
+int32_t bench_ringbuf(const bench_option &option);
+
+/* event_loop checks, lateness of periodic jobs on sleeping threads vs the timer wheel, and cross-thread post latency */
+int32_t bench_loop(const bench_option &option);
@@ -0,0 +1,215 @@
+/**************************************************************************************************
+ *
+ * Copyright (c) 2019-2024 Axera Semiconductor Co., Ltd. All Rights Reserved.
+ *
+ * This source file is the property of Axera Semiconductor Co., Ltd. and
+ * may not be copied or distributed in any isomorphic form without the prior
+ * written consent of Axera Semiconductor Co., Ltd.
+ *
+ **************************************************************************************************/
+
+#include <string.h>
+#include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include "bench.hpp"
+#include "dma_buffer.hpp"
+#include "dma_buffer_pool.hpp"
+#include "fake_mmb_device.hpp"
+#include "logger.h"
+
+using bench_clock = std::chrono::steady_clock;
+
+/* 1080p NV12, a typical per frame buffer */
+static constexpr uint32_t FRAME_SIZE = 1920 * 1080 * 3 / 2;
+
+struct percentile {
+    double p50, p99, max;
+};
+
+static percentile summarize(std::vector<double> &us) {
+    std::sort(us.begin(), us.end());
+    return {us[us.size() / 2], us[us.size() * 99 / 100], us.back()};
+}
+
+static double since_us(const bench_clock::time_point &begin) {
+    return std::chrono::duration<double, std::micro>(bench_clock::now() - begin).count();
+}
+
+/* open + ioctl + mmap per alloc, munmap + close per free */
+static int32_t bench_dma_buffer(uint32_t count, std::vector<double> &alloc_us, std::vector<double> &free_us) {
+    for (uint32_t i = 0; i < count; ++i) {
+        dma_buffer buf;
+        auto begin = bench_clock::now();
+        if (!buf.alloc(FRAME_SIZE)) {
+            SAMPLE_LOG_E("dma_buffer alloc %u bytes fail", FRAME_SIZE);
+            return -1;
+        }
+        alloc_us.push_back(since_us(begin));
+
+        begin = bench_clock::now();
+        buf.free();
+        free_us.push_back(since_us(begin));
+    }
+
+    return 0;
+}
+
+static int32_t bench_dma_pool(dma_buffer_pool &pool, uint32_t count, std::vector<double> &alloc_us, std::vector<double> &free_us) {
+    for (uint32_t i = 0; i < count; ++i) {
+        dma_slab slab;
+        auto begin = bench_clock::now();
+        if (!pool.alloc(FRAME_SIZE, slab)) {
+            SAMPLE_LOG_E("dma_buffer_pool alloc %u bytes fail", FRAME_SIZE);
+            return -1;
+        }
+        alloc_us.push_back(since_us(begin));
+
+        begin = bench_clock::now();
+        pool.free(slab);
+        free_us.push_back(since_us(begin));
+    }
+
+    return 0;
+}
+
+/* threads alloc and free slabs of all classes, a slab handed out twice is caught by its owner mark */
+static int32_t stress_dma_pool(dma_buffer_pool &pool, uint32_t threads, uint32_t rounds) {
+    std::atomic<uint32_t> errors{0};
+    std::vector<std::thread> workers;
+    for (uint32_t t = 0; t < threads; ++t) {
+        workers.emplace_back([&pool, &errors, t, rounds]() {
+            static constexpr size_t SIZES[] = {4096, 64 * 1024, FRAME_SIZE};
+            for (uint32_t i = 0; i < rounds; ++i) {
+                dma_slab slab;
+                if (!pool.alloc(SIZES[(t + i) % 3], slab)) {
+                    std::this_thread::yield();
+                    continue;
+                }
+
+                volatile uint32_t *mark = static_cast<volatile uint32_t *>(slab.vir);
+                *mark = t + 1;
+                std::this_thread::yield();
+                if (*mark != t + 1) {
+                    errors.fetch_add(1);
+                }
+                pool.free(slab);
+            }
+        });
+    }
+    for (auto &w : workers) {
+        w.join();
+    }
+
+    return (0 == errors.load()) ? 0 : -1;
+}
+
+/* a 4K NV12 ring of 8 frames as one scattered buffer, more blocks than one scatter list allocation returns */
+static int32_t check_scatter(const fake_mmb_device *fake) {
+    constexpr size_t RING_SIZE = 3840 * 2160 * 3 / 2 * 8;
+    constexpr uintptr_t HUGE_PAGE = 2 * 1024 * 1024;
+
+    dma_buffer ring;
+    if (!ring.alloc(RING_SIZE, true, true, true)) {
+        SAMPLE_LOG_E("alloc scattered ring of %zu bytes fail", RING_SIZE);
+        return -1;
+    }
+
+    const struct dma_mem &mem = ring.get();
+    uint64_t sum = 0;
+    uint8_t *vir = static_cast<uint8_t *>(mem.blks[0].vir);
+    for (uint32_t i = 0; i < mem.blk_cnt; ++i) {
+        if (mem.blks[i].vir != vir) {
+            SAMPLE_LOG_E("block %u is not virtually contiguous", i);
+            return -1;
+        }
+        if (i > 0 && mem.blks[i - 1].phy + mem.blks[i - 1].size == mem.blks[i].phy) {
+            SAMPLE_LOG_E("block %u is physically adjacent to the previous one but not merged", i);
+            return -1;
+        }
+        vir += mem.blks[i].size;
+        sum += mem.blks[i].size;
+    }
+
+    if (sum != RING_SIZE || mem.blk_cnt != mem.blks.size()) {
+        SAMPLE_LOG_E("blocks sum up to %lu bytes of %zu", (unsigned long)sum, RING_SIZE);
+        return -1;
+    }
+
+    if (0 != reinterpret_cast<uintptr_t>(mem.blks[0].vir) % HUGE_PAGE) {
+        SAMPLE_LOG_E("hugepage buffer at %p is not 2MB aligned", mem.blks[0].vir);
+        return -1;
+    }
+
+    /* the whole ring is mapped and writable, flush of all goes to every allocation */
+    memset(mem.blks[0].vir, 0x5A, RING_SIZE);
+    const uint64_t flushes = fake ? fake->flushes() : 0;
+    if (!ring.flush(mem.blks[0].phy, mem.blks[0].vir, RING_SIZE)) {
+        return -1;
+    }
+
+    if (fake) {
+        /* fake blocks are 1MB in runs of 4, a scatter list allocation returns up to 64 of them */
+        const uint64_t blocks = (RING_SIZE + (1 << 20) - 1) >> 20;
+        SAMPLE_LOG_I("scattered 4K NV12 x 8 ring of %zu bytes: %lu sg blocks on %lu allocations, %u blocks after coalescing, a flush takes %lu ioctls",
+                     RING_SIZE, (unsigned long)blocks, (unsigned long)((blocks + 63) / 64), mem.blk_cnt, (unsigned long)(fake->flushes() - flushes));
+    } else {
+        SAMPLE_LOG_I("scattered 4K NV12 x 8 ring of %zu bytes: %u blocks after coalescing", RING_SIZE, mem.blk_cnt);
+    }
+
+    return 0;
+}
+
+int32_t bench_dma(const bench_option &option) {
+    const uint32_t count = std::min<uint32_t>(option.count, 10000);
+
+    std::shared_ptr<fake_mmb_device> fake;
+    if (0 != access(AX_MM_DEV, F_OK)) {
+        SAMPLE_LOG_W("no %s, run on a fake mmb device: the numbers are memfd, not CMA", AX_MM_DEV);
+        fake = std::make_shared<fake_mmb_device>();
+        dma_buffer::set_device(fake);
+    }
+
+    if (0 != check_scatter(fake.get())) {
+        return -1;
+    }
+
+    SAMPLE_LOG_I("%u x alloc + free of %u bytes, dma_buffer vs dma_buffer_pool", count, FRAME_SIZE);
+
+    std::vector<double> buffer_alloc, buffer_free;
+    if (0 != bench_dma_buffer(count, buffer_alloc, buffer_free)) {
+        return -1;
+    }
+
+    dma_buffer_pool pool;
+    /* fewer slabs than threads, so that the stress below also runs classes empty */
+    constexpr uint32_t SLABS = 4;
+    if (!pool.init({{4096, SLABS}, {64 * 1024, SLABS}, {FRAME_SIZE, SLABS}})) {
+        SAMPLE_LOG_E("init dma_buffer_pool fail");
+        return -1;
+    }
+
+    std::vector<double> pool_alloc, pool_free;
+    if (0 != bench_dma_pool(pool, count, pool_alloc, pool_free)) {
+        return -1;
+    }
+
+    const percentile a0 = summarize(buffer_alloc);
+    const percentile f0 = summarize(buffer_free);
+    const percentile a1 = summarize(pool_alloc);
+    const percentile f1 = summarize(pool_free);
+    SAMPLE_LOG_I("%16s | %28s | %28s", "us", "alloc p50 / p99 / max", "free p50 / p99 / max");
+    SAMPLE_LOG_I("%16s | %8.2f / %8.2f / %8.2f | %8.2f / %8.2f / %8.2f", "dma_buffer", a0.p50, a0.p99, a0.max, f0.p50, f0.p99, f0.max);
+    SAMPLE_LOG_I("%16s | %8.2f / %8.2f / %8.2f | %8.2f / %8.2f / %8.2f", "dma_buffer_pool", a1.p50, a1.p99, a1.max, f1.p50, f1.p99, f1.max);
+
+    if (0 != stress_dma_pool(pool, option.max_threads, count)) {
+        SAMPLE_LOG_E("%u threads share dma_buffer_pool: a slab is handed out twice", option.max_threads);
+        return -1;
+    }
+
+    SAMPLE_LOG_I("%u threads x %u alloc + free on 3 size classes: ok", option.max_threads, count);
+    return 0;
+}
@@ -0,0 +1,178 @@
+/**************************************************************************************************
+ *
+ * Copyright (c) 2019-2024 Axera Semiconductor Co., Ltd. All Rights Reserved.
+ *
+ * This source file is the property of Axera Semiconductor Co., Ltd. and
+ * may not be copied or distributed in any isomorphic form without the prior
+ * written consent of Axera Semiconductor Co., Ltd.
+ *
+ **************************************************************************************************/
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <random>
+#include <thread>
+#include <vector>
+#include "bench.hpp"
+#include "elapser.hpp"
+#include "logger.h"
+
+/* log-uniform latencies from 100ns to 100ms, with the long tail a frame path has */
+static std::vector<uint64_t> make_latencies(uint32_t count) {
+    std::mt19937_64 rng(20241019);
+    std::uniform_real_distribution<double> exponent(2.0, 8.0);
+
+    std::vector<uint64_t> values(count);
+    for (auto &v : values) {
+        v = static_cast<uint64_t>(std::pow(10.0, exponent(rng)));
+    }
+    return values;
+}
+
+/* exact percentile of sorted values with the same rank as latency_histogram::percentile() */
+static uint64_t exact_percentile(const std::vector<uint64_t> &sorted, double percent) {
+    const double exact = percent / 100.0 * sorted.size();
+    uint64_t rank = static_cast<uint64_t>(exact);
+    rank += (rank < exact || 0 == rank) ? 1 : 0;
+    return sorted[rank - 1];
+}
+
+static bool same(const axcl::latency_histogram &a, const axcl::latency_histogram &b) {
+    for (double p : {1.0, 50.0, 90.0, 99.0, 99.9, 100.0}) {
+        if (a.percentile(p) != b.percentile(p)) {
+            return false;
+        }
+    }
+    return a.count() == b.count() && a.mean() == b.mean() && a.min() == b.min() && a.max() == b.max();
+}
+
+template <typename F>
+static double per_record_ns(uint32_t threads, uint32_t count, F &&f) {
+    std::vector<std::thread> workers;
+    const auto begin = std::chrono::steady_clock::now();
+    for (uint32_t t = 0; t < threads; ++t) {
+        workers.emplace_back([&f, count, t]() {
+            for (uint32_t i = 0; i < count; ++i) {
+                f(t, i);
+            }
+        });
+    }
+    for (auto &w : workers) {
+        w.join();
+    }
+
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - begin).count() / count;
+}
+
+int32_t bench_latency(const bench_option &option) {
+    const uint32_t count = std::min<uint32_t>(option.count, 1000000);
+    const std::vector<uint64_t> values = make_latencies(count);
+
+    /* accuracy against the exact percentiles */
+    axcl::latency_histogram histogram;
+    for (uint64_t v : values) {
+        histogram.record(v);
+    }
+
+    std::vector<uint64_t> sorted = values;
+    std::sort(sorted.begin(), sorted.end());
+
+    SAMPLE_LOG_I("%u latencies of 100ns .. 100ms, percentiles in ns", count);
+    SAMPLE_LOG_I("%8s | %12s | %12s | %10s", "", "exact", "histogram", "error");
+    for (double p : {50.0, 90.0, 99.0, 99.9, 100.0}) {
+        const uint64_t exact = exact_percentile(sorted, p);
+        const uint64_t approx = histogram.percentile(p);
+        const double error = (static_cast<double>(approx) - exact) / exact;
+        SAMPLE_LOG_I("%8.1f | %12lu | %12lu | %9.3f%%", p, (unsigned long)exact, (unsigned long)approx, error * 100);
+        if (std::fabs(error) > 1.0 / (1 << axcl::latency_histogram::PRECISION)) {
+            SAMPLE_LOG_E("p%.1f is off by more than 1/%u", p, 1u << axcl::latency_histogram::PRECISION);
+            return -1;
+        }
+    }
+
+    /* threads record into one recorder, the snapshot is the merge of what each recorded */
+    const uint32_t threads = option.max_threads;
+    axcl::latency_recorder recorder;
+    std::vector<axcl::latency_histogram> parts(threads);
+    (void)per_record_ns(threads, count / threads, [&](uint32_t t, uint32_t i) {
+        const uint64_t v = values[t * (count / threads) + i];
+        recorder.record(v);
+        parts[t].record(v);
+    });
+
+    axcl::latency_histogram merged, snapshot;
+    for (const auto &part : parts) {
+        merged.merge(part);
+    }
+    recorder.snapshot(snapshot);
+    if (!same(merged, snapshot)) {
+        SAMPLE_LOG_E("snapshot of %u threads differs from the merge of their histograms", threads);
+        return -1;
+    }
+
+    /* interval: the first one is all so far, the next one only what came after */
+    axcl::latency_histogram first, second;
+    recorder.interval(first);
+    recorder.record(1000);
+    recorder.record(2000);
+    recorder.interval(second);
+    if (first.count() != merged.count() || 2 != second.count() || second.percentile(50) / 1000 != 1 || second.max() / 1000 != 2) {
+        SAMPLE_LOG_E("interval counts %lu and %lu, expect %lu and 2", (unsigned long)first.count(), (unsigned long)second.count(),
+                     (unsigned long)merged.count());
+        return -1;
+    }
+
+    merged.reset();
+    if (0 != merged.count() || 0 != merged.percentile(99) || 0 != merged.max()) {
+        SAMPLE_LOG_E("histogram is not empty after reset");
+        return -1;
+    }
+
+    SAMPLE_LOG_I("%u threads: snapshot == merge, interval and reset: ok", threads);
+
+    /* cost of a record */
+    SAMPLE_LOG_I("%u records per thread, ns per record of all threads together", count);
+    SAMPLE_LOG_I("%8s | %18s | %18s | %22s", "threads", "latency_histogram", "latency_recorder", "scoped_elapser");
+    for (uint32_t n = 1; n <= option.max_threads; n *= 2) {
+        std::vector<axcl::latency_histogram> locals(n);
+        const double histogram_ns = per_record_ns(n, count, [&](uint32_t t, uint32_t i) { locals[t].record(values[i]); });
+
+        axcl::latency_recorder shared;
+        const double recorder_ns = per_record_ns(n, count, [&](uint32_t, uint32_t i) { shared.record(values[i]); });
+
+        axcl::latency_recorder timed;
+        const double elapser_ns = per_record_ns(n, count, [&](uint32_t, uint32_t) { axcl::scoped_elapser timer(timed); });
+
+        axcl::latency_histogram check;
+        shared.snapshot(check);
+        if (check.count() != static_cast<uint64_t>(n) * count) {
+            SAMPLE_LOG_E("%u threads: recorded %lu of %lu", n, (unsigned long)check.count(), (unsigned long)n * count);
+            return -1;
+        }
+
+        SAMPLE_LOG_I("%8u | %18.2f | %18.2f | %22.2f", n, histogram_ns, recorder_ns, elapser_ns);
+    }
+
+    /* streams come and go, each with a recorder this thread records into: the cost of a record must not grow with them */
+    constexpr uint32_t STREAMS = 10000;
+    double ns[2] = {0, 0};
+    for (uint32_t round = 0; round < 2; ++round) {
+        if (1 == round) {
+            for (uint32_t i = 0; i < STREAMS; ++i) {
+                axcl::latency_recorder stream;
+                stream.record(values[i % count]);
+            }
+        }
+
+        axcl::latency_recorder live;
+        const auto begin = std::chrono::steady_clock::now();
+        for (uint32_t i = 0; i < count; ++i) {
+            live.record(values[i]);
+        }
+        ns[round] = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - begin).count() / count;
+    }
+
+    SAMPLE_LOG_I("record after %u recorders came and went on the thread: %.2f ns, before %.2f ns", STREAMS, ns[1], ns[0]);
+    return 0;
+}
@@ -0,0 +1,109 @@
+/**************************************************************************************************
+ *
+ * Copyright (c) 2019-2024 Axera Semiconductor Co., Ltd. All Rights Reserved.
+ *
+ * This source file is the property of Axera Semiconductor Co., Ltd. and
+ * may not be copied or distributed in any isomorphic form without the prior
+ * written consent of Axera Semiconductor Co., Ltd.
+ *
+ **************************************************************************************************/
+
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include "bench.hpp"
+#include "log/logger.hpp"
+#include "logger.h"
+
+#define TAG "bench"
+
+/* LOG_MM_I as it was: default arguments of get_instance() per call, arguments evaluated before the level check */
+#define LEGACY_LOG_MM_I(tag, fmt, ...) \
+    axcl::logger::get_instance()->log(spdlog::level::info, "[{}][{}][{}]: " fmt, tag, __func__, __LINE__, ##__VA_ARGS__)
+
+/* stands for an argument which costs something to evaluate, counts how often it really is */
+static uint64_t evaluated = 0;
+static __attribute__((noinline)) uint64_t probe(uint64_t v) {
+    ++evaluated;
+    return v;
+}
+
+/* a frame log of the dispatchers: 9 integers */
+struct frame_info {
+    int32_t grp, chn;
+    uint64_t seq, pts, phy;
+    uint32_t width, height, stride, blk;
+};
+
+template <typename F>
+static double per_call_ns(uint32_t count, F &&f) {
+    evaluated = 0;
+    const auto begin = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < count; ++i) {
+        f(i);
+    }
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - begin).count() / count;
+}
+
+static void legacy_log(const frame_info &f, uint32_t i) {
+    LEGACY_LOG_MM_I(TAG, "decoded vdGrp {} vdChn {} frame {} pts {} phy {:#x} {}x{} stride {} blkId {:#x}", f.grp, f.chn, probe(f.seq + i),
+                    f.pts, f.phy, f.width, f.height, f.stride, f.blk);
+}
+
+static void runtime_log(const frame_info &f, uint32_t i) {
+    LOG_MM_I(TAG, "decoded vdGrp {} vdChn {} frame {} pts {} phy {:#x} {}x{} stride {} blkId {:#x}", f.grp, f.chn, probe(f.seq + i), f.pts,
+             f.phy, f.width, f.height, f.stride, f.blk);
+}
+
+static void deferred_log(const frame_info &f, uint32_t i) {
+    LOG_MM_DEFER_I(TAG, "decoded vdGrp {} vdChn {} frame {} pts {} phy {:#x} {}x{} stride {} blkId {:#x}", f.grp, f.chn, probe(f.seq + i),
+                   f.pts, f.phy, f.width, f.height, f.stride, f.blk);
+}
+
+/* as built with -DAXCL_LOG_ACTIVE_LEVEL=3: info is compiled out */
+#pragma push_macro("AXCL_LOG_ACTIVE_LEVEL")
+#undef AXCL_LOG_ACTIVE_LEVEL
+#define AXCL_LOG_ACTIVE_LEVEL 3
+static void stripped_log(const frame_info &f, uint32_t i) {
+    LOG_MM_I(TAG, "decoded vdGrp {} vdChn {} frame {} pts {} phy {:#x} {}x{} stride {} blkId {:#x}", f.grp, f.chn, probe(f.seq + i), f.pts,
+             f.phy, f.width, f.height, f.stride, f.blk);
+}
+#pragma pop_macro("AXCL_LOG_ACTIVE_LEVEL")
+
+int32_t bench_log(const bench_option &option) {
+    const uint32_t count = std::min<uint32_t>(option.count, 200000);
+    const frame_info f = {0, 1, 1000, 33000, 0x1c0000000, 1920, 1080, 1920, 0x8800001};
+    spdlog::logger *logger = AXCL_LOGGER;
+
+    SAMPLE_LOG_I("%u x LOG_MM_I of a decoded frame (9 integers), ns per call, evaluations of an argument", count);
+    SAMPLE_LOG_I("%26s | %14s | %14s", "", "info disabled", "info enabled");
+
+    struct variant {
+        const char *name;
+        void (*log)(const frame_info &, uint32_t);
+    } variants[] = {
+        {"legacy LOG_MM_I", legacy_log},
+        {"LOG_MM_I", runtime_log},
+        {"LOG_MM_DEFER_I", deferred_log},
+        {"LOG_MM_I, active level 3", stripped_log},
+    };
+
+    for (const auto &v : variants) {
+        logger->set_level(spdlog::level::warn);
+        const double off_ns = per_call_ns(count, [&](uint32_t i) { v.log(f, i); });
+        const uint64_t off_evaluated = evaluated;
+
+        logger->set_level(spdlog::level::info);
+        const double on_ns = per_call_ns(count, [&](uint32_t i) { v.log(f, i); });
+        const uint64_t on_evaluated = evaluated;
+
+        /* let the logger threads catch up, so that the next variant is not timed against their backlog */
+        logger->flush();
+        std::this_thread::sleep_for(std::chrono::milliseconds(200));
+
+        SAMPLE_LOG_I("%26s | %6.1f %7lu | %6.1f %7lu", v.name, off_ns, (unsigned long)off_evaluated, on_ns, (unsigned long)on_evaluated);
+    }
+
+    logger->set_level(spdlog::level::debug);
+    return 0;
+}
@@ -0,0 +1,195 @@
+/**************************************************************************************************
+ *
+ * Copyright (c) 2019-2024 Axera Semiconductor Co., Ltd. All Rights Reserved.
+ *
+ * This source file is the property of Axera Semiconductor Co., Ltd. and
+ * may not be copied or distributed in any isomorphic form without the prior
+ * written consent of Axera Semiconductor Co., Ltd.
+ *
+ **************************************************************************************************/
+
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+#include "bench.hpp"
+#include "elapser.hpp"
+#include "event_loop.hpp"
+#include "logger.h"
+
+static constexpr uint32_t PERIOD_MS = 10;
+static constexpr uint32_t RUNS = 100;
+
+static uint64_t now_us() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static void report(const char *name, const axcl::latency_histogram &h) {
+    SAMPLE_LOG_I("%28s | %8lu | %8lu | %8lu | %8lu", name, (unsigned long)h.count(), (unsigned long)h.percentile(50),
+                 (unsigned long)h.percentile(99), (unsigned long)h.max());
+}
+
+/* one-shot, periodic, cancel from a callback and from another thread, fds, post order */
+static int32_t check_loop(axcl::event_loop &loop) {
+    /* a one-shot timer runs once, not before its delay */
+    std::atomic<uint32_t> once = {0};
+    const uint64_t begin = axcl::event_loop::now_ms();
+    std::atomic<uint64_t> at = {0};
+    loop.add_timer(30, 0, [&]() {
+        at = axcl::event_loop::now_ms();
+        ++once;
+    });
+
+    /* a periodic timer that cancels itself on the 5th run */
+    std::atomic<uint32_t> periodic = {0};
+    std::shared_ptr<uint64_t> self = std::make_shared<uint64_t>(0);
+    *self = loop.add_timer(5, 5, [&loop, &periodic, self]() {
+        if (5 == ++periodic) {
+            loop.cancel_timer(*self);
+        }
+    });
+
+    /* cancelled from this thread before it is due, it never runs */
+    std::atomic<uint32_t> cancelled = {0};
+    const uint64_t id = loop.add_timer(20, 0, [&]() { ++cancelled; });
+    loop.cancel_timer(id);
+
+    /* an eventfd written from this thread, read on the loop */
+    const int32_t efd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    std::atomic<uint64_t> received = {0};
+    loop.add_fd(efd, EPOLLIN, [&](uint32_t) {
+        uint64_t v;
+        if (sizeof(v) == read(efd, &v, sizeof(v))) {
+            received += v;
+        }
+    });
+    for (uint64_t v = 1; v <= 10; ++v) {
+        (void)!write(efd, &v, sizeof(v));
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    /* tasks run in the order posted */
+    std::vector<uint32_t> order;
+    for (uint32_t i = 0; i < 100; ++i) {
+        loop.post([&order, i]() { order.push_back(i); });
+    }
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    loop.remove_fd(efd);
+    close(efd);
+
+    bool ordered = (100 == order.size());
+    loop.invoke([&]() {
+        for (uint32_t i = 0; ordered && i < order.size(); ++i) {
+            ordered = (order[i] == i);
+        }
+    });
+
+    if (1 != once || at < begin + 30 || 5 != periodic || 0 != cancelled || 55 != received || !ordered) {
+        SAMPLE_LOG_E("one-shot %u at +%lu ms, periodic %u of 5, cancelled %u, received %lu of 55, ordered %d", once.load(),
+                     (unsigned long)(at - begin), periodic.load(), cancelled.load(), (unsigned long)received.load(), ordered);
+        return -1;
+    }
+
+    SAMPLE_LOG_I("one-shot, periodic, cancel, eventfd and post order: ok");
+    return 0;
+}
+
+int32_t bench_loop(const bench_option &option) {
+    axcl::event_loop loop;
+    if (!loop.start("bench_loop")) {
+        SAMPLE_LOG_E("start event loop fail");
+        return -1;
+    }
+
+    if (0 != check_loop(loop)) {
+        return -1;
+    }
+
+    /* n periodic jobs of 10ms for 1s: a sleeping thread each vs timers of one loop, lateness of every run */
+    const uint32_t n = std::max<uint32_t>(option.max_threads, 1);
+    SAMPLE_LOG_I("%u periodic jobs of %u ms x %u runs, lateness to the schedule in us", n, PERIOD_MS, RUNS);
+    SAMPLE_LOG_I("%28s | %8s | %8s | %8s | %8s", "", "runs", "p50", "p99", "max");
+
+    /* sleep_for as the dispatch threads do, it drifts by the time of every wakeup; sleep_until does not */
+    for (bool until : {false, true}) {
+        std::vector<axcl::latency_histogram> lates(n);
+        std::vector<std::thread> sleepers;
+        for (uint32_t i = 0; i < n; ++i) {
+            sleepers.emplace_back([&lates, i, until]() {
+                const auto begin = std::chrono::steady_clock::now();
+                const uint64_t start = now_us();
+                for (uint32_t r = 1; r <= RUNS; ++r) {
+                    if (until) {
+                        std::this_thread::sleep_until(begin + std::chrono::milliseconds(r * PERIOD_MS));
+                    } else {
+                        std::this_thread::sleep_for(std::chrono::milliseconds(PERIOD_MS));
+                    }
+                    const uint64_t due = start + r * PERIOD_MS * 1000;
+                    const uint64_t now = now_us();
+                    lates[i].record(now > due ? now - due : 0);
+                }
+            });
+        }
+        for (auto &t : sleepers) {
+            t.join();
+        }
+
+        axcl::latency_histogram sleeper_late;
+        for (const auto &h : lates) {
+            sleeper_late.merge(h);
+        }
+        report(until ? "sleep_until thread per job" : "sleep_for thread per job", sleeper_late);
+    }
+
+    axcl::latency_histogram timer_late;
+    std::atomic<uint32_t> runs = {0};
+    std::vector<uint64_t> ids(n);
+    for (uint32_t i = 0; i < n; ++i) {
+        const uint64_t start = now_us();
+        auto count = std::make_shared<uint32_t>(0);
+        ids[i] = loop.add_timer(PERIOD_MS, PERIOD_MS, [&timer_late, &runs, start, count]() {
+            if (*count < RUNS) {
+                const uint64_t due = start + (++*count) * PERIOD_MS * 1000;
+                const uint64_t now = now_us();
+                timer_late.record(now > due ? now - due : 0);
+                ++runs;
+            }
+        });
+    }
+
+    while (runs < n * RUNS) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(PERIOD_MS));
+    }
+    for (uint64_t id : ids) {
+        loop.cancel_timer(id);
+    }
+
+    /* timers run on the loop thread, timer_late is read after they are cancelled */
+    report("timer_wheel on one loop", timer_late);
+    SAMPLE_LOG_I("threads: %u sleeping vs 1 loop; the wheel ticks whole ms, a run up to 1ms ahead of the us schedule counts as 0", n);
+
+    /* cross-thread post: from the call to the run of the task */
+    axcl::latency_histogram post_latency;
+    const uint32_t posts = std::min<uint32_t>(option.count, 10000);
+    for (uint32_t i = 0; i < posts; ++i) {
+        std::atomic<bool> done = {false};
+        const uint64_t t0 = now_us();
+        loop.post([&]() {
+            post_latency.record(now_us() - t0);
+            done = true;
+        });
+        while (!done) {
+            std::this_thread::yield();
+        }
+    }
+    report("post to run, us", post_latency);
+
+    loop.stop();
+    return 0;
+}
@@ -0,0 +1,56 @@
+/**************************************************************************************************
+ *
+ * Copyright (c) 2019-2024 Axera Semiconductor Co., Ltd. All Rights Reserved.
+ *
+ * This source file is the property of Axera Semiconductor Co., Ltd. and
+ * may not be copied or distributed in any isomorphic form without the prior
+ * written consent of Axera Semiconductor Co., Ltd.
+ *
+ **************************************************************************************************/
+
+#include <string>
+#include "bench.hpp"
+#include "cmdline.h"
+#include "logger.h"
+
+int main(int argc, char *argv[]) {
+    cmdline::parser a;
+    a.add<std::string>("case", 'c', "benchmark case", false, "queue", cmdline::oneof<std::string>("queue", "pool", "memory", "dma", "log", "metrics", "latency", "ringbuf", "loop"));
+    a.add<uint32_t>("count", 'n', "items per run", false, 1000000);
+    a.add<uint32_t>("depth", 'q', "queue depth", false, 1024);
+    a.add<uint32_t>("threads", 't', "max threads of producers, consumers or workers", false, 16);
+    a.parse_check(argc, argv);
+
+    const std::string name = a.get<std::string>("case");
+    bench_option option;
+    option.count = a.get<uint32_t>("count");
+    option.depth = a.get<uint32_t>("depth");
+    option.max_threads = a.get<uint32_t>("threads");
+    if (0 == option.count || 0 == option.depth || 0 == option.max_threads) {
+        SAMPLE_LOG_E("count, depth and threads should be greater than 0");
+        return 1;
+    }
+
+    int32_t ret = 0;
+    if ("queue" == name) {
+        ret = bench_queue(option);
+    } else if ("pool" == name) {
+        ret = bench_pool(option);
+    } else if ("memory" == name) {
+        ret = bench_memory(option);
+    } else if ("dma" == name) {
+        ret = bench_dma(option);
+    } else if ("log" == name) {
+        ret = bench_log(option);
+    } else if ("metrics" == name) {
+        ret = bench_metrics(option);
+    } else if ("latency" == name) {
+        ret = bench_latency(option);
+    } else if ("ringbuf" == name) {
+        ret = bench_ringbuf(option);
+    } else if ("loop" == name) {
+        ret = bench_loop(option);
+    }
+
+    return (0 == ret) ? 0 : 1;
+}
@@ -0,0 +1,195 @@
+/**************************************************************************************************
+ *
+ * Copyright (c) 2019-2024 Axera Semiconductor Co., Ltd. All Rights Reserved.
+ *
+ * This source file is the property of Axera Semiconductor Co., Ltd. and
+ * may not be copied or distributed in any isomorphic form without the prior
+ * written consent of Axera Semiconductor Co., Ltd.
+ *
+ **************************************************************************************************/
+
+#include <string.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <memory>
+#include "bench.hpp"
+#include "logger.h"
+#include "mem_helper.hpp"
+
+/* every size moves at least this many bytes, so small sizes repeat enough to be timed */
+static constexpr uint64_t BYTES_PER_RUN = 512ULL * 1024 * 1024;
+static constexpr uint64_t MAX_SIZE = 32ULL * 1024 * 1024;
+
+/* called through volatile pointers so that the compiler cannot drop or inline the repeated calls */
+static void *(*volatile libc_memcpy)(void *, const void *, size_t) = ::memcpy;
+static void *(*volatile libc_memset)(void *, int, size_t) = ::memset;
+
+struct buffer_deleter {
+    void operator()(uint8_t *p) const {
+        free(p);
+    }
+};
+using buffer = std::unique_ptr<uint8_t, buffer_deleter>;
+
+static buffer alloc(uint64_t size) {
+    auto *p = static_cast<uint8_t *>(aligned_alloc(4096, size));
+    if (p) {
+        memset(p, 0x5A, size); /* fault in the pages before timing */
+    }
+    return buffer(p);
+}
+
+/* returns GB/s of repeating f, which moves size bytes per call */
+template <typename F>
+static double measure(uint64_t size, F &&f) {
+    const uint64_t loops = std::max<uint64_t>(BYTES_PER_RUN / size, 4);
+    f(); /* warm up */
+    const auto begin = std::chrono::steady_clock::now();
+    for (uint64_t i = 0; i < loops; ++i) {
+        f();
+    }
+    const double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - begin).count();
+    return static_cast<double>(size) * loops / ns;
+}
+
+static const char *simd_name(axcl::mem_helper::SIMD simd) {
+    switch (simd) {
+        case axcl::mem_helper::SIMD::neon:
+            return "neon";
+        case axcl::mem_helper::SIMD::sse:
+            return "sse";
+        case axcl::mem_helper::SIMD::avx:
+            return "avx";
+        default:
+            return "none";
+    }
+}
+
+static void bench_linear(uint8_t *dst, const uint8_t *src) {
+    static constexpr uint64_t SIZES[] = {1ULL << 10, 4ULL << 10, 16ULL << 10, 64ULL << 10, 256ULL << 10, 1ULL << 20, 2ULL << 20, 4ULL << 20, 8ULL << 20, 16ULL << 20, MAX_SIZE};
+
+    const uint64_t auto_threshold = axcl::mem_helper::stream_threshold();
+    SAMPLE_LOG_I("GB/s, stream: mem_helper always non-temporal, auto: mem_helper streams from %lu bytes", (unsigned long)auto_threshold);
+    SAMPLE_LOG_I("%8s | %8s %8s %8s | %8s %8s %8s", "size", "memcpy", "stream", "auto", "memset", "stream", "auto");
+
+    for (uint64_t size : SIZES) {
+        const double libc = measure(size, [&]() { libc_memcpy(dst, src, size); });
+        const double libc_set = measure(size, [&]() { libc_memset(dst, 0x10, size); });
+        const double automatic = measure(size, [&]() { axcl::mem_helper::memcpy(dst, src, size); });
+        const double auto_set = measure(size, [&]() { axcl::mem_helper::memset(dst, 0x10, size); });
+
+        axcl::mem_helper::set_stream_threshold(0);
+        const double stream = measure(size, [&]() { axcl::mem_helper::memcpy(dst, src, size); });
+        const double stream_set = measure(size, [&]() { axcl::mem_helper::memset(dst, 0x10, size); });
+        axcl::mem_helper::set_stream_threshold(auto_threshold);
+
+        if (size >= 1024 * 1024) {
+            SAMPLE_LOG_I("%6luMB | %8.2f %8.2f %8.2f | %8.2f %8.2f %8.2f", (unsigned long)(size >> 20), libc, stream, automatic, libc_set, stream_set, auto_set);
+        } else {
+            SAMPLE_LOG_I("%6luKB | %8.2f %8.2f %8.2f | %8.2f %8.2f %8.2f", (unsigned long)(size >> 10), libc, stream, automatic, libc_set, stream_set, auto_set);
+        }
+    }
+}
+
+/* 1080p NV12 out of a 2048 aligned stride into a tightly packed buffer, the copy after decoding with a padded stride */
+static int32_t bench_nv12(uint8_t *dst, const uint8_t *src) {
+    constexpr uint64_t WIDTH = 1920;
+    constexpr uint64_t HEIGHT = 1080;
+    constexpr uint64_t STRIDE = 2048;
+    constexpr uint64_t FRAME = WIDTH * HEIGHT * 3 / 2;
+
+    auto rows = [&]() {
+        for (uint64_t i = 0; i < HEIGHT * 3 / 2; ++i) {
+            libc_memcpy(dst + i * WIDTH, src + i * STRIDE, WIDTH);
+        }
+    };
+    auto planes = [&]() {
+        axcl::mem_helper::memcpy_2d(dst, WIDTH, src, STRIDE, WIDTH, HEIGHT);
+        axcl::mem_helper::memcpy_2d(dst + WIDTH * HEIGHT, WIDTH, src + STRIDE * HEIGHT, STRIDE, WIDTH, HEIGHT / 2);
+    };
+
+    const uint64_t auto_threshold = axcl::mem_helper::stream_threshold();
+    const double libc = measure(FRAME, rows);
+    const double automatic = measure(FRAME, planes);
+    axcl::mem_helper::set_stream_threshold(0);
+    const double stream = measure(FRAME, planes);
+    axcl::mem_helper::set_stream_threshold(auto_threshold);
+
+    /* check the planes against the row by row copy */
+    rows();
+    auto expected = alloc(FRAME);
+    if (!expected) {
+        SAMPLE_LOG_E("alloc %lu bytes fail", (unsigned long)FRAME);
+        return -1;
+    }
+    ::memcpy(expected.get(), dst, FRAME);
+    ::memset(dst, 0, FRAME);
+    planes();
+    if (0 != ::memcmp(expected.get(), dst, FRAME)) {
+        SAMPLE_LOG_E("memcpy_2d of NV12 planes mismatches");
+        return -1;
+    }
+
+    SAMPLE_LOG_I("NV12 %lux%lu stride %lu -> packed, GB/s: memcpy per row %.2f, memcpy_2d stream %.2f, auto %.2f", (unsigned long)WIDTH,
+                 (unsigned long)HEIGHT, (unsigned long)STRIDE, libc, stream, automatic);
+    return 0;
+}
+
+/* odd sizes and offsets against libc, through the non-temporal kernels */
+static int32_t verify(uint8_t *dst, const uint8_t *src) {
+    auto expected = alloc(8192);
+    if (!expected) {
+        return -1;
+    }
+
+    const uint64_t auto_threshold = axcl::mem_helper::stream_threshold();
+    int32_t ret = 0;
+    axcl::mem_helper::set_stream_threshold(0);
+    for (uint64_t offset = 0; offset < 64 && 0 == ret; offset += 7) {
+        for (uint64_t size = 0; size < 4096 && 0 == ret; size += (size < 300) ? 1 : 61) {
+            ::memset(dst, 0, 8192);
+            ::memset(expected.get(), 0, 8192);
+            ::memcpy(expected.get() + offset, src + 3, size);
+            axcl::mem_helper::memcpy(dst + offset, src + 3, size);
+            if (0 != ::memcmp(expected.get(), dst, 8192)) {
+                SAMPLE_LOG_E("memcpy of %lu bytes at offset %lu mismatches", (unsigned long)size, (unsigned long)offset);
+                ret = -1;
+            }
+
+            ::memset(expected.get() + offset, 0xA5, size);
+            axcl::mem_helper::memset(dst + offset, 0xA5, size);
+            if (0 != ::memcmp(expected.get(), dst, 8192)) {
+                SAMPLE_LOG_E("memset of %lu bytes at offset %lu mismatches", (unsigned long)size, (unsigned long)offset);
+                ret = -1;
+            }
+        }
+    }
+
+    axcl::mem_helper::set_stream_threshold(auto_threshold);
+    return ret;
+}
+
+int32_t bench_memory(const bench_option &option) {
+    (void)option;
+
+    axcl::mem_helper::init_check_simd();
+    SAMPLE_LOG_I("libc vs axcl::mem_helper, simd: %s", simd_name(axcl::mem_helper::get_simd()));
+
+    auto src = alloc(MAX_SIZE);
+    auto dst = alloc(MAX_SIZE);
+    if (!src || !dst) {
+        SAMPLE_LOG_E("alloc 2 x %lu bytes fail", (unsigned long)MAX_SIZE);
+        return -1;
+    }
+    for (uint64_t i = 0; i < MAX_SIZE; ++i) {
+        src.get()[i] = static_cast<uint8_t>(i * 131 + (i >> 11));
+    }
+
+    if (0 != verify(dst.get(), src.get())) {
+        return -1;
+    }
+
+    bench_linear(dst.get(), src.get());
+    return bench_nv12(dst.get(), src.get());
+}
@@ -0,0 +1,133 @@
+/**************************************************************************************************
+ *
+ * Copyright (c) 2019-2024 Axera Semiconductor Co., Ltd. All Rights Reserved.
+ *
+ * This source file is the property of Axera Semiconductor Co., Ltd. and
+ * may not be copied or distributed in any isomorphic form without the prior
+ * written consent of Axera Semiconductor Co., Ltd.
+ *
+ **************************************************************************************************/
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+#include "bench.hpp"
+#include "logger.h"
+#include "metrics.hpp"
+
+/* ns per update of threads x count updates */
+template <typename F>
+static double per_update_ns(uint32_t threads, uint32_t count, F &&f) {
+    std::vector<std::thread> workers;
+    const auto begin = std::chrono::steady_clock::now();
+    for (uint32_t t = 0; t < threads; ++t) {
+        workers.emplace_back([&f, count, t]() {
+            for (uint32_t i = 0; i < count; ++i) {
+                f(t, i);
+            }
+        });
+    }
+    for (auto &w : workers) {
+        w.join();
+    }
+
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - begin).count() / count;
+}
+
+/* a plain HTTP/1.1 GET of the local server, returns the whole response */
+static std::string scrape(uint16_t port, const char *path) {
+    const int32_t fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) {
+        return {};
+    }
+
+    struct sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+    std::string response;
+    if (0 == connect(fd, reinterpret_cast<struct sockaddr *>(&addr), sizeof(addr))) {
+        const std::string request = std::string("GET ") + path + " HTTP/1.1\r\nHost: localhost\r\n\r\n";
+        if (send(fd, request.data(), request.size(), MSG_NOSIGNAL) == static_cast<ssize_t>(request.size())) {
+            char buf[4096];
+            ssize_t n;
+            while ((n = recv(fd, buf, sizeof(buf), 0)) > 0) {
+                response.append(buf, n);
+            }
+        }
+    }
+
+    close(fd);
+    return response;
+}
+
+int32_t bench_metrics(const bench_option &option) {
+    const uint32_t count = option.count;
+    axcl::metrics_registry *registry = axcl::metrics_registry::get_instance();
+
+    SAMPLE_LOG_I("%u updates per thread, ns per update of all threads together", count);
+    SAMPLE_LOG_I("%8s | %14s | %16s | %24s", "threads", "std::atomic", "metric_counter", "metric_histogram");
+
+    for (uint32_t threads = 1; threads <= option.max_threads; threads *= 2) {
+        alignas(64) std::atomic<uint64_t> shared = {0};
+        const double atomic_ns = per_update_ns(threads, count, [&shared](uint32_t, uint32_t) { shared.fetch_add(1, std::memory_order_relaxed); });
+
+        const std::string labels = std::to_string(threads);
+        axcl::metric_counter &counter = registry->counter("bench_updates_total", "updates of the bench", {{"threads", labels}});
+        const double counter_ns = per_update_ns(threads, count, [&counter](uint32_t, uint32_t) { counter.inc(); });
+
+        axcl::metric_histogram &histogram = registry->histogram("bench_latency_seconds", "latencies observed by the bench",
+                                                                axcl::metric_histogram::latency_buckets(), {{"threads", labels}});
+        const double histogram_ns =
+            per_update_ns(threads, count, [&histogram](uint32_t t, uint32_t i) { histogram.observe(((i + t) % 2000) * 0.0001); });
+
+        if (counter.value() != static_cast<uint64_t>(threads) * count || shared.load() != static_cast<uint64_t>(threads) * count) {
+            SAMPLE_LOG_E("%u threads: counter %lu of %lu", threads, (unsigned long)counter.value(), (unsigned long)threads * count);
+            return -1;
+        }
+
+        SAMPLE_LOG_I("%8u | %14.2f | %16.2f | %24.2f", threads, atomic_ns, counter_ns, histogram_ns);
+    }
+
+    registry->gauge("bench_threads", "max threads of the bench").set(option.max_threads);
+
+    axcl::metrics_server server;
+    if (!server.start(0)) {
+        SAMPLE_LOG_E("start metrics server fail");
+        return -1;
+    }
+
+    const std::string metrics = scrape(server.port(), "/metrics");
+    const std::string missing = scrape(server.port(), "/");
+    server.stop();
+
+    const std::string expected = "bench_updates_total{threads=\"1\"} " + std::to_string(count) + "\n";
+    if (0 != metrics.compare(0, 15, "HTTP/1.1 200 OK") || std::string::npos == metrics.find(expected) ||
+        std::string::npos == metrics.find("bench_latency_seconds_bucket{threads=\"1\",le=\"+Inf\"}") ||
+        0 != missing.compare(0, 22, "HTTP/1.1 404 Not Found")) {
+        SAMPLE_LOG_E("unexpected scrape of 127.0.0.1:%u:\n%s", server.port(), metrics.c_str());
+        return -1;
+    }
+
+    /* print the series of 1 thread only */
+    const size_t body = metrics.find("\r\n\r\n") + 4;
+    std::string text;
+    for (size_t pos = body, end; pos < metrics.size(); pos = end + 1) {
+        end = std::min(metrics.find('\n', pos), metrics.size());
+        const std::string line = metrics.substr(pos, end - pos);
+        if (std::string::npos == line.find("{threads=") || std::string::npos != line.find("{threads=\"1\"")) {
+            text += line + "\n";
+        }
+    }
+
+    SAMPLE_LOG_I("GET http://127.0.0.1:%u/metrics, %zu bytes:\n%s", server.port(), metrics.size() - body, text.c_str());
+    return 0;
+}
@@ -0,0 +1,228 @@
+/**************************************************************************************************
+ *
+ * Copyright (c) 2019-2024 Axera Semiconductor Co., Ltd. All Rights Reserved.
+ *
+ * This source file is the property of Axera Semiconductor Co., Ltd. and
+ * may not be copied or distributed in any isomorphic form without the prior
+ * written consent of Axera Semiconductor Co., Ltd.
+ *
+ **************************************************************************************************/
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <memory>
+#include <thread>
+#include <vector>
+#include "bench.hpp"
+#include "futex.hpp"
+#include "log/logger.hpp"
+#include "logger.h"
+#include "thread_pool.hpp"
+#include "ws_thread_pool.hpp"
+
+using bench_clock = std::chrono::steady_clock;
+
+static uint64_t work(uint32_t loops) {
+    volatile uint64_t x = 0;
+    for (uint32_t i = 0; i < loops; ++i) {
+        x = x + i;
+    }
+    return x;
+}
+
+/* count down of the tasks of a run, the last one wakes up the waiting thread */
+class countdown {
+public:
+    explicit countdown(uint32_t count) : m_remain(count) {
+    }
+    void done(void) {
+        if (1 == m_remain.fetch_sub(1, std::memory_order_acq_rel)) {
+            axcl::futex_wake(m_remain);
+        }
+    }
+    void wait(void) {
+        for (uint32_t remain = m_remain.load(std::memory_order_acquire); 0 != remain; remain = m_remain.load(std::memory_order_acquire)) {
+            axcl::futex_wait(m_remain, remain);
+        }
+    }
+
+private:
+    std::atomic<uint32_t> m_remain;
+};
+
+static double elapsed_ms(const bench_clock::time_point &begin) {
+    return std::chrono::duration<double, std::milli>(bench_clock::now() - begin).count();
+}
+
+/* 1. a flat batch of small tasks submitted from outside, then waited all */
+static void bench_batch(uint32_t threads, uint32_t count, uint32_t loops) {
+    double old_ms, ws_enqueue_ms, ws_future_ms, ws_submit_ms;
+    {
+        axcl::thread_pool pool(threads, "old");
+        std::vector<std::future<uint64_t>> futures;
+        futures.reserve(count);
+        auto begin = bench_clock::now();
+        for (uint32_t i = 0; i < count; ++i) {
+            futures.push_back(pool.enqueue(work, loops));
+        }
+        for (auto &f : futures) {
+            f.get();
+        }
+        old_ms = elapsed_ms(begin);
+    }
+    {
+        axcl::ws_thread_pool pool(threads, "ws");
+        std::vector<std::future<uint64_t>> futures;
+        futures.reserve(count);
+        auto begin = bench_clock::now();
+        for (uint32_t i = 0; i < count; ++i) {
+            futures.push_back(pool.enqueue(work, loops));
+        }
+        for (auto &f : futures) {
+            f.get();
+        }
+        ws_enqueue_ms = elapsed_ms(begin);
+    }
+    {
+        axcl::ws_thread_pool pool(threads, "ws");
+        std::unique_ptr<axcl::task_future<uint64_t>[]> futures(new axcl::task_future<uint64_t>[count]);
+        auto begin = bench_clock::now();
+        for (uint32_t i = 0; i < count; ++i) {
+            pool.submit(futures[i], [loops]() { return work(loops); });
+        }
+        for (uint32_t i = 0; i < count; ++i) {
+            futures[i].get();
+        }
+        ws_future_ms = elapsed_ms(begin);
+    }
+    {
+        axcl::ws_thread_pool pool(threads, "ws");
+        countdown latch(count);
+        auto begin = bench_clock::now();
+        for (uint32_t i = 0; i < count; ++i) {
+            pool.submit([loops, &latch]() {
+                work(loops);
+                latch.done();
+            });
+        }
+        latch.wait();
+        ws_submit_ms = elapsed_ms(begin);
+    }
+
+    SAMPLE_LOG_I("batch  : %u tasks x %u loops, K tasks/s: thread_pool::enqueue %.1f, ws enqueue %.1f, ws submit+task_future %.1f, ws submit %.1f",
+                 count, loops, count / old_ms, count / ws_enqueue_ms, count / ws_future_ms, count / ws_submit_ms);
+}
+
+/* 2. a binary tree of tasks, every task submits its 2 children from inside the pool */
+template <typename P>
+static void spawn(P &pool, uint32_t depth, uint32_t loops, countdown &latch) {
+    work(loops);
+    if (depth > 1) {
+        for (int i = 0; i < 2; ++i) {
+            if constexpr (std::is_same_v<P, axcl::thread_pool>) {
+                pool.enqueue([&pool, depth, loops, &latch]() { spawn(pool, depth - 1, loops, latch); });
+            } else {
+                pool.submit([&pool, depth, loops, &latch]() { spawn(pool, depth - 1, loops, latch); });
+            }
+        }
+    }
+    latch.done();
+}
+
+template <typename P>
+static double run_tree(uint32_t threads, uint32_t depth, uint32_t loops) {
+    P pool(threads, "tree");
+    countdown latch((1u << depth) - 1);
+    auto begin = bench_clock::now();
+    if constexpr (std::is_same_v<P, axcl::thread_pool>) {
+        pool.enqueue([&pool, depth, loops, &latch]() { spawn(pool, depth, loops, latch); });
+    } else {
+        pool.submit([&pool, depth, loops, &latch]() { spawn(pool, depth, loops, latch); });
+    }
+    latch.wait();
+    return elapsed_ms(begin);
+}
+
+static void bench_tree(uint32_t threads, uint32_t count, uint32_t loops) {
+    uint32_t depth = 1;
+    while (depth < 24 && (2u << depth) - 1 <= count) {
+        ++depth;
+    }
+
+    const uint32_t tasks = (1u << depth) - 1;
+    const double old_ms = run_tree<axcl::thread_pool>(threads, depth, loops);
+    const double ws_ms = run_tree<axcl::ws_thread_pool>(threads, depth, loops);
+    SAMPLE_LOG_I("tree   : %u tasks (depth %u) x %u loops, K tasks/s: thread_pool %.1f, ws_thread_pool %.1f, speedup %.2fx", tasks, depth, loops,
+                 tasks / old_ms, tasks / ws_ms, old_ms / ws_ms);
+}
+
+/* 3. latency from submit to start of a probe task, while the pool is flooded with background tasks */
+struct latency {
+    double p50, p99, max;
+};
+
+static latency summarize(std::vector<double> &us) {
+    std::sort(us.begin(), us.end());
+    return {us[us.size() / 2], us[us.size() * 99 / 100], us.back()};
+}
+
+template <typename P>
+static latency run_probe(uint32_t threads, uint32_t background, uint32_t loops, uint32_t probes) {
+    P pool(threads, "probe");
+    countdown latch(background + probes);
+    std::vector<double> us(probes, 0);
+
+    for (uint32_t i = 0; i < background; ++i) {
+        auto task = [loops, &latch]() {
+            work(loops);
+            latch.done();
+        };
+        if constexpr (std::is_same_v<P, axcl::thread_pool>) {
+            pool.enqueue(task);
+        } else {
+            pool.submit(task);
+        }
+    }
+
+    for (uint32_t i = 0; i < probes; ++i) {
+        std::this_thread::sleep_for(std::chrono::microseconds(500));
+        const auto submit = bench_clock::now();
+        auto probe = [submit, &us, i, &latch]() {
+            us[i] = std::chrono::duration<double, std::micro>(bench_clock::now() - submit).count();
+            latch.done();
+        };
+        if constexpr (std::is_same_v<P, axcl::thread_pool>) {
+            pool.enqueue(probe);
+        } else {
+            pool.submit(probe, axcl::ws_lane::high);
+        }
+    }
+
+    latch.wait();
+    return summarize(us);
+}
+
+static void bench_latency(uint32_t threads, uint32_t count, uint32_t loops) {
+    constexpr uint32_t PROBES = 100;
+    const uint32_t background = std::max<uint32_t>(count / 10, 1);
+    const latency old_lat = run_probe<axcl::thread_pool>(threads, background, loops * 20, PROBES);
+    const latency ws_lat = run_probe<axcl::ws_thread_pool>(threads, background, loops * 20, PROBES);
+    SAMPLE_LOG_I("latency: %u probes behind %u tasks x %u loops, submit to start us p50/p99/max: thread_pool %.1f/%.1f/%.1f, ws_thread_pool high lane %.1f/%.1f/%.1f",
+                 PROBES, background, loops * 20, old_lat.p50, old_lat.p99, old_lat.max, ws_lat.p50, ws_lat.p99, ws_lat.max);
+}
+
+int32_t bench_pool(const bench_option &option) {
+    constexpr uint32_t LOOPS = 200;
+    const uint32_t threads = option.max_threads;
+    SAMPLE_LOG_I("%u workers of thread_pool vs ws_thread_pool, %u hardware threads", threads, std::thread::hardware_concurrency());
+
+    /* thread_pool warns for every task queued beyond its workers, which is the normal case here */
+    AXCL_LOGGER->set_level(spdlog::level::err);
+
+    bench_batch(threads, option.count, LOOPS);
+    bench_tree(threads, option.count, LOOPS);
+    bench_latency(threads, option.count, LOOPS);
+    return 0;
+}
@@ -0,0 +1,145 @@
+/**************************************************************************************************
+ *
+ * Copyright (c) 2019-2024 Axera Semiconductor Co., Ltd. All Rights Reserved.
+ *
+ * This source file is the property of Axera Semiconductor Co., Ltd. and
+ * may not be copied or distributed in any isomorphic form without the prior
+ * written consent of Axera Semiconductor Co., Ltd.
+ *
+ **************************************************************************************************/
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include "AXLockQ.hpp"
+#include "bench.hpp"
+#include "lock_queue.hpp"
+#include "logger.h"
+#include "mpmc_queue.hpp"
+
+/* one interface over the 3 queues: push never fails (it retries or waits), pop waits until an item comes */
+struct lock_queue_adapter {
+    axcl::lock_queue<uint64_t> q;
+    explicit lock_queue_adapter(uint32_t depth) {
+        q.set_capacity(depth);
+    }
+    void push(uint64_t v) {
+        while (!q.push(v)) {
+            std::this_thread::yield();
+        }
+    }
+    bool pop(uint64_t &v) {
+        return q.pop(v, -1);
+    }
+};
+
+struct axlockq_adapter {
+    CAXLockQ<uint64_t> q;
+    explicit axlockq_adapter(uint32_t depth) {
+        q.SetCapacity(depth);
+    }
+    void push(uint64_t v) {
+        while (!q.Push(v)) {
+            std::this_thread::yield();
+        }
+    }
+    bool pop(uint64_t &v) {
+        return q.Pop(v, -1);
+    }
+};
+
+struct mpmc_queue_adapter {
+    axcl::mpmc_queue<uint64_t> q;
+    explicit mpmc_queue_adapter(uint32_t depth) : q(depth) {
+    }
+    void push(uint64_t v) {
+        q.push(v, -1);
+    }
+    bool pop(uint64_t &v) {
+        return q.pop(v, -1);
+    }
+};
+
+static constexpr uint64_t SENTINEL = UINT64_MAX;
+
+/* returns million items per second, or a negative value if items were lost */
+template <typename Q>
+static double run(uint32_t producers, uint32_t consumers, uint32_t count, uint32_t depth) {
+    Q queue(depth);
+    std::atomic<uint64_t> sum{0};
+    std::atomic<uint64_t> popped{0};
+
+    const uint32_t per_producer = count / producers;
+    auto begin = std::chrono::steady_clock::now();
+
+    std::vector<std::thread> threads;
+    for (uint32_t c = 0; c < consumers; ++c) {
+        threads.emplace_back([&]() {
+            uint64_t local_sum = 0;
+            uint64_t local_count = 0;
+            uint64_t v;
+            while (queue.pop(v)) {
+                if (SENTINEL == v) {
+                    break;
+                }
+                local_sum += v;
+                ++local_count;
+            }
+            sum.fetch_add(local_sum);
+            popped.fetch_add(local_count);
+        });
+    }
+
+    std::vector<std::thread> producer_threads;
+    for (uint32_t p = 0; p < producers; ++p) {
+        producer_threads.emplace_back([&queue, per_producer]() {
+            for (uint32_t i = 1; i <= per_producer; ++i) {
+                queue.push(i);
+            }
+        });
+    }
+
+    for (auto &t : producer_threads) {
+        t.join();
+    }
+    for (uint32_t c = 0; c < consumers; ++c) {
+        queue.push(SENTINEL);
+    }
+    for (auto &t : threads) {
+        t.join();
+    }
+
+    const double us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - begin).count();
+    const uint64_t expected = static_cast<uint64_t>(per_producer) * producers;
+    const uint64_t expected_sum = static_cast<uint64_t>(per_producer) * (per_producer + 1) / 2 * producers;
+    if (popped.load() != expected || sum.load() != expected_sum) {
+        return -1.0;
+    }
+
+    return expected / us;
+}
+
+int32_t bench_queue(const bench_option &option) {
+    SAMPLE_LOG_I("%u items per run, depth %u, M items/s of lock_queue | CAXLockQ | mpmc_queue:", option.count, option.depth);
+    SAMPLE_LOG_I("%9s %9s %12s %12s %12s %8s", "producers", "consumers", "lock_queue", "CAXLockQ", "mpmc_queue", "speedup");
+
+    int32_t ret = 0;
+    for (uint32_t producers = 1; producers <= option.max_threads; producers *= 2) {
+        for (uint32_t consumers = 1; consumers <= option.max_threads; consumers *= 2) {
+            const double lock = run<lock_queue_adapter>(producers, consumers, option.count, option.depth);
+            const double axlock = run<axlockq_adapter>(producers, consumers, option.count, option.depth);
+            const double mpmc = run<mpmc_queue_adapter>(producers, consumers, option.count, option.depth);
+            if (lock < 0 || axlock < 0 || mpmc < 0) {
+                SAMPLE_LOG_E("%ux%u: items lost, lock_queue %s, CAXLockQ %s, mpmc_queue %s", producers, consumers, (lock < 0) ? "fail" : "ok",
+                             (axlock < 0) ? "fail" : "ok", (mpmc < 0) ? "fail" : "ok");
+                ret = -1;
+                continue;
+            }
+
+            SAMPLE_LOG_I("%9u %9u %12.2f %12.2f %12.2f %7.2fx", producers, consumers, lock, axlock, mpmc, mpmc / std::max(lock, axlock));
+        }
+    }
+
+    return ret;
+}
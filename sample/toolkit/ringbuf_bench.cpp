@@ -0,0 +1,225 @@
+/**************************************************************************************************
+ *
+ * Copyright (c) 2019-2024 Axera Semiconductor Co., Ltd. All Rights Reserved.
+ *
+ * This source file is the property of Axera Semiconductor Co., Ltd. and
+ * may not be copied or distributed in any isomorphic form without the prior
+ * written consent of Axera Semiconductor Co., Ltd.
+ *
+ **************************************************************************************************/
+
+#include <string.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+#include "bench.hpp"
+#include "logger.h"
+#include "ringbuf_broadcast.hpp"
+
+static constexpr uint32_t RING_SIZE = 8 * 1024 * 1024;
+static constexpr uint32_t GOP = 30;
+
+/* an encoded stream: a keyframe of 60KB every GOP, P frames of 2KB .. 18KB */
+static uint32_t packet_size(uint64_t seq) {
+    return (0 == seq % GOP) ? 60 * 1024 : 2048 + static_cast<uint32_t>((seq * 2654435761u) % (16 * 1024));
+}
+
+/* seq in the first 8 bytes, the key flag in the 9th, then a pattern of the seq */
+static void fill_packet(uint8_t *p, uint32_t size, uint64_t seq) {
+    memcpy(p, &seq, sizeof(seq));
+    p[8] = (0 == seq % GOP) ? 1 : 0;
+    memset(p + 9, static_cast<int>(seq & 0xFF), size - 9);
+}
+
+static bool check_packet(const axcl::ringbuf_data &data, uint64_t &seq) {
+    memcpy(&seq, data.data, sizeof(seq));
+    const uint8_t *p = static_cast<const uint8_t *>(data.data);
+    if (data.size != packet_size(seq) || p[8] != ((0 == seq % GOP) ? 1 : 0)) {
+        return false;
+    }
+    return p[9] == (seq & 0xFF) && p[data.size - 1] == (seq & 0xFF);
+}
+
+struct reader_result {
+    uint64_t records = 0;
+    uint32_t errors = 0;      /* wrong content, out of order, or not a keyframe after a skip */
+    uint32_t skips = 0;       /* gaps in seq */
+};
+
+/* pops until the writer is done and the reader is drained, sleeps per record to play a slow output */
+static void read_stream(axcl::ringbuf_broadcast &ring, int32_t id, const std::atomic<bool> &done, uint32_t sleep_us, reader_result &result) {
+    bool first = true;
+    uint64_t expected = 0;
+    axcl::ringbuf_data data;
+    while (true) {
+        if (!ring.pop(id, data, 10)) {
+            axcl::ringbuf_broadcast::reader_stat s = {};
+            if (!ring.stat(id, s) || !s.connected || (done && 0 == s.lag)) {
+                break;
+            }
+            continue;
+        }
+
+        uint64_t seq;
+        if (!check_packet(data, seq)) {
+            ++result.errors;
+        } else if (!first && seq != expected) {
+            /* a gap must be an overrun that resumes on a keyframe */
+            ++result.skips;
+            if (seq < expected || 0 != seq % GOP) {
+                ++result.errors;
+            }
+        } else if (first && 0 != seq % GOP) {
+            ++result.errors;
+        }
+
+        first = false;
+        expected = seq + 1;
+        ++result.records;
+        ring.free(id, data);
+
+        if (sleep_us > 0) {
+            std::this_thread::sleep_for(std::chrono::microseconds(sleep_us));
+        }
+    }
+}
+
+/* 1 writer, 2 outputs keeping up, a slow one that skips and a slow one that is disconnected */
+static int32_t check_broadcast(uint32_t count) {
+    axcl::ringbuf_broadcast ring(RING_SIZE, 4, "bench");
+    struct {
+        const char *name;
+        axcl::ringbuf_broadcast::POLICY policy;
+        uint32_t sleep_us;
+    } outputs[] = {
+        {"rtmp", axcl::ringbuf_broadcast::POLICY::SKIP, 0},
+        {"recorder", axcl::ringbuf_broadcast::POLICY::SKIP, 0},
+        {"preview (slow, skip)", axcl::ringbuf_broadcast::POLICY::SKIP, 2000},
+        {"preview (slow, disconnect)", axcl::ringbuf_broadcast::POLICY::DISCONNECT, 2000},
+    };
+
+    constexpr uint32_t N = sizeof(outputs) / sizeof(outputs[0]);
+    int32_t ids[N];
+    reader_result results[N];
+    std::atomic<bool> done = {false};
+    std::vector<std::thread> readers;
+    for (uint32_t i = 0; i < N; ++i) {
+        ids[i] = ring.attach(outputs[i].policy);
+        readers.emplace_back(read_stream, std::ref(ring), ids[i], std::cref(done), outputs[i].sleep_us, std::ref(results[i]));
+    }
+
+    /* about 3MB/s ... 30 fps of 1080p at 8Mbps x 10, fast enough to overrun the slow outputs */
+    std::vector<uint8_t> packet(64 * 1024);
+    for (uint64_t seq = 0; seq < count; ++seq) {
+        axcl::ringbuf_data data;
+        data.size = packet_size(seq);
+        if (ring.get(data, 0 == seq % GOP)) {
+            fill_packet(static_cast<uint8_t *>(data.data), data.size, seq);
+            ring.put(data);
+        }
+        if (0 == seq % 8) {
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+        }
+    }
+
+    done = true;
+    for (auto &t : readers) {
+        t.join();
+    }
+
+    SAMPLE_LOG_I("%u packets broadcast to %u outputs, %lu dropped by the writer", count, N, (unsigned long)ring.dropped());
+    SAMPLE_LOG_I("%28s | %10s | %10s | %10s | %10s", "output", "records", "skipped", "overruns", "connected");
+    int32_t ret = 0;
+    for (uint32_t i = 0; i < N; ++i) {
+        axcl::ringbuf_broadcast::reader_stat s = {};
+        ring.stat(ids[i], s);
+        SAMPLE_LOG_I("%28s | %10lu | %10lu | %10u | %10s", outputs[i].name, (unsigned long)results[i].records, (unsigned long)s.skipped, s.overruns,
+                     s.connected ? "yes" : "no");
+
+        if (results[i].errors > 0) {
+            SAMPLE_LOG_E("%s: %u records are corrupted, out of order, or do not resume on a keyframe", outputs[i].name, results[i].errors);
+            ret = -1;
+        }
+        if (results[i].records + s.skipped > count || (s.overruns > 0) != (results[i].skips > 0 || !s.connected)) {
+            SAMPLE_LOG_E("%s: records %lu + skipped %lu of %u, %u overruns vs %u gaps seen", outputs[i].name, (unsigned long)results[i].records,
+                         (unsigned long)s.skipped, count, s.overruns, results[i].skips);
+            ret = -1;
+        }
+        ring.detach(ids[i]);
+    }
+
+    return ret;
+}
+
+/**
+ * publish cost of one stream to n outputs: n rings of copies vs one broadcast ring, drained in the same thread.
+ * outputs trail the writer by half a ring, so that both walk the whole buffer as they do in a pipeline; an empty
+ * ringbuf_nowarp restarts at offset 0 and would copy into the same cache lines again and again.
+ */
+static void bench_publish(uint32_t count, uint32_t n) {
+    std::vector<uint8_t> packet(64 * 1024);
+    fill_packet(packet.data(), static_cast<uint32_t>(packet.size()), 0);
+
+    std::vector<std::unique_ptr<axcl::ringbuf_nowarp>> rings;
+    for (uint32_t i = 0; i < n; ++i) {
+        rings.emplace_back(std::make_unique<axcl::ringbuf_nowarp>(RING_SIZE));
+    }
+
+    auto begin = std::chrono::steady_clock::now();
+    for (uint64_t seq = 0; seq < count; ++seq) {
+        for (auto &ring : rings) {
+            axcl::ringbuf_data data;
+            data.size = packet_size(seq);
+            if (ring->get(data, 0 == seq % GOP)) {
+                memcpy(data.data, packet.data(), data.size);
+                ring->put(data);
+            }
+        }
+        for (auto &ring : rings) {
+            axcl::ringbuf_data data;
+            while (ring->size() > RING_SIZE / 2 && ring->pop(data)) {
+                ring->free(data);
+            }
+        }
+    }
+    const double copies_ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - begin).count() / count;
+
+    axcl::ringbuf_broadcast broadcast(RING_SIZE, n);
+    std::vector<int32_t> ids;
+    for (uint32_t i = 0; i < n; ++i) {
+        ids.push_back(broadcast.attach());
+    }
+
+    begin = std::chrono::steady_clock::now();
+    for (uint64_t seq = 0; seq < count; ++seq) {
+        broadcast.push(packet.data(), packet_size(seq), 0 == seq % GOP);
+        for (int32_t id : ids) {
+            axcl::ringbuf_data data;
+            axcl::ringbuf_broadcast::reader_stat stat = {};
+            while (broadcast.stat(id, stat) && stat.lag > RING_SIZE / 2 && broadcast.pop(id, data)) {
+                broadcast.free(id, data);
+            }
+        }
+    }
+    const double broadcast_ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - begin).count() / count;
+
+    SAMPLE_LOG_I("%8u | %22.0f | %22.0f | %8.2fx", n, copies_ns, broadcast_ns, copies_ns / broadcast_ns);
+}
+
+int32_t bench_ringbuf(const bench_option &option) {
+    if (0 != check_broadcast(std::min<uint32_t>(option.count, 20000))) {
+        return -1;
+    }
+
+    const uint32_t count = std::min<uint32_t>(option.count, 200000);
+    SAMPLE_LOG_I("%u packets of 2KB .. 60KB published and consumed once per output, ns per packet", count);
+    SAMPLE_LOG_I("%8s | %22s | %22s | %9s", "outputs", "ringbuf_nowarp x n", "ringbuf_broadcast", "speedup");
+    for (uint32_t n = 1; n <= std::min<uint32_t>(option.max_threads, 8); n *= 2) {
+        bench_publish(count, n);
+    }
+
+    return 0;
+}
@@ -369,7 +369,7 @@ static void sample_get_decoded_image_thread(AX_VDEC_GRP grp, int32_t device_id,
 
             if (dump) {
                 if (axclError Ret =
-                        axclrtMemcpy(reinterpret_cast<void *>(cma_mem.phy), reinterpret_cast<void *>(frame.stVFrame.u64PhyAddr[0]), size,
+                        axclrtMemcpy(reinterpret_cast<void *>(cma_mem.blks[0].phy), reinterpret_cast<void *>(frame.stVFrame.u64PhyAddr[0]), size,
                                      AXCL_MEMCPY_DEVICE_TO_HOST_PHY);
                     AXCL_SUCC != Ret) {
                     SAMPLE_LOG_E("axclrt memcpy device phy to host phy error grp:%d, chn:%d", grp, chn);
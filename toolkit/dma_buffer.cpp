@@ -10,47 +10,33 @@
 
 #include "dma_buffer.hpp"
 #include <error.h>
-#include <fcntl.h>
 #include <string.h>
-#include <sys/ioctl.h>
-#include <sys/mman.h>
 #include <sys/stat.h>
-#include <sys/types.h>
-#include <unistd.h>
+#include <algorithm>
+#include <climits>
 #include <utility>
 #include "ax_base_type.h"
 #include "log/logger.hpp"
 
-#define AX_MM_DEV "/dev/ax_mmb_dev"
 #define TAG "pcie"
 
-// ioctl cmd
-#define AX_IOC_PCIe_BASE 'H'
-#define AX_IOC_PCIE_DMA_GET_PHY_BASE    _IOW(AX_IOC_PCIe_BASE, 3, unsigned int)
-#define AX_IOC_PCIe_ALLOC_MEMORY        _IOW(AX_IOC_PCIe_BASE, 4, unsigned int)
-#define AX_IOC_PCIe_ALLOC_MEMCACHED     _IOW(AX_IOC_PCIe_BASE, 5, unsigned int)
-#define AX_IOC_PCIe_FLUSH_CACHED        _IOW(AX_IOC_PCIe_BASE, 6, struct ax_mem_info)
-#define AX_IOC_PCIe_INVALID_CACHED      _IOW(AX_IOC_PCIe_BASE, 7, struct ax_mem_info)
-#define AX_IOC_PCIe_SCATTERLIST_ALLOC   _IOW(AX_IOC_PCIe_BASE, 8, struct ax_scatterlist)
-
-struct ax_mem_info {
-    uint64_t phy;
-    uint64_t vir;
-    uint64_t size;
-};
-
-struct ax_sg_list {
-    unsigned long phyaddr;
-    unsigned long virtaddr;
-    unsigned int size;
-};
-
-#define MAX_SG_LIST_ENTRY 64
-struct ax_scatterlist {
-    int num;
-    int size;
-    struct ax_sg_list sg_list[MAX_SG_LIST_ENTRY];
-};
+static constexpr size_t PAGE_SIZE_4K = 4096;
+static constexpr size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+
+/* a failing scatter list allocation is retried with half of the size, down to this */
+static constexpr size_t MIN_SG_REQUEST = 4 * 1024 * 1024;
+
+static size_t align_up(size_t value, size_t align) {
+    return (value + align - 1) / align * align;
+}
+
+static std::shared_ptr<mmb_device> s_device;
+
+static std::shared_ptr<mmb_device> current_device() {
+    static auto default_device = std::make_shared<mmb_device>();
+    auto device = std::atomic_load(&s_device);
+    return device ? device : default_device;
+}
 
 static void print_scatterlist(const struct ax_scatterlist &sg) {
     LOG_MM_C(TAG, "pid: {} scatter list: size {:#x} num {}", getpid(), sg.size, sg.num);
@@ -59,34 +45,49 @@ static void print_scatterlist(const struct ax_scatterlist &sg) {
     }
 }
 
-dma_buffer::dma_buffer() : m_fd(-1) {
+dma_buffer::dma_buffer() : m_reserved(nullptr), m_reserved_size(0) {
 }
 
 dma_buffer::~dma_buffer() {
     free();
 }
 
-dma_buffer::dma_buffer(dma_buffer &&rhs) noexcept {
-    m_fd = std::exchange(rhs.m_fd, -1);
-    m_mem = std::exchange(rhs.m_mem, dma_mem{});
+dma_buffer::dma_buffer(dma_buffer &&rhs) noexcept
+    : m_device(std::move(rhs.m_device)),
+      m_chunks(std::exchange(rhs.m_chunks, {})),
+      m_reserved(std::exchange(rhs.m_reserved, nullptr)),
+      m_reserved_size(std::exchange(rhs.m_reserved_size, 0)),
+      m_mem(std::exchange(rhs.m_mem, dma_mem{})) {
+    bind_ops();
 }
 
 dma_buffer &dma_buffer::operator=(dma_buffer &&rhs) noexcept {
-    m_fd = std::exchange(rhs.m_fd, -1);
-    m_mem = std::exchange(rhs.m_mem, dma_mem{});
+    if (this != &rhs) {
+        free();
+
+        m_device = std::move(rhs.m_device);
+        m_chunks = std::exchange(rhs.m_chunks, {});
+        m_reserved = std::exchange(rhs.m_reserved, nullptr);
+        m_reserved_size = std::exchange(rhs.m_reserved_size, 0);
+        m_mem = std::exchange(rhs.m_mem, dma_mem{});
+        bind_ops();
+    }
 
     return *this;
 }
 
-bool dma_buffer::alloc(size_t size, bool cached /* = false */, bool scattered /* = false */) {
-    if (m_fd > 0) {
-        LOG_MM_E(TAG, "{} is opened", AX_MM_DEV);
+void dma_buffer::set_device(std::shared_ptr<mmb_device> device) {
+    std::atomic_store(&s_device, std::move(device));
+}
+
+bool dma_buffer::alloc(size_t size, bool cached /* = false */, bool scattered /* = false */, bool hugepage /* = false */) {
+    if (m_reserved) {
+        LOG_MM_E(TAG, "dma buffer is allocated");
         return false;
     }
 
-    int fd = ::open(AX_MM_DEV, O_RDWR);
-    if (fd < 0) {
-        LOG_MM_E(TAG, "open {} fail", AX_MM_DEV);
+    if (0 == size || size > UINT32_MAX) {
+        LOG_MM_E(TAG, "invalid dma buffer size {}", size);
         return false;
     }
 
@@ -94,23 +95,123 @@ bool dma_buffer::alloc(size_t size, bool cached /* = false */, bool scattered /*
     cached = false;
 #endif
 
-    int ret;
-
     if (scattered) {
         /* drv use kmalloc to alloc sg memory which means always cached */
         cached = true;
+    }
+
+    m_device = current_device();
+
+    /* reserve the virtual range first, the allocations of the device are mapped into it back to back */
+    const size_t align = hugepage ? HUGE_PAGE_SIZE : PAGE_SIZE_4K;
+    m_reserved_size = align_up(size, align) + align - PAGE_SIZE_4K;
+    m_reserved = ::mmap(NULL, m_reserved_size, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (MAP_FAILED == m_reserved) {
+        LOG_MM_E(TAG, "reserve {} bytes of virtual address fail, {}", m_reserved_size, ::strerror(errno));
+        m_reserved = nullptr;
+        m_reserved_size = 0;
+        return false;
+    }
+
+    uint8_t *base = reinterpret_cast<uint8_t *>(align_up(reinterpret_cast<uintptr_t>(m_reserved), align));
+    if (!(scattered ? alloc_scattered(base, size, hugepage) : alloc_contiguous(base, size, cached, hugepage))) {
+        free();
+        return false;
+    }
+
+    m_mem.scattered = scattered;
+    m_mem.cached = cached;
+    m_mem.total_size = static_cast<uint32_t>(size);
+    m_mem.blk_cnt = coalesce(m_mem.blks);
+    bind_ops();
+
+    return true;
+}
+
+bool dma_buffer::alloc_contiguous(uint8_t *base, size_t size, bool cached, bool hugepage) {
+    int32_t fd = m_device->open();
+    if (fd < 0) {
+        LOG_MM_E(TAG, "open {} fail", AX_MM_DEV);
+        return false;
+    }
+
+    /* owned from now on, free() closes it */
+    m_chunks.push_back({fd, 0, base, 0});
+
+    int ret;
+    uint64_t dma_buffer_size = size;
+    if (cached) {
+        if (ret = m_device->ioctl(fd, AX_IOC_PCIe_ALLOC_MEMCACHED, &dma_buffer_size); ret < 0) {
+            LOG_MM_E(TAG, "allocate pcie cached dma buffer (size: {}) fail, {}", dma_buffer_size, ::strerror(errno));
+            return false;
+        }
+    } else {
+        if (ret = m_device->ioctl(fd, AX_IOC_PCIe_ALLOC_MEMORY, &dma_buffer_size); ret < 0) {
+            LOG_MM_E(TAG, "allocate pcie dma buffer (size: {}) fail, {}", dma_buffer_size, ::strerror(errno));
+            return false;
+        }
+    }
+
+    uint64_t phy = 0;
+    if (ret = m_device->ioctl(fd, AX_IOC_PCIE_DMA_GET_PHY_BASE, &phy); ret < 0) {
+        LOG_MM_E(TAG, "get pcie dma phy address fail, {}", ::strerror(errno));
+        return false;
+    }
+
+    if (0 == phy) {
+        LOG_MM_E(TAG, "allocated dma phy address is 0");
+        return false;
+    }
+
+    m_chunks.back().phy = phy;
+    m_chunks.back().size = size;
+
+    if (!map(fd, base, size, hugepage)) {
+        return false;
+    }
+
+    if (cached) {
+        /* make sure pages have been allocated, and flush is mandatory */
+        ::memset(base, 0xCC, size);
+        if (!sync(AX_IOC_PCIe_FLUSH_CACHED, phy, base, size)) {
+            return false;
+        }
+    }
+
+    m_mem.blks.push_back({phy, base, static_cast<uint32_t>(size)});
+    return true;
+}
+
+bool dma_buffer::alloc_scattered(uint8_t *base, size_t size, bool hugepage) {
+    /* one scatter list allocation returns at most MAX_SG_LIST_ENTRY blocks, take as many as needed */
+    size_t request = std::min(align_up(size, PAGE_SIZE_4K), static_cast<size_t>(INT_MAX) / PAGE_SIZE_4K * PAGE_SIZE_4K);
+    size_t offset = 0;
+    while (offset < size) {
+        const size_t remain = size - offset;
+
+        int32_t fd = m_device->open();
+        if (fd < 0) {
+            LOG_MM_E(TAG, "open {} fail", AX_MM_DEV);
+            return false;
+        }
 
         struct ax_scatterlist sg = {};
-        sg.size = size;
-        if (ret = ::ioctl(fd, AX_IOC_PCIe_SCATTERLIST_ALLOC, &sg); ret < 0) {
-            LOG_MM_E(TAG, "allocate sg buffers (size: {}) fail, {}", size, ::strerror(errno));
-            ::close(fd);
+        sg.size = static_cast<int>(std::min(remain, request));
+        if (int ret = m_device->ioctl(fd, AX_IOC_PCIe_SCATTERLIST_ALLOC, &sg); ret < 0) {
+            m_device->close(fd);
+            if (request > MIN_SG_REQUEST) {
+                request = std::max(MIN_SG_REQUEST, align_up(request / 2, PAGE_SIZE_4K));
+                continue;
+            }
+
+            LOG_MM_E(TAG, "allocate sg buffers (size: {}) fail, {}", sg.size, ::strerror(errno));
             return false;
         }
 
-        if (sg.num <= 0) {
-            LOG_MM_E(TAG, "0 sg buffer is allocated");
-            ::close(fd);
+        m_chunks.push_back({fd, 0, base + offset, 0});
+
+        if (sg.num <= 0 || sg.num > MAX_SG_LIST_ENTRY) {
+            LOG_MM_E(TAG, "{} sg buffer is allocated", sg.num);
             return false;
         }
 
@@ -119,148 +220,148 @@ bool dma_buffer::alloc(size_t size, bool cached /* = false */, bool scattered /*
             if (0 == sg.sg_list[i].phyaddr || 0 == sg.sg_list[i].size) {
                 LOG_MM_E(TAG, "allocated invalid sglist[{}] phy {:#x} size: {:#x}", i, sg.sg_list[i].phyaddr, sg.sg_list[i].size);
                 print_scatterlist(sg);
-                ::close(fd);
                 return false;
             }
 
             total_size += sg.sg_list[i].size;
         }
 
-        if (total_size < size) {
-            LOG_MM_E(TAG, "expected {}, but allocated {}", total_size, size);
+        /* a partial allocation is continued by the next one, which must start at a page */
+        const size_t used = std::min(total_size, remain);
+        if (used < remain && 0 != used % PAGE_SIZE_4K) {
+            LOG_MM_E(TAG, "allocated {} bytes of sg buffers are not page aligned", total_size);
             print_scatterlist(sg);
-            ::close(fd);
             return false;
         }
 
-        m_mem.blk_cnt = sg.num;
+        chunk &c = m_chunks.back();
+        c.phy = sg.sg_list[0].phyaddr;
+        c.size = used;
 
-        void *vir = ::mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
-        if (vir == MAP_FAILED) {
-            LOG_MM_E(TAG, "mmap sg buffers fail, {}", ::strerror(errno));
+        if (!map(fd, c.vir, used, hugepage)) {
             print_scatterlist(sg);
-            ::close(fd);
             return false;
         }
 
         /* make sure pages have been allocated, and flush is mandatory */
-        ::memset(vir, 0xCC, size);
-
-        m_fd = fd;
-        if (!flush(sg.sg_list[0].phyaddr, vir, size)) {
+        ::memset(c.vir, 0xCC, used);
+        if (!sync(AX_IOC_PCIe_FLUSH_CACHED, c.phy, c.vir, used)) {
             print_scatterlist(sg);
-            ::close(fd);
-            m_fd = -1;
             return false;
         }
 
-        uint8_t *base = reinterpret_cast<uint8_t *>(vir);
-        for (int i = 0; i < sg.num; ++i) {
-            struct dma_mem_block &blk = m_mem.blks[i];
-            blk.phy = sg.sg_list[i].phyaddr;
-            blk.vir = reinterpret_cast<void *>(base);
-            blk.size = sg.sg_list[i].size;
-            base += blk.size;
-        }
-    } else {
-        uint64_t dma_buffer_size = size;
-        if (cached) {
-            if (ret = ::ioctl(fd, AX_IOC_PCIe_ALLOC_MEMCACHED, &dma_buffer_size); ret < 0) {
-                LOG_MM_E(TAG, "allocate pcie cached dma buffer (size: {}) fail, {}", dma_buffer_size, ::strerror(errno));
-                ::close(fd);
-                return false;
-            }
-        } else {
-            if (ret = ::ioctl(fd, AX_IOC_PCIe_ALLOC_MEMORY, &dma_buffer_size); ret < 0) {
-                LOG_MM_E(TAG, "allocate pcie dma buffer (size: {}) fail, {}", dma_buffer_size, ::strerror(errno));
-                ::close(fd);
-                return false;
-            }
+        uint8_t *vir = c.vir;
+        size_t left = used;
+        for (int i = 0; i < sg.num && left > 0; ++i) {
+            const uint32_t blk_size = static_cast<uint32_t>(std::min<size_t>(sg.sg_list[i].size, left));
+            m_mem.blks.push_back({sg.sg_list[i].phyaddr, vir, blk_size});
+            vir += blk_size;
+            left -= blk_size;
         }
 
-        uint64_t phy = 0;
-        if (ret = ::ioctl(fd, AX_IOC_PCIE_DMA_GET_PHY_BASE, &phy); ret < 0) {
-            LOG_MM_E(TAG, "get pcie dma phy address fail, {}", ::strerror(errno));
-            ::close(fd);
-            return false;
-        }
+        offset += used;
+    }
 
-        if (0 == phy) {
-            LOG_MM_E(TAG, "allocated dma phy address is 0");
-            ::close(fd);
-            return false;
-        }
+    return true;
+}
 
-        void *vir = ::mmap(NULL, dma_buffer_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
-        if (vir == MAP_FAILED) {
-            LOG_MM_E(TAG, "mmap pcie dma phy address fail, {}", ::strerror(errno));
-            ::close(fd);
-            return false;
-        }
+bool dma_buffer::map(int32_t fd, uint8_t *at, size_t size, bool hugepage) {
+    const size_t length = align_up(size, PAGE_SIZE_4K);
+    void *vir = m_device->mmap(at, length, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0);
+    if (vir == MAP_FAILED) {
+        LOG_MM_E(TAG, "mmap pcie dma buffer (size: {}) fail, {}", size, ::strerror(errno));
+        return false;
+    }
 
-        if (cached) {
-            /* make sure pages have been allocated, and flush is mandatory */
-            ::memset(vir, 0xCC, size);
+    if (hugepage && 0 != ::madvise(at, length, MADV_HUGEPAGE)) {
+        LOG_MM_W(TAG, "mapping of {} bytes takes no huge page, {}", size, ::strerror(errno));
+    }
 
-            m_fd = fd;
-            if (!flush(phy, vir, size)) {
-                ::close(fd);
-                m_fd = -1;
-                return false;
-            }
-        }
+    return true;
+}
 
-        m_mem.blk_cnt = 1;
-        m_mem.blks[0].phy = phy;
-        m_mem.blks[0].vir = vir;
-        m_mem.blks[0].size = size;
+void dma_buffer::free() {
+    if (m_reserved) {
+        /* unmaps all chunks mapped into the reserved range */
+        ::munmap(m_reserved, m_reserved_size);
+        m_reserved = nullptr;
+        m_reserved_size = 0;
     }
 
-    m_fd = fd;
-    m_mem.scattered = scattered;
-    m_mem.cached = cached;
-    m_mem.total_size = size;
-    if (cached) {
+    for (auto &c : m_chunks) {
+        m_device->close(c.fd);
+    }
+
+    m_chunks.clear();
+    m_mem = dma_mem{};
+}
+
+void dma_buffer::bind_ops() {
+    if (m_mem.cached) {
         m_mem.ops.flush = std::bind(&dma_buffer::flush, this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3);
         m_mem.ops.invalidate =
             std::bind(&dma_buffer::invalidate, this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3);
+    } else {
+        m_mem.ops = dma_mem_operation{};
     }
+}
 
-    return true;
+bool dma_buffer::flush(uint64_t phy, void *vir, uint32_t size) {
+    return sync(AX_IOC_PCIe_FLUSH_CACHED, phy, vir, size);
 }
 
-void dma_buffer::free() {
-    if (m_fd > 0) {
-        if (m_mem.blks[0].vir) {
-            ::munmap(m_mem.blks[0].vir, m_mem.total_size);
+bool dma_buffer::invalidate(uint64_t phy, void *vir, uint32_t size) {
+    return sync(AX_IOC_PCIe_INVALID_CACHED, phy, vir, size);
+}
+
+bool dma_buffer::sync(unsigned long cmd, uint64_t phy, void *vir, uint32_t size) {
+    const char *name = (AX_IOC_PCIe_FLUSH_CACHED == cmd) ? "flush" : "invalidate";
+    uint8_t *begin = reinterpret_cast<uint8_t *>(vir);
+    uint8_t *end = begin + size;
+
+    /* a range over several allocations is split, each part goes to the fd owning it */
+    bool found = false;
+    for (auto &c : m_chunks) {
+        uint8_t *lo = std::max(begin, c.vir);
+        uint8_t *hi = std::min(end, c.vir + c.size);
+        if (lo >= hi) {
+            continue;
         }
 
-        ::close(m_fd);
-        m_fd = -1;
+        found = true;
+        struct ax_mem_info mem = {(lo == begin) ? phy : c.phy, reinterpret_cast<uint64_t>(lo), static_cast<uint64_t>(hi - lo)};
+        if (int ret = m_device->ioctl(c.fd, cmd, &mem); ret < 0) {
+            LOG_MM_E(TAG, "{} dma buffer (phy {} vir {} size {}) fail, {}", name, mem.phy, static_cast<void *>(lo), mem.size, ::strerror(errno));
+            return false;
+        }
     }
 
-    m_mem.blk_cnt = 0;
-    m_mem.total_size = 0;
-}
-
-bool dma_buffer::flush(uint64_t phy, void *vir, uint32_t size) {
-    struct ax_mem_info mem = {phy, reinterpret_cast<uint64_t>(vir), size};
-    if (int ret = ::ioctl(m_fd, AX_IOC_PCIe_FLUSH_CACHED, &mem); ret < 0) {
-        LOG_MM_E(TAG, "flush dma buffer (phy {} vir {} size {}) fail, {}", phy, vir, size, ::strerror(errno));
-        return false;
+    if (!found) {
+        LOG_MM_E(TAG, "{} dma buffer (phy {} vir {} size {}) is out of the buffer", name, phy, vir, size);
     }
 
-    return true;
+    return found;
 }
 
-bool dma_buffer::invalidate(uint64_t phy, void *vir, uint32_t size) {
-    struct ax_mem_info mem = {phy, reinterpret_cast<uint64_t>(vir), size};
-    if (int ret = ::ioctl(m_fd, AX_IOC_PCIe_INVALID_CACHED, &mem); ret < 0) {
-        LOG_MM_E(TAG, "invalidate dma buffer (phy {} vir {} size {}) fail, {}", phy, vir, size, ::strerror(errno));
-        return false;
+uint32_t dma_buffer::coalesce(std::vector<struct dma_mem_block> &blks) {
+    if (blks.empty()) {
+        return 0;
     }
 
-    return true;
+    size_t last = 0;
+    for (size_t i = 1; i < blks.size(); ++i) {
+        struct dma_mem_block &prev = blks[last];
+        const struct dma_mem_block &cur = blks[i];
+        if (prev.phy + prev.size == cur.phy && static_cast<uint8_t *>(prev.vir) + prev.size == cur.vir &&
+            static_cast<uint64_t>(prev.size) + cur.size <= UINT32_MAX) {
+            prev.size += cur.size;
+        } else {
+            blks[++last] = cur;
+        }
+    }
+
+    blks.resize(last + 1);
+    return static_cast<uint32_t>(blks.size());
 }
 
 unsigned long dma_buffer::get_cma_free_size() {
@@ -280,4 +381,4 @@ unsigned long dma_buffer::get_cma_free_size() {
 
     fclose(fp);
     return cma_free;
-}
\ No newline at end of file
+}
@@ -13,8 +13,9 @@
 #include <cstddef>
 #include <cstdint>
 #include <functional>
-
-#define MAX_DMA_MEM_BLOCK_NUM (64)
+#include <memory>
+#include <vector>
+#include "mmb_device.hpp"
 
 struct dma_mem_block {
     uint64_t phy = 0;
@@ -27,12 +28,13 @@ struct dma_mem_operation {
     std::function<bool(uint64_t, void *, uint32_t)> invalidate = nullptr;
 };
 
+/* blks are virtually contiguous from blks[0].vir, physically adjacent blocks are merged */
 struct dma_mem {
     bool scattered = false;
     bool cached = false;
     uint32_t total_size = 0;
     uint32_t blk_cnt = 0;
-    struct dma_mem_block blks[MAX_DMA_MEM_BLOCK_NUM];
+    std::vector<struct dma_mem_block> blks;
     struct dma_mem_operation ops;
 };
 
@@ -46,7 +48,12 @@ public:
     dma_buffer(const dma_buffer &) = delete;
     dma_buffer &operator=(const dma_buffer &) = delete;
 
-    [[nodiscard]] bool alloc(size_t size, bool cached = false, bool scattered = false);
+    /**
+     * @brief scattered buffers have no limit of blocks, they take as many scatter list allocations as needed.
+     *        hugepage places the buffer at a 2MB aligned virtual address and asks for huge page mappings,
+     *        the mmb driver decides whether its mappings can use them.
+     */
+    [[nodiscard]] bool alloc(size_t size, bool cached = false, bool scattered = false, bool hugepage = false);
     void free();
 
     [[nodiscard]] bool flush(uint64_t phy, void *vir, uint32_t size);
@@ -59,7 +66,31 @@ public:
     /* get free CMA in kB from /proc/meminfo */
     static unsigned long get_cma_free_size();
 
+    /* merges blocks adjacent both physically and virtually, returns the number of blocks left */
+    static uint32_t coalesce(std::vector<struct dma_mem_block> &blks);
+
+    /* device of the buffers allocated afterwards, nullptr restores /dev/ax_mmb_dev */
+    static void set_device(std::shared_ptr<mmb_device> device);
+
+private:
+    /* one allocation of the device: its fd and where it is mapped */
+    struct chunk {
+        int32_t fd;
+        uint64_t phy;
+        uint8_t *vir;
+        size_t size;
+    };
+
+    bool alloc_contiguous(uint8_t *base, size_t size, bool cached, bool hugepage);
+    bool alloc_scattered(uint8_t *base, size_t size, bool hugepage);
+    bool map(int32_t fd, uint8_t *at, size_t size, bool hugepage);
+    bool sync(unsigned long cmd, uint64_t phy, void *vir, uint32_t size);
+    void bind_ops();
+
 private:
-    int32_t m_fd;
+    std::shared_ptr<mmb_device> m_device;
+    std::vector<chunk> m_chunks;
+    void *m_reserved;
+    size_t m_reserved_size;
     struct dma_mem m_mem;
 };
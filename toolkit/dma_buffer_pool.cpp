@@ -0,0 +1,190 @@
+/**************************************************************************************************
+ *
+ * Copyright (c) 2019-2024 Axera Semiconductor Co., Ltd. All Rights Reserved.
+ *
+ * This source file is the property of Axera Semiconductor Co., Ltd. and
+ * may not be copied or distributed in any isomorphic form without the prior
+ * written consent of Axera Semiconductor Co., Ltd.
+ *
+ **************************************************************************************************/
+
+#include "dma_buffer_pool.hpp"
+#include <algorithm>
+#include "log/logger.hpp"
+
+#define TAG "pcie"
+
+static constexpr uint32_t SLAB_ALIGN = 4096;
+
+dma_buffer_pool::dma_buffer_pool() : m_class_num(0), m_cached(false) {
+}
+
+dma_buffer_pool::~dma_buffer_pool() {
+    deinit();
+}
+
+bool dma_buffer_pool::init(const std::vector<size_class> &classes, bool cached /* = false */, uint32_t region_size /* = 16MB */) {
+    if (m_class_num > 0) {
+        LOG_MM_E(TAG, "dma buffer pool is initialized");
+        return false;
+    }
+
+    if (classes.empty()) {
+        LOG_MM_E(TAG, "no size class");
+        return false;
+    }
+
+    std::vector<size_class> sorted(classes);
+    std::sort(sorted.begin(), sorted.end(), [](const size_class &a, const size_class &b) { return a.size < b.size; });
+
+    /* lay out classes on regions first, regions are constructed in place as dma_buffer binds itself to its ops */
+    m_classes = std::make_unique<slab_class[]>(sorted.size());
+    uint32_t regions = 0;
+    for (size_t i = 0; i < sorted.size(); ++i) {
+        if (0 == sorted[i].size || 0 == sorted[i].count) {
+            LOG_MM_E(TAG, "size class[{}] size {} count {} is invalid", i, sorted[i].size, sorted[i].count);
+            m_classes.reset();
+            return false;
+        }
+
+        slab_class &c = m_classes[i];
+        c.size = (sorted[i].size + SLAB_ALIGN - 1) / SLAB_ALIGN * SLAB_ALIGN;
+        c.count = sorted[i].count;
+        c.slabs_per_region = std::max<uint32_t>(1, std::min<uint32_t>(region_size / c.size, c.count));
+        c.first_region = regions;
+        regions += (c.count + c.slabs_per_region - 1) / c.slabs_per_region;
+    }
+
+    m_regions = std::vector<dma_buffer>(regions);
+    m_class_num = static_cast<uint32_t>(sorted.size());
+
+    for (uint32_t i = 0; i < m_class_num; ++i) {
+        slab_class &c = m_classes[i];
+        for (uint32_t slab = 0; slab < c.count; slab += c.slabs_per_region) {
+            const uint32_t num = std::min(c.slabs_per_region, c.count - slab);
+            dma_buffer &region = m_regions[c.first_region + slab / c.slabs_per_region];
+            if (!region.alloc(static_cast<size_t>(c.size) * num, cached)) {
+                LOG_MM_E(TAG, "alloc region of {} x {} bytes for size class {} fail", num, c.size, c.size);
+                deinit();
+                return false;
+            }
+        }
+
+        /* push all slabs, index 0 ends up on top */
+        c.next = std::make_unique<std::atomic<uint32_t>[]>(c.count);
+        for (uint32_t slab = 0; slab < c.count; ++slab) {
+            c.next[slab].store((slab + 1 < c.count) ? (slab + 2) : 0, std::memory_order_relaxed);
+        }
+        c.head.store(1, std::memory_order_relaxed);
+        c.available.store(c.count, std::memory_order_relaxed);
+
+        LOG_MM_I(TAG, "size class {}: {} slabs on {} regions", c.size, c.count, (c.count + c.slabs_per_region - 1) / c.slabs_per_region);
+    }
+
+    m_cached = m_regions[0].get().cached;
+    return true;
+}
+
+void dma_buffer_pool::deinit() {
+    for (uint32_t i = 0; i < m_class_num; ++i) {
+        const slab_class &c = m_classes[i];
+        if (c.next && c.available.load(std::memory_order_relaxed) != c.count) {
+            LOG_MM_W(TAG, "{} slabs of size class {} are not freed", c.count - c.available.load(std::memory_order_relaxed), c.size);
+        }
+    }
+
+    /* dma_buffer::free() of every region */
+    m_regions.clear();
+    m_classes.reset();
+    m_class_num = 0;
+    m_cached = false;
+}
+
+int32_t dma_buffer_pool::find_class(size_t size) const {
+    for (uint32_t i = 0; i < m_class_num; ++i) {
+        if (size <= m_classes[i].size) {
+            return static_cast<int32_t>(i);
+        }
+    }
+
+    return -1;
+}
+
+bool dma_buffer_pool::alloc(size_t size, dma_slab &slab) {
+    const int32_t cls = find_class(size);
+    if (cls < 0) {
+        LOG_MM_E(TAG, "no size class fits {} bytes", size);
+        return false;
+    }
+
+    slab_class &c = m_classes[cls];
+    uint64_t head = c.head.load(std::memory_order_acquire);
+    uint32_t top;
+    do {
+        top = static_cast<uint32_t>(head);
+        if (0 == top) {
+            return false;
+        }
+
+        /* a stale next is harmless: the tag has moved on and the CAS fails */
+        const uint64_t next = c.next[top - 1].load(std::memory_order_relaxed);
+        if (c.head.compare_exchange_weak(head, ((head >> 32) + 1) << 32 | next, std::memory_order_acquire, std::memory_order_acquire)) {
+            break;
+        }
+    } while (true);
+
+    c.available.fetch_sub(1, std::memory_order_relaxed);
+
+    const uint32_t index = top - 1;
+    const struct dma_mem &mem = m_regions[c.first_region + index / c.slabs_per_region].get();
+    const uint64_t offset = static_cast<uint64_t>(index % c.slabs_per_region) * c.size;
+
+    slab.phy = mem.blks[0].phy + offset;
+    slab.vir = static_cast<uint8_t *>(mem.blks[0].vir) + offset;
+    slab.size = c.size;
+    slab.cls = static_cast<uint32_t>(cls);
+    slab.index = index;
+    return true;
+}
+
+void dma_buffer_pool::free(const dma_slab &slab) {
+    if (slab.cls >= m_class_num || slab.index >= m_classes[slab.cls].count) {
+        LOG_MM_E(TAG, "slab (class {} index {}) does not belong to the pool", slab.cls, slab.index);
+        return;
+    }
+
+    slab_class &c = m_classes[slab.cls];
+    uint64_t head = c.head.load(std::memory_order_relaxed);
+    do {
+        c.next[slab.index].store(static_cast<uint32_t>(head), std::memory_order_relaxed);
+    } while (!c.head.compare_exchange_weak(head, ((head >> 32) + 1) << 32 | (slab.index + 1), std::memory_order_release,
+                                           std::memory_order_relaxed));
+
+    c.available.fetch_add(1, std::memory_order_relaxed);
+}
+
+dma_buffer &dma_buffer_pool::region_of(const dma_slab &slab) {
+    const slab_class &c = m_classes[slab.cls];
+    return m_regions[c.first_region + slab.index / c.slabs_per_region];
+}
+
+bool dma_buffer_pool::flush(const dma_slab &slab) {
+    if (!m_cached) {
+        return true;
+    }
+
+    return region_of(slab).flush(slab.phy, slab.vir, slab.size);
+}
+
+bool dma_buffer_pool::invalidate(const dma_slab &slab) {
+    if (!m_cached) {
+        return true;
+    }
+
+    return region_of(slab).invalidate(slab.phy, slab.vir, slab.size);
+}
+
+uint32_t dma_buffer_pool::available(size_t size) const {
+    const int32_t cls = find_class(size);
+    return (cls < 0) ? 0 : m_classes[cls].available.load(std::memory_order_relaxed);
+}
@@ -0,0 +1,82 @@
+/**************************************************************************************************
+ *
+ * Copyright (c) 2019-2024 Axera Semiconductor Co., Ltd. All Rights Reserved.
+ *
+ * This source file is the property of Axera Semiconductor Co., Ltd. and
+ * may not be copied or distributed in any isomorphic form without the prior
+ * written consent of Axera Semiconductor Co., Ltd.
+ *
+ **************************************************************************************************/
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "dma_buffer.hpp"
+
+/* a fixed size buffer carved out of a dma_buffer_pool region */
+struct dma_slab {
+    uint64_t phy = 0;
+    void *vir = nullptr;
+    uint32_t size = 0; /* slab size of the class, may be larger than requested */
+    uint32_t cls = 0;  /* size class and index in it, used by free() */
+    uint32_t index = 0;
+};
+
+/**
+ * dma_buffer_pool pre-allocates contiguous CMA regions at init and carves them into fixed size slabs,
+ * alloc() and free() are a lock-free pop and push on the free list of a size class, no syscall at all.
+ *  - a request goes to the smallest class whose slab fits it, an exhausted class fails rather than falls back;
+ *  - the driver binds one allocation to one open of the device, so every region keeps its own fd,
+ *    regions are at most region_size bytes so that a big class does not need one huge contiguous block;
+ *  - slabs are page aligned inside a region, cached slabs are flushed / invalidated by flush() / invalidate().
+ */
+class dma_buffer_pool {
+public:
+    struct size_class {
+        uint32_t size;  /* slab size, rounded up to page size */
+        uint32_t count; /* number of slabs */
+    };
+
+    dma_buffer_pool();
+    ~dma_buffer_pool();
+
+    dma_buffer_pool(const dma_buffer_pool &) = delete;
+    dma_buffer_pool &operator=(const dma_buffer_pool &) = delete;
+
+    [[nodiscard]] bool init(const std::vector<size_class> &classes, bool cached = false, uint32_t region_size = 16 * 1024 * 1024);
+    void deinit();
+
+    [[nodiscard]] bool alloc(size_t size, dma_slab &slab);
+    void free(const dma_slab &slab);
+
+    [[nodiscard]] bool flush(const dma_slab &slab);
+    [[nodiscard]] bool invalidate(const dma_slab &slab);
+
+    /* free slabs of the class serving size, 0 if no class fits */
+    uint32_t available(size_t size) const;
+
+private:
+    /* Treiber stack of slab indices, the head packs an ABA tag (high 32 bits) and index + 1 (low 32 bits, 0 is empty) */
+    struct alignas(64) slab_class {
+        uint32_t size = 0;
+        uint32_t count = 0;
+        uint32_t slabs_per_region = 0;
+        uint32_t first_region = 0;
+        std::atomic<uint64_t> head{0};
+        std::atomic<uint32_t> available{0};
+        std::unique_ptr<std::atomic<uint32_t>[]> next;
+    };
+
+    int32_t find_class(size_t size) const;
+    dma_buffer &region_of(const dma_slab &slab);
+
+private:
+    std::vector<dma_buffer> m_regions;
+    std::unique_ptr<slab_class[]> m_classes;
+    uint32_t m_class_num;
+    bool m_cached;
+};
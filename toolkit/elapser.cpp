@@ -11,7 +11,9 @@
 #include "elapser.hpp"
 #include <sys/time.h>
 #include <time.h>
+#include <algorithm>
 #include <thread>
+#include <unordered_set>
 
 #ifdef __AX_HIGH_PRECISION_CLOCK__
 #include "ax_base_type.h"
@@ -86,4 +88,169 @@ void elapser::ax_usleep(uint32_t us) {
 #endif
 }
 
+latency_histogram::latency_histogram() : m_counts(std::make_unique<uint64_t[]>(BUCKETS)) {
+    reset();
+}
+
+void latency_histogram::merge(const latency_histogram &rhs) {
+    for (size_t i = 0; i < BUCKETS; ++i) {
+        m_counts[i] += rhs.m_counts[i];
+    }
+    m_count += rhs.m_count;
+    m_sum += rhs.m_sum;
+    m_min = std::min(m_min, rhs.m_min);
+    m_max = std::max(m_max, rhs.m_max);
+}
+
+void latency_histogram::reset() {
+    std::fill(m_counts.get(), m_counts.get() + BUCKETS, 0);
+    m_count = 0;
+    m_sum = 0;
+    m_min = UINT64_MAX;
+    m_max = 0;
+}
+
+uint64_t latency_histogram::percentile(double percent) const {
+    if (0 == m_count) {
+        return 0;
+    }
+
+    const double exact = std::clamp(percent, 0.0, 100.0) / 100.0 * m_count;
+    uint64_t rank = static_cast<uint64_t>(exact);
+    rank += (rank < exact || 0 == rank) ? 1 : 0;
+
+    uint64_t accumulated = 0;
+    for (size_t i = 0; i < BUCKETS; ++i) {
+        accumulated += m_counts[i];
+        if (accumulated >= rank) {
+            return std::clamp(highest(i), m_min, m_max);
+        }
+    }
+
+    return m_max;
+}
+
+uint64_t latency_histogram::lowest(size_t index) {
+    if (index < (size_t{1} << PRECISION)) {
+        return static_cast<uint64_t>(index);
+    }
+
+    const uint32_t shift = static_cast<uint32_t>(index >> PRECISION) - 1;
+    const uint64_t mantissa = static_cast<uint64_t>(index & ((size_t{1} << PRECISION) - 1)) + (uint64_t{1} << PRECISION);
+    return mantissa << shift;
+}
+
+uint64_t latency_histogram::highest(size_t index) {
+    if (index < (size_t{1} << PRECISION)) {
+        return static_cast<uint64_t>(index);
+    }
+
+    const uint32_t shift = static_cast<uint32_t>(index >> PRECISION) - 1;
+    return lowest(index) + ((uint64_t{1} << shift) - 1);
+}
+
+thread_local std::vector<std::pair<uint64_t, latency_recorder::shard *>> latency_recorder::t_shards;
+
+static std::atomic<uint64_t> g_recorder_id = {0};
+
+/**
+ * ids of live recorders, and how many recorders have been destroyed. a thread drops entries of destroyed recorders
+ * from t_shards when it adds a shard and some recorder has been destroyed since its last drop, so a thread that
+ * records into recorders of streams coming and going keeps only the live ones, and record() does not pay for it.
+ * never freed: a recorder of static storage may be destroyed after this file's statics.
+ */
+struct recorder_registry {
+    std::mutex mtx;
+    std::unordered_set<uint64_t> live;
+    std::atomic<uint64_t> destroyed = {0};
+};
+
+static recorder_registry &registry() {
+    static recorder_registry *r = new recorder_registry;
+    return *r;
+}
+
+static thread_local uint64_t t_destroyed = 0;
+
+latency_recorder::latency_recorder() : m_id(g_recorder_id.fetch_add(1, std::memory_order_relaxed)) {
+    recorder_registry &r = registry();
+    std::lock_guard<std::mutex> lck(r.mtx);
+    r.live.insert(m_id);
+}
+
+latency_recorder::~latency_recorder() {
+    recorder_registry &r = registry();
+    std::lock_guard<std::mutex> lck(r.mtx);
+    r.live.erase(m_id);
+    r.destroyed.fetch_add(1, std::memory_order_relaxed);
+}
+
+void latency_recorder::prune() {
+    recorder_registry &r = registry();
+    if (t_destroyed == r.destroyed.load(std::memory_order_relaxed)) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lck(r.mtx);
+    t_shards.erase(std::remove_if(t_shards.begin(), t_shards.end(),
+                                  [&r](const std::pair<uint64_t, shard *> &entry) { return 0 == r.live.count(entry.first); }),
+                   t_shards.end());
+    t_destroyed = r.destroyed.load(std::memory_order_relaxed);
+}
+
+latency_recorder::shard &latency_recorder::add_shard() {
+    prune();
+
+    auto s = std::make_unique<shard>();
+    s->counts = std::make_unique<std::atomic<uint64_t>[]>(latency_histogram::BUCKETS);
+    for (size_t i = 0; i < latency_histogram::BUCKETS; ++i) {
+        s->counts[i].store(0, std::memory_order_relaxed);
+    }
+
+    shard *p = s.get();
+    {
+        std::lock_guard<std::mutex> lck(m_mtx);
+        m_shards.push_back(std::move(s));
+    }
+
+    t_shards.emplace_back(m_id, p);
+    return *p;
+}
+
+void latency_recorder::snapshot(latency_histogram &out) const {
+    out.reset();
+
+    std::lock_guard<std::mutex> lck(m_mtx);
+    for (const auto &s : m_shards) {
+        for (size_t i = 0; i < latency_histogram::BUCKETS; ++i) {
+            const uint64_t n = s->counts[i].load(std::memory_order_relaxed);
+            out.m_counts[i] += n;
+            out.m_count += n;
+        }
+        out.m_sum += s->sum.load(std::memory_order_relaxed);
+        out.m_min = std::min(out.m_min, s->min.load(std::memory_order_relaxed));
+        out.m_max = std::max(out.m_max, s->max.load(std::memory_order_relaxed));
+    }
+}
+
+void latency_recorder::interval(latency_histogram &out) {
+    latency_histogram now;
+    snapshot(now);
+
+    std::lock_guard<std::mutex> lck(m_mtx);
+    out.reset();
+    for (size_t i = 0; i < latency_histogram::BUCKETS; ++i) {
+        const uint64_t n = now.m_counts[i] - m_last.m_counts[i];
+        if (n > 0) {
+            out.m_counts[i] = n;
+            out.m_min = std::min(out.m_min, latency_histogram::lowest(i));
+            out.m_max = std::max(out.m_max, latency_histogram::highest(i));
+        }
+    }
+    out.m_count = now.m_count - m_last.m_count;
+    out.m_sum = now.m_sum - m_last.m_sum;
+
+    std::swap(m_last, now);
+}
+
 }  // namespace axcl
\ No newline at end of file
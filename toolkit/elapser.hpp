@@ -10,8 +10,12 @@
 
 #pragma once
 
+#include <atomic>
 #include <chrono>
 #include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
 
 namespace axcl {
 
@@ -51,4 +55,161 @@ private:
     clock::time_point m_begin = clock::now();
 };
 
+/**
+ * HDR style log-linear histogram of latencies in nanoseconds: every power of 2 is split into 2^PRECISION linear buckets,
+ * so a value is kept with a relative error below 1/32 in constant memory (15KB), recording is an index and 5 plain updates.
+ * not thread safe, each thread records into its own and they are merged, or see latency_recorder.
+ */
+class latency_histogram {
+    friend class latency_recorder;
+
+public:
+    static constexpr uint32_t PRECISION = 5;
+    static constexpr size_t BUCKETS = static_cast<size_t>(64 - PRECISION + 1) << PRECISION;
+
+    latency_histogram();
+
+    void record(uint64_t ns) {
+        ++m_counts[index(ns)];
+        ++m_count;
+        m_sum += ns;
+        m_min = (ns < m_min) ? ns : m_min;
+        m_max = (ns > m_max) ? ns : m_max;
+    }
+
+    void merge(const latency_histogram &rhs);
+    void reset();
+
+    /* the highest value equivalent to the bucket of the percent ranked value, clamped into [min, max], 0 if empty */
+    uint64_t percentile(double percent) const;
+
+    uint64_t count() const {
+        return m_count;
+    }
+
+    uint64_t min() const {
+        return (0 == m_count) ? 0 : m_min;
+    }
+
+    uint64_t max() const {
+        return m_max;
+    }
+
+    double mean() const {
+        return (0 == m_count) ? 0 : static_cast<double>(m_sum) / m_count;
+    }
+
+    static size_t index(uint64_t ns) {
+        if (ns < (uint64_t{1} << PRECISION)) {
+            return static_cast<size_t>(ns);
+        }
+
+        const uint32_t shift = 63 - static_cast<uint32_t>(__builtin_clzll(ns)) - PRECISION;
+        return (static_cast<size_t>(shift + 1) << PRECISION) + static_cast<size_t>((ns >> shift) - (uint64_t{1} << PRECISION));
+    }
+
+    static uint64_t lowest(size_t index);
+    static uint64_t highest(size_t index);
+
+private:
+    std::unique_ptr<uint64_t[]> m_counts;
+    uint64_t m_count;
+    uint64_t m_sum;
+    uint64_t m_min;
+    uint64_t m_max;
+};
+
+/**
+ * latency_histogram shared by threads: every thread records into a shard of its own, which only that thread writes,
+ * so record() takes no lock and no atomic read-modify-write; a reader merges the shards whenever it likes.
+ *  - snapshot() is everything recorded so far, interval() what was recorded since the previous interval() call,
+ *    so a periodic reporter neither resets nor stops the recording threads;
+ *  - min and max of interval() are bucket bounds, not exact values;
+ *  - shards live as long as the recorder, a thread that exits still counts;
+ *  - a thread keeps an entry per recorder it records into, entries of destroyed recorders are dropped as it meets new ones.
+ */
+class latency_recorder {
+public:
+    latency_recorder();
+    ~latency_recorder();
+
+    latency_recorder(const latency_recorder &) = delete;
+    latency_recorder &operator=(const latency_recorder &) = delete;
+
+    void record(uint64_t ns) {
+        shard &s = local();
+        bump(s.counts[latency_histogram::index(ns)], 1);
+        bump(s.sum, ns);
+        if (ns < s.min.load(std::memory_order_relaxed)) {
+            s.min.store(ns, std::memory_order_relaxed);
+        }
+        if (ns > s.max.load(std::memory_order_relaxed)) {
+            s.max.store(ns, std::memory_order_relaxed);
+        }
+    }
+
+    void snapshot(latency_histogram &out) const;
+    void interval(latency_histogram &out);
+
+private:
+    struct shard {
+        std::unique_ptr<std::atomic<uint64_t>[]> counts; /* the count is their sum, so that it always matches the buckets */
+        std::atomic<uint64_t> sum = {0};
+        std::atomic<uint64_t> min = {UINT64_MAX};
+        std::atomic<uint64_t> max = {0};
+    };
+
+    /* single writer: a load and a store, readers see either the old or the new value */
+    static void bump(std::atomic<uint64_t> &v, uint64_t n) {
+        v.store(v.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+    }
+
+    shard &local() {
+        /* ids are never reused, an entry of a destroyed recorder is never matched again, prune() drops it */
+        for (const auto &entry : t_shards) {
+            if (entry.first == m_id) {
+                return *entry.second;
+            }
+        }
+        return add_shard();
+    }
+
+    shard &add_shard();
+    static void prune();
+
+private:
+    static thread_local std::vector<std::pair<uint64_t, shard *>> t_shards;
+
+    const uint64_t m_id;
+    mutable std::mutex m_mtx;
+    std::vector<std::unique_ptr<shard>> m_shards;
+    latency_histogram m_last; /* snapshot of the previous interval() */
+};
+
+/**
+ * records the time from construction to destruction into a latency_histogram or latency_recorder:
+ *     {
+ *         axcl::scoped_elapser timer(m_send_latency);
+ *         AXCL_VDEC_SendStream(...);
+ *     }
+ */
+template <typename T>
+class scoped_elapser {
+public:
+    explicit scoped_elapser(T &sink) : m_sink(sink), m_begin(std::chrono::steady_clock::now()) {
+    }
+
+    ~scoped_elapser() {
+        m_sink.record(static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - m_begin).count()));
+    }
+
+    scoped_elapser(const scoped_elapser &) = delete;
+    scoped_elapser &operator=(const scoped_elapser &) = delete;
+
+private:
+    T &m_sink;
+    std::chrono::steady_clock::time_point m_begin;
+};
+
 }  // namespace axcl
\ No newline at end of file
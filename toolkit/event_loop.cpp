@@ -0,0 +1,461 @@
+/**************************************************************************************************
+ *
+ * Copyright (c) 2019-2024 Axera Semiconductor Co., Ltd. All Rights Reserved.
+ *
+ * This source file is the property of Axera Semiconductor Co., Ltd. and
+ * may not be copied or distributed in any isomorphic form without the prior
+ * written consent of Axera Semiconductor Co., Ltd.
+ *
+ **************************************************************************************************/
+
+#include "event_loop.hpp"
+#include <pthread.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+#include <time.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#include <future>
+#include "log/logger.hpp"
+
+#define TAG "event_loop"
+
+namespace axcl {
+
+timer_wheel::timer_wheel(uint64_t now) : m_base(now) {
+}
+
+timer_wheel::~timer_wheel() = default;
+
+void timer_wheel::add(uint64_t id, uint64_t expire, uint64_t period, callback cb) {
+    auto t = std::make_unique<timer>();
+    t->id = id;
+    t->expire = expire;
+    t->period = period;
+    t->cb = std::move(cb);
+    t->owner = nullptr;
+
+    insert(t.get());
+    m_timers[id] = std::move(t);
+}
+
+bool timer_wheel::cancel(uint64_t id) {
+    auto it = m_timers.find(id);
+    if (it == m_timers.end()) {
+        return false;
+    }
+
+    if (id == m_running) {
+        /* erased once its callback returns */
+        m_running_cancel = true;
+        return true;
+    }
+
+    unlink(it->second.get());
+    m_timers.erase(it);
+    return true;
+}
+
+void timer_wheel::insert(timer *t) {
+    /* an overdue timer runs on the next tick */
+    uint64_t expire = (t->expire < m_base) ? m_base : t->expire;
+    const uint64_t delta = expire - m_base;
+
+    slot *s = nullptr;
+    if (delta < (uint64_t{1} << ROOT_BITS)) {
+        s = &m_root[expire & ((1 << ROOT_BITS) - 1)];
+    } else {
+        for (uint32_t level = 0; level < LEVELS && !s; ++level) {
+            const uint32_t shift = ROOT_BITS + level * LEVEL_BITS;
+            if (delta < (uint64_t{1} << (shift + LEVEL_BITS))) {
+                s = &m_levels[level][(expire >> shift) & ((1 << LEVEL_BITS) - 1)];
+            }
+        }
+
+        if (!s) {
+            /* out of range: park it in the farthest slot, it is re-inserted from there */
+            constexpr uint32_t shift = ROOT_BITS + (LEVELS - 1) * LEVEL_BITS;
+            expire = m_base + (uint64_t{1} << (shift + LEVEL_BITS)) - 1;
+            s = &m_levels[LEVELS - 1][(expire >> shift) & ((1 << LEVEL_BITS) - 1)];
+        }
+    }
+
+    t->owner = s;
+    t->pos = s->insert(s->end(), t);
+}
+
+void timer_wheel::unlink(timer *t) {
+    if (t->owner) {
+        t->owner->erase(t->pos);
+        t->owner = nullptr;
+    }
+}
+
+void timer_wheel::cascade(uint32_t level) {
+    slot moving;
+    moving.swap(m_levels[level][(m_base >> (ROOT_BITS + level * LEVEL_BITS)) & ((1 << LEVEL_BITS) - 1)]);
+    while (!moving.empty()) {
+        timer *t = moving.front();
+        moving.pop_front();
+        insert(t);
+    }
+}
+
+void timer_wheel::run_tick() {
+    const uint64_t tick = m_base;
+    for (uint32_t level = 0; level < LEVELS; ++level) {
+        /* an upper level cascades when all levels below wrap around */
+        if (0 != (tick & ((uint64_t{1} << (ROOT_BITS + level * LEVEL_BITS)) - 1))) {
+            break;
+        }
+        cascade(level);
+    }
+
+    /* take the slot out first: a timer added by a callback 256 ticks ahead goes into the same slot */
+    slot expired;
+    expired.swap(m_root[tick & ((1 << ROOT_BITS) - 1)]);
+    for (timer *t : expired) {
+        t->owner = &expired;
+    }
+    m_base = tick + 1;
+
+    while (!expired.empty()) {
+        timer *t = expired.front();
+        expired.pop_front();
+        t->owner = nullptr;
+
+        m_running = t->id;
+        m_running_cancel = false;
+        t->cb();
+        m_running = 0;
+
+        if (m_running_cancel || 0 == t->period) {
+            m_timers.erase(t->id);
+        } else {
+            /* fixed rate; a timer late by more than a period restarts from now rather than catching up in a burst */
+            t->expire += t->period;
+            if (t->expire < m_base) {
+                t->expire = m_base;
+            }
+            insert(t);
+        }
+    }
+}
+
+void timer_wheel::advance(uint64_t now) {
+    if (m_timers.empty()) {
+        m_base = (now + 1 > m_base) ? (now + 1) : m_base;
+        return;
+    }
+
+    while (m_base <= now) {
+        run_tick();
+    }
+}
+
+uint64_t timer_wheel::next_expiry() const {
+    if (m_timers.empty()) {
+        return UINT64_MAX;
+    }
+
+    const uint64_t boundary = (m_base | ((1 << ROOT_BITS) - 1)) + 1;
+    for (uint64_t tick = m_base; tick < boundary; ++tick) {
+        if (!m_root[tick & ((1 << ROOT_BITS) - 1)].empty()) {
+            return tick;
+        }
+    }
+
+    return boundary;
+}
+
+event_loop *event_loop::get_instance() {
+    static event_loop instance;
+    static std::once_flag once;
+    std::call_once(once, []() { (void)instance.start("axcl_loop"); });
+    return &instance;
+}
+
+uint64_t event_loop::now_ms() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000 + ts.tv_nsec / 1000000;
+}
+
+event_loop::event_loop() : m_wheel(now_ms()) {
+    m_epoll = epoll_create1(EPOLL_CLOEXEC);
+    m_wakeup = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    m_timer = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (m_epoll < 0 || m_wakeup < 0 || m_timer < 0) {
+        LOG_MM_E(TAG, "create epoll, eventfd or timerfd fail, {}", strerror(errno));
+        return;
+    }
+
+    /* generation 0 marks the loop's own fds, watchers start at 1 */
+    for (int32_t fd : {m_wakeup, m_timer}) {
+        struct epoll_event ev = {};
+        ev.events = EPOLLIN;
+        ev.data.u64 = static_cast<uint32_t>(fd);
+        if (0 != epoll_ctl(m_epoll, EPOLL_CTL_ADD, fd, &ev)) {
+            LOG_MM_E(TAG, "watch fd {} fail, {}", fd, strerror(errno));
+        }
+    }
+}
+
+event_loop::~event_loop() {
+    stop();
+
+    for (int32_t fd : {m_epoll, m_wakeup, m_timer}) {
+        if (fd >= 0) {
+            close(fd);
+        }
+    }
+}
+
+bool event_loop::start(const std::string &name) {
+    if (m_epoll < 0 || m_wakeup < 0 || m_timer < 0) {
+        return false;
+    }
+
+    if (m_running) {
+        LOG_MM_W(TAG, "event loop {} is already started", name);
+        return true;
+    }
+
+    m_running = true;
+    m_thread = std::thread([this, name]() {
+        pthread_setname_np(pthread_self(), name.substr(0, 15).c_str());
+        run();
+    });
+
+    return true;
+}
+
+void event_loop::stop() {
+    if (!m_thread.joinable()) {
+        return;
+    }
+
+    if (in_loop()) {
+        LOG_MM_E(TAG, "stop event loop on its own thread");
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lck(m_mtx);
+        m_running = false;
+    }
+
+    wakeup();
+    m_thread.join();
+
+    /* tasks posted before the loop was stopped, invoke() waits on them */
+    drain_tasks();
+}
+
+void event_loop::post(task t) {
+    {
+        std::lock_guard<std::mutex> lck(m_mtx);
+        m_tasks.push_back(std::move(t));
+    }
+
+    /* on the loop thread tasks are drained before it waits again */
+    if (!in_loop()) {
+        wakeup();
+    }
+}
+
+void event_loop::invoke(const task &t) {
+    if (in_loop()) {
+        t();
+        return;
+    }
+
+    /* shared, the loop may still be inside set_value() when the caller wakes up and returns */
+    auto done = std::make_shared<std::promise<void>>();
+    std::future<void> result = done->get_future();
+    {
+        std::unique_lock<std::mutex> lck(m_mtx);
+        if (!m_running) {
+            lck.unlock();
+            t();
+            return;
+        }
+
+        m_tasks.push_back([&t, done]() {
+            t();
+            done->set_value();
+        });
+    }
+
+    wakeup();
+    result.wait();
+}
+
+bool event_loop::add_fd(int32_t fd, uint32_t events, fd_callback cb) {
+    bool ok = false;
+    invoke([&]() {
+        if (m_watchers.end() != m_watchers.find(fd)) {
+            LOG_MM_E(TAG, "fd {} is already watched", fd);
+            return;
+        }
+
+        auto w = std::make_shared<watcher>();
+        w->generation = (0 == ++m_generation) ? ++m_generation : m_generation;
+        w->cb = std::move(cb);
+
+        struct epoll_event ev = {};
+        ev.events = events;
+        ev.data.u64 = (static_cast<uint64_t>(w->generation) << 32) | static_cast<uint32_t>(fd);
+        if (0 != epoll_ctl(m_epoll, EPOLL_CTL_ADD, fd, &ev)) {
+            LOG_MM_E(TAG, "watch fd {} fail, {}", fd, strerror(errno));
+            return;
+        }
+
+        m_watchers[fd] = std::move(w);
+        ok = true;
+    });
+
+    return ok;
+}
+
+bool event_loop::modify_fd(int32_t fd, uint32_t events) {
+    bool ok = false;
+    invoke([&]() {
+        auto it = m_watchers.find(fd);
+        if (m_watchers.end() == it) {
+            LOG_MM_E(TAG, "fd {} is not watched", fd);
+            return;
+        }
+
+        struct epoll_event ev = {};
+        ev.events = events;
+        ev.data.u64 = (static_cast<uint64_t>(it->second->generation) << 32) | static_cast<uint32_t>(fd);
+        if (0 != epoll_ctl(m_epoll, EPOLL_CTL_MOD, fd, &ev)) {
+            LOG_MM_E(TAG, "modify fd {} fail, {}", fd, strerror(errno));
+            return;
+        }
+
+        ok = true;
+    });
+
+    return ok;
+}
+
+void event_loop::remove_fd(int32_t fd) {
+    invoke([&]() {
+        auto it = m_watchers.find(fd);
+        if (m_watchers.end() != it) {
+            (void)epoll_ctl(m_epoll, EPOLL_CTL_DEL, fd, nullptr);
+            m_watchers.erase(it);
+        }
+    });
+}
+
+uint64_t event_loop::add_timer(uint32_t delay_ms, uint32_t period_ms, timer_callback cb) {
+    const uint64_t id = ++m_timer_id;
+    const uint64_t expire = now_ms() + delay_ms;
+    if (in_loop()) {
+        /* added right away, so that a callback can cancel what it just added */
+        m_wheel.add(id, expire, period_ms, std::move(cb));
+        arm_timer();
+    } else {
+        post([this, id, expire, period_ms, cb = std::move(cb)]() {
+            m_wheel.add(id, expire, period_ms, cb);
+            arm_timer();
+        });
+    }
+
+    return id;
+}
+
+void event_loop::cancel_timer(uint64_t id) {
+    invoke([&]() {
+        (void)m_wheel.cancel(id);
+        arm_timer();
+    });
+}
+
+void event_loop::run() {
+    struct epoll_event events[32];
+    while (m_running) {
+        int32_t timeout = -1;
+        {
+            std::lock_guard<std::mutex> lck(m_mtx);
+            timeout = m_tasks.empty() ? -1 : 0;
+        }
+
+        const int32_t n = epoll_wait(m_epoll, events, sizeof(events) / sizeof(events[0]), timeout);
+        if (n < 0 && EINTR != errno) {
+            LOG_MM_E(TAG, "epoll_wait fail, {}", strerror(errno));
+            break;
+        }
+
+        for (int32_t i = 0; i < n; ++i) {
+            const int32_t fd = static_cast<int32_t>(events[i].data.u64 & 0xFFFFFFFF);
+            const uint32_t generation = static_cast<uint32_t>(events[i].data.u64 >> 32);
+            if (0 == generation) {
+                uint64_t value;
+                (void)!read(fd, &value, sizeof(value));
+                if (fd == m_timer) {
+                    m_armed = UINT64_MAX;
+                }
+                continue;
+            }
+
+            /* the fd may be removed, or removed and added again, by a callback before it in this batch */
+            auto it = m_watchers.find(fd);
+            if (m_watchers.end() == it || it->second->generation != generation) {
+                continue;
+            }
+
+            std::shared_ptr<watcher> w = it->second;
+            w->cb(events[i].events);
+        }
+
+        drain_tasks();
+        m_wheel.advance(now_ms());
+        arm_timer();
+    }
+}
+
+void event_loop::wakeup() {
+    const uint64_t one = 1;
+    (void)!write(m_wakeup, &one, sizeof(one));
+}
+
+void event_loop::drain_tasks() {
+    std::vector<task> tasks;
+    {
+        std::lock_guard<std::mutex> lck(m_mtx);
+        tasks.swap(m_tasks);
+    }
+
+    for (auto &t : tasks) {
+        t();
+    }
+}
+
+void event_loop::arm_timer() {
+    const uint64_t next = m_wheel.next_expiry();
+    if (next == m_armed) {
+        return;
+    }
+
+    m_armed = next;
+    struct itimerspec its = {};
+    if (UINT64_MAX != next) {
+        its.it_value.tv_sec = static_cast<time_t>(next / 1000);
+        its.it_value.tv_nsec = static_cast<long>(next % 1000) * 1000000;
+        if (0 == its.it_value.tv_sec && 0 == its.it_value.tv_nsec) {
+            its.it_value.tv_nsec = 1;
+        }
+    }
+
+    if (0 != timerfd_settime(m_timer, TFD_TIMER_ABSTIME, &its, nullptr)) {
+        LOG_MM_E(TAG, "arm timerfd at {}ms fail, {}", next, strerror(errno));
+    }
+}
+
+}  // namespace axcl
@@ -0,0 +1,168 @@
+/**************************************************************************************************
+ *
+ * Copyright (c) 2019-2024 Axera Semiconductor Co., Ltd. All Rights Reserved.
+ *
+ * This source file is the property of Axera Semiconductor Co., Ltd. and
+ * may not be copied or distributed in any isomorphic form without the prior
+ * written consent of Axera Semiconductor Co., Ltd.
+ *
+ **************************************************************************************************/
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+/* the shared loop is one per process, exported for the same reason as the metrics registry */
+#define AXCL_LOOP_API __attribute__((visibility("default")))
+
+namespace axcl {
+
+/**
+ * hierarchical timer wheel of 1ms ticks: 256 slots of 1ms, then 3 levels of 64 slots of 256ms, 16.4s and 17.5min,
+ * add and cancel are O(1), a timer is moved down a level at most 3 times; beyond 18.6h a timer stays in the last level
+ * and is re-inserted until it is due. not thread safe, it is driven by event_loop on its own thread.
+ */
+class timer_wheel {
+public:
+    using callback = std::function<void()>;
+
+    explicit timer_wheel(uint64_t now);
+    ~timer_wheel();
+
+    timer_wheel(const timer_wheel &) = delete;
+    timer_wheel &operator=(const timer_wheel &) = delete;
+
+    /* due at tick expire (run on the next tick if already passed), then every period ticks if period > 0 */
+    void add(uint64_t id, uint64_t expire, uint64_t period, callback cb);
+    bool cancel(uint64_t id);
+
+    /* runs every timer due up to now, a callback may add or cancel timers, itself included */
+    void advance(uint64_t now);
+
+    /* tick to wake up at: the first due timer, or the next cascade of an upper level; UINT64_MAX if there is no timer */
+    uint64_t next_expiry() const;
+
+    size_t size() const {
+        return m_timers.size();
+    }
+
+private:
+    struct timer;
+    using slot = std::list<timer *>;
+
+    struct timer {
+        uint64_t id;
+        uint64_t expire;
+        uint64_t period;
+        callback cb;
+        slot *owner;
+        slot::iterator pos;
+    };
+
+    static constexpr uint32_t ROOT_BITS = 8;
+    static constexpr uint32_t LEVEL_BITS = 6;
+    static constexpr uint32_t LEVELS = 3;
+
+    void insert(timer *t);
+    void unlink(timer *t);
+    void cascade(uint32_t level);
+    void run_tick();
+
+private:
+    uint64_t m_base; /* next tick to run */
+    slot m_root[1 << ROOT_BITS];
+    slot m_levels[LEVELS][1 << LEVEL_BITS];
+    std::unordered_map<uint64_t, std::unique_ptr<timer>> m_timers;
+    uint64_t m_running = 0;       /* id of the timer whose callback runs, 0 if none */
+    bool m_running_cancel = false; /* it cancelled itself */
+};
+
+/**
+ * epoll loop on one thread for fds, timers and tasks posted from other threads, so that periodic and I/O driven
+ * work needs no sleeping thread of its own:
+ *  - fds are watched by epoll, timers by a timer_wheel armed on a timerfd, posted tasks wake the loop by an eventfd;
+ *  - every callback runs on the loop thread, one at a time, so a callback must not block;
+ *  - add_fd / modify_fd / remove_fd / cancel_timer called off the loop wait until the loop has done them, after
+ *    remove_fd or cancel_timer returns the callback is not running and does not run again;
+ *  - get_instance() is a loop shared by the process, started on first use.
+ */
+class AXCL_LOOP_API event_loop {
+public:
+    using task = std::function<void()>;
+    using fd_callback = std::function<void(uint32_t events)>;
+    using timer_callback = std::function<void()>;
+
+    static event_loop *get_instance();
+
+    event_loop();
+    ~event_loop();
+
+    event_loop(const event_loop &) = delete;
+    event_loop &operator=(const event_loop &) = delete;
+
+    bool start(const std::string &name);
+
+    /* joins the loop thread, tasks posted before still run; fds and timers stay registered for the next start() */
+    void stop();
+
+    bool in_loop() const {
+        return std::this_thread::get_id() == m_thread.get_id();
+    }
+
+    /* runs t on the loop thread later, in the order posted */
+    void post(task t);
+
+    /* runs t on the loop thread and waits for it, runs it right away on the loop thread or if the loop is not started */
+    void invoke(const task &t);
+
+    /* events of epoll (EPOLLIN, EPOLLOUT ...), the callback gets the events that happened */
+    bool add_fd(int32_t fd, uint32_t events, fd_callback cb);
+    bool modify_fd(int32_t fd, uint32_t events);
+    void remove_fd(int32_t fd);
+
+    /* first run after delay_ms, then every period_ms if period_ms > 0; ids are never 0 */
+    uint64_t add_timer(uint32_t delay_ms, uint32_t period_ms, timer_callback cb);
+    void cancel_timer(uint64_t id);
+
+    /* CLOCK_MONOTONIC in ms, the clock of timers */
+    static uint64_t now_ms();
+
+private:
+    struct watcher {
+        uint32_t generation;
+        fd_callback cb;
+    };
+
+    void run();
+    void wakeup();
+    void drain_tasks();
+    void arm_timer();
+
+private:
+    int32_t m_epoll = -1;
+    int32_t m_wakeup = -1; /* eventfd */
+    int32_t m_timer = -1;  /* timerfd */
+    std::thread m_thread;
+    std::atomic<bool> m_running = {false};
+
+    std::mutex m_mtx;
+    std::vector<task> m_tasks;
+
+    /* below only touched on the loop thread */
+    std::unordered_map<int32_t, std::shared_ptr<watcher>> m_watchers;
+    uint32_t m_generation = 0;
+    timer_wheel m_wheel;
+    uint64_t m_armed = UINT64_MAX;
+    std::atomic<uint64_t> m_timer_id = {0};
+};
+
+}  // namespace axcl
@@ -0,0 +1,98 @@
+/**************************************************************************************************
+ *
+ * Copyright (c) 2019-2024 Axera Semiconductor Co., Ltd. All Rights Reserved.
+ *
+ * This source file is the property of Axera Semiconductor Co., Ltd. and
+ * may not be copied or distributed in any isomorphic form without the prior
+ * written consent of Axera Semiconductor Co., Ltd.
+ *
+ **************************************************************************************************/
+
+#include "fake_mmb_device.hpp"
+#include <errno.h>
+#include <sys/mman.h>
+#include <algorithm>
+
+/* physical addresses start above 4GB like the card window on the host, gaps keep separate allocations apart */
+static constexpr uint64_t FAKE_PHY_BASE = 0x100000000ULL;
+static constexpr uint64_t FAKE_PHY_GAP = 0x1000;
+
+fake_mmb_device::fake_mmb_device(uint32_t sg_block_size /* = 1MB */, uint32_t adjacent_run /* = 4 */)
+    : m_next_phy(FAKE_PHY_BASE), m_sg_block_size(std::max<uint32_t>(sg_block_size, 4096)), m_adjacent_run(std::max<uint32_t>(adjacent_run, 1)) {
+}
+
+int32_t fake_mmb_device::open() {
+    return ::memfd_create("fake_mmb", MFD_CLOEXEC);
+}
+
+int32_t fake_mmb_device::close(int32_t fd) {
+    {
+        std::lock_guard<std::mutex> lck(m_mtx);
+        m_phys.erase(fd);
+    }
+
+    return ::close(fd);
+}
+
+int32_t fake_mmb_device::ioctl(int32_t fd, unsigned long cmd, void *arg) {
+    switch (cmd) {
+        case AX_IOC_PCIe_ALLOC_MEMORY:
+        case AX_IOC_PCIe_ALLOC_MEMCACHED: {
+            const uint64_t size = *static_cast<uint64_t *>(arg);
+            if (0 != ::ftruncate(fd, size)) {
+                return -1;
+            }
+
+            std::lock_guard<std::mutex> lck(m_mtx);
+            m_phys[fd] = m_next_phy;
+            m_next_phy += (size + FAKE_PHY_GAP - 1) / FAKE_PHY_GAP * FAKE_PHY_GAP + FAKE_PHY_GAP;
+            return 0;
+        }
+        case AX_IOC_PCIE_DMA_GET_PHY_BASE: {
+            std::lock_guard<std::mutex> lck(m_mtx);
+            auto it = m_phys.find(fd);
+            if (m_phys.end() == it) {
+                errno = EINVAL;
+                return -1;
+            }
+
+            *static_cast<uint64_t *>(arg) = it->second;
+            return 0;
+        }
+        case AX_IOC_PCIe_SCATTERLIST_ALLOC: {
+            struct ax_scatterlist *sg = static_cast<struct ax_scatterlist *>(arg);
+            if (sg->size <= 0) {
+                errno = EINVAL;
+                return -1;
+            }
+
+            const uint64_t blocks = (static_cast<uint64_t>(sg->size) + m_sg_block_size - 1) / m_sg_block_size;
+            sg->num = static_cast<int>(std::min<uint64_t>(blocks, MAX_SG_LIST_ENTRY));
+            if (0 != ::ftruncate(fd, static_cast<off_t>(sg->num) * m_sg_block_size)) {
+                return -1;
+            }
+
+            std::lock_guard<std::mutex> lck(m_mtx);
+            for (int i = 0; i < sg->num; ++i) {
+                if (0 == i % m_adjacent_run) {
+                    m_next_phy += FAKE_PHY_GAP;
+                }
+
+                sg->sg_list[i].phyaddr = m_next_phy;
+                sg->sg_list[i].virtaddr = 0;
+                sg->sg_list[i].size = m_sg_block_size;
+                m_next_phy += m_sg_block_size;
+            }
+            return 0;
+        }
+        case AX_IOC_PCIe_FLUSH_CACHED:
+            m_flushes.fetch_add(1, std::memory_order_relaxed);
+            return 0;
+        case AX_IOC_PCIe_INVALID_CACHED:
+            m_invalidates.fetch_add(1, std::memory_order_relaxed);
+            return 0;
+        default:
+            errno = ENOTTY;
+            return -1;
+    }
+}
@@ -0,0 +1,49 @@
+/**************************************************************************************************
+ *
+ * Copyright (c) 2019-2024 Axera Semiconductor Co., Ltd. All Rights Reserved.
+ *
+ * This source file is the property of Axera Semiconductor Co., Ltd. and
+ * may not be copied or distributed in any isomorphic form without the prior
+ * written consent of Axera Semiconductor Co., Ltd.
+ *
+ **************************************************************************************************/
+
+#pragma once
+
+#include <atomic>
+#include <mutex>
+#include <unordered_map>
+#include "mmb_device.hpp"
+
+/**
+ * fake mmb device on memfd, runs dma_buffer and dma_buffer_pool on a host without card:
+ *  - an allocation gets a made-up physical address, the memory behind is a memfd mapped as usual;
+ *  - a scatter list allocation returns blocks of sg_block_size, at most MAX_SG_LIST_ENTRY of them, so large buffers
+ *    take several allocations; every adjacent_run blocks are physically adjacent, then a gap follows;
+ *  - flush and invalidate only count the calls.
+ */
+class fake_mmb_device : public mmb_device {
+public:
+    explicit fake_mmb_device(uint32_t sg_block_size = 1024 * 1024, uint32_t adjacent_run = 4);
+
+    int32_t open() override;
+    int32_t close(int32_t fd) override;
+    int32_t ioctl(int32_t fd, unsigned long cmd, void *arg) override;
+
+    uint64_t flushes() const {
+        return m_flushes.load(std::memory_order_relaxed);
+    }
+
+    uint64_t invalidates() const {
+        return m_invalidates.load(std::memory_order_relaxed);
+    }
+
+private:
+    std::mutex m_mtx;
+    std::unordered_map<int32_t, uint64_t> m_phys; /* fd -> phy of a contiguous allocation */
+    uint64_t m_next_phy;
+    uint32_t m_sg_block_size;
+    uint32_t m_adjacent_run;
+    std::atomic<uint64_t> m_flushes{0};
+    std::atomic<uint64_t> m_invalidates{0};
+};
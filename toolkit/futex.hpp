@@ -0,0 +1,84 @@
+/**************************************************************************************************
+ *
+ * Copyright (c) 2019-2024 Axera Semiconductor Co., Ltd. All Rights Reserved.
+ *
+ * This source file is the property of Axera Semiconductor Co., Ltd. and
+ * may not be copied or distributed in any isomorphic form without the prior
+ * written consent of Axera Semiconductor Co., Ltd.
+ *
+ **************************************************************************************************/
+
+#pragma once
+
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <atomic>
+#include <cerrno>
+#include <climits>
+#include <cstdint>
+#include <ctime>
+
+namespace axcl {
+
+static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t) && std::atomic<uint32_t>::is_always_lock_free, "futex word must be a plain 32 bits");
+
+/**
+ * sleeps while 'word' still holds 'expected', until futex_wake or timeout_ms (< 0: infinite).
+ * returns false only on timeout, a changed word or a spurious wakeup return true, so callers recheck their condition.
+ */
+inline bool futex_wait(std::atomic<uint32_t>& word, uint32_t expected, int32_t timeout_ms = -1) {
+    struct timespec ts;
+    struct timespec* pts = nullptr;
+    if (timeout_ms >= 0) {
+        ts.tv_sec = timeout_ms / 1000;
+        ts.tv_nsec = (timeout_ms % 1000) * 1000000L;
+        pts = &ts;
+    }
+
+    long ret = syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAIT_PRIVATE, expected, pts, nullptr, 0);
+    return !(0 != ret && ETIMEDOUT == errno);
+}
+
+inline void futex_wake(std::atomic<uint32_t>& word, int32_t count = INT_MAX) {
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAKE_PRIVATE, count, nullptr, nullptr, 0);
+}
+
+/**
+ * eventcount over a futex word: bit 0 tells threads sleep on it, the rest is an epoch bumped to wake them up.
+ *   waiter:   key = prepare_wait(); if (!condition()) wait(key);
+ *   notifier: make condition() true; notify();
+ * notify only enters the kernel when somebody sleeps, and clears the flag, so the following notifies stay in user space.
+ */
+class alignas(64) futex_eventcount {
+public:
+    uint32_t prepare_wait(void) {
+        const uint32_t key = m_word.fetch_or(1, std::memory_order_relaxed) | 1;
+        /* pairs with the fence in notify(): either the waiter sees the condition, or the notifier sees the flag */
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        return key;
+    }
+
+    bool wait(uint32_t key, int32_t timeout_ms = -1) {
+        return futex_wait(m_word, key, timeout_ms);
+    }
+
+    void notify(void) {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        uint32_t word = m_word.load(std::memory_order_relaxed);
+        if (0 != (word & 1) && m_word.compare_exchange_strong(word, (word + 2) & ~1u, std::memory_order_release, std::memory_order_relaxed)) {
+            futex_wake(m_word);
+        }
+    }
+
+    /* wakes up all the waiters, even the ones between prepare_wait() and wait() */
+    void broadcast(void) {
+        m_word.fetch_add(2, std::memory_order_release);
+        futex_wake(m_word);
+    }
+
+private:
+    std::atomic<uint32_t> m_word{0};
+};
+
+}  // namespace axcl
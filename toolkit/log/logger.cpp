@@ -11,12 +11,73 @@
 #include "logger.hpp"
 #include <spdlog/sinks/rotating_file_sink.h>
 #include <spdlog/sinks/stdout_color_sinks.h>
+#include <atomic>
 #include <chrono>
 #include <iostream>
+#include <thread>
 #include <vector>
+#include "mpmc_queue.hpp"
 #include "spdlog/async.h"
 
 #define LOGGER_NAME "axcl_logger"
+#define DEFERRED_NAME "axcl_deferred"
+
+namespace {
+
+/* formats the records of logger::defer() and writes them to the sinks of the logger, started by the first deferred call */
+class deferred_writer {
+public:
+    explicit deferred_writer(spdlog::logger *logger) : m_logger(logger), m_queue(8192, axcl::mpmc_overflow::drop_oldest) {
+        m_thread = std::thread([this]() {
+            pthread_setname_np(pthread_self(), DEFERRED_NAME);
+            axcl::logger::deferred_record rec;
+            /* pop returns false only on an empty queue after wakeup(), so records pushed before exit are written */
+            while (m_queue.pop(rec)) {
+                write(rec);
+            }
+        });
+    }
+
+    ~deferred_writer() {
+        m_queue.wakeup();
+        m_thread.join();
+    }
+
+    void post(const axcl::logger::deferred_record &rec) {
+        (void)m_queue.push(rec);
+    }
+
+private:
+    void write(const axcl::logger::deferred_record &rec) {
+        spdlog::memory_buf_t buf;
+        try {
+            rec.format(rec, buf);
+        } catch (const std::exception &e) {
+            buf.clear();
+            fmt::format_to(std::back_inserter(buf), "deferred log \"{}\" format fail: {}", rec.fmt, e.what());
+        }
+
+        spdlog::details::log_msg msg(rec.time, spdlog::source_loc{}, m_logger->name(), rec.level, spdlog::string_view_t(buf.data(), buf.size()));
+        msg.thread_id = rec.thread_id;
+
+        const bool flush = (rec.level >= m_logger->flush_level());
+        for (auto &sink : m_logger->sinks()) {
+            if (sink->should_log(rec.level)) {
+                sink->log(msg);
+                if (flush) {
+                    sink->flush();
+                }
+            }
+        }
+    }
+
+private:
+    spdlog::logger *m_logger;
+    axcl::mpmc_queue<axcl::logger::deferred_record> m_queue;
+    std::thread m_thread;
+};
+
+}  // namespace
 
 axcl::logger::logger(std::string log_path, std::size_t max_size, std::size_t max_num) noexcept {
     m_logger = spdlog::get(LOGGER_NAME);
@@ -52,6 +113,11 @@ axcl::logger::logger(std::string log_path, std::size_t max_size, std::size_t max
 axcl::logger::~logger() {
 }
 
+void axcl::logger::post(const deferred_record &rec) {
+    static deferred_writer writer(instance());
+    writer.post(rec);
+}
+
 void axcl::logger::flush_every(uint32_t seconds) {
     spdlog::flush_every(std::chrono::seconds(seconds));
 }
@@ -17,8 +17,21 @@
 #define SPDLOG_COMPILED_LIB
 #endif
 
+#include "spdlog/details/os.h"
 #include "spdlog/spdlog.h"
+#include <cstring>
+#include <iterator>
 #include <string>
+#include <tuple>
+#include <type_traits>
+
+/**
+ * compile-time minimum level, 0 (trace) .. 6 (off) as logger::get_level(): calls below it are compiled out together with
+ * their arguments, e.g. -DAXCL_LOG_ACTIVE_LEVEL=2 strips LOG_M_D and LOG_MM_D of a release build.
+ */
+#ifndef AXCL_LOG_ACTIVE_LEVEL
+#define AXCL_LOG_ACTIVE_LEVEL 0
+#endif
 
 namespace axcl {
 
@@ -30,9 +43,77 @@ public:
         return instance.m_logger.get();
     }
 
+    /* get_instance() of the default settings, without building the default path string per call */
+    static spdlog::logger *instance() {
+        static spdlog::logger *const s_logger = get_instance();
+        return s_logger;
+    }
+
     static void flush_every(uint32_t seconds);
     static spdlog::level::level_enum get_level(int32_t lv);
 
+    /* a log record whose arguments are copied raw by the caller, formatting is left to the deferred thread */
+    struct deferred_record {
+        static constexpr size_t ARGS_SIZE = 192;
+
+        void (*format)(const deferred_record &rec, spdlog::memory_buf_t &out);
+        spdlog::level::level_enum level;
+        spdlog::string_view_t fmt;
+        spdlog::log_clock::time_point time;
+        size_t thread_id;
+        alignas(8) unsigned char args[ARGS_SIZE];
+    };
+
+    /**
+     * LOG_MM_DEFER_x: the caller only copies the format string and the arguments into a record and pushes it to a lock-free queue,
+     * the record is formatted and written to the sinks on a thread of its own, with the time and thread id of the caller.
+     *  - arguments must be trivially copyable (integers, enums, pointers ...), std::string and the like do not compile;
+     *  - pointers are copied, not what they point to: const char * must be a literal (tag, __func__) or outlive the record;
+     *  - when the queue is full the oldest record is dropped, as the async logger does.
+     */
+    template <typename... Args>
+    static void defer(spdlog::level::level_enum level, spdlog::format_string_t<Args...> fmt, Args &&...args) {
+        static_assert((std::is_trivially_copyable_v<std::decay_t<Args>> && ...), "deferred log arguments are copied raw, use LOG_MM_x");
+        static_assert((sizeof(std::decay_t<Args>) + ... + 0) <= deferred_record::ARGS_SIZE, "too many deferred log arguments");
+
+        deferred_record rec;
+        rec.format = &format_deferred<std::decay_t<Args>...>;
+        rec.level = level;
+        rec.fmt = fmt.get();
+        rec.time = spdlog::log_clock::now();
+        rec.thread_id = spdlog::details::os::thread_id();
+
+        unsigned char *p = rec.args;
+        (put_arg<std::decay_t<Args>>(p, args), ...);
+        post(rec);
+    }
+
+private:
+    template <typename T>
+    static void put_arg(unsigned char *&p, const T &v) {
+        std::memcpy(p, &v, sizeof(T));
+        p += sizeof(T);
+    }
+
+    template <typename T>
+    static T get_arg(const unsigned char *&p) {
+        T v;
+        std::memcpy(&v, p, sizeof(T));
+        p += sizeof(T);
+        return v;
+    }
+
+    template <typename... Ts>
+    static void format_deferred(const deferred_record &rec, spdlog::memory_buf_t &out) {
+        const unsigned char *p = rec.args;
+        (void)p;
+        /* braced init evaluates get_arg left to right, in the order put_arg wrote them */
+        std::tuple<Ts...> args{get_arg<Ts>(p)...};
+        std::apply([&rec, &out](const Ts &...v) { fmt::format_to(std::back_inserter(out), fmt::runtime(rec.fmt), v...); }, args);
+    }
+
+    static void post(const deferred_record &rec);
+
 private:
     logger(std::string log_path, std::size_t max_size, std::size_t max_num) noexcept;
     ~logger();
@@ -45,16 +126,41 @@ private:
 
 }  // namespace axcl
 
-#define AXCL_LOGGER axcl::logger::get_instance()
+#define AXCL_LOGGER axcl::logger::instance()
+
+/* the level is checked at compile time first, then at runtime, the arguments are only evaluated when the message is logged */
+#define AXCL_LOG(lv, fmt, ...)                                                   \
+    do {                                                                         \
+        if constexpr (static_cast<int>(lv) >= AXCL_LOG_ACTIVE_LEVEL) {           \
+            spdlog::logger *axcl_logger_ = AXCL_LOGGER;                          \
+            if (axcl_logger_->should_log(lv)) {                                  \
+                axcl_logger_->log(lv, fmt, ##__VA_ARGS__);                       \
+            }                                                                    \
+        }                                                                        \
+    } while (0)
+
+#define AXCL_LOG_DEFER(lv, fmt, ...)                                             \
+    do {                                                                         \
+        if constexpr (static_cast<int>(lv) >= AXCL_LOG_ACTIVE_LEVEL) {           \
+            if (AXCL_LOGGER->should_log(lv)) {                                   \
+                axcl::logger::defer(lv, fmt, ##__VA_ARGS__);                     \
+            }                                                                    \
+        }                                                                        \
+    } while (0)
+
+#define LOG_M_D(tag, fmt, ...)  AXCL_LOG(spdlog::level::debug,    "[{}]: " fmt, tag, ##__VA_ARGS__)
+#define LOG_M_I(tag, fmt, ...)  AXCL_LOG(spdlog::level::info,     "[{}]: " fmt, tag, ##__VA_ARGS__)
+#define LOG_M_W(tag, fmt, ...)  AXCL_LOG(spdlog::level::warn,     "[{}]: " fmt, tag, ##__VA_ARGS__)
+#define LOG_M_E(tag, fmt, ...)  AXCL_LOG(spdlog::level::err,      "[{}]: " fmt, tag, ##__VA_ARGS__)
+#define LOG_M_C(tag, fmt, ...)  AXCL_LOG(spdlog::level::critical, "[{}]: " fmt, tag, ##__VA_ARGS__)
 
-#define LOG_M_D(tag, fmt, ...)  AXCL_LOGGER->log(spdlog::level::debug,    "[{}]: " fmt, tag, ##__VA_ARGS__)
-#define LOG_M_I(tag, fmt, ...)  AXCL_LOGGER->log(spdlog::level::info,     "[{}]: " fmt, tag, ##__VA_ARGS__)
-#define LOG_M_W(tag, fmt, ...)  AXCL_LOGGER->log(spdlog::level::warn,     "[{}]: " fmt, tag, ##__VA_ARGS__)
-#define LOG_M_E(tag, fmt, ...)  AXCL_LOGGER->log(spdlog::level::err,      "[{}]: " fmt, tag, ##__VA_ARGS__)
-#define LOG_M_C(tag, fmt, ...)  AXCL_LOGGER->log(spdlog::level::critical, "[{}]: " fmt, tag, ##__VA_ARGS__)
+#define LOG_MM_D(tag, fmt, ...) AXCL_LOG(spdlog::level::debug,    "[{}][{}][{}]: " fmt, tag, __func__, __LINE__, ##__VA_ARGS__)
+#define LOG_MM_I(tag, fmt, ...) AXCL_LOG(spdlog::level::info,     "[{}][{}][{}]: " fmt, tag, __func__, __LINE__, ##__VA_ARGS__)
+#define LOG_MM_W(tag, fmt, ...) AXCL_LOG(spdlog::level::warn,     "[{}][{}][{}]: " fmt, tag, __func__, __LINE__, ##__VA_ARGS__)
+#define LOG_MM_E(tag, fmt, ...) AXCL_LOG(spdlog::level::err,      "[{}][{}][{}]: " fmt, tag, __func__, __LINE__, ##__VA_ARGS__)
+#define LOG_MM_C(tag, fmt, ...) AXCL_LOG(spdlog::level::critical, "[{}][{}][{}]: " fmt, tag, __func__, __LINE__, ##__VA_ARGS__)
 
-#define LOG_MM_D(tag, fmt, ...) AXCL_LOGGER->log(spdlog::level::debug,    "[{}][{}][{}]: " fmt, tag, __func__, __LINE__, ##__VA_ARGS__)
-#define LOG_MM_I(tag, fmt, ...) AXCL_LOGGER->log(spdlog::level::info,     "[{}][{}][{}]: " fmt, tag, __func__, __LINE__, ##__VA_ARGS__)
-#define LOG_MM_W(tag, fmt, ...) AXCL_LOGGER->log(spdlog::level::warn,     "[{}][{}][{}]: " fmt, tag, __func__, __LINE__, ##__VA_ARGS__)
-#define LOG_MM_E(tag, fmt, ...) AXCL_LOGGER->log(spdlog::level::err,      "[{}][{}][{}]: " fmt, tag, __func__, __LINE__, ##__VA_ARGS__)
-#define LOG_MM_C(tag, fmt, ...) AXCL_LOGGER->log(spdlog::level::critical, "[{}][{}][{}]: " fmt, tag, __func__, __LINE__, ##__VA_ARGS__)
\ No newline at end of file
+/* per frame logs of hot paths, see logger::defer() for the restrictions on arguments */
+#define LOG_MM_DEFER_D(tag, fmt, ...) AXCL_LOG_DEFER(spdlog::level::debug, "[{}][{}][{}]: " fmt, tag, __func__, __LINE__, ##__VA_ARGS__)
+#define LOG_MM_DEFER_I(tag, fmt, ...) AXCL_LOG_DEFER(spdlog::level::info,  "[{}][{}][{}]: " fmt, tag, __func__, __LINE__, ##__VA_ARGS__)
+#define LOG_MM_DEFER_W(tag, fmt, ...) AXCL_LOG_DEFER(spdlog::level::warn,  "[{}][{}][{}]: " fmt, tag, __func__, __LINE__, ##__VA_ARGS__)
@@ -9,134 +9,309 @@
  **************************************************************************************************/
 
 #include "mem_helper.hpp"
+#include <string.h>
+#include "log/logger.hpp"
+
+#define TAG "mem_helper"
 
 namespace axcl {
 
-mem_helper::SIMD mem_helper::simd_type = SIMD::unknown;
+/* below these sizes libc is as fast and the SIMD head/tail handling does not pay off */
+static constexpr uint64_t SIMD_MIN_SIZE = 64;
 
-void mem_helper::init_check_simd() {
+mem_helper::SIMD mem_helper::simd_type = mem_helper::check_simd();
+/* a copy pulls both src and dest through the cache, from half of a typical 2MB L2 it only evicts the working set */
+uint64_t mem_helper::threshold = 1024 * 1024;
+
+mem_helper::SIMD mem_helper::check_simd() {
 #if (defined(__aarch64__) || defined(__arm__))
-    simd_type = SIMD::neon;
+    return SIMD::neon;
 #else
-    uint32_t eax, ebx, ecx, edx;
+    /* __builtin_cpu_supports also checks that the OS saves the AVX state (OSXSAVE + XGETBV) */
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx")) {
+        return SIMD::avx;
+    }
+    if (__builtin_cpu_supports("sse2")) {
+        return SIMD::sse;
+    }
+    return SIMD::unknown;
+#endif
+}
+
+void mem_helper::init_check_simd() {
+    simd_type = check_simd();
+    LOG_MM_I(TAG, "simd_type [{}], stream threshold {} bytes", static_cast<uint32_t>(simd_type), threshold);
+}
 
-    __asm__ __volatile__(
-        "cpuid"
-        : "=a"(eax), "=b"(ebx), "=c"(ecx), "=d"(edx)
-        : "a"(1)
-    );
+mem_helper::SIMD mem_helper::get_simd() {
+    return simd_type;
+}
 
-    if (edx & (1 << 25)) {
-        simd_type = SIMD::sse;
+void mem_helper::set_stream_threshold(uint64_t bytes) {
+    threshold = bytes;
+}
+
+uint64_t mem_helper::stream_threshold() {
+    return threshold;
+}
+
+void mem_helper::memcpy(uint8_t *dest, const uint8_t *src, uint64_t size) {
+    const bool stream = (size >= threshold);
+    simd_memcpy(dest, src, size, stream);
+    if (stream) {
+        stream_fence();
     }
-    if (edx & (1 << 26)) {
-        simd_type = SIMD::sse;
+}
+
+void mem_helper::memcpy_2d(uint8_t *dest, uint64_t dest_stride, const uint8_t *src, uint64_t src_stride, uint64_t width, uint64_t height) {
+    if (width == dest_stride && width == src_stride) {
+        memcpy(dest, src, width * height);
+        return;
     }
-    if (ecx & (1 << 0)) {
-        simd_type = SIMD::sse;
+
+    const bool stream = (width * height >= threshold);
+    for (uint64_t i = 0; i < height; ++i) {
+        simd_memcpy(dest, src, width, stream);
+        dest += dest_stride;
+        src += src_stride;
     }
-    if (ecx & (1 << 19)) {
-        simd_type = SIMD::sse;
+
+    if (stream) {
+        stream_fence();
     }
-    if (ecx & (1 << 20)) {
-        simd_type = SIMD::sse;
+}
+
+void mem_helper::memset(uint8_t *dest, uint8_t value, uint64_t size) {
+    const bool stream = (size >= threshold);
+    simd_memset(dest, value, size, stream);
+    if (stream) {
+        stream_fence();
     }
-    if (ecx & (1 << 28)) {
-        simd_type = SIMD::avx;
+}
+
+void mem_helper::simd_memcpy(uint8_t *dest, const uint8_t *src, uint64_t n, bool stream) {
+    /* libc is already tuned for cached copies (and picks its own SIMD), the kernels only add the non-temporal path */
+    if (!stream || n < SIMD_MIN_SIZE) {
+        ::memcpy(dest, src, n);
+        return;
     }
+
+    switch (simd_type) {
+#if defined(__aarch64__)
+        case SIMD::neon:
+            neon_memcpy(dest, src, n);
+            break;
+#elif !defined(__arm__)
+        case SIMD::sse:
+            sse_memcpy(dest, src, n);
+            break;
+        case SIMD::avx:
+            avx_memcpy(dest, src, n);
+            break;
 #endif
-    printf("simd_type [%d]\n", (uint32_t)simd_type);
+        default:
+            ::memcpy(dest, src, n);
+            break;
+    }
 }
 
-void mem_helper::memcpy(uint8_t *dest, const uint8_t *src, uint64_t size) {
-    switch(simd_type) {
-#if (defined(__aarch64__) || defined(__arm__))
+void mem_helper::simd_memset(uint8_t *dest, uint8_t value, uint64_t n, bool stream) {
+    if (!stream || n < SIMD_MIN_SIZE) {
+        ::memset(dest, value, n);
+        return;
+    }
+
+    switch (simd_type) {
+#if defined(__aarch64__)
         case SIMD::neon:
-            neon_memcpy(dest, src, size);
+            neon_memset(dest, value, n);
             break;
-#else
+#elif !defined(__arm__)
         case SIMD::sse:
-            sse_memcpy(dest, src, size);
+            sse_memset(dest, value, n);
             break;
         case SIMD::avx:
-            avx_memcpy(dest, src, size);
+            avx_memset(dest, value, n);
             break;
 #endif
         default:
-            memcpy(dest, src, size);
+            ::memset(dest, value, n);
             break;
     }
 }
 
-#if (defined(__aarch64__) || defined(__arm__))
+void mem_helper::stream_fence() {
+#if defined(__aarch64__)
+    __asm__ __volatile__("dmb ishst" ::: "memory");
+#elif defined(__arm__)
+    __asm__ __volatile__("" ::: "memory");
+#else
+    _mm_sfence();
+#endif
+}
+
+
+/**
+ * non-temporal kernels, n >= SIMD_MIN_SIZE.
+ * they write whole cache lines only, the partial lines at both ends go through libc:
+ * a regular store into a line being written non-temporally would flush the write combining buffer.
+ */
+#if defined(__aarch64__)
 void mem_helper::neon_memcpy(uint8_t *dest, const uint8_t *src, uint64_t n) {
     uint8_t *d = dest;
     const uint8_t *s = src;
 
-    while (((uintptr_t)d % 16) && n > 0) {
-        *d++ = *s++;
-        n--;
-    }
+    const uint64_t head = (64 - ((uintptr_t)d & 63)) & 63;
+    ::memcpy(d, s, head);
+    d += head;
+    s += head;
+    n -= head;
 
-    while (n >= 16) {
-        vst1q_u8(d, vld1q_u8(s));
-        d += 16;
-        s += 16;
-        n -= 16;
+    while (n >= 64) {
+        __asm__ __volatile__(
+            "ldp q0, q1, [%[s]]\n\t"
+            "ldp q2, q3, [%[s], #32]\n\t"
+            "stnp q0, q1, [%[d]]\n\t"
+            "stnp q2, q3, [%[d], #32]\n\t"
+            :
+            : [d] "r"(d), [s] "r"(s)
+            : "v0", "v1", "v2", "v3", "memory");
+        d += 64;
+        s += 64;
+        n -= 64;
     }
 
-    while (n > 0) {
-        *d++ = *s++;
-        n--;
+    ::memcpy(d, s, n);
+}
+
+void mem_helper::neon_memset(uint8_t *dest, uint8_t value, uint64_t n) {
+    uint8_t *d = dest;
+    const uint8x16_t v = vdupq_n_u8(value);
+
+    const uint64_t head = (64 - ((uintptr_t)d & 63)) & 63;
+    ::memset(d, value, head);
+    d += head;
+    n -= head;
+
+    while (n >= 64) {
+        __asm__ __volatile__(
+            "stnp %q[v], %q[v], [%[d]]\n\t"
+            "stnp %q[v], %q[v], [%[d], #32]\n\t"
+            :
+            : [d] "r"(d), [v] "w"(v)
+            : "memory");
+        d += 64;
+        n -= 64;
     }
+
+    ::memset(d, value, n);
 }
-#else
+#elif !defined(__arm__)
 void mem_helper::sse_memcpy(uint8_t *dest, const uint8_t *src, uint64_t n) {
     uint8_t *d = dest;
     const uint8_t *s = src;
 
-    while (((uintptr_t)d % 16) && n > 0) {
-        *d++ = *s++;
-        n--;
-    }
+    const uint64_t head = (64 - ((uintptr_t)d & 63)) & 63;
+    ::memcpy(d, s, head);
+    d += head;
+    s += head;
+    n -= head;
 
-    __m128i xmm;
-    while (n >= 16) {
-        xmm = _mm_loadu_si128((__m128i *)s);
-        _mm_storeu_si128((__m128i *)d, xmm);
-        d += 16;
-        s += 16;
-        n -= 16;
+    __m128i xmm0, xmm1, xmm2, xmm3;
+    while (n >= 64) {
+        xmm0 = _mm_loadu_si128((const __m128i *)s);
+        xmm1 = _mm_loadu_si128((const __m128i *)(s + 16));
+        xmm2 = _mm_loadu_si128((const __m128i *)(s + 32));
+        xmm3 = _mm_loadu_si128((const __m128i *)(s + 48));
+        _mm_stream_si128((__m128i *)d, xmm0);
+        _mm_stream_si128((__m128i *)(d + 16), xmm1);
+        _mm_stream_si128((__m128i *)(d + 32), xmm2);
+        _mm_stream_si128((__m128i *)(d + 48), xmm3);
+        d += 64;
+        s += 64;
+        n -= 64;
     }
 
-    while (n > 0) {
-        *d++ = *s++;
-        n--;
-    }
+    ::memcpy(d, s, n);
 }
 
-void mem_helper::avx_memcpy(uint8_t *dest, const uint8_t *src, uint64_t n) {
+__attribute__((target("avx"))) void mem_helper::avx_memcpy(uint8_t *dest, const uint8_t *src, uint64_t n) {
     uint8_t *d = dest;
     const uint8_t *s = src;
 
-    while (((uintptr_t)d % 32) && n > 0) {
-        *d++ = *s++;
-        n--;
+    const uint64_t head = (64 - ((uintptr_t)d & 63)) & 63;
+    ::memcpy(d, s, head);
+    d += head;
+    s += head;
+    n -= head;
+
+    __m256i ymm0, ymm1, ymm2, ymm3;
+    while (n >= 128) {
+        ymm0 = _mm256_loadu_si256((const __m256i *)s);
+        ymm1 = _mm256_loadu_si256((const __m256i *)(s + 32));
+        ymm2 = _mm256_loadu_si256((const __m256i *)(s + 64));
+        ymm3 = _mm256_loadu_si256((const __m256i *)(s + 96));
+        _mm256_stream_si256((__m256i *)d, ymm0);
+        _mm256_stream_si256((__m256i *)(d + 32), ymm1);
+        _mm256_stream_si256((__m256i *)(d + 64), ymm2);
+        _mm256_stream_si256((__m256i *)(d + 96), ymm3);
+        d += 128;
+        s += 128;
+        n -= 128;
     }
 
-    __m256i ymm;
-    while (n >= 32) {
-        ymm = _mm256_loadu_si256((__m256i *)s);
-        _mm256_storeu_si256((__m256i *)d, ymm);
-        d += 32;
-        s += 32;
-        n -= 32;
+    if (n >= 64) {
+        ymm0 = _mm256_loadu_si256((const __m256i *)s);
+        ymm1 = _mm256_loadu_si256((const __m256i *)(s + 32));
+        _mm256_stream_si256((__m256i *)d, ymm0);
+        _mm256_stream_si256((__m256i *)(d + 32), ymm1);
+        d += 64;
+        s += 64;
+        n -= 64;
     }
 
-    while (n > 0) {
-        *d++ = *s++;
-        n--;
+    ::memcpy(d, s, n);
+}
+
+void mem_helper::sse_memset(uint8_t *dest, uint8_t value, uint64_t n) {
+    uint8_t *d = dest;
+    const __m128i xmm = _mm_set1_epi8(static_cast<char>(value));
+
+    const uint64_t head = (64 - ((uintptr_t)d & 63)) & 63;
+    ::memset(d, value, head);
+    d += head;
+    n -= head;
+
+    while (n >= 64) {
+        _mm_stream_si128((__m128i *)d, xmm);
+        _mm_stream_si128((__m128i *)(d + 16), xmm);
+        _mm_stream_si128((__m128i *)(d + 32), xmm);
+        _mm_stream_si128((__m128i *)(d + 48), xmm);
+        d += 64;
+        n -= 64;
     }
+
+    ::memset(d, value, n);
+}
+
+__attribute__((target("avx"))) void mem_helper::avx_memset(uint8_t *dest, uint8_t value, uint64_t n) {
+    uint8_t *d = dest;
+    const __m256i ymm = _mm256_set1_epi8(static_cast<char>(value));
+
+    const uint64_t head = (64 - ((uintptr_t)d & 63)) & 63;
+    ::memset(d, value, head);
+    d += head;
+    n -= head;
+
+    while (n >= 64) {
+        _mm256_stream_si256((__m256i *)d, ymm);
+        _mm256_stream_si256((__m256i *)(d + 32), ymm);
+        d += 64;
+        n -= 64;
+    }
+
+    ::memset(d, value, n);
 }
 #endif
 
@@ -23,6 +23,14 @@
 
 namespace axcl {
 
+/**
+ * SIMD memory helpers for host side frame copies.
+ *  - the SIMD type is detected once at startup (cpuid + OS support of AVX state), init_check_simd() only logs it;
+ *  - copies and fills of at least stream_threshold() bytes use SIMD non-temporal stores, which bypass the cache so that
+ *    a large frame does not evict the working set, the stores are fenced before return. smaller ones go to libc, which
+ *    is already tuned (and dispatched) for cached copies. 32-bit ARM has no non-temporal store and always uses libc;
+ *  - memcpy_2d() copies strided planes, e.g. NV12/NV21 Y and UV planes or packed RGB rows with padding.
+ */
 class mem_helper final {
 public:
     enum class SIMD {
@@ -34,31 +42,62 @@ public:
 
 public:
     /**
-     * @brief
+     * @brief detects the SIMD type again and logs it
      */
     static void init_check_simd();
 
     /**
-     * @brief
+     * @brief SIMD type in use
+     */
+    static SIMD get_simd();
+
+    /**
+     * @brief bytes from which copies and fills use non-temporal stores, 1MB by default, 0 to always stream
+     */
+    static void set_stream_threshold(uint64_t bytes);
+    static uint64_t stream_threshold();
+
+    /**
+     * @brief copies size bytes, dest and src must not overlap
      */
     static void memcpy(uint8_t *dest, const uint8_t *src, uint64_t size);
 
-    // pending for other memory functions
+    /**
+     * @brief copies height rows of width bytes from src to dest, each row starts stride bytes after the previous one.
+     *        for NV12/NV21 call it for the Y plane (height) and the UV plane (height / 2), for RGB width is 3 * pixels.
+     */
+    static void memcpy_2d(uint8_t *dest, uint64_t dest_stride, const uint8_t *src, uint64_t src_stride, uint64_t width, uint64_t height);
+
+    /**
+     * @brief fills size bytes with value
+     */
+    static void memset(uint8_t *dest, uint8_t value, uint64_t size);
 
 private:
     mem_helper() = default;
     ~mem_helper() = default;
 
+    static SIMD check_simd();
+
+    /* below the threshold libc is used, above it the non-temporal kernels, which leave the fence to the caller */
+    static void simd_memcpy(uint8_t *dest, const uint8_t *src, uint64_t n, bool stream);
+    static void simd_memset(uint8_t *dest, uint8_t value, uint64_t n, bool stream);
+    static void stream_fence();
+
 private:
-#if (defined(__aarch64__) || defined(__arm__))
+#if defined(__aarch64__)
     static void neon_memcpy(uint8_t *dest, const uint8_t *src, uint64_t n);
-#else
+    static void neon_memset(uint8_t *dest, uint8_t value, uint64_t n);
+#elif !defined(__arm__)
     static void sse_memcpy(uint8_t *dest, const uint8_t *src, uint64_t n);
     static void avx_memcpy(uint8_t *dest, const uint8_t *src, uint64_t n);
+    static void sse_memset(uint8_t *dest, uint8_t value, uint64_t n);
+    static void avx_memset(uint8_t *dest, uint8_t value, uint64_t n);
 #endif
 
 private:
     static SIMD simd_type;
+    static uint64_t threshold;
 };
 
-}  // namespace axcl
\ No newline at end of file
+}  // namespace axcl
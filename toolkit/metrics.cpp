@@ -0,0 +1,379 @@
+/**************************************************************************************************
+ *
+ * Copyright (c) 2019-2024 Axera Semiconductor Co., Ltd. All Rights Reserved.
+ *
+ * This source file is the property of Axera Semiconductor Co., Ltd. and
+ * may not be copied or distributed in any isomorphic form without the prior
+ * written consent of Axera Semiconductor Co., Ltd.
+ *
+ **************************************************************************************************/
+
+#include "metrics.hpp"
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstdio>
+#include "event_loop.hpp"
+#include "log/logger.hpp"
+
+#define TAG "metrics"
+
+namespace axcl {
+
+static bool valid_name(const std::string &name) {
+    if (name.empty() || (name[0] >= '0' && name[0] <= '9')) {
+        return false;
+    }
+
+    for (char c : name) {
+        if (!((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || '_' == c || ':' == c)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/* {k1="v1",k2="v2"}, label values escape \, " and newline */
+static std::string render_labels(const metric_labels &labels) {
+    if (labels.empty()) {
+        return {};
+    }
+
+    std::string s = "{";
+    for (size_t i = 0; i < labels.size(); ++i) {
+        if (i > 0) {
+            s += ',';
+        }
+        s += labels[i].first;
+        s += "=\"";
+        for (char c : labels[i].second) {
+            if ('\\' == c || '"' == c) {
+                s += '\\';
+                s += c;
+            } else if ('\n' == c) {
+                s += "\\n";
+            } else {
+                s += c;
+            }
+        }
+        s += '"';
+    }
+    s += '}';
+    return s;
+}
+
+/* rendered labels plus one more, for the le of histogram buckets */
+static std::string append_label(const std::string &labels, const char *key, const std::string &value) {
+    const std::string label = std::string(key) + "=\"" + value + "\"";
+    if (labels.empty()) {
+        return "{" + label + "}";
+    }
+
+    return labels.substr(0, labels.size() - 1) + "," + label + "}";
+}
+
+static std::string format_double(double v) {
+    char buf[32];
+    snprintf(buf, sizeof(buf), "%.9g", v);
+    return buf;
+}
+
+metric_histogram::metric_histogram(const std::vector<double> &bounds) : m_bounds(bounds) {
+    m_bucket_num = static_cast<uint32_t>(m_bounds.size()) + 1;
+    m_lines_per_shard = (m_bucket_num + 1 + 7) / 8;
+    m_lines = std::make_unique<cache_line[]>(METRIC_SHARDS * m_lines_per_shard);
+    for (uint32_t i = 0; i < METRIC_SHARDS * m_lines_per_shard; ++i) {
+        for (auto &slot : m_lines[i].slot) {
+            slot.store(0, std::memory_order_relaxed);
+        }
+    }
+}
+
+void metric_histogram::collect(std::vector<uint64_t> &counts, double &sum) const {
+    counts.assign(m_bucket_num, 0);
+    sum = 0;
+    for (uint32_t s = 0; s < METRIC_SHARDS; ++s) {
+        const std::atomic<uint64_t> *slots = shard_slots(s);
+        for (uint32_t i = 0; i < m_bucket_num; ++i) {
+            counts[i] += slots[i].load(std::memory_order_relaxed);
+        }
+
+        const uint64_t bits = slots[m_bucket_num].load(std::memory_order_relaxed);
+        double d;
+        std::memcpy(&d, &bits, sizeof(d));
+        sum += d;
+    }
+}
+
+std::vector<double> metric_histogram::latency_buckets() {
+    return {0.0005, 0.001, 0.0025, 0.005, 0.01, 0.025, 0.05, 0.1, 0.25, 0.5, 1};
+}
+
+metrics_registry *metrics_registry::get_instance() {
+    static metrics_registry instance;
+    return &instance;
+}
+
+metrics_registry::family *metrics_registry::find_family(const std::string &name, const std::string &help, TYPE type,
+                                                        const std::vector<double> &bounds) {
+    if (!valid_name(name)) {
+        LOG_MM_E(TAG, "invalid metric name \"{}\"", name);
+        return nullptr;
+    }
+
+    auto it = m_families.find(name);
+    if (it == m_families.end()) {
+        family &f = m_families[name];
+        f.type = type;
+        f.help = help;
+        f.bounds = bounds;
+        return &f;
+    }
+
+    if (it->second.type != type || it->second.bounds != bounds) {
+        LOG_MM_E(TAG, "metric {} is already registered with another type or buckets", name);
+        return nullptr;
+    }
+
+    return &it->second;
+}
+
+metric_counter &metrics_registry::counter(const std::string &name, const std::string &help, const metric_labels &labels) {
+    std::lock_guard<std::mutex> lck(m_mtx);
+    family *f = find_family(name, help, TYPE::counter, {});
+    auto &metric = (f ? f : &m_detached)->counters[f ? render_labels(labels) : std::to_string(m_detached.counters.size())];
+    if (!metric) {
+        metric = std::make_unique<metric_counter>();
+    }
+
+    return *metric;
+}
+
+metric_gauge &metrics_registry::gauge(const std::string &name, const std::string &help, const metric_labels &labels) {
+    std::lock_guard<std::mutex> lck(m_mtx);
+    family *f = find_family(name, help, TYPE::gauge, {});
+    auto &metric = (f ? f : &m_detached)->gauges[f ? render_labels(labels) : std::to_string(m_detached.gauges.size())];
+    if (!metric) {
+        metric = std::make_unique<metric_gauge>();
+    }
+
+    return *metric;
+}
+
+metric_histogram &metrics_registry::histogram(const std::string &name, const std::string &help, const std::vector<double> &bounds,
+                                              const metric_labels &labels) {
+    std::lock_guard<std::mutex> lck(m_mtx);
+    bool ascending = true;
+    for (size_t i = 1; i < bounds.size(); ++i) {
+        ascending = ascending && (bounds[i] > bounds[i - 1]);
+    }
+
+    if (!ascending) {
+        LOG_MM_E(TAG, "buckets of histogram {} are not ascending", name);
+    }
+
+    family *f = ascending ? find_family(name, help, TYPE::histogram, bounds) : nullptr;
+    auto &metric = (f ? f : &m_detached)->histograms[f ? render_labels(labels) : std::to_string(m_detached.histograms.size())];
+    if (!metric) {
+        metric = std::make_unique<metric_histogram>(bounds);
+    }
+
+    return *metric;
+}
+
+std::string metrics_registry::expose() const {
+    std::lock_guard<std::mutex> lck(m_mtx);
+
+    std::string text;
+    text.reserve(4096);
+    std::vector<uint64_t> counts;
+    for (const auto &[name, f] : m_families) {
+        static const char *TYPE_NAMES[] = {"counter", "gauge", "histogram"};
+        text += "# HELP " + name + " " + f.help + "\n";
+        text += "# TYPE " + name + " " + TYPE_NAMES[static_cast<int>(f.type)] + "\n";
+
+        for (const auto &[labels, m] : f.counters) {
+            text += name + labels + " " + std::to_string(m->value()) + "\n";
+        }
+
+        for (const auto &[labels, m] : f.gauges) {
+            text += name + labels + " " + std::to_string(m->value()) + "\n";
+        }
+
+        for (const auto &[labels, m] : f.histograms) {
+            double sum;
+            m->collect(counts, sum);
+
+            uint64_t cumulative = 0;
+            for (size_t i = 0; i < counts.size(); ++i) {
+                cumulative += counts[i];
+                const std::string le = (i < f.bounds.size()) ? format_double(f.bounds[i]) : "+Inf";
+                text += name + "_bucket" + append_label(labels, "le", le) + " " + std::to_string(cumulative) + "\n";
+            }
+            text += name + "_sum" + labels + " " + format_double(sum) + "\n";
+            text += name + "_count" + labels + " " + std::to_string(cumulative) + "\n";
+        }
+    }
+
+    return text;
+}
+
+metrics_server::~metrics_server() {
+    stop();
+}
+
+bool metrics_server::start(uint16_t port, const std::string &ip /* = "127.0.0.1" */) {
+    if (m_fd >= 0) {
+        LOG_MM_W(TAG, "metrics server is already started on port {}", m_port);
+        return true;
+    }
+
+    struct sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    if (1 != inet_pton(AF_INET, ip.c_str(), &addr.sin_addr)) {
+        LOG_MM_E(TAG, "invalid ip {}", ip);
+        return false;
+    }
+
+    m_fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (m_fd < 0) {
+        LOG_MM_E(TAG, "create socket fail, {}", strerror(errno));
+        return false;
+    }
+
+    int32_t on = 1;
+    setsockopt(m_fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+    if (0 != bind(m_fd, reinterpret_cast<struct sockaddr *>(&addr), sizeof(addr)) || 0 != listen(m_fd, 8)) {
+        LOG_MM_E(TAG, "listen on {}:{} fail, {}", ip, port, strerror(errno));
+        close(m_fd);
+        m_fd = -1;
+        return false;
+    }
+
+    socklen_t len = sizeof(addr);
+    getsockname(m_fd, reinterpret_cast<struct sockaddr *>(&addr), &len);
+    m_port = ntohs(addr.sin_port);
+
+    if (!event_loop::get_instance()->add_fd(m_fd, EPOLLIN, [this](uint32_t) { on_accept(); })) {
+        close(m_fd);
+        m_fd = -1;
+        return false;
+    }
+
+    LOG_MM_I(TAG, "serve metrics on http://{}:{}/metrics", ip, m_port);
+    return true;
+}
+
+void metrics_server::stop() {
+    if (m_fd < 0) {
+        return;
+    }
+
+    event_loop *loop = event_loop::get_instance();
+    loop->invoke([this, loop]() {
+        loop->remove_fd(m_fd);
+        while (!m_connections.empty()) {
+            close_connection(m_connections.begin()->first);
+        }
+    });
+
+    close(m_fd);
+    m_fd = -1;
+}
+
+void metrics_server::on_accept() {
+    event_loop *loop = event_loop::get_instance();
+    while (true) {
+        const int32_t fd = accept4(m_fd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            return;
+        }
+
+        connection &conn = m_connections[fd];
+        conn.timer = loop->add_timer(1000, 0, [this, fd]() {
+            LOG_MM_W(TAG, "metrics connection {} timeout", fd);
+            m_connections[fd].timer = 0;
+            close_connection(fd);
+        });
+
+        if (!loop->add_fd(fd, EPOLLIN, [this, fd](uint32_t events) { on_connection(fd, events); })) {
+            close_connection(fd);
+        }
+    }
+}
+
+void metrics_server::on_connection(int32_t fd, uint32_t events) {
+    connection &conn = m_connections[fd];
+    if (conn.response.empty()) {
+        char buf[1024];
+        ssize_t n;
+        while ((n = recv(fd, buf, sizeof(buf), 0)) > 0) {
+            conn.request.append(buf, n);
+        }
+
+        const bool complete = (std::string::npos != conn.request.find("\r\n\r\n"));
+        if (!complete && (0 == n || (n < 0 && EAGAIN != errno && EWOULDBLOCK != errno) || conn.request.size() >= 8192)) {
+            close_connection(fd);
+            return;
+        }
+
+        if (!complete) {
+            return;
+        }
+
+        std::string status = "200 OK";
+        std::string body;
+        if (0 != conn.request.compare(0, 4, "GET ")) {
+            status = "405 Method Not Allowed";
+        } else if (0 != conn.request.compare(4, 9, "/metrics ") && 0 != conn.request.compare(4, 9, "/metrics?")) {
+            status = "404 Not Found";
+        } else {
+            body = metrics_registry::get_instance()->expose();
+        }
+
+        conn.response = "HTTP/1.1 " + status + "\r\nContent-Type: text/plain; version=0.0.4; charset=utf-8\r\nContent-Length: " +
+                        std::to_string(body.size()) + "\r\nConnection: close\r\n\r\n" + body;
+    } else if (0 == (events & EPOLLOUT)) {
+        return;
+    }
+
+    while (conn.sent < conn.response.size()) {
+        const ssize_t n = send(fd, conn.response.data() + conn.sent, conn.response.size() - conn.sent, MSG_NOSIGNAL);
+        if (n < 0 && (EAGAIN == errno || EWOULDBLOCK == errno)) {
+            /* the rest when the socket is writable again */
+            (void)event_loop::get_instance()->modify_fd(fd, EPOLLOUT);
+            return;
+        }
+
+        if (n <= 0) {
+            LOG_MM_W(TAG, "send metrics fail, {}", strerror(errno));
+            break;
+        }
+
+        conn.sent += n;
+    }
+
+    close_connection(fd);
+}
+
+void metrics_server::close_connection(int32_t fd) {
+    auto it = m_connections.find(fd);
+    if (it == m_connections.end()) {
+        return;
+    }
+
+    event_loop *loop = event_loop::get_instance();
+    if (0 != it->second.timer) {
+        loop->cancel_timer(it->second.timer);
+    }
+    loop->remove_fd(fd);
+    close(fd);
+    m_connections.erase(it);
+}
+
+}  // namespace axcl
@@ -0,0 +1,220 @@
+/**************************************************************************************************
+ *
+ * Copyright (c) 2019-2024 Axera Semiconductor Co., Ltd. All Rights Reserved.
+ *
+ * This source file is the property of Axera Semiconductor Co., Ltd. and
+ * may not be copied or distributed in any isomorphic form without the prior
+ * written consent of Axera Semiconductor Co., Ltd.
+ *
+ **************************************************************************************************/
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * every module compiles the toolkit sources it uses, some with -fvisibility=hidden (libaxcl_ppl),
+ * the registry is exported so that all copies in a process resolve to the same instance.
+ */
+#define AXCL_METRICS_API __attribute__((visibility("default")))
+
+namespace axcl {
+
+using metric_labels = std::vector<std::pair<std::string, std::string>>;
+
+/* a metric is split into shards, a thread always updates the same shard so that threads do not share cache lines */
+static constexpr uint32_t METRIC_SHARDS = 16;
+
+inline uint32_t metric_shard() {
+    static std::atomic<uint32_t> next = {0};
+    static thread_local const uint32_t shard = next.fetch_add(1, std::memory_order_relaxed) % METRIC_SHARDS;
+    return shard;
+}
+
+/* monotonic counter, e.g. frames or bytes */
+class metric_counter {
+public:
+    void inc(uint64_t n = 1) {
+        m_shards[metric_shard()].value.fetch_add(n, std::memory_order_relaxed);
+    }
+
+    /* sum of all shards, taken on scrape */
+    uint64_t value() const {
+        uint64_t sum = 0;
+        for (const auto &s : m_shards) {
+            sum += s.value.load(std::memory_order_relaxed);
+        }
+        return sum;
+    }
+
+private:
+    struct alignas(64) shard {
+        std::atomic<uint64_t> value = {0};
+    };
+    shard m_shards[METRIC_SHARDS];
+};
+
+/* current value, e.g. queue depth or streams running, not sharded as it is set rather than accumulated */
+class metric_gauge {
+public:
+    void set(int64_t v) {
+        m_value.store(v, std::memory_order_relaxed);
+    }
+
+    void add(int64_t n) {
+        m_value.fetch_add(n, std::memory_order_relaxed);
+    }
+
+    int64_t value() const {
+        return m_value.load(std::memory_order_relaxed);
+    }
+
+private:
+    alignas(64) std::atomic<int64_t> m_value = {0};
+};
+
+/* distribution over fixed buckets, e.g. latency in seconds; observe() is a search of the bounds and 2 uncontended atomics */
+class metric_histogram {
+public:
+    /* upper bounds of the buckets in ascending order, +Inf is implied */
+    explicit metric_histogram(const std::vector<double> &bounds);
+
+    void observe(double v) {
+        uint32_t i = 0;
+        while (i < m_bucket_num - 1 && v > m_bounds[i]) {
+            ++i;
+        }
+
+        std::atomic<uint64_t> *slots = shard_slots(metric_shard());
+        slots[i].fetch_add(1, std::memory_order_relaxed);
+
+        /* the sum is the bits of a double, updated by CAS, only the threads of one shard contend on it */
+        std::atomic<uint64_t> &sum = slots[m_bucket_num];
+        uint64_t old_bits = sum.load(std::memory_order_relaxed);
+        uint64_t new_bits;
+        do {
+            double d;
+            std::memcpy(&d, &old_bits, sizeof(d));
+            d += v;
+            std::memcpy(&new_bits, &d, sizeof(d));
+        } while (!sum.compare_exchange_weak(old_bits, new_bits, std::memory_order_relaxed));
+    }
+
+    const std::vector<double> &bounds() const {
+        return m_bounds;
+    }
+
+    /* per bucket counts (not cumulative, the last one is +Inf) and the sum of all observations, taken on scrape */
+    void collect(std::vector<uint64_t> &counts, double &sum) const;
+
+    /* 0.5ms .. 1s, for per frame latencies in seconds */
+    static std::vector<double> latency_buckets();
+
+private:
+    struct alignas(64) cache_line {
+        std::atomic<uint64_t> slot[8];
+    };
+
+    std::atomic<uint64_t> *shard_slots(uint32_t shard) const {
+        return &m_lines[shard * m_lines_per_shard].slot[0];
+    }
+
+private:
+    std::vector<double> m_bounds;
+    uint32_t m_bucket_num;       /* bounds + 1 */
+    uint32_t m_lines_per_shard;  /* a shard holds bucket counts then the sum, padded to whole cache lines */
+    std::unique_ptr<cache_line[]> m_lines;
+};
+
+/**
+ * process wide registry of metrics, rendered in Prometheus text format on scrape.
+ *  - a metric is identified by name and labels, registering it again returns the same one, so a module that is
+ *    recreated keeps counting on it; it lives until the process exits;
+ *  - register once when a module is set up and keep the reference, the hot path only touches the metric itself;
+ *  - a name registered with another type (or other buckets) is an error, the call then returns a metric that is never exposed.
+ */
+class AXCL_METRICS_API metrics_registry {
+public:
+    static metrics_registry *get_instance();
+
+    metric_counter &counter(const std::string &name, const std::string &help, const metric_labels &labels = {});
+    metric_gauge &gauge(const std::string &name, const std::string &help, const metric_labels &labels = {});
+    metric_histogram &histogram(const std::string &name, const std::string &help, const std::vector<double> &bounds,
+                                const metric_labels &labels = {});
+
+    /* text exposition format 0.0.4 */
+    std::string expose() const;
+
+private:
+    enum class TYPE { counter, gauge, histogram };
+
+    struct family {
+        TYPE type;
+        std::string help;
+        std::vector<double> bounds;
+        std::map<std::string, std::unique_ptr<metric_counter>> counters; /* keyed by rendered labels */
+        std::map<std::string, std::unique_ptr<metric_gauge>> gauges;
+        std::map<std::string, std::unique_ptr<metric_histogram>> histograms;
+    };
+
+    metrics_registry() = default;
+    metrics_registry(const metrics_registry &) = delete;
+    metrics_registry &operator=(const metrics_registry &) = delete;
+
+    family *find_family(const std::string &name, const std::string &help, TYPE type, const std::vector<double> &bounds);
+
+private:
+    mutable std::mutex m_mtx;
+    std::map<std::string, family> m_families;
+    family m_detached; /* metrics of failed registrations */
+};
+
+/**
+ * serves GET /metrics of the registry over HTTP on the shared event_loop, without a thread of its own.
+ * binds to 127.0.0.1 by default, the port is not meant to be exposed beyond the host.
+ * a connection is non-blocking and closed after 1s, so that a slow scraper does not hold the loop.
+ */
+class AXCL_METRICS_API metrics_server {
+public:
+    metrics_server() = default;
+    ~metrics_server();
+
+    /* port 0 picks a free one, see port() */
+    bool start(uint16_t port, const std::string &ip = "127.0.0.1");
+    void stop();
+
+    uint16_t port() const {
+        return m_port;
+    }
+
+private:
+    metrics_server(const metrics_server &) = delete;
+    metrics_server &operator=(const metrics_server &) = delete;
+
+    struct connection {
+        std::string request;
+        std::string response;
+        size_t sent = 0;
+        uint64_t timer = 0;
+    };
+
+    /* all on the loop thread */
+    void on_accept();
+    void on_connection(int32_t fd, uint32_t events);
+    void close_connection(int32_t fd);
+
+private:
+    int32_t m_fd = -1;
+    uint16_t m_port = 0;
+    std::map<int32_t, connection> m_connections;
+};
+
+}  // namespace axcl
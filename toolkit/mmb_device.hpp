@@ -0,0 +1,74 @@
+/**************************************************************************************************
+ *
+ * Copyright (c) 2019-2024 Axera Semiconductor Co., Ltd. All Rights Reserved.
+ *
+ * This source file is the property of Axera Semiconductor Co., Ltd. and
+ * may not be copied or distributed in any isomorphic form without the prior
+ * written consent of Axera Semiconductor Co., Ltd.
+ *
+ **************************************************************************************************/
+
+#pragma once
+
+#include <fcntl.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <sys/types.h>
+#include <unistd.h>
+#include <cstdint>
+
+#define AX_MM_DEV "/dev/ax_mmb_dev"
+
+// ioctl cmd
+#define AX_IOC_PCIe_BASE 'H'
+#define AX_IOC_PCIE_DMA_GET_PHY_BASE    _IOW(AX_IOC_PCIe_BASE, 3, unsigned int)
+#define AX_IOC_PCIe_ALLOC_MEMORY        _IOW(AX_IOC_PCIe_BASE, 4, unsigned int)
+#define AX_IOC_PCIe_ALLOC_MEMCACHED     _IOW(AX_IOC_PCIe_BASE, 5, unsigned int)
+#define AX_IOC_PCIe_FLUSH_CACHED        _IOW(AX_IOC_PCIe_BASE, 6, struct ax_mem_info)
+#define AX_IOC_PCIe_INVALID_CACHED      _IOW(AX_IOC_PCIe_BASE, 7, struct ax_mem_info)
+#define AX_IOC_PCIe_SCATTERLIST_ALLOC   _IOW(AX_IOC_PCIe_BASE, 8, struct ax_scatterlist)
+
+struct ax_mem_info {
+    uint64_t phy;
+    uint64_t vir;
+    uint64_t size;
+};
+
+struct ax_sg_list {
+    unsigned long phyaddr;
+    unsigned long virtaddr;
+    unsigned int size;
+};
+
+/* entries of one AX_IOC_PCIe_SCATTERLIST_ALLOC, larger buffers take several allocations */
+#define MAX_SG_LIST_ENTRY 64
+struct ax_scatterlist {
+    int num;
+    int size;
+    struct ax_sg_list sg_list[MAX_SG_LIST_ENTRY];
+};
+
+/**
+ * the calls dma_buffer makes on the mmb device, one allocation is bound to one open of the device.
+ * the default goes to /dev/ax_mmb_dev, a fake (see fake_mmb_device.hpp) runs the buffer logic without a card.
+ */
+class mmb_device {
+public:
+    virtual ~mmb_device() = default;
+
+    virtual int32_t open() {
+        return ::open(AX_MM_DEV, O_RDWR);
+    }
+
+    virtual int32_t close(int32_t fd) {
+        return ::close(fd);
+    }
+
+    virtual int32_t ioctl(int32_t fd, unsigned long cmd, void *arg) {
+        return ::ioctl(fd, cmd, arg);
+    }
+
+    virtual void *mmap(void *addr, size_t size, int32_t prot, int32_t flags, int32_t fd, off_t offset) {
+        return ::mmap(addr, size, prot, flags, fd, offset);
+    }
+};
@@ -0,0 +1,290 @@
+/**************************************************************************************************
+ *
+ * Copyright (c) 2019-2024 Axera Semiconductor Co., Ltd. All Rights Reserved.
+ *
+ * This source file is the property of Axera Semiconductor Co., Ltd. and
+ * may not be copied or distributed in any isomorphic form without the prior
+ * written consent of Axera Semiconductor Co., Ltd.
+ *
+ **************************************************************************************************/
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <utility>
+#include "futex.hpp"
+
+namespace axcl {
+
+enum class mpmc_overflow {
+    reject,      /* push fails (or waits for timeout_ms) when full, as lock_queue */
+    drop_oldest, /* push never fails, the oldest item is popped and handed to the drop callback */
+};
+
+/**
+ * bounded lock-free multi-producer multi-consumer queue (D. Vyukov's sequenced ring), a drop-in for lock_queue:
+ *  - push and pop are one CAS on a cache line of their own plus a store to the cell, no mutex is taken;
+ *  - blocking push/pop spin on try_xxx, and only sleep on a futex when the queue stays full/empty,
+ *    the other side only enters the kernel once to wake them up, when somebody really sleeps;
+ *  - with mpmc_overflow::drop_oldest, a full queue drops its oldest item instead of the new one;
+ *  - the capacity is fixed by constructor or set_capacity() before the queue is used.
+ */
+template <typename T>
+class mpmc_queue {
+public:
+    mpmc_queue() = default;
+    explicit mpmc_queue(uint32_t capacity, mpmc_overflow overflow = mpmc_overflow::reject) {
+        set_capacity(capacity);
+        set_overflow(overflow);
+    }
+
+    virtual ~mpmc_queue() = default;
+
+    /* not thread safe: call before any push or pop, items still queued are destroyed */
+    void set_capacity(uint32_t capacity) {
+        m_capacity = capacity;
+        m_mask = (0 != capacity && 0 == (capacity & (capacity - 1))) ? (capacity - 1) : 0;
+        m_cells.reset((capacity > 0) ? new cell[capacity] : nullptr);
+        for (uint32_t i = 0; i < capacity; ++i) {
+            m_cells[i].seq.store(i, std::memory_order_relaxed);
+        }
+        m_enqueue.pos.store(0, std::memory_order_relaxed);
+        m_dequeue.pos.store(0, std::memory_order_relaxed);
+        m_dropped.store(0, std::memory_order_relaxed);
+    }
+
+    int32_t get_capacity(void) const {
+        return static_cast<int32_t>(m_capacity);
+    }
+
+    /* not thread safe, as set_capacity */
+    void set_overflow(mpmc_overflow overflow, std::function<void(T&)> on_drop = nullptr) {
+        m_overflow = overflow;
+        m_on_drop = std::move(on_drop);
+    }
+
+    /* a snapshot, exact only when no push or pop is running */
+    size_t size(void) const {
+        const uint64_t head = m_dequeue.pos.load(std::memory_order_acquire);
+        const uint64_t tail = m_enqueue.pos.load(std::memory_order_acquire);
+        return (tail > head) ? static_cast<size_t>(tail - head) : 0;
+    }
+
+    bool full(void) const {
+        return size() >= m_capacity;
+    }
+
+    /* items dropped by the drop_oldest overflow */
+    uint64_t dropped(void) const {
+        return m_dropped.load(std::memory_order_relaxed);
+    }
+
+    /* wakes up the pops waiting on empty queue, one of them returns false */
+    void wakeup(void) {
+        m_wakeup.store(true, std::memory_order_release);
+        m_pushed.broadcast();
+    }
+
+    bool try_push(const T& m) {
+        return enqueue(m);
+    }
+
+    bool try_push(T&& m) {
+        return enqueue(std::move(m));
+    }
+
+    bool try_pop(T& m) {
+        if (!dequeue(m)) {
+            return false;
+        }
+
+        m_popped.notify();
+        return true;
+    }
+
+    /* timeout_ms: 0 returns at once as lock_queue::push, < 0 waits for a free cell */
+    bool push(const T& m, int32_t timeout_ms = 0) {
+        return push_impl(m, timeout_ms);
+    }
+
+    bool push(T&& m, int32_t timeout_ms = 0) {
+        return push_impl(std::move(m), timeout_ms);
+    }
+
+    /* timeout_ms: 0 returns at once, < 0 waits for an item or wakeup() */
+    bool pop(T& m, int32_t timeout_ms = -1) {
+        if (try_pop(m)) {
+            return true;
+        }
+
+        if (0 == timeout_ms) {
+            return false;
+        }
+
+        return wait(m_pushed, timeout_ms, [this, &m]() -> bool { return try_pop(m); }, true);
+    }
+
+private:
+    /* delete copy and assignment ctor, std::vector<mpmc_queue<X>> is not allowed */
+    mpmc_queue(const mpmc_queue&) = delete;
+    mpmc_queue(mpmc_queue&&) = delete;
+    mpmc_queue& operator=(const mpmc_queue&) = delete;
+    mpmc_queue& operator=(mpmc_queue&&) = delete;
+
+    static constexpr size_t CACHE_LINE = 64;
+
+    struct cell {
+        std::atomic<uint64_t> seq;
+        T data;
+    };
+
+    struct alignas(CACHE_LINE) cursor {
+        std::atomic<uint64_t> pos{0};
+    };
+
+    cell& at(uint64_t pos) {
+        return m_cells[(0 != m_mask) ? (pos & m_mask) : (pos % m_capacity)];
+    }
+
+    template <typename U>
+    bool enqueue(U&& m) {
+        if (0 == m_capacity) {
+            return false;
+        }
+
+        uint64_t pos = m_enqueue.pos.load(std::memory_order_relaxed);
+        for (;;) {
+            cell& c = at(pos);
+            const uint64_t seq = c.seq.load(std::memory_order_acquire);
+            const int64_t diff = static_cast<int64_t>(seq - pos);
+            if (0 == diff) {
+                if (m_enqueue.pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    c.data = std::forward<U>(m);
+                    c.seq.store(pos + 1, std::memory_order_release);
+                    m_pushed.notify();
+                    return true;
+                }
+            } else if (diff < 0) {
+                /* the cell of pos still holds the item of one round ago: full */
+                return false;
+            } else {
+                pos = m_enqueue.pos.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    bool dequeue(T& m) {
+        if (0 == m_capacity) {
+            return false;
+        }
+
+        uint64_t pos = m_dequeue.pos.load(std::memory_order_relaxed);
+        for (;;) {
+            cell& c = at(pos);
+            const uint64_t seq = c.seq.load(std::memory_order_acquire);
+            const int64_t diff = static_cast<int64_t>(seq - (pos + 1));
+            if (0 == diff) {
+                if (m_dequeue.pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    m = std::move(c.data);
+                    c.seq.store(pos + m_capacity, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                /* the cell of pos is not written yet: empty */
+                return false;
+            } else {
+                pos = m_dequeue.pos.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    template <typename U>
+    bool push_impl(U&& m, int32_t timeout_ms) {
+        if (0 == m_capacity) {
+            return false;
+        }
+
+        if (mpmc_overflow::drop_oldest == m_overflow) {
+            /* enqueue only takes the item on success, so it is forwarded again on every retry */
+            while (!enqueue(std::forward<U>(m))) {
+                T oldest;
+                if (try_pop(oldest)) {
+                    m_dropped.fetch_add(1, std::memory_order_relaxed);
+                    if (m_on_drop) {
+                        m_on_drop(oldest);
+                    }
+                }
+            }
+            return true;
+        }
+
+        if (enqueue(std::forward<U>(m))) {
+            return true;
+        }
+
+        if (0 == timeout_ms) {
+            return false;
+        }
+
+        return wait(m_popped, timeout_ms, [this, &m]() -> bool { return enqueue(std::forward<U>(m)); }, false);
+    }
+
+    template <typename F>
+    bool wait(futex_eventcount& event, int32_t timeout_ms, F&& attempt, bool wakeable) {
+        /* a short spin, then yield so the other side gets the core when threads outnumber cores, then sleep */
+        constexpr int SPIN_COUNT = 32;
+        constexpr int YIELD_COUNT = 8;
+        for (int i = 0; i < SPIN_COUNT + YIELD_COUNT; ++i) {
+            if (attempt()) {
+                return true;
+            }
+            if (i >= SPIN_COUNT) {
+                std::this_thread::yield();
+            }
+        }
+
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+        for (;;) {
+            const uint32_t key = event.prepare_wait();
+            if (attempt()) {
+                return true;
+            }
+
+            if (wakeable && m_wakeup.exchange(false, std::memory_order_acq_rel)) {
+                return false;
+            }
+
+            int32_t remain_ms = -1;
+            if (timeout_ms > 0) {
+                const auto now = std::chrono::steady_clock::now();
+                if (now >= deadline) {
+                    return false;
+                }
+                remain_ms = static_cast<int32_t>(std::chrono::duration_cast<std::chrono::milliseconds>(deadline - now).count()) + 1;
+            }
+
+            event.wait(key, remain_ms);
+        }
+    }
+
+private:
+    uint32_t m_capacity = 0;
+    uint32_t m_mask = 0;
+    std::unique_ptr<cell[]> m_cells;
+    mpmc_overflow m_overflow = mpmc_overflow::reject;
+    std::function<void(T&)> m_on_drop;
+
+    cursor m_enqueue;
+    cursor m_dequeue;
+    futex_eventcount m_pushed;
+    futex_eventcount m_popped;
+    std::atomic<uint64_t> m_dropped{0};
+    std::atomic<bool> m_wakeup{false};
+};
+
+}  // namespace axcl
@@ -0,0 +1,354 @@
+/**************************************************************************************************
+ *
+ * Copyright (c) 2019-2024 Axera Semiconductor Co., Ltd. All Rights Reserved.
+ *
+ * This source file is the property of Axera Semiconductor Co., Ltd. and
+ * may not be copied or distributed in any isomorphic form without the prior
+ * written consent of Axera Semiconductor Co., Ltd.
+ *
+ **************************************************************************************************/
+
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "ringbuf_nowarp.hpp"
+
+namespace axcl {
+
+/*
+ broadcast mode of ringbuf_nowarp: one writer publishes variable size records once, every reader has a cursor of its own.
+   writer: get -> put (or push), the same as ringbuf_nowarp
+   reader: attach -> pop -> free ... -> detach
+
+ - a record never wraps, it is read in place, so N readers cost no copy at all;
+ - the writer never waits for readers: the oldest records are overwritten when space is needed, a reader whose cursor
+   is overwritten is overrun, on its next pop it is either skipped forward to the latest keyframe (SKIP) or disconnected (DISCONNECT);
+ - the only record the writer cannot overwrite is one a reader holds between pop and free, the new record is dropped then,
+   so free a record as soon as it is sent or copied.
+*/
+
+class ringbuf_broadcast {
+public:
+    enum class POLICY {
+        SKIP = 0,       /* jump to the latest keyframe, or wait for the next one */
+        DISCONNECT = 1, /* stop reading, pop fails until detach */
+    };
+
+    struct reader_stat {
+        uint64_t records;  /* records popped */
+        uint64_t skipped;  /* records lost by overruns or passed while waiting for a keyframe */
+        uint32_t overruns; /* times the cursor was overwritten */
+        uint64_t lag;      /* bytes published but not read yet */
+        bool connected;
+    };
+
+    ringbuf_broadcast(uint32_t capacity, uint32_t max_readers, const char *name = nullptr) : m_readers(max_readers) {
+        m_capacity = RINGBUF_ALIGN_TO(capacity, sizeof(record_head));
+        m_buf = new uint8_t[m_capacity];
+        memset(m_buf, 0, m_capacity);
+        if (name) {
+            m_name = name;
+        }
+    }
+
+    ~ringbuf_broadcast() {
+        delete[] m_buf;
+    }
+
+    ringbuf_broadcast(const ringbuf_broadcast &) = delete;
+    ringbuf_broadcast &operator=(const ringbuf_broadcast &) = delete;
+
+    /* reserves space for data.size bytes, fill data.data then put(), records of an overrun reader are overwritten */
+    bool get(ringbuf_data &data, bool key_data) {
+        std::lock_guard<std::mutex> lck(m_mutex);
+        const uint32_t total = RINGBUF_ALIGN_TO(data.size + sizeof(record_head), sizeof(record_head));
+        if (m_pending || total > m_capacity) {
+            ++m_dropped;
+            return false;
+        }
+
+        /* the record does not wrap: pad up to the end of the buffer if it does not fit there */
+        const uint32_t offset = m_tail % m_capacity;
+        if (m_capacity - offset < total) {
+            if (!reclaim(m_tail + m_capacity - offset)) {
+                ++m_dropped;
+                return false;
+            }
+
+            record_head *pad = reinterpret_cast<record_head *>(m_buf + offset);
+            memset(pad, 0, sizeof(record_head));
+            pad->total = m_capacity - offset;
+            pad->is_pad = 1;
+            m_tail += pad->total;
+        }
+
+        if (!reclaim(m_tail + total)) {
+            ++m_dropped;
+            return false;
+        }
+
+        record_head *h = reinterpret_cast<record_head *>(m_buf + m_tail % m_capacity);
+        h->seq = m_seq;
+        h->total = total;
+        h->size = data.size;
+        h->is_key = key_data ? 1 : 0;
+        h->is_pad = 0;
+        data.data = h + 1;
+
+        m_pending = true;
+        return true;
+    }
+
+    /* publishes the record of the last get() to all readers */
+    bool put(ringbuf_data &data) {
+        {
+            std::lock_guard<std::mutex> lck(m_mutex);
+            record_head *h = reinterpret_cast<record_head *>(m_buf + m_tail % m_capacity);
+            if (!m_pending || data.data != static_cast<void *>(h + 1)) {
+                return false;
+            }
+
+            if (h->is_key) {
+                m_last_key = m_tail;
+                m_has_key = true;
+            }
+            m_tail += h->total;
+            ++m_seq;
+            m_pending = false;
+        }
+
+        m_cv.notify_all();
+        return true;
+    }
+
+    /* get, copy and put in one call */
+    bool push(const void *data, uint32_t size, bool key_data) {
+        ringbuf_data rd;
+        rd.size = size;
+        if (!get(rd, key_data)) {
+            return false;
+        }
+        memcpy(rd.data, data, size);
+        return put(rd);
+    }
+
+    /* a new reader starts at the latest keyframe still in the ring, or with the next keyframe; -1 if all slots are taken */
+    int32_t attach(POLICY policy = POLICY::SKIP) {
+        std::lock_guard<std::mutex> lck(m_mutex);
+        for (size_t i = 0; i < m_readers.size(); ++i) {
+            reader &r = m_readers[i];
+            if (!r.attached) {
+                r = reader();
+                r.attached = true;
+                r.policy = policy;
+                seek_key(r);
+                return static_cast<int32_t>(i);
+            }
+        }
+        return -1;
+    }
+
+    /* also ends a pop() of the reader waiting on another thread */
+    void detach(int32_t id) {
+        {
+            std::lock_guard<std::mutex> lck(m_mutex);
+            if (valid(id)) {
+                m_readers[id] = reader();
+            }
+        }
+        m_cv.notify_all();
+    }
+
+    /* the next record of the reader, waits up to timeout ms (-1 forever) for one; it is valid until free() */
+    bool pop(int32_t id, ringbuf_data &data, int32_t timeout = 0) {
+        std::unique_lock<std::mutex> lck(m_mutex);
+        if (!valid(id) || m_readers[id].held) {
+            return false;
+        }
+
+        reader &r = m_readers[id];
+        bool ready = next(r);
+        if (!ready && 0 != timeout && r.connected) {
+            auto done = [this, &r]() { return !r.attached || !r.connected || next(r); };
+            if (timeout < 0) {
+                m_cv.wait(lck, done);
+            } else {
+                m_cv.wait_for(lck, std::chrono::milliseconds(timeout), done);
+            }
+            ready = r.attached && r.connected && next(r);
+        }
+
+        if (!ready) {
+            return false;
+        }
+
+        const record_head *h = reinterpret_cast<const record_head *>(m_buf + r.cursor % m_capacity);
+        data.data = const_cast<record_head *>(h) + 1;
+        data.size = h->size;
+        r.held = true;
+        ++r.records;
+        return true;
+    }
+
+    /* releases the record of the last pop() and moves the cursor past it */
+    void free(int32_t id, ringbuf_data &data) {
+        std::lock_guard<std::mutex> lck(m_mutex);
+        if (!valid(id) || !m_readers[id].held) {
+            return;
+        }
+
+        reader &r = m_readers[id];
+        const record_head *h = reinterpret_cast<const record_head *>(m_buf + r.cursor % m_capacity);
+        if (data.data != static_cast<const void *>(h + 1)) {
+            return;
+        }
+
+        r.held = false;
+        r.cursor += h->total;
+        r.seq = h->seq + 1;
+        data.data = nullptr;
+        data.size = 0;
+    }
+
+    bool stat(int32_t id, reader_stat &s) {
+        std::lock_guard<std::mutex> lck(m_mutex);
+        if (!valid(id)) {
+            return false;
+        }
+
+        const reader &r = m_readers[id];
+        s.records = r.records;
+        s.skipped = r.skipped;
+        s.overruns = r.overruns;
+        s.lag = (r.cursor < m_tail) ? (m_tail - r.cursor) : 0;
+        s.connected = r.connected;
+        return true;
+    }
+
+    /* records the writer dropped: too large, or the space is held by a reader */
+    uint64_t dropped() {
+        std::lock_guard<std::mutex> lck(m_mutex);
+        return m_dropped;
+    }
+
+    uint32_t capacity() const {
+        return m_capacity;
+    }
+
+private:
+    struct record_head {
+        uint64_t seq;
+        uint32_t total; /* head + data, aligned to the head */
+        uint32_t size;
+        uint8_t is_key;
+        uint8_t is_pad; /* unused space up to the end of the buffer */
+        uint8_t reserved[6];
+    };
+
+    struct reader {
+        bool attached = false;
+        bool connected = true;
+        bool held = false;     /* a record is popped and not freed */
+        bool wait_key = false; /* skip records up to the next keyframe */
+        POLICY policy = POLICY::SKIP;
+        uint64_t cursor = 0;   /* position of the next record */
+        uint64_t seq = 0;      /* seq of the next record, to count what is skipped */
+        uint64_t records = 0;
+        uint64_t skipped = 0;
+        uint32_t overruns = 0;
+    };
+
+    bool valid(int32_t id) const {
+        return id >= 0 && static_cast<size_t>(id) < m_readers.size() && m_readers[id].attached;
+    }
+
+    /* moves the head until end - head fits the buffer, nothing is moved if a held record is in the way */
+    bool reclaim(uint64_t end) {
+        uint64_t head = m_head;
+        while (end - head > m_capacity) {
+            for (const auto &r : m_readers) {
+                if (r.attached && r.held && r.cursor == head) {
+                    return false;
+                }
+            }
+
+            head += reinterpret_cast<const record_head *>(m_buf + head % m_capacity)->total;
+        }
+
+        m_head = head;
+        if (m_has_key && m_last_key < m_head) {
+            m_has_key = false;
+        }
+        return true;
+    }
+
+    void seek_key(reader &r) {
+        if (m_has_key) {
+            r.cursor = m_last_key;
+            r.seq = reinterpret_cast<const record_head *>(m_buf + m_last_key % m_capacity)->seq;
+            r.wait_key = false;
+        } else {
+            r.cursor = m_tail;
+            r.seq = m_seq;
+            r.wait_key = true;
+        }
+    }
+
+    /* brings the cursor of r onto a readable record: handles overruns, pads and waiting for a keyframe */
+    bool next(reader &r) {
+        if (!r.connected) {
+            return false;
+        }
+
+        if (r.cursor < m_head) {
+            ++r.overruns;
+            if (POLICY::DISCONNECT == r.policy) {
+                r.connected = false;
+                return false;
+            }
+
+            const uint64_t seq = r.seq;
+            seek_key(r);
+            r.skipped += r.seq - seq;
+        }
+
+        while (r.cursor < m_tail) {
+            const record_head *h = reinterpret_cast<const record_head *>(m_buf + r.cursor % m_capacity);
+            if (h->is_pad) {
+                r.cursor += h->total;
+            } else if (r.wait_key && !h->is_key) {
+                r.cursor += h->total;
+                r.seq = h->seq + 1;
+                ++r.skipped;
+            } else {
+                r.wait_key = false;
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+private:
+    uint8_t *m_buf;
+    uint32_t m_capacity;
+    uint64_t m_head = 0;     /* oldest record still in the buffer */
+    uint64_t m_tail = 0;     /* end of the published records */
+    uint64_t m_seq = 0;      /* seq of the next record */
+    uint64_t m_last_key = 0; /* latest keyframe, valid if m_has_key */
+    bool m_has_key = false;
+    bool m_pending = false;  /* a record is reserved by get() and not put yet */
+    uint64_t m_dropped = 0;
+    std::vector<reader> m_readers;
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+    std::string m_name;
+};
+
+}  // namespace axcl
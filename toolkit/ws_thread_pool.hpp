@@ -0,0 +1,491 @@
+/**************************************************************************************************
+ *
+ * Copyright (c) 2019-2024 Axera Semiconductor Co., Ltd. All Rights Reserved.
+ *
+ * This source file is the property of Axera Semiconductor Co., Ltd. and
+ * may not be copied or distributed in any isomorphic form without the prior
+ * written consent of Axera Semiconductor Co., Ltd.
+ *
+ **************************************************************************************************/
+
+#pragma once
+
+#include <dirent.h>
+#include <pthread.h>
+#include <sched.h>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstring>
+#include <deque>
+#include <exception>
+#include <fstream>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "futex.hpp"
+#include "log/logger.hpp"
+#include "mpmc_queue.hpp"
+
+namespace axcl {
+
+/**
+ * move-only void() callable, callables up to INLINE_SIZE bytes (a lambda capturing a few pointers) are stored in place,
+ * so queuing them takes no heap allocation; bigger ones fall back to the heap.
+ */
+class ws_task {
+public:
+    static constexpr size_t INLINE_SIZE = 48;
+
+    ws_task() = default;
+
+    template <class F, typename = std::enable_if_t<!std::is_same_v<std::decay_t<F>, ws_task>>>
+    ws_task(F&& f) {
+        using T = std::decay_t<F>;
+        if constexpr (sizeof(T) <= INLINE_SIZE && alignof(T) <= alignof(std::max_align_t) && std::is_nothrow_move_constructible_v<T>) {
+            new (m_storage) T(std::forward<F>(f));
+            m_ops = &inline_ops<T>;
+        } else {
+            *reinterpret_cast<T**>(m_storage) = new T(std::forward<F>(f));
+            m_ops = &heap_ops<T>;
+        }
+    }
+
+    ws_task(ws_task&& other) noexcept {
+        move_from(other);
+    }
+
+    ws_task& operator=(ws_task&& other) noexcept {
+        if (this != &other) {
+            reset();
+            move_from(other);
+        }
+        return *this;
+    }
+
+    ~ws_task() {
+        reset();
+    }
+
+    explicit operator bool() const {
+        return nullptr != m_ops;
+    }
+
+    void operator()() {
+        m_ops->invoke(m_storage);
+    }
+
+    void reset(void) {
+        if (m_ops) {
+            m_ops->destroy(m_storage);
+            m_ops = nullptr;
+        }
+    }
+
+private:
+    ws_task(const ws_task&) = delete;
+    ws_task& operator=(const ws_task&) = delete;
+
+    struct ops {
+        void (*invoke)(void*);
+        void (*move)(void* dst, void* src);
+        void (*destroy)(void*);
+    };
+
+    template <class T>
+    static constexpr ops inline_ops = {
+        [](void* p) { (*static_cast<T*>(p))(); },
+        [](void* dst, void* src) { new (dst) T(std::move(*static_cast<T*>(src))); static_cast<T*>(src)->~T(); },
+        [](void* p) { static_cast<T*>(p)->~T(); },
+    };
+
+    template <class T>
+    static constexpr ops heap_ops = {
+        [](void* p) { (**static_cast<T**>(p))(); },
+        [](void* dst, void* src) { *static_cast<T**>(dst) = *static_cast<T**>(src); },
+        [](void* p) { delete *static_cast<T**>(p); },
+    };
+
+    void move_from(ws_task& other) {
+        if (other.m_ops) {
+            other.m_ops->move(m_storage, other.m_storage);
+            m_ops = other.m_ops;
+            other.m_ops = nullptr;
+        }
+    }
+
+private:
+    alignas(std::max_align_t) unsigned char m_storage[INLINE_SIZE];
+    const ops* m_ops = nullptr;
+};
+
+/**
+ * result of a task submitted by ws_thread_pool::submit(future, f), the state lives in this object instead of a heap
+ * block shared with the task, so it must stay where it is (on the stack of the caller, in an array ...) until ready.
+ */
+template <class R>
+class task_future {
+public:
+    task_future() = default;
+    task_future(const task_future&) = delete;
+    task_future& operator=(const task_future&) = delete;
+
+    bool ready(void) const {
+        return 0 != (m_state.load(std::memory_order_acquire) & READY);
+    }
+
+    /* timeout_ms < 0: infinite, returns false on timeout */
+    bool wait(int32_t timeout_ms = -1) {
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+        for (;;) {
+            uint32_t state = m_state.load(std::memory_order_acquire);
+            if (state & READY) {
+                return true;
+            }
+
+            int32_t remain_ms = -1;
+            if (timeout_ms >= 0) {
+                const auto now = std::chrono::steady_clock::now();
+                if (now >= deadline) {
+                    return false;
+                }
+                remain_ms = static_cast<int32_t>(std::chrono::duration_cast<std::chrono::milliseconds>(deadline - now).count()) + 1;
+            }
+
+            if (0 == (state & WAITING) && !m_state.compare_exchange_weak(state, state | WAITING, std::memory_order_acquire)) {
+                continue;
+            }
+            futex_wait(m_state, state | WAITING, remain_ms);
+        }
+    }
+
+    /* waits, then returns the result or rethrows the exception of the task, once */
+    R get(void) {
+        wait();
+        if (m_exception) {
+            std::rethrow_exception(m_exception);
+        }
+        if constexpr (!std::is_void_v<R>) {
+            return std::move(*m_value);
+        }
+    }
+
+    /* makes the future reusable for another submit, not while a task is on it */
+    void reset(void) {
+        m_value.reset();
+        m_exception = nullptr;
+        m_state.store(0, std::memory_order_relaxed);
+    }
+
+private:
+    friend class ws_thread_pool;
+
+    static constexpr uint32_t READY = 1;
+    static constexpr uint32_t WAITING = 2;
+
+    template <class F>
+    void run(F& f) {
+        try {
+            if constexpr (std::is_void_v<R>) {
+                f();
+            } else {
+                m_value.emplace(f());
+            }
+        } catch (...) {
+            m_exception = std::current_exception();
+        }
+
+        if (m_state.fetch_or(READY, std::memory_order_release) & WAITING) {
+            futex_wake(m_state);
+        }
+    }
+
+private:
+    std::atomic<uint32_t> m_state{0};
+    std::optional<std::conditional_t<std::is_void_v<R>, char, R>> m_value;
+    std::exception_ptr m_exception;
+};
+
+enum class ws_lane {
+    normal, /* per worker deques, FIFO for the owner and stolen from the back by idle workers */
+    high,   /* one shared lane, every worker takes from it before its own deque */
+};
+
+/**
+ * work-stealing thread pool:
+ *  - every worker owns a deque, tasks submitted by a worker go to its own deque and stay on that core as long as it
+ *    keeps up, tasks from other threads are spread round robin, idle workers steal from the others;
+ *  - the high lane is for latency sensitive work (encoded packets delivery ...): it is taken before any deque;
+ *  - workers can be pinned to a set of CPUs, for example pcie_local_cpus() of the card;
+ *  - submit() of small callables takes no heap allocation, neither does submit(task_future&, f);
+ *  - exceptions thrown by fire and forget tasks are logged;
+ *  - enqueue() is kept for code written for thread_pool and returns a std::future.
+ */
+class ws_thread_pool {
+public:
+    ws_thread_pool(size_t threads, const std::string& token = "threads", const std::vector<int>& cpus = {}, const int32_t& sched_policy = SCHED_OTHER,
+                   const uint32_t& sched_priority = 0, uint32_t high_lane_depth = 1024)
+        : m_high(high_lane_depth) {
+        if (0 == threads) {
+            threads = 1;
+        }
+
+        for (size_t i = 0; i < threads; ++i) {
+            m_workers.emplace_back(new worker);
+        }
+
+        for (size_t i = 0; i < threads; ++i) {
+            std::string name = (threads > 1) ? (token + "_" + std::to_string(i + 1)) : token;
+            m_workers[i]->thread = std::thread([this, i, name, cpus, sched_policy, sched_priority]() {
+                setup(name, cpus, sched_policy, sched_priority);
+                run(i);
+            });
+        }
+    }
+
+    /* the tasks already queued are run before the workers exit */
+    ~ws_thread_pool() {
+        m_stop.store(true, std::memory_order_release);
+        m_event.broadcast();
+        for (auto& w : m_workers) {
+            w->thread.join();
+        }
+    }
+
+    size_t size(void) const {
+        return m_workers.size();
+    }
+
+    /* fire and forget */
+    template <class F>
+    void submit(F&& f, ws_lane lane = ws_lane::normal) {
+        push(ws_task(std::forward<F>(f)), lane);
+    }
+
+    /* the result goes to 'future', which must outlive the task */
+    template <class R, class F>
+    void submit(task_future<R>& future, F&& f, ws_lane lane = ws_lane::normal) {
+        push(ws_task([&future, f = std::forward<F>(f)]() mutable { future.run(f); }), lane);
+    }
+
+    /* as thread_pool::enqueue */
+    template <class F, class... Args>
+    auto enqueue(F&& f, Args&&... args) -> std::future<std::invoke_result_t<F, Args...>> {
+        using return_type = std::invoke_result_t<F, Args...>;
+
+        auto task = std::make_shared<std::packaged_task<return_type()>>(std::bind(std::forward<F>(f), std::forward<Args>(args)...));
+        std::future<return_type> res = task->get_future();
+        push(ws_task([task]() { (*task)(); }), ws_lane::normal);
+        return res;
+    }
+
+    /* "0-3,8,10-11" to {0, 1, 2, 3, 8, 10, 11} */
+    static std::vector<int> parse_cpu_list(const std::string& list) {
+        std::vector<int> cpus;
+        size_t pos = 0;
+        while (pos < list.size()) {
+            size_t end = list.find(',', pos);
+            if (std::string::npos == end) {
+                end = list.size();
+            }
+
+            const std::string range = list.substr(pos, end - pos);
+            const size_t dash = range.find('-');
+            try {
+                const int first = std::stoi(range.substr(0, dash));
+                const int last = (std::string::npos == dash) ? first : std::stoi(range.substr(dash + 1));
+                for (int cpu = first; cpu <= last; ++cpu) {
+                    cpus.push_back(cpu);
+                }
+            } catch (const std::exception&) {
+                /* blank or malformed item, skipped */
+            }
+            pos = end + 1;
+        }
+        return cpus;
+    }
+
+    /* CPUs of the NUMA node the PCIe card on 'bus' hangs on, empty if unknown */
+    static std::vector<int> pcie_local_cpus(uint32_t bus) {
+        char suffix[16];
+        snprintf(suffix, sizeof(suffix), ":%02x:00.0", bus);
+
+        std::vector<int> cpus;
+        DIR* dir = opendir("/sys/bus/pci/devices");
+        if (!dir) {
+            return cpus;
+        }
+
+        while (struct dirent* entry = readdir(dir)) {
+            const size_t len = strlen(entry->d_name);
+            if (len > strlen(suffix) && 0 == strcmp(entry->d_name + len - strlen(suffix), suffix)) {
+                std::ifstream ifs(std::string("/sys/bus/pci/devices/") + entry->d_name + "/local_cpulist");
+                std::string list;
+                if (std::getline(ifs, list)) {
+                    cpus = parse_cpu_list(list);
+                }
+                break;
+            }
+        }
+
+        closedir(dir);
+        return cpus;
+    }
+
+private:
+    ws_thread_pool(const ws_thread_pool&) = delete;
+    ws_thread_pool& operator=(const ws_thread_pool&) = delete;
+
+    struct alignas(64) worker {
+        std::mutex mtx;
+        std::deque<ws_task> tasks;
+        std::thread thread;
+    };
+
+    static void setup(const std::string& name, const std::vector<int>& cpus, int32_t sched_policy, uint32_t sched_priority) {
+        pthread_setname_np(pthread_self(), name.c_str());
+
+        if (!cpus.empty()) {
+            cpu_set_t set;
+            CPU_ZERO(&set);
+            for (int cpu : cpus) {
+                if (cpu >= 0 && cpu < CPU_SETSIZE) {
+                    CPU_SET(cpu, &set);
+                }
+            }
+            if (int ret = pthread_setaffinity_np(pthread_self(), sizeof(set), &set); 0 != ret) {
+                LOG_MM_W("thread_pool", "{} pin to {} cpus fail, ret = {}", name.c_str(), cpus.size(), ret);
+            }
+        }
+
+        sched_param sch;
+        int policy;
+        pthread_getschedparam(pthread_self(), &policy, &sch);
+        sch.sched_priority = sched_priority;
+        pthread_setschedparam(pthread_self(), sched_policy, &sch);
+    }
+
+    void push(ws_task&& task, ws_lane lane) {
+        const bool inside = (this == tls_pool);
+        if (!inside && m_stop.load(std::memory_order_acquire)) {
+            throw std::runtime_error("enqueue on stopped thread_pool");
+        }
+
+        /* a full high lane falls back to the deques, the task is late but not lost */
+        if (ws_lane::high != lane || !m_high.try_push(std::move(task))) {
+            worker& w = *m_workers[inside ? tls_index : (m_next.fetch_add(1, std::memory_order_relaxed) % m_workers.size())];
+            std::lock_guard<std::mutex> lck(w.mtx);
+            w.tasks.push_back(std::move(task));
+        }
+
+        m_event.notify();
+    }
+
+    bool take(size_t self, ws_task& task) {
+        if (m_high.try_pop(task)) {
+            return true;
+        }
+
+        {
+            worker& w = *m_workers[self];
+            std::lock_guard<std::mutex> lck(w.mtx);
+            if (!w.tasks.empty()) {
+                task = std::move(w.tasks.front());
+                w.tasks.pop_front();
+                return true;
+            }
+        }
+
+        const size_t count = m_workers.size();
+        for (size_t k = 1; k < count; ++k) {
+            worker& victim = *m_workers[(self + k) % count];
+            std::unique_lock<std::mutex> lck(victim.mtx, std::try_to_lock);
+            if (lck.owns_lock() && !victim.tasks.empty()) {
+                task = std::move(victim.tasks.back());
+                victim.tasks.pop_back();
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    /* one more round with blocking locks, try_lock of the steal pass may skip a deque being pushed to */
+    bool take_locked(size_t self, ws_task& task) {
+        if (take(self, task)) {
+            return true;
+        }
+
+        for (auto& victim : m_workers) {
+            std::lock_guard<std::mutex> lck(victim->mtx);
+            if (!victim->tasks.empty()) {
+                task = std::move(victim->tasks.back());
+                victim->tasks.pop_back();
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    void run(size_t self) {
+        tls_pool = this;
+        tls_index = self;
+
+        constexpr int SPIN_COUNT = 16;
+        ws_task task;
+        for (;;) {
+            bool found = false;
+            for (int i = 0; i < SPIN_COUNT && !found; ++i) {
+                found = take(self, task);
+                if (!found) {
+                    std::this_thread::yield();
+                }
+            }
+
+            if (!found) {
+                const uint32_t key = m_event.prepare_wait();
+                found = take_locked(self, task);
+                if (!found) {
+                    if (m_stop.load(std::memory_order_acquire)) {
+                        break;
+                    }
+                    m_event.wait(key);
+                    continue;
+                }
+            }
+
+            try {
+                task();
+            } catch (const std::exception& e) {
+                LOG_MM_E("thread_pool", "task throws: {}", e.what());
+            } catch (...) {
+                LOG_MM_E("thread_pool", "task throws an unknown exception");
+            }
+            task.reset();
+        }
+
+        tls_pool = nullptr;
+    }
+
+private:
+    std::vector<std::unique_ptr<worker>> m_workers;
+    mpmc_queue<ws_task> m_high;
+    futex_eventcount m_event;
+    std::atomic<size_t> m_next{0};
+    std::atomic<bool> m_stop{false};
+
+    static inline thread_local ws_thread_pool* tls_pool = nullptr;
+    static inline thread_local size_t tls_index = 0;
+};
+
+}  // namespace axcl